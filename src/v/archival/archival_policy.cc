@@ -18,6 +18,7 @@
 #include "storage/version.h"
 #include "vlog.h"
 
+#include <seastar/core/coroutine.hh>
 #include <seastar/core/shared_ptr.hh>
 
 namespace archival {
@@ -180,13 +181,15 @@ static upload_candidate create_upload_candidate(
       .content_length = clen};
 }
 
-upload_candidate archival_policy::get_next_candidate(
+ss::future<upload_candidate> archival_policy::get_next_candidate(
   model::offset last_offset, storage::log_manager& lm) {
     auto [segment, ntp_conf] = find_segment(last_offset, lm);
     if (segment.get() == nullptr || ntp_conf == nullptr) {
-        return {};
+        co_return upload_candidate{};
     }
-    return create_upload_candidate(last_offset, segment, ntp_conf);
+    // the index of a sealed segment may have been paged out
+    co_await segment->index().hydrate();
+    co_return create_upload_candidate(last_offset, segment, ntp_conf);
 }
 
 } // namespace archival
@@ -48,7 +48,7 @@ public:
     ///       last_offset because index is sparse and don't have all possible
     ///       offsets. If index is not materialized we will upload log starting
     ///       from the begining.
-    upload_candidate
+    ss::future<upload_candidate>
     get_next_candidate(model::offset last_offset, storage::log_manager& lm);
 
 private:
@@ -14,6 +14,7 @@
 #include "cloud_storage/remote.h"
 #include "cloud_storage/types.h"
 #include "model/metadata.h"
+#include "raft/configuration_manager.h"
 #include "s3/client.h"
 #include "s3/error.h"
 #include "storage/disk_log_impl.h"
@@ -41,11 +42,15 @@ std::ostream& operator<<(std::ostream& o, const configuration& cfg) {
     fmt::print(
       o,
       "{{bucket_name: {}, interval: {}, client_config: {}, connection_limit: "
-      "{}}}",
+      "{}, remote_read_enabled: {}, max_concurrent_reads: {}, "
+      "max_read_memory: {}}}",
       cfg.bucket_name,
       cfg.interval.count(),
       cfg.client_config,
-      cfg.connection_limit);
+      cfg.connection_limit,
+      cfg.remote_read_enabled,
+      cfg.max_concurrent_reads,
+      cfg.max_read_memory);
     return o;
 }
 
@@ -61,7 +66,7 @@ ntp_archiver::ntp_archiver(
   , _remote(remote)
   , _policy(_ntp, _svc_probe, std::ref(_probe))
   , _bucket(conf.bucket_name)
-  , _manifest(_ntp, _rev)
+  , _manifest(ss::make_lw_shared<cloud_storage::manifest>(_ntp, _rev))
   , _gate() {
     vlog(archival_log.trace, "Create ntp_archiver {}", _ntp.path());
 }
@@ -80,6 +85,11 @@ const ss::lowres_clock::time_point ntp_archiver::get_last_upload_time() const {
 }
 
 const cloud_storage::manifest& ntp_archiver::get_remote_manifest() const {
+    return *_manifest;
+}
+
+ss::lw_shared_ptr<const cloud_storage::manifest>
+ntp_archiver::share_remote_manifest() const {
     return _manifest;
 }
 
@@ -88,7 +98,7 @@ ntp_archiver::download_manifest(retry_chain_node& parent) {
     gate_guard guard{_gate};
     retry_chain_node fib(manifest_upload_timeout, 100ms, &parent);
     vlog(archival_log.debug, "{} Downloading manifest for {}", fib(), _ntp);
-    co_return co_await _remote.download_manifest(_bucket, _manifest, fib);
+    co_return co_await _remote.download_manifest(_bucket, *_manifest, fib);
 }
 
 ss::future<cloud_storage::upload_result>
@@ -96,7 +106,7 @@ ntp_archiver::upload_manifest(retry_chain_node& parent) {
     gate_guard guard{_gate};
     retry_chain_node fib(manifest_upload_timeout, 100ms, &parent);
     vlog(archival_log.debug, "{} Uploading manifest for {}", fib(), _ntp);
-    co_return co_await _remote.upload_manifest(_bucket, _manifest, fib);
+    co_return co_await _remote.upload_manifest(_bucket, *_manifest, fib);
 }
 
 ss::future<cloud_storage::upload_result> ntp_archiver::upload_segment(
@@ -122,12 +132,14 @@ ss::future<cloud_storage::upload_result> ntp_archiver::upload_segment(
       candidate.exposed_name,
       candidate.content_length,
       reset_func,
-      _manifest,
+      *_manifest,
       fib);
 }
 
 ss::future<ntp_archiver::batch_result> ntp_archiver::upload_next_candidates(
-  storage::log_manager& lm, retry_chain_node& parent) {
+  storage::log_manager& lm,
+  retry_chain_node& parent,
+  const raft::configuration_manager* cfg) {
     gate_guard guard{_gate};
     auto mlock = co_await ss::get_units(_mutex, 1);
     vlog(
@@ -141,8 +153,8 @@ ss::future<ntp_archiver::batch_result> ntp_archiver::upload_next_candidates(
     // latest uploaded segment but '_policy' requires offset that
     // belongs to the next offset or the gap. No need to do this
     // if there is no segments.
-    auto offset = _manifest.size()
-                    ? _manifest.get_last_offset() + model::offset(1)
+    auto offset = _manifest->size()
+                    ? _manifest->get_last_offset() + model::offset(1)
                     : model::offset(0);
     std::vector<ss::future<cloud_storage::upload_result>> flist;
     std::vector<cloud_storage::manifest::segment_meta> meta;
@@ -155,7 +167,7 @@ ss::future<ntp_archiver::batch_result> ntp_archiver::upload_next_candidates(
           parent(),
           _ntp,
           offset);
-        auto upload = _policy.get_next_candidate(offset, lm);
+        auto upload = co_await _policy.get_next_candidate(offset, lm);
         if (upload.source.get() == nullptr) {
             vlog(
               archival_log.debug,
@@ -164,7 +176,7 @@ ss::future<ntp_archiver::batch_result> ntp_archiver::upload_next_candidates(
               _ntp);
             break;
         }
-        if (_manifest.contains(upload.exposed_name)) {
+        if (_manifest->contains(upload.exposed_name)) {
             // This sholdn't happen normally and indicates an error (e.g.
             // manifest doesn't match the actual data because it was uploaded by
             // different cluster or altered). We can just skip the segment.
@@ -174,7 +186,7 @@ ss::future<ntp_archiver::batch_result> ntp_archiver::upload_next_candidates(
               parent(),
               _ntp,
               upload);
-            const auto& meta = _manifest.get(upload.exposed_name);
+            const auto& meta = _manifest->get(upload.exposed_name);
             offset = meta->committed_offset + model::offset(1);
             continue;
         }
@@ -189,6 +201,10 @@ ss::future<ntp_archiver::batch_result> ntp_archiver::upload_next_candidates(
           .base_offset = upload.starting_offset,
           .committed_offset = upload.source->offsets().committed_offset,
         };
+        if (cfg) {
+            m.delta_offset = model::offset(
+              cfg->offset_delta(upload.starting_offset));
+        }
         meta.emplace_back(m);
         names.emplace_back(upload.exposed_name);
     }
@@ -209,7 +225,7 @@ ss::future<ntp_archiver::batch_result> ntp_archiver::upload_next_candidates(
             break;
         }
         _probe.uploaded(deltas[i]);
-        _manifest.add(segment_name(names[i]), meta[i]);
+        _manifest->add(segment_name(names[i]), meta[i]);
     }
     if (total.num_succeded != 0) {
         vlog(
@@ -17,9 +17,11 @@
 #include "cloud_storage/types.h"
 #include "model/fundamental.h"
 #include "model/metadata.h"
+#include "raft/fwd.h"
 #include "s3/client.h"
 #include "storage/fwd.h"
 #include "storage/segment.h"
+#include "units.h"
 #include "utils/retry_chain_node.h"
 
 #include <seastar/core/abort_source.hh>
@@ -50,6 +52,12 @@ struct configuration {
     service_metrics_disabled svc_metrics_disabled;
     /// Flag that indicates that ntp-archiver level metrics are disabled
     per_ntp_metrics_disabled ntp_metrics_disabled;
+    /// Serve reads of archived data through the partition manager
+    bool remote_read_enabled{false};
+    /// Number of readers of archived data open at the same time
+    size_t max_concurrent_reads{1};
+    /// Bytes of archived data buffered by the readers
+    size_t max_read_memory{1_MiB};
 };
 
 std::ostream& operator<<(std::ostream& o, const configuration& cfg);
@@ -112,6 +120,11 @@ public:
 
     const cloud_storage::manifest& get_remote_manifest() const;
 
+    /// Manifest shared with the readers of archived data, it is updated by
+    /// the archiver and may outlive it
+    ss::lw_shared_ptr<const cloud_storage::manifest>
+    share_remote_manifest() const;
+
     struct batch_result {
         size_t num_succeded;
         size_t num_failed;
@@ -123,9 +136,15 @@ public:
     /// uploading them.
     ///
     /// \param lm is a log manager instance
+    /// \param cfg is the configuration manager of the partition, used to
+    ///        record the kafka offset delta of the uploaded segments. Without
+    ///        it the delta is unknown and the segments can't be served to
+    ///        kafka clients.
     /// \return future that returns number of uploaded/failed segments
-    ss::future<batch_result>
-    upload_next_candidates(storage::log_manager& lm, retry_chain_node& parent);
+    ss::future<batch_result> upload_next_candidates(
+      storage::log_manager& lm,
+      retry_chain_node& parent,
+      const raft::configuration_manager* cfg = nullptr);
 
 private:
     /// Upload individual segment to S3.
@@ -143,7 +162,7 @@ private:
     s3::bucket_name _bucket;
     /// Remote manifest contains representation of the data stored in S3 (it
     /// gets uploaded to the remote location)
-    cloud_storage::manifest _manifest;
+    ss::lw_shared_ptr<cloud_storage::manifest> _manifest;
     ss::gate _gate;
     ss::abort_source _as;
     ss::semaphore _mutex{1};
@@ -152,6 +152,12 @@ scheduler_service_impl::get_archival_service_config() {
         static_cast<bool>(disable_metrics)),
       .ntp_metrics_disabled = per_ntp_metrics_disabled(
         static_cast<bool>(disable_metrics)),
+      .remote_read_enabled
+      = config::shard_local_cfg().cloud_storage_enable_remote_read(),
+      .max_concurrent_reads
+      = config::shard_local_cfg().cloud_storage_max_concurrent_reads(),
+      .max_read_memory
+      = config::shard_local_cfg().cloud_storage_max_read_memory(),
     };
     vlog(archival_log.debug, "Archival configuration generated: {}", cfg);
     co_return cfg;
@@ -161,7 +167,8 @@ scheduler_service_impl::scheduler_service_impl(
   const configuration& conf,
   ss::sharded<storage::api>& api,
   ss::sharded<cluster::partition_manager>& pm,
-  ss::sharded<cluster::topic_table>& tt)
+  ss::sharded<cluster::topic_table>& tt,
+  cloud_storage::cache* cache)
   : _conf(conf)
   , _partition_manager(pm)
   , _topic_table(tt)
@@ -170,14 +177,17 @@ scheduler_service_impl::scheduler_service_impl(
   , _stop_limit(conf.connection_limit())
   , _rtcnode(_as)
   , _probe(conf.svc_metrics_disabled)
-  , _remote(conf.connection_limit, conf.client_config, _probe) {}
+  , _remote(conf.connection_limit, conf.client_config, _probe)
+  , _cache(cache)
+  , _read_limits(conf.max_concurrent_reads, conf.max_read_memory) {}
 
 scheduler_service_impl::scheduler_service_impl(
   ss::sharded<storage::api>& api,
   ss::sharded<cluster::partition_manager>& pm,
   ss::sharded<cluster::topic_table>& tt,
-  ss::sharded<archival::configuration>& config)
-  : scheduler_service_impl(config.local(), api, pm, tt) {}
+  ss::sharded<archival::configuration>& config,
+  ss::sharded<cloud_storage::cache>& cache)
+  : scheduler_service_impl(config.local(), api, pm, tt, &cache.local()) {}
 
 void scheduler_service_impl::rearm_timer() {
     (void)ss::with_gate(_gate, [this] {
@@ -208,21 +218,35 @@ ss::future<> scheduler_service_impl::stop() {
     vlog(archival_log.info, "{} Scheduler service stop", _rtcnode());
     _timer.cancel();
     _as.request_abort(); // interrupt possible sleep
-    return _remote.stop().then([this] {
-        std::vector<ss::future<>> outstanding;
-        for (auto& it : _queue) {
-            auto fut = ss::with_semaphore(
-              _stop_limit, 1, [it] { return it.second.archiver->stop(); });
-            outstanding.emplace_back(std::move(fut));
-        }
-        return ss::do_with(
-          std::move(outstanding),
-          [this](std::vector<ss::future<>>& outstanding) {
-              return ss::when_all_succeed(
-                       outstanding.begin(), outstanding.end())
-                .finally([this] { return _gate.close(); });
-          });
-    });
+    std::vector<model::ntp> remote_partitions;
+    remote_partitions.reserve(_remote_partitions.size());
+    for (const auto& [ntp, _] : _remote_partitions) {
+        remote_partitions.push_back(ntp);
+    }
+    return ss::do_with(
+             std::move(remote_partitions),
+             [this](const std::vector<model::ntp>& ntps) {
+                 return ss::parallel_for_each(
+                   ntps, [this](const model::ntp& ntp) {
+                       return remove_remote_partition(ntp);
+                   });
+             })
+      .then([this] { return _remote.stop(); })
+      .then([this] {
+          std::vector<ss::future<>> outstanding;
+          for (auto& it : _queue) {
+              auto fut = ss::with_semaphore(
+                _stop_limit, 1, [it] { return it.second.archiver->stop(); });
+              outstanding.emplace_back(std::move(fut));
+          }
+          return ss::do_with(
+            std::move(outstanding),
+            [this](std::vector<ss::future<>>& outstanding) {
+                return ss::when_all_succeed(
+                         outstanding.begin(), outstanding.end())
+                  .finally([this] { return _gate.close(); });
+            });
+      });
 }
 
 ss::lw_shared_ptr<ntp_archiver> scheduler_service_impl::get_upload_candidate() {
@@ -295,6 +319,7 @@ ss::future<ss::stop_iteration> scheduler_service_impl::add_ntp_archiver(
           switch (result) {
           case cloud_storage::download_result::success:
               _queue.insert(archiver);
+              add_remote_partition(*archiver);
               vlog(
                 archival_log.info,
                 "{} Found manifest for partition {}",
@@ -305,6 +330,7 @@ ss::future<ss::stop_iteration> scheduler_service_impl::add_ntp_archiver(
                 ss::stop_iteration::yes);
           case cloud_storage::download_result::notfound:
               _queue.insert(archiver);
+              add_remote_partition(*archiver);
               vlog(
                 archival_log.info,
                 "{} Start archiving new partition {}",
@@ -354,6 +380,33 @@ scheduler_service_impl::create_archivers(std::vector<model::ntp> to_create) {
       });
 }
 
+void scheduler_service_impl::add_remote_partition(
+  const ntp_archiver& archiver) {
+    if (!_conf.remote_read_enabled || _cache == nullptr) {
+        return;
+    }
+    auto rp = ss::make_shared<cloud_storage::remote_partition>(
+      archiver.share_remote_manifest(),
+      _remote,
+      *_cache,
+      _conf.bucket_name,
+      _read_limits);
+    _partition_manager.local().register_archival_reader(archiver.get_ntp(), rp);
+    _remote_partitions.insert_or_assign(archiver.get_ntp(), std::move(rp));
+}
+
+ss::future<>
+scheduler_service_impl::remove_remote_partition(const model::ntp& ntp) {
+    auto it = _remote_partitions.find(ntp);
+    if (it == _remote_partitions.end()) {
+        return ss::now();
+    }
+    auto rp = std::move(it->second);
+    _remote_partitions.erase(it);
+    _partition_manager.local().unregister_archival_reader(ntp);
+    return rp->stop().finally([rp] {});
+}
+
 ss::future<>
 scheduler_service_impl::remove_archivers(std::vector<model::ntp> to_remove) {
     gate_guard g(_gate);
@@ -366,10 +419,12 @@ scheduler_service_impl::remove_archivers(std::vector<model::ntp> to_remove) {
                    _rtcnode(),
                    ntp.path());
                  auto archiver = _queue[ntp];
-                 return ss::with_semaphore(
-                          _stop_limit,
-                          1,
-                          [archiver] { return archiver->stop(); })
+                 return remove_remote_partition(ntp)
+                   .then([this, archiver] {
+                       return ss::with_semaphore(_stop_limit, 1, [archiver] {
+                           return archiver->stop();
+                       });
+                   })
                    .finally([this, ntp] {
                        vlog(
                          archival_log.info,
@@ -454,7 +509,16 @@ ss::future<> scheduler_service_impl::run_uploads() {
                     "{} Checking {} for S3 upload candidates",
                     _rtcnode(),
                     archiver->get_ntp());
-                  return archiver->upload_next_candidates(lm, _rtcnode);
+                  auto partition = _partition_manager.local().get(
+                    archiver->get_ntp());
+                  // the partition outlives the upload that reads the
+                  // configurations
+                  return archiver
+                    ->upload_next_candidates(
+                      lm,
+                      _rtcnode,
+                      partition ? &partition->get_cfg_manager() : nullptr)
+                    .finally([partition] {});
               });
 
             auto results = co_await ss::when_all_succeed(
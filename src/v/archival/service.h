@@ -10,7 +10,9 @@
 
 #pragma once
 #include "archival/ntp_archiver_service.h"
+#include "cloud_storage/cache_service.h"
 #include "cloud_storage/manifest.h"
+#include "cloud_storage/remote_partition.h"
 #include "cluster/partition_manager.h"
 #include "model/fundamental.h"
 #include "s3/client.h"
@@ -104,16 +106,20 @@ public:
     /// \param configuration is a archival cnfiguration
     /// \param api is a storage api service instance
     /// \param pm is a partition_manager service instance
+    /// \param cache is the cache of archived segments, reads of archived
+    ///        data are served only if it is set
     scheduler_service_impl(
       const configuration& conf,
       ss::sharded<storage::api>& api,
       ss::sharded<cluster::partition_manager>& pm,
-      ss::sharded<cluster::topic_table>& tt);
+      ss::sharded<cluster::topic_table>& tt,
+      cloud_storage::cache* cache = nullptr);
     scheduler_service_impl(
       ss::sharded<storage::api>& api,
       ss::sharded<cluster::partition_manager>& pm,
       ss::sharded<cluster::topic_table>& tt,
-      ss::sharded<archival::configuration>& configs);
+      ss::sharded<archival::configuration>& configs,
+      ss::sharded<cloud_storage::cache>& cache);
 
     /// \brief Configure scheduler service
     ///
@@ -161,6 +167,12 @@ private:
     /// Adds archiver to the reconciliation loop after fetching its manifest.
     ss::future<ss::stop_iteration>
     add_ntp_archiver(ss::lw_shared_ptr<ntp_archiver> archiver);
+    /// Registers the archived data of the partition with the partition
+    /// manager, if reads of archived data are enabled
+    void add_remote_partition(const ntp_archiver& archiver);
+    /// Unregisters the archived data of the partition and waits for its
+    /// readers
+    ss::future<> remove_remote_partition(const model::ntp& ntp);
 
     configuration _conf;
     ss::sharded<cluster::partition_manager>& _partition_manager;
@@ -176,6 +188,12 @@ private:
     retry_chain_node _rtcnode;
     service_probe _probe;
     cloud_storage::remote _remote;
+    cloud_storage::cache* _cache;
+    cloud_storage::remote_read_limits _read_limits;
+    absl::node_hash_map<
+      model::ntp,
+      ss::shared_ptr<cloud_storage::remote_partition>>
+      _remote_partitions;
 };
 
 } // namespace internal
@@ -279,13 +279,17 @@ FIXTURE_TEST(test_archiver_policy, archiver_fixture) {
     };
     log_segment_set(lm);
     // Starting offset is lower than offset1
-    auto upload1 = policy.get_next_candidate(model::offset(0), lm);
+    auto upload1 = policy.get_next_candidate(model::offset(0), lm).get0();
     log_upload_candidate(upload1);
     BOOST_REQUIRE(upload1.source.get() != nullptr);
     BOOST_REQUIRE(upload1.starting_offset == offset1);
 
-    auto upload2 = policy.get_next_candidate(
-      upload1.source->offsets().committed_offset + model::offset(1), lm);
+    auto upload2 = policy
+                     .get_next_candidate(
+                       upload1.source->offsets().committed_offset
+                         + model::offset(1),
+                       lm)
+                     .get0();
     log_upload_candidate(upload2);
     BOOST_REQUIRE(upload2.source.get() != nullptr);
     BOOST_REQUIRE(upload2.starting_offset() == offset2);
@@ -293,8 +297,12 @@ FIXTURE_TEST(test_archiver_policy, archiver_fixture) {
     BOOST_REQUIRE(upload2.source != upload1.source);
     BOOST_REQUIRE(upload2.source->offsets().base_offset == offset2);
 
-    auto upload3 = policy.get_next_candidate(
-      upload2.source->offsets().committed_offset + model::offset(1), lm);
+    auto upload3 = policy
+                     .get_next_candidate(
+                       upload2.source->offsets().committed_offset
+                         + model::offset(1),
+                       lm)
+                     .get0();
     log_upload_candidate(upload3);
     BOOST_REQUIRE(upload3.source.get() != nullptr);
     BOOST_REQUIRE(upload3.starting_offset() == offset3);
@@ -302,7 +310,11 @@ FIXTURE_TEST(test_archiver_policy, archiver_fixture) {
     BOOST_REQUIRE(upload3.source != upload2.source);
     BOOST_REQUIRE(upload3.source->offsets().base_offset == offset3);
 
-    auto upload4 = policy.get_next_candidate(
-      upload3.source->offsets().committed_offset + model::offset(1), lm);
+    auto upload4 = policy
+                     .get_next_candidate(
+                       upload3.source->offsets().committed_offset
+                         + model::offset(1),
+                       lm)
+                     .get0();
     BOOST_REQUIRE(upload4.source.get() == nullptr);
 }
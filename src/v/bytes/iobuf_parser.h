@@ -66,6 +66,11 @@ public:
 
     bool read_bool() { return bool(consume_type<int8_t>()); }
 
+    template<typename Output>
+    void consume_to(size_t n, Output out) {
+        _in.consume_to(n, out);
+    }
+
     template<typename T>
     T consume_type() {
         return _in.consume_type<T>();
@@ -0,0 +1,272 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "cloud_storage/cache_service.h"
+
+#include "cloud_storage/logger.h"
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "utils/directory_walker.h"
+#include "utils/gate_guard.h"
+#include "vlog.h"
+
+#include <seastar/core/fstream.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/core/smp.hh>
+
+namespace cloud_storage {
+
+static constexpr std::string_view partial_suffix = ".part";
+
+static ss::sstring cache_key(const remote_segment_path& key) {
+    return ss::sstring(key().relative_path().native());
+}
+
+cache::cache(const std::filesystem::path& cache_dir, size_t max_bytes) noexcept
+  : _cache_dir(cache_dir / std::to_string(ss::this_shard_id()))
+  , _max_bytes(max_bytes / ss::smp::count) {}
+
+ss::future<> cache::start() {
+    vlog(
+      cst_log.info,
+      "Starting segment cache in {}, max size {} bytes",
+      _cache_dir,
+      _max_bytes);
+    co_await ss::recursive_touch_directory(_cache_dir.string());
+    co_await adopt_directory(_cache_dir);
+    co_await evict("");
+    setup_metrics();
+}
+
+ss::future<> cache::stop() { return _gate.close(); }
+
+std::filesystem::path cache::data_path(const ss::sstring& key) const {
+    return _cache_dir / std::string_view(key);
+}
+
+ss::future<> cache::adopt_directory(std::filesystem::path dir) {
+    return directory_walker::walk(
+      dir.string(), [this, dir](ss::directory_entry de) -> ss::future<> {
+          auto path = dir / std::string_view(de.name);
+          auto type = de.type;
+          if (!type) {
+              type = co_await ss::file_type(path.string());
+          }
+          if (type == ss::directory_entry_type::directory) {
+              co_await adopt_directory(path);
+          } else if (type == ss::directory_entry_type::regular) {
+              if (std::string_view(de.name).ends_with(partial_suffix)) {
+                  // interrupted download
+                  co_await ss::remove_file(path.string());
+                  co_return;
+              }
+              auto size = co_await ss::file_size(path.string());
+              add_entry(
+                ss::sstring(path.lexically_relative(_cache_dir).native()),
+                size);
+          }
+      });
+}
+
+void cache::add_entry(ss::sstring key, size_t size) {
+    if (auto it = _entries.find(key); it != _entries.end()) {
+        _size_bytes -= it->second.size;
+        _entries.erase(it);
+    }
+    auto [it, _] = _entries.try_emplace(key, key, size);
+    _lru.push_back(it->second);
+    _size_bytes += size;
+}
+
+void cache::touch(entry& e) {
+    e.hook.unlink();
+    _lru.push_back(e);
+}
+
+bool cache::is_cached(const remote_segment_path& key) const {
+    return _entries.contains(cache_key(key));
+}
+
+ss::future<std::optional<cache_item>>
+cache::get(const remote_segment_path& key) {
+    gate_guard guard{_gate};
+    auto item = co_await do_get(cache_key(key));
+    if (item) {
+        ++_hits;
+    } else {
+        ++_misses;
+    }
+    co_return item;
+}
+
+ss::future<std::optional<cache_item>> cache::do_get(const ss::sstring& k) {
+    auto it = _entries.find(k);
+    if (it == _entries.end()) {
+        co_return std::nullopt;
+    }
+    touch(it->second);
+    const auto size = it->second.size;
+    std::optional<cache_item> item;
+    try {
+        auto f = co_await ss::open_file_dma(
+          data_path(k).string(), ss::open_flags::ro);
+        item = cache_item{.body = std::move(f), .size = size};
+    } catch (const std::system_error& e) {
+        // evicted while the file was being opened, or removed by an eviction
+        // racing with a later put of the same key
+        vlog(cst_log.debug, "Cached segment {} is gone: {}", k, e);
+        if (auto it = _entries.find(k); it != _entries.end()) {
+            _size_bytes -= it->second.size;
+            _entries.erase(it);
+        }
+    }
+    co_return item;
+}
+
+ss::future<uint64_t>
+cache::put(const remote_segment_path& key, ss::input_stream<char>& data) {
+    gate_guard guard{_gate};
+    auto k = cache_key(key);
+    auto path = data_path(k);
+    auto tmp = path;
+    tmp += partial_suffix;
+    co_await ss::recursive_touch_directory(path.parent_path().string());
+
+    auto f = co_await ss::open_file_dma(
+      tmp.string(),
+      ss::open_flags::wo | ss::open_flags::create | ss::open_flags::truncate);
+    auto out = co_await ss::make_file_output_stream(f);
+    std::exception_ptr err;
+    try {
+        co_await ss::copy(data, out);
+        co_await out.flush();
+        // the entry may be adopted after a restart, make it durable before
+        // it gets its final name
+        co_await f.flush();
+    } catch (...) {
+        err = std::current_exception();
+    }
+    co_await out.close();
+    if (err) {
+        co_await ss::remove_file(tmp.string());
+        std::rethrow_exception(err);
+    }
+    auto size = co_await ss::file_size(tmp.string());
+    co_await ss::rename_file(tmp.string(), path.string());
+    vlog(cst_log.debug, "Cached segment {}, {} bytes", k, size);
+    ++_puts;
+    add_entry(k, size);
+    co_await evict(k);
+    co_return size;
+}
+
+ss::future<std::optional<cache_item>>
+cache::get_or_hydrate(const remote_segment_path& key, hydrate_fn hydrate) {
+    gate_guard guard{_gate};
+    // the lookup is counted once, reads after hydration are not hits
+    auto k = cache_key(key);
+    if (auto item = co_await do_get(k); item) {
+        ++_hits;
+        co_return item;
+    }
+    ++_misses;
+    if (auto it = _hydrations.find(k); it != _hydrations.end()) {
+        ++_deduplicated;
+        auto p = it->second;
+        co_await p->get_shared_future();
+        co_return co_await do_get(k);
+    }
+    auto p = ss::make_lw_shared<ss::shared_promise<>>();
+    _hydrations.emplace(k, p);
+    std::exception_ptr err;
+    try {
+        co_await hydrate();
+    } catch (...) {
+        err = std::current_exception();
+    }
+    _hydrations.erase(k);
+    if (err) {
+        p->set_exception(err);
+        std::rethrow_exception(err);
+    }
+    p->set_value();
+    co_return co_await do_get(k);
+}
+
+ss::future<> cache::evict(const ss::sstring& skip) {
+    while (_size_bytes > _max_bytes && !_lru.empty()) {
+        auto& victim = _lru.front();
+        if (victim.key == skip) {
+            // the most recent entry, everything else is gone
+            break;
+        }
+        auto key = victim.key;
+        auto path = data_path(key);
+        vlog(
+          cst_log.debug,
+          "Evicting cached segment {}, {} bytes",
+          key,
+          victim.size);
+        _size_bytes -= victim.size;
+        ++_evictions;
+        // unlinks the entry from the lru
+        _entries.erase(key);
+        try {
+            // open handles keep reading the unlinked file
+            co_await ss::remove_file(path.string());
+        } catch (const std::system_error& e) {
+            vlog(
+              cst_log.warn, "Failed to remove cached segment {}: {}", path, e);
+        }
+    }
+}
+
+void cache::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("cloud_storage:cache"),
+      {
+        sm::make_gauge(
+          "size_bytes",
+          [this] { return _size_bytes; },
+          sm::description("Bytes of segments in the cache")),
+        sm::make_gauge(
+          "segments",
+          [this] { return _entries.size(); },
+          sm::description("Number of segments in the cache")),
+        sm::make_derive(
+          "hits",
+          [this] { return _hits; },
+          sm::description("Number of reads served from the cache")),
+        sm::make_derive(
+          "misses",
+          [this] { return _misses; },
+          sm::description("Number of reads of segments not in the cache")),
+        sm::make_derive(
+          "puts",
+          [this] { return _puts; },
+          sm::description("Number of segments added to the cache")),
+        sm::make_derive(
+          "evictions",
+          [this] { return _evictions; },
+          sm::description("Number of segments evicted from the cache")),
+        sm::make_derive(
+          "deduplicated_downloads",
+          [this] { return _deduplicated; },
+          sm::description("Misses that waited for a download already in "
+                          "progress")),
+      });
+}
+
+} // namespace cloud_storage
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#pragma once
+
+#include "cloud_storage/types.h"
+#include "seastarx.h"
+#include "utils/intrusive_list_helpers.h"
+
+#include <seastar/core/file.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/iostream.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/shared_future.hh>
+#include <seastar/core/shared_ptr.hh>
+#include <seastar/util/noncopyable_function.hh>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/node_hash_map.h>
+
+#include <filesystem>
+#include <optional>
+
+namespace cloud_storage {
+
+/// Open handle of a cached remote segment. The file stays readable even if
+/// the entry is evicted while the handle is in use.
+struct cache_item {
+    ss::file body;
+    size_t size;
+};
+
+/// \brief Disk-backed cache of remote segments
+///
+/// Segments downloaded from S3 are stored under the cache directory using
+/// their S3 path, so that reads of archived data don't have to download the
+/// segment again. The cache is shard-local: each shard uses its own
+/// subdirectory and a share of the size budget.
+///
+/// - entries are evicted in least recently used order once the total size
+///   exceeds the budget. The entry being added is never evicted, so a single
+///   segment larger than the budget can still be served.
+/// - concurrent `get_or_hydrate` calls for the same segment share a single
+///   download.
+/// - files left in the directory by a previous run are adopted on start.
+class cache {
+public:
+    /// Downloads a segment and stores it through `put`
+    using hydrate_fn = ss::noncopyable_function<ss::future<>()>;
+
+    /// \param cache_dir is the root directory of the cache
+    /// \param max_bytes is the size budget of the cache on all shards
+    cache(const std::filesystem::path& cache_dir, size_t max_bytes) noexcept;
+
+    cache(const cache&) = delete;
+    cache& operator=(const cache&) = delete;
+    cache(cache&&) = delete;
+    cache& operator=(cache&&) = delete;
+    ~cache() noexcept = default;
+
+    ss::future<> start();
+    ss::future<> stop();
+
+    /// \brief opens the cached copy of \p key, nullopt if it isn't cached
+    ss::future<std::optional<cache_item>> get(const remote_segment_path& key);
+
+    /// \brief stores the content of \p data as \p key, evicting other
+    /// entries when the cache grows over its budget
+    /// \return number of bytes stored
+    ss::future<uint64_t>
+    put(const remote_segment_path& key, ss::input_stream<char>& data);
+
+    /// \brief returns the cached copy of \p key, calling \p hydrate to fetch
+    /// it on a miss. Concurrent misses of the same key wait for one call.
+    ss::future<std::optional<cache_item>>
+    get_or_hydrate(const remote_segment_path& key, hydrate_fn hydrate);
+
+    bool is_cached(const remote_segment_path& key) const;
+    size_t size_bytes() const { return _size_bytes; }
+    size_t max_bytes() const { return _max_bytes; }
+
+private:
+    struct entry {
+        entry(ss::sstring key, size_t size)
+          : key(std::move(key))
+          , size(size) {}
+        ss::sstring key;
+        size_t size;
+        intrusive_list_hook hook;
+    };
+
+    std::filesystem::path data_path(const ss::sstring& key) const;
+    /// lookup that does not count a hit or a miss
+    ss::future<std::optional<cache_item>> do_get(const ss::sstring& key);
+    ss::future<> adopt_directory(std::filesystem::path dir);
+    void add_entry(ss::sstring key, size_t size);
+    void touch(entry&);
+    ss::future<> evict(const ss::sstring& skip);
+    void setup_metrics();
+
+    std::filesystem::path _cache_dir;
+    size_t _max_bytes;
+    size_t _size_bytes{0};
+    ss::gate _gate;
+    // node map, the lru list links entries in place
+    absl::node_hash_map<ss::sstring, entry> _entries;
+    intrusive_list<entry, &entry::hook> _lru;
+    absl::flat_hash_map<ss::sstring, ss::lw_shared_ptr<ss::shared_promise<>>>
+      _hydrations;
+
+    uint64_t _hits{0};
+    uint64_t _misses{0};
+    uint64_t _puts{0};
+    uint64_t _evictions{0};
+    uint64_t _deduplicated{0};
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace cloud_storage
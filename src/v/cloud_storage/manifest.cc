@@ -175,6 +175,10 @@ void manifest::update(const rapidjson::Document& m) {
               .base_offset = model::offset(boffs),
               .committed_offset = model::offset(coffs),
             };
+            if (it->value.HasMember("delta_offset")) {
+                meta.delta_offset = model::offset(
+                  it->value["delta_offset"].GetInt64());
+            }
             tmp.insert(std::make_pair(name, meta));
         }
     }
@@ -223,6 +227,10 @@ void manifest::serialize(std::ostream& out) const {
             w.Int64(meta.committed_offset());
             w.Key("base_offset");
             w.Int64(meta.base_offset());
+            if (meta.delta_offset) {
+                w.Key("delta_offset");
+                w.Int64((*meta.delta_offset)());
+            }
             w.EndObject();
         }
         w.EndObject();
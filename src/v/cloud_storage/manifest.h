@@ -27,6 +27,7 @@
 
 #include <compare>
 #include <iterator>
+#include <optional>
 
 namespace cloud_storage {
 
@@ -70,6 +71,10 @@ public:
         size_t size_bytes;
         model::offset base_offset;
         model::offset committed_offset;
+        /// number of raft configuration batches before the base offset, the
+        /// kafka offset of a batch is its offset minus the delta. Not known
+        /// for the segments uploaded before the field was introduced.
+        std::optional<model::offset> delta_offset;
 
         auto operator<=>(const segment_meta&) const = default;
     };
@@ -381,7 +381,7 @@ ss::future<upload_result> remote::upload_segment(
 ss::future<download_result> remote::download_segment(
   const s3::bucket_name& bucket,
   const segment_name& name,
-  manifest& manifest,
+  const manifest& manifest,
   const try_consume_stream& cons_str,
   retry_chain_node& parent) {
     gate_guard guard{_gate};
@@ -109,7 +109,7 @@ public:
     ss::future<download_result> download_segment(
       const s3::bucket_name& bucket,
       const segment_name& name,
-      manifest& manifest,
+      const manifest& manifest,
       const try_consume_stream& cons_str,
       retry_chain_node& parent);
 
@@ -0,0 +1,332 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "cloud_storage/remote_partition.h"
+
+#include "cloud_storage/logger.h"
+#include "cloud_storage/remote_segment.h"
+#include "utils/gate_guard.h"
+#include "vassert.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+
+#include <fmt/ostream.h>
+
+#include <algorithm>
+
+namespace cloud_storage {
+
+/// Reads consecutive archived segments of a partition. All the segment
+/// readers work on the config of the reader.
+class remote_partition::reader final
+  : public model::record_batch_reader::impl {
+    using storage_t = model::record_batch_reader::storage_t;
+
+public:
+    reader(
+      remote_partition& p,
+      storage::log_reader_config cfg,
+      ss::semaphore_units<> reader_units,
+      ss::semaphore_units<> memory_units)
+      : _partition(p)
+      , _holder(p._gate)
+      , _config(cfg)
+      , _rtc(segment_download_timeout, 100ms, &p._rtc)
+      , _reader_units(std::move(reader_units))
+      , _memory_units(std::move(memory_units)) {}
+
+    ~reader() final {
+        vassert(
+          !_segment, "remote partition reader destroyed with live reader");
+    }
+
+    bool is_end_of_stream() const final { return _done; }
+
+    ss::future<storage_t>
+    do_load_slice(model::timeout_clock::time_point) final {
+        while (!_done) {
+            if (!_segment && !co_await open_next_segment()) {
+                _done = true;
+                break;
+            }
+            auto res = co_await _segment->read_some();
+            if (!res) {
+                vlog(
+                  cst_log.info,
+                  "stopped reading archived segment: {}",
+                  res.error().message());
+                _done = true;
+                break;
+            }
+            if (!res.value().empty()) {
+                co_return std::move(res.value());
+            }
+            // the segment or the budget of the read is exhausted
+            co_await close_segment();
+            _done = _config.over_budget
+                    || _config.bytes_consumed >= _config.max_bytes
+                    || _config.start_offset > _config.max_offset;
+        }
+        co_return storage_t{};
+    }
+
+    ss::future<> finally() noexcept final { return close_segment(); }
+
+    void print(std::ostream& o) final {
+        fmt::print(o, "cloud_storage::remote_partition::reader {}", _config);
+    }
+
+private:
+    ss::future<bool> open_next_segment() {
+        // the first segment is looked up by the kafka start offset of the
+        // read, the following ones by their log offsets
+        auto seg = _next_base_offset == model::offset{}
+                     ? _partition.find_kafka_segment(_config.start_offset)
+                     : _partition.find_segment(_next_base_offset);
+        if (!seg || seg->kafka_base_offset() > _config.max_offset) {
+            co_return false;
+        }
+        _next_base_offset = seg->committed_offset + model::offset(1);
+        try {
+            _segment = co_await make_remote_segment_batch_reader(
+              _partition._api,
+              _partition._cache,
+              _partition._bucket,
+              *_partition._manifest,
+              seg->name,
+              _config,
+              _rtc);
+        } catch (const remote_segment_exception& e) {
+            vlog(
+              cst_log.warn,
+              "{} can't read archived data: {}",
+              _rtc(),
+              e.what());
+            co_return false;
+        }
+        _partition.prefetch(_next_base_offset);
+        co_return true;
+    }
+
+    ss::future<> close_segment() {
+        if (_segment) {
+            co_await _segment->close();
+            _segment.reset();
+        }
+    }
+
+    remote_partition& _partition;
+    ss::gate::holder _holder;
+    storage::log_reader_config _config;
+    retry_chain_node _rtc;
+    ss::semaphore_units<> _reader_units;
+    ss::semaphore_units<> _memory_units;
+    std::unique_ptr<remote_segment_batch_reader> _segment;
+    model::offset _next_base_offset;
+    bool _done{false};
+};
+
+remote_partition::remote_partition(
+  ss::lw_shared_ptr<const manifest> m,
+  remote& api,
+  cache& c,
+  s3::bucket_name bucket,
+  remote_read_limits& limits)
+  : _manifest(std::move(m))
+  , _api(api)
+  , _cache(c)
+  , _bucket(std::move(bucket))
+  , _limits(limits)
+  , _rtc(_as) {}
+
+const std::optional<remote_partition::offset_range>&
+remote_partition::offset_bounds() const {
+    if (
+      _bounds_segments == _manifest->size()
+      && _bounds_last_offset == _manifest->get_last_offset()) {
+        return _bounds;
+    }
+    _bounds.reset();
+    for (const auto& [name, meta] : *_manifest) {
+        if (!meta.delta_offset) {
+            continue;
+        }
+        const auto kafka_base = meta.base_offset - *meta.delta_offset;
+        if (!_bounds) {
+            _bounds = offset_range{
+              .base_offset = meta.base_offset,
+              .committed_offset = meta.committed_offset,
+              .kafka_base_offset = kafka_base};
+            continue;
+        }
+        if (meta.base_offset < _bounds->base_offset) {
+            _bounds->base_offset = meta.base_offset;
+            _bounds->kafka_base_offset = kafka_base;
+        }
+        _bounds->committed_offset = std::max(
+          _bounds->committed_offset, meta.committed_offset);
+    }
+    _bounds_segments = _manifest->size();
+    _bounds_last_offset = _manifest->get_last_offset();
+    return _bounds;
+}
+
+std::optional<model::offset> remote_partition::start_offset() const {
+    if (_gate.is_closed()) {
+        return std::nullopt;
+    }
+    const auto& bounds = offset_bounds();
+    if (!bounds) {
+        return std::nullopt;
+    }
+    return bounds->base_offset;
+}
+
+std::optional<model::offset> remote_partition::last_offset() const {
+    if (_gate.is_closed()) {
+        return std::nullopt;
+    }
+    const auto& bounds = offset_bounds();
+    if (!bounds) {
+        return std::nullopt;
+    }
+    return bounds->committed_offset;
+}
+
+std::optional<model::offset> remote_partition::start_kafka_offset() const {
+    if (_gate.is_closed()) {
+        return std::nullopt;
+    }
+    const auto& bounds = offset_bounds();
+    if (!bounds) {
+        return std::nullopt;
+    }
+    return bounds->kafka_base_offset;
+}
+
+std::optional<remote_partition::segment>
+remote_partition::find_segment(model::offset o) const {
+    // the manifest is ordered by segment name rather than by offset
+    std::optional<segment> res;
+    for (const auto& [name, meta] : *_manifest) {
+        if (!meta.delta_offset || meta.committed_offset < o) {
+            continue;
+        }
+        if (!res || meta.base_offset < res->base_offset) {
+            res = segment{
+              .name = name,
+              .base_offset = meta.base_offset,
+              .committed_offset = meta.committed_offset,
+              .delta_offset = *meta.delta_offset};
+        }
+    }
+    return res;
+}
+
+std::optional<remote_partition::segment>
+remote_partition::find_kafka_segment(model::offset o) const {
+    // the kafka offset range of a segment ends where the one of the next
+    // segment starts, the last kafka offset isn't stored in the manifest
+    std::optional<segment> first;
+    std::optional<segment> res;
+    for (const auto& [name, meta] : *_manifest) {
+        if (!meta.delta_offset) {
+            continue;
+        }
+        segment seg{
+          .name = name,
+          .base_offset = meta.base_offset,
+          .committed_offset = meta.committed_offset,
+          .delta_offset = *meta.delta_offset};
+        if (!first || seg.base_offset < first->base_offset) {
+            first = seg;
+        }
+        if (
+          seg.kafka_base_offset() <= o
+          && (!res || seg.base_offset > res->base_offset)) {
+            res = std::move(seg);
+        }
+    }
+    return res ? res : first;
+}
+
+ss::future<model::record_batch_reader> remote_partition::make_reader(
+  storage::log_reader_config cfg,
+  std::optional<model::timeout_clock::time_point> deadline) {
+    gate_guard guard{_gate};
+    auto acquire = [&deadline](ss::semaphore& sem, size_t units) {
+        if (!deadline) {
+            return ss::get_units(sem, units);
+        }
+        return ss::get_units(
+          sem,
+          units,
+          std::chrono::duration_cast<ss::semaphore::duration>(
+            *deadline - model::timeout_clock::now()));
+    };
+    const auto memory = std::clamp<size_t>(
+      cfg.max_bytes, 1, _limits.max_memory);
+    try {
+        auto reader_units = co_await acquire(_limits.readers, 1);
+        auto memory_units = co_await acquire(_limits.memory, memory);
+        cfg.max_bytes = memory;
+        co_return model::make_record_batch_reader<reader>(
+          *this, cfg, std::move(reader_units), std::move(memory_units));
+    } catch (const ss::semaphore_timed_out&) {
+        vlog(
+          cst_log.debug,
+          "{} read of archived data timed out waiting for the read limits",
+          _manifest->get_ntp());
+    }
+    co_return model::make_memory_record_batch_reader(
+      model::record_batch_reader::data_t{});
+}
+
+void remote_partition::prefetch(model::offset o) {
+    if (_gate.is_closed()) {
+        return;
+    }
+    auto seg = find_segment(o);
+    if (
+      !seg || _prefetching.contains(seg->name)
+      || _cache.is_cached(_manifest->get_remote_segment_path(seg->name))) {
+        return;
+    }
+    _prefetching.insert(seg->name);
+    (void)ss::with_gate(_gate, [this, seg = std::move(*seg)]() mutable {
+        return do_prefetch(std::move(seg));
+    });
+}
+
+ss::future<> remote_partition::do_prefetch(segment seg) {
+    retry_chain_node fib(segment_download_timeout, 100ms, &_rtc);
+    vlog(cst_log.debug, "{} prefetching segment {}", fib(), seg.name);
+    try {
+        auto item = co_await hydrate_remote_segment(
+          _api, _cache, _bucket, *_manifest, seg.name, fib);
+        co_await item.body.close();
+    } catch (...) {
+        vlog(
+          cst_log.info,
+          "{} failed to prefetch segment {}: {}",
+          fib(),
+          seg.name,
+          std::current_exception());
+    }
+    _prefetching.erase(seg.name);
+}
+
+ss::future<> remote_partition::stop() {
+    _as.request_abort();
+    return _gate.close();
+}
+
+} // namespace cloud_storage
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#pragma once
+
+#include "cloud_storage/cache_service.h"
+#include "cloud_storage/manifest.h"
+#include "cloud_storage/remote.h"
+#include "cloud_storage/types.h"
+#include "cluster/archival_reader.h"
+#include "model/record_batch_reader.h"
+#include "s3/client.h"
+#include "storage/types.h"
+#include "utils/retry_chain_node.h"
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/shared_ptr.hh>
+
+#include <absl/container/flat_hash_set.h>
+
+#include <chrono>
+#include <optional>
+#include <utility>
+
+namespace cloud_storage {
+
+using namespace std::chrono_literals;
+
+/// Shard-wide limits of the reads of archived data. Reads of the local log
+/// don't use them, so that catch-up consumers can't starve the consumers of
+/// the tail of the log.
+struct remote_read_limits {
+    remote_read_limits(size_t max_readers, size_t max_memory)
+      : readers(max_readers)
+      , memory(max_memory)
+      , max_memory(max_memory) {}
+
+    /// number of readers open at the same time
+    ss::semaphore readers;
+    /// bytes of batches that the open readers can hold
+    ss::semaphore memory;
+    size_t max_memory;
+};
+
+/// \brief Archived data of a partition
+///
+/// Serves reads of the offsets that were uploaded to S3. The segment that
+/// contains the start offset of a read is looked up in the manifest and read
+/// through the cache. A reader continues into the following segments until
+/// the offset range or the byte budget of the read is exhausted. Reads use
+/// kafka offsets, translated with the offset delta of each segment. Segments
+/// uploaded without the delta are not served.
+///
+/// When a reader opens a segment the next segment of the partition is
+/// hydrated in the background, so that a consumer that catches up
+/// sequentially finds it in the cache.
+class remote_partition final : public cluster::archival_reader {
+public:
+    /// Time budget of a segment download
+    static constexpr ss::lowres_clock::duration segment_download_timeout
+      = 60s;
+
+    /// \param m is the manifest of the partition, it may be updated while
+    ///        the remote partition is in use
+    remote_partition(
+      ss::lw_shared_ptr<const manifest> m,
+      remote& api,
+      cache& c,
+      s3::bucket_name bucket,
+      remote_read_limits& limits);
+
+    /// first archived offset, nullopt if nothing was archived or the
+    /// remote partition is stopped
+    std::optional<model::offset> start_offset() const final;
+
+    /// last archived offset, nullopt if nothing was archived or the remote
+    /// partition is stopped
+    std::optional<model::offset> last_offset() const final;
+
+    /// kafka offset of the first archived batch, nullopt if nothing was
+    /// archived or the remote partition is stopped
+    std::optional<model::offset> start_kafka_offset() const final;
+
+    /// \brief Creates a reader of archived data
+    ///
+    /// The reader holds a share of the read limits until it is closed. If the
+    /// limits aren't available before \p deadline the reader is empty. The
+    /// byte budget of \p cfg is capped to the memory limit.
+    ss::future<model::record_batch_reader> make_reader(
+      storage::log_reader_config cfg,
+      std::optional<model::timeout_clock::time_point> deadline) final;
+
+    /// Waits for the readers and the background downloads to finish
+    ss::future<> stop();
+
+private:
+    class reader;
+    friend class reader;
+
+    struct segment {
+        segment_name name;
+        model::offset base_offset;
+        model::offset committed_offset;
+        model::offset delta_offset;
+
+        model::offset kafka_base_offset() const {
+            return base_offset - delta_offset;
+        }
+    };
+
+    struct offset_range {
+        model::offset base_offset;
+        model::offset committed_offset;
+        model::offset kafka_base_offset;
+    };
+
+    /// \brief finds the segment that contains \p o or the first segment
+    /// after it
+    std::optional<segment> find_segment(model::offset o) const;
+
+    /// \brief finds the segment that contains kafka offset \p o, the first
+    /// segment if \p o is below the archived range
+    std::optional<segment> find_kafka_segment(model::offset o) const;
+
+    /// \brief offset range of the manifest, computed again only when the
+    /// manifest changed since the last call
+    const std::optional<offset_range>& offset_bounds() const;
+
+    /// \brief hydrates the segment that contains \p o in the background
+    void prefetch(model::offset o);
+    ss::future<> do_prefetch(segment);
+
+    ss::lw_shared_ptr<const manifest> _manifest;
+    /// cached offset_bounds() and the manifest state they were computed for,
+    /// the archiver only appends segments to the manifest or replaces it when
+    /// it is downloaded
+    mutable std::optional<offset_range> _bounds;
+    mutable size_t _bounds_segments{0};
+    mutable model::offset _bounds_last_offset;
+    remote& _api;
+    cache& _cache;
+    s3::bucket_name _bucket;
+    remote_read_limits& _limits;
+    ss::gate _gate;
+    ss::abort_source _as;
+    retry_chain_node _rtc;
+    absl::flat_hash_set<segment_name> _prefetching;
+};
+
+} // namespace cloud_storage
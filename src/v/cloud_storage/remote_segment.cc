@@ -0,0 +1,283 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "cloud_storage/remote_segment.h"
+
+#include "cloud_storage/logger.h"
+#include "storage/fs_utils.h"
+#include "storage/parser.h"
+#include "vlog.h"
+
+#include <seastar/core/fstream.hh>
+
+#include <fmt/ostream.h>
+
+namespace cloud_storage {
+
+class remote_segment_batch_reader::consumer final
+  : public storage::batch_consumer {
+public:
+    explicit consumer(remote_segment_batch_reader& r)
+      : _reader(r) {}
+
+    consume_result
+    accept_batch_start(const model::record_batch_header& h) const final {
+        auto& cfg = _reader._config;
+        if (h.base_offset - _reader._delta > cfg.max_offset) {
+            return consume_result::stop_parser;
+        }
+        if (h.type == model::record_batch_type::raft_configuration) {
+            // has no kafka offset
+            return consume_result::skip_batch;
+        }
+        if (
+          (cfg.strict_max_bytes || cfg.bytes_consumed)
+          && (cfg.bytes_consumed + h.size_bytes) > cfg.max_bytes) {
+            cfg.over_budget = true;
+            return consume_result::stop_parser;
+        }
+        const auto last = h.last_offset() - _reader._delta;
+        if (last < cfg.start_offset) {
+            return consume_result::skip_batch;
+        }
+        if (
+          (cfg.type_filter && cfg.type_filter != h.type)
+          || cfg.first_timestamp > h.first_timestamp) {
+            cfg.start_offset = last + model::offset(1);
+            return consume_result::skip_batch;
+        }
+        return consume_result::accept_batch;
+    }
+
+    void
+    consume_batch_start(model::record_batch_header h, size_t, size_t) final {
+        _header = h;
+        _header.base_offset = h.base_offset - _reader._delta;
+        _header.ctx.term = _reader._term;
+    }
+
+    void
+    skip_batch_start(model::record_batch_header h, size_t, size_t) final {
+        if (h.type == model::record_batch_type::raft_configuration) {
+            _reader._delta += h.record_count;
+        }
+    }
+
+    void consume_records(iobuf&& records) final {
+        _records = std::move(records);
+    }
+
+    stop_parser consume_batch_end() final {
+        auto last = _header.last_offset();
+        _reader.add_one(model::record_batch(
+          _header, std::move(_records), model::record_batch::tag_ctor_ng{}));
+        _header = {};
+        return stop_parser(
+          last >= _reader._config.max_offset
+          || _reader._config.bytes_consumed >= _reader._config.max_bytes
+          || _reader._buffer_size >= max_buffer_size);
+    }
+
+    void print(std::ostream& o) const final {
+        fmt::print(o, "cloud_storage::remote_segment_batch_reader::consumer");
+    }
+
+private:
+    remote_segment_batch_reader& _reader;
+    model::record_batch_header _header;
+    iobuf _records;
+};
+
+remote_segment_batch_reader::remote_segment_batch_reader(
+  cache_item item,
+  storage::log_reader_config& cfg,
+  model::term_id term,
+  model::offset delta) noexcept
+  : _item(std::move(item))
+  , _config(cfg)
+  , _term(term)
+  , _delta(delta) {}
+
+ss::future<result<ss::circular_buffer<model::record_batch>>>
+remote_segment_batch_reader::read_some() {
+    using ret_t = result<ss::circular_buffer<model::record_batch>>;
+    if (
+      _config.start_offset > _config.max_offset || _config.over_budget
+      || _config.bytes_consumed >= _config.max_bytes) {
+        co_return ret_t(ss::circular_buffer<model::record_batch>{});
+    }
+    if (!_parser) {
+        ss::file_input_stream_options opts;
+        opts.buffer_size = max_buffer_size;
+        opts.read_ahead = 1;
+        _parser = std::make_unique<storage::continuous_batch_parser>(
+          std::make_unique<consumer>(*this),
+          ss::make_file_input_stream(_item.body, 0, _item.size, opts));
+    }
+    // at the end of the segment the parser consumes nothing and the buffer
+    // stays empty
+    auto res = co_await _parser->consume();
+    if (!res) {
+        co_return ret_t(res.error());
+    }
+    _buffer_size = 0;
+    co_return ret_t(std::exchange(_buffer, {}));
+}
+
+ss::future<> remote_segment_batch_reader::close() {
+    if (_parser) {
+        co_await _parser->close();
+    }
+    try {
+        co_await _item.body.close();
+    } catch (...) {
+        vlog(
+          cst_log.debug,
+          "error closing remote segment: {}",
+          std::current_exception());
+    }
+}
+
+void remote_segment_batch_reader::add_one(model::record_batch&& b) {
+    const auto size = b.header().size_bytes;
+    _config.start_offset = b.header().last_offset() + model::offset(1);
+    _config.bytes_consumed += size;
+    _buffer_size += size;
+    _buffer.emplace_back(std::move(b));
+}
+
+/// Reader of a single archived segment, owns the config of the read
+class single_segment_reader final : public model::record_batch_reader::impl {
+    using storage_t = model::record_batch_reader::storage_t;
+
+public:
+    single_segment_reader(
+      cache_item item,
+      storage::log_reader_config cfg,
+      model::term_id term,
+      model::offset delta) noexcept
+      : _config(cfg)
+      , _reader(std::move(item), _config, term, delta) {}
+
+    bool is_end_of_stream() const final { return _done; }
+
+    ss::future<storage_t>
+    do_load_slice(model::timeout_clock::time_point) final {
+        auto res = co_await _reader.read_some();
+        if (!res) {
+            vlog(
+              cst_log.info,
+              "stopped reading remote segment: {}",
+              res.error().message());
+            _done = true;
+            co_return storage_t{};
+        }
+        _done = res.value().empty();
+        co_return std::move(res.value());
+    }
+
+    ss::future<> finally() noexcept final { return _reader.close(); }
+
+    void print(std::ostream& o) final {
+        fmt::print(
+          o,
+          "cloud_storage::single_segment_reader{{size:{}, {}}}",
+          _reader.size(),
+          _config);
+    }
+
+private:
+    storage::log_reader_config _config;
+    remote_segment_batch_reader _reader;
+    bool _done{false};
+};
+
+static model::term_id segment_term(const segment_name& name) {
+    auto meta = storage::segment_path::parse_segment_filename(name());
+    return meta ? meta->term : model::term_id{};
+}
+
+static model::offset
+segment_delta(const manifest& m, const segment_name& name) {
+    const auto* meta = m.get(name);
+    if (!meta || !meta->delta_offset) {
+        throw remote_segment_exception(fmt::format(
+          "kafka offset delta of segment {} is not known", name));
+    }
+    return *meta->delta_offset;
+}
+
+ss::future<cache_item> hydrate_remote_segment(
+  remote& api,
+  cache& c,
+  const s3::bucket_name& bucket,
+  const manifest& m,
+  const segment_name& name,
+  retry_chain_node& parent) {
+    auto key = m.get_remote_segment_path(name);
+    auto item = co_await c.get_or_hydrate(
+      key, [&api, &c, &bucket, &m, &name, &parent, key]() -> ss::future<> {
+          retry_chain_node fib(&parent);
+          auto res = co_await api.download_segment(
+            bucket,
+            name,
+            m,
+            [&c, key](ss::input_stream<char> is) -> ss::future<uint64_t> {
+                auto size = co_await c.put(key, is);
+                co_await is.close();
+                co_return size;
+            },
+            fib);
+          if (res != download_result::success) {
+              throw remote_segment_exception(fmt::format(
+                "failed to download segment {}: {}",
+                key,
+                static_cast<int32_t>(res)));
+          }
+      });
+    if (!item) {
+        throw remote_segment_exception(
+          fmt::format("segment {} was evicted from the cache", key));
+    }
+    co_return std::move(*item);
+}
+
+ss::future<std::unique_ptr<remote_segment_batch_reader>>
+make_remote_segment_batch_reader(
+  remote& api,
+  cache& c,
+  const s3::bucket_name& bucket,
+  const manifest& m,
+  const segment_name& name,
+  storage::log_reader_config& cfg,
+  retry_chain_node& parent) {
+    const auto delta = segment_delta(m, name);
+    auto item = co_await hydrate_remote_segment(
+      api, c, bucket, m, name, parent);
+    co_return std::make_unique<remote_segment_batch_reader>(
+      std::move(item), cfg, segment_term(name), delta);
+}
+
+ss::future<model::record_batch_reader> make_remote_segment_reader(
+  remote& api,
+  cache& c,
+  const s3::bucket_name& bucket,
+  const manifest& m,
+  const segment_name& name,
+  storage::log_reader_config cfg,
+  retry_chain_node& parent) {
+    const auto delta = segment_delta(m, name);
+    auto item = co_await hydrate_remote_segment(
+      api, c, bucket, m, name, parent);
+    co_return model::make_record_batch_reader<single_segment_reader>(
+      std::move(item), cfg, segment_term(name), delta);
+}
+
+} // namespace cloud_storage
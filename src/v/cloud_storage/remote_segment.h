@@ -0,0 +1,136 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#pragma once
+
+#include "cloud_storage/cache_service.h"
+#include "cloud_storage/manifest.h"
+#include "cloud_storage/remote.h"
+#include "cloud_storage/types.h"
+#include "model/record_batch_reader.h"
+#include "outcome.h"
+#include "s3/client.h"
+#include "storage/parser.h"
+#include "storage/types.h"
+#include "units.h"
+#include "utils/retry_chain_node.h"
+
+#include <seastar/core/circular_buffer.hh>
+
+#include <memory>
+#include <stdexcept>
+
+namespace cloud_storage {
+
+class remote_segment_exception : public std::runtime_error {
+public:
+    explicit remote_segment_exception(const std::string& m)
+      : std::runtime_error(m) {}
+};
+
+/// Reads the batches of a cached segment file. Like the segment reader of the
+/// local log it works on a config owned by the caller, so that a reader
+/// spanning several segments can track its progress across them.
+///
+/// The offsets of the config and of the batches are kafka offsets. Raft
+/// configuration batches are skipped and the offsets of the other batches are
+/// shifted by the number of configuration batches before them, starting with
+/// the delta of the segment recorded in the manifest.
+class remote_segment_batch_reader {
+public:
+    // stop parsing once this many bytes are buffered
+    static constexpr size_t max_buffer_size = 128_KiB;
+
+    remote_segment_batch_reader(
+      cache_item item,
+      storage::log_reader_config& cfg,
+      model::term_id term,
+      model::offset delta) noexcept;
+    remote_segment_batch_reader(remote_segment_batch_reader&&) noexcept
+      = delete;
+    remote_segment_batch_reader&
+    operator=(remote_segment_batch_reader&&) noexcept = delete;
+    remote_segment_batch_reader(const remote_segment_batch_reader&) = delete;
+    remote_segment_batch_reader& operator=(const remote_segment_batch_reader&)
+      = delete;
+    ~remote_segment_batch_reader() noexcept = default;
+
+    /// \brief reads the next batches of the segment. An empty buffer means
+    /// that the segment or the budget of the config is exhausted.
+    ss::future<result<ss::circular_buffer<model::record_batch>>> read_some();
+
+    ss::future<> close();
+
+    size_t size() const { return _item.size; }
+
+private:
+    class consumer;
+
+    void add_one(model::record_batch&&);
+
+    cache_item _item;
+    storage::log_reader_config& _config;
+    model::term_id _term;
+    // number of configuration batches before the current position
+    model::offset _delta;
+    std::unique_ptr<storage::continuous_batch_parser> _parser;
+    ss::circular_buffer<model::record_batch> _buffer;
+    size_t _buffer_size{0};
+};
+
+/// \brief Makes sure that an archived segment is in the cache
+///
+/// On a cache miss the segment is downloaded into the cache first, concurrent
+/// callers for the same segment share the download.
+///
+/// \return open handle of the cached copy
+/// \throws remote_segment_exception if the segment can't be downloaded
+ss::future<cache_item> hydrate_remote_segment(
+  remote& api,
+  cache& c,
+  const s3::bucket_name& bucket,
+  const manifest& m,
+  const segment_name& name,
+  retry_chain_node& parent);
+
+/// \brief Creates a batch reader for an archived segment
+///
+/// \return the reader, which works on \p cfg
+/// \throws remote_segment_exception if the segment can't be downloaded or
+///         its kafka offset delta isn't known
+ss::future<std::unique_ptr<remote_segment_batch_reader>>
+make_remote_segment_batch_reader(
+  remote& api,
+  cache& c,
+  const s3::bucket_name& bucket,
+  const manifest& m,
+  const segment_name& name,
+  storage::log_reader_config& cfg,
+  retry_chain_node& parent);
+
+/// \brief Creates a reader over the batches of an archived segment
+///
+/// The batches are read from the cached copy of the segment, see
+/// `hydrate_remote_segment`. The reader honours the offset range, byte
+/// budget, type filter and timestamp of \p cfg. Offsets are kafka offsets,
+/// see `remote_segment_batch_reader`.
+///
+/// \throws remote_segment_exception if the segment can't be downloaded or
+///         its kafka offset delta isn't known
+ss::future<model::record_batch_reader> make_remote_segment_reader(
+  remote& api,
+  cache& c,
+  const s3::bucket_name& bucket,
+  const manifest& m,
+  const segment_name& name,
+  storage::log_reader_config cfg,
+  retry_chain_node& parent);
+
+} // namespace cloud_storage
@@ -0,0 +1,508 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Licensed as a Redpanda Enterprise file under the Redpanda Community
+ * License (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ * https://github.com/vectorizedio/redpanda/blob/master/licenses/rcl.md
+ */
+
+#include "bytes/iobuf.h"
+#include "bytes/iobuf_parser.h"
+#include "cloud_storage/cache_service.h"
+#include "cloud_storage/remote.h"
+#include "cloud_storage/remote_partition.h"
+#include "cloud_storage/remote_segment.h"
+#include "cloud_storage/tests/s3_imposter.h"
+#include "cloud_storage/types.h"
+#include "random/generators.h"
+#include "ssx/sformat.h"
+#include "storage/segment_appender.h"
+#include "storage/segment_appender_utils.h"
+#include "storage/tests/utils/random_batch.h"
+#include "test_utils/fixture.h"
+#include "utils/file_io.h"
+#include "utils/retry_chain_node.h"
+
+#include <seastar/core/seastar.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/testing/thread_test_case.hh>
+#include <seastar/util/defer.hh>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std::chrono_literals;
+using namespace cloud_storage;
+
+static std::filesystem::path make_cache_dir() {
+    return std::filesystem::path(fmt::format(
+      "test_cloud_storage_cache_{}", random_generators::get_int(1000000)));
+}
+
+static ss::input_stream<char> make_stream(size_t size) {
+    iobuf b;
+    auto data = random_generators::gen_alphanum_string(size);
+    b.append(data.data(), data.size());
+    return make_iobuf_input_stream(std::move(b));
+}
+
+static void put(cache& c, std::string_view key, size_t size) {
+    auto s = make_stream(size);
+    c.put(remote_segment_path(std::filesystem::path(key)), s).get();
+}
+
+static bool is_cached(const cache& c, std::string_view key) {
+    return c.is_cached(remote_segment_path(std::filesystem::path(key)));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_cache_evicts_least_recently_used) {
+    cache c(make_cache_dir(), 100);
+    c.start().get();
+    auto stop = ss::defer([&c] { c.stop().get(); });
+
+    put(c, "a/0-1-v1.log", 40);
+    put(c, "a/40-1-v1.log", 40);
+    BOOST_REQUIRE_EQUAL(c.size_bytes(), 80);
+
+    // make the first segment the most recently used
+    auto item = c.get(remote_segment_path("a/0-1-v1.log")).get0();
+    BOOST_REQUIRE(item);
+    BOOST_REQUIRE_EQUAL(item->size, 40);
+    item->body.close().get();
+
+    put(c, "b/0-1-v1.log", 40);
+    BOOST_REQUIRE(is_cached(c, "a/0-1-v1.log"));
+    BOOST_REQUIRE(!is_cached(c, "a/40-1-v1.log"));
+    BOOST_REQUIRE(is_cached(c, "b/0-1-v1.log"));
+    BOOST_REQUIRE_EQUAL(c.size_bytes(), 80);
+    BOOST_REQUIRE(!c.get(remote_segment_path("a/40-1-v1.log")).get0());
+
+    // a segment larger than the budget is kept on its own
+    put(c, "c/0-1-v1.log", 150);
+    BOOST_REQUIRE(is_cached(c, "c/0-1-v1.log"));
+    BOOST_REQUIRE_EQUAL(c.size_bytes(), 150);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_cache_adopts_files_on_start) {
+    auto dir = make_cache_dir();
+    {
+        cache c(dir, 1000);
+        c.start().get();
+        put(c, "a/0-1-v1.log", 40);
+        put(c, "b/0-1-v1.log", 60);
+        c.stop().get();
+    }
+    cache c(dir, 1000);
+    c.start().get();
+    auto stop = ss::defer([&c] { c.stop().get(); });
+    BOOST_REQUIRE(is_cached(c, "a/0-1-v1.log"));
+    BOOST_REQUIRE(is_cached(c, "b/0-1-v1.log"));
+    BOOST_REQUIRE_EQUAL(c.size_bytes(), 100);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_cache_deduplicates_hydration) {
+    cache c(make_cache_dir(), 1000);
+    c.start().get();
+    auto stop = ss::defer([&c] { c.stop().get(); });
+
+    const auto key = remote_segment_path("a/0-1-v1.log");
+    int hydrations = 0;
+    auto hydrate = [&c, &key, &hydrations]() -> ss::future<> {
+        ++hydrations;
+        co_await ss::sleep(10ms);
+        auto s = make_stream(40);
+        co_await c.put(key, s);
+    };
+    auto f1 = c.get_or_hydrate(key, hydrate);
+    auto f2 = c.get_or_hydrate(key, hydrate);
+    auto i1 = f1.get0();
+    auto i2 = f2.get0();
+    BOOST_REQUIRE_EQUAL(hydrations, 1);
+    BOOST_REQUIRE(i1 && i2);
+    BOOST_REQUIRE_EQUAL(i1->size, 40);
+    BOOST_REQUIRE_EQUAL(i2->size, 40);
+    i1->body.close().get();
+    i2->body.close().get();
+
+    // hits don't hydrate
+    auto i3 = c.get_or_hydrate(key, hydrate).get0();
+    BOOST_REQUIRE_EQUAL(hydrations, 1);
+    i3->body.close().get();
+}
+
+static const auto manifest_ntp = model::ntp( // NOLINT
+  model::ns("test-ns"),
+  model::topic("test-topic"),
+  model::partition_id(42));
+static const auto manifest_revision = model::revision_id(0); // NOLINT
+// NOLINTNEXTLINE
+static const ss::sstring segment_url
+  = "/ce4fd1a3/test-ns/test-topic/42_0/1-2-v1.log";
+
+/// Serializes batches in the on-disk segment format
+static ss::sstring
+make_segment_body(const ss::circular_buffer<model::record_batch>& batches) {
+    auto path = fmt::format(
+      "test_remote_segment_{}.log", random_generators::get_int(1000000));
+    auto f = ss::open_file_dma(
+               path, ss::open_flags::create | ss::open_flags::rw)
+               .get0();
+    storage::segment_appender appender(
+      f, storage::segment_appender::options(ss::default_priority_class(), 1));
+    for (const auto& b : batches) {
+        storage::write(appender, b).get();
+    }
+    appender.close().get();
+    auto buf = read_fully(path).get0();
+    ss::remove_file(path).get();
+    iobuf_parser p(std::move(buf));
+    return p.read_string(p.bytes_left());
+}
+
+static std::vector<model::offset>
+read_offsets(model::record_batch_reader reader) {
+    auto batches = model::consume_reader_to_memory(
+                     std::move(reader), model::no_timeout)
+                     .get0();
+    std::vector<model::offset> offsets;
+    for (const auto& b : batches) {
+        offsets.push_back(b.base_offset());
+    }
+    return offsets;
+}
+
+FIXTURE_TEST(test_remote_segment_reader, s3_imposter_fixture) { // NOLINT
+    auto batches = storage::test::make_random_batches(model::offset(1), 10);
+    std::vector<model::offset> expected;
+    for (const auto& b : batches) {
+        expected.push_back(b.base_offset());
+    }
+    set_expectations_and_listen(
+      {{.url = segment_url, .body = make_segment_body(batches)}});
+
+    service_probe probe;
+    remote api(s3_connection_limit(10), get_configuration(), probe);
+    cache c(make_cache_dir(), 1_GiB);
+    c.start().get();
+    auto stop = ss::defer([&api, &c] {
+        c.stop().get();
+        api.stop().get();
+    });
+    manifest m(manifest_ntp, manifest_revision);
+    auto bucket = s3::bucket_name("bucket");
+    auto name = segment_name("1-2-v1.log");
+    m.add(
+      name,
+      manifest::segment_meta{
+        .is_compacted = false,
+        .size_bytes = 1,
+        .base_offset = model::offset(1),
+        .committed_offset = batches.back().last_offset(),
+        .delta_offset = model::offset(0)});
+    retry_chain_node fib(1s, 20ms);
+
+    auto full = make_remote_segment_reader(
+                  api,
+                  c,
+                  bucket,
+                  m,
+                  name,
+                  storage::log_reader_config(
+                    model::offset(0),
+                    model::model_limits<model::offset>::max(),
+                    ss::default_priority_class()),
+                  fib)
+                  .get0();
+    BOOST_REQUIRE(read_offsets(std::move(full)) == expected);
+    BOOST_REQUIRE_EQUAL(get_requests().size(), 1);
+
+    // the second read is served from the cache
+    auto tail = make_remote_segment_reader(
+                  api,
+                  c,
+                  bucket,
+                  m,
+                  name,
+                  storage::log_reader_config(
+                    expected[5],
+                    model::model_limits<model::offset>::max(),
+                    ss::default_priority_class()),
+                  fib)
+                  .get0();
+    BOOST_REQUIRE(
+      read_offsets(std::move(tail))
+      == std::vector<model::offset>(expected.begin() + 5, expected.end()));
+    BOOST_REQUIRE_EQUAL(get_requests().size(), 1);
+}
+
+/// Archived partition with two consecutive segments
+struct archived_partition {
+    ss::lw_shared_ptr<manifest> m = ss::make_lw_shared<manifest>(
+      manifest_ntp, manifest_revision);
+    std::vector<model::offset> offsets;
+    std::vector<segment_name> names;
+    std::vector<s3_imposter_fixture::expectation> expectations;
+
+    archived_partition() {
+        auto base = model::offset(1);
+        for (int i = 0; i < 2; ++i) {
+            auto batches = storage::test::make_random_batches(base, 10);
+            for (const auto& b : batches) {
+                offsets.push_back(b.base_offset());
+            }
+            auto name = segment_name(ssx::sformat("{}-2-v1.log", base()));
+            auto body = make_segment_body(batches);
+            auto last = batches.back().last_offset();
+            m->add(
+              name,
+              manifest::segment_meta{
+                .is_compacted = false,
+                .size_bytes = body.size(),
+                .base_offset = base,
+                .committed_offset = last,
+                .delta_offset = model::offset(0)});
+            expectations.push_back(
+              {.url = "/" + m->get_remote_segment_path(name)().string(),
+               .body = std::move(body)});
+            names.push_back(name);
+            base = last + model::offset(1);
+        }
+    }
+
+    bool is_cached(const cache& c, size_t segment) const {
+        return c.is_cached(m->get_remote_segment_path(names[segment]));
+    }
+};
+
+FIXTURE_TEST(test_remote_partition_reader, s3_imposter_fixture) { // NOLINT
+    archived_partition p;
+    set_expectations_and_listen(p.expectations);
+
+    service_probe probe;
+    remote api(s3_connection_limit(10), get_configuration(), probe);
+    cache c(make_cache_dir(), 1_GiB);
+    c.start().get();
+    remote_read_limits limits(4, 1_MiB);
+    remote_partition rp(p.m, api, c, s3::bucket_name("bucket"), limits);
+    auto stop = ss::defer([&api, &c, &rp] {
+        rp.stop().get();
+        c.stop().get();
+        api.stop().get();
+    });
+    BOOST_REQUIRE_EQUAL(*rp.start_offset(), model::offset(1));
+
+    // a read that spans both segments
+    auto full = rp.make_reader(
+                    storage::log_reader_config(
+                      model::offset(0),
+                      model::model_limits<model::offset>::max(),
+                      ss::default_priority_class()),
+                    std::nullopt)
+                  .get0();
+    BOOST_REQUIRE(read_offsets(std::move(full)) == p.offsets);
+    BOOST_REQUIRE_EQUAL(limits.readers.available_units(), 4);
+    BOOST_REQUIRE_EQUAL(limits.memory.available_units(), 1_MiB);
+
+    // a read that starts in the middle of the second segment
+    auto tail = rp.make_reader(
+                    storage::log_reader_config(
+                      p.offsets[15],
+                      model::model_limits<model::offset>::max(),
+                      ss::default_priority_class()),
+                    std::nullopt)
+                  .get0();
+    BOOST_REQUIRE(
+      read_offsets(std::move(tail))
+      == std::vector<model::offset>(p.offsets.begin() + 15, p.offsets.end()));
+    BOOST_REQUIRE_EQUAL(get_requests().size(), 2);
+}
+
+FIXTURE_TEST(test_remote_partition_prefetch, s3_imposter_fixture) { // NOLINT
+    archived_partition p;
+    set_expectations_and_listen(p.expectations);
+
+    service_probe probe;
+    remote api(s3_connection_limit(10), get_configuration(), probe);
+    cache c(make_cache_dir(), 1_GiB);
+    c.start().get();
+    remote_read_limits limits(4, 1_MiB);
+    remote_partition rp(p.m, api, c, s3::bucket_name("bucket"), limits);
+    auto stop = ss::defer([&api, &c, &rp] {
+        rp.stop().get();
+        c.stop().get();
+        api.stop().get();
+    });
+
+    // reading the first segment hydrates the second one in the background
+    auto first = rp.make_reader(
+                     storage::log_reader_config(
+                       model::offset(0),
+                       p.offsets[9],
+                       ss::default_priority_class()),
+                     std::nullopt)
+                   .get0();
+    BOOST_REQUIRE(
+      read_offsets(std::move(first))
+      == std::vector<model::offset>(p.offsets.begin(), p.offsets.begin() + 10));
+    for (int i = 0; i < 100 && !p.is_cached(c, 1); ++i) {
+        ss::sleep(10ms).get();
+    }
+    BOOST_REQUIRE(p.is_cached(c, 0));
+    BOOST_REQUIRE(p.is_cached(c, 1));
+    BOOST_REQUIRE_EQUAL(get_requests().size(), 2);
+}
+
+FIXTURE_TEST(test_remote_partition_read_limits, s3_imposter_fixture) { // NOLINT
+    archived_partition p;
+    set_expectations_and_listen(p.expectations);
+
+    service_probe probe;
+    remote api(s3_connection_limit(10), get_configuration(), probe);
+    cache c(make_cache_dir(), 1_GiB);
+    c.start().get();
+    remote_read_limits limits(1, 1_MiB);
+    remote_partition rp(p.m, api, c, s3::bucket_name("bucket"), limits);
+    auto stop = ss::defer([&api, &c, &rp] {
+        rp.stop().get();
+        c.stop().get();
+        api.stop().get();
+    });
+    auto cfg = storage::log_reader_config(
+      model::offset(0),
+      model::model_limits<model::offset>::max(),
+      ss::default_priority_class());
+
+    // the byte budget of a read is capped by the memory limit
+    auto held = rp.make_reader(cfg, std::nullopt).get0();
+    BOOST_REQUIRE_EQUAL(limits.readers.available_units(), 0);
+    BOOST_REQUIRE_EQUAL(limits.memory.available_units(), 0);
+
+    // no reader is available, the read gives up at the deadline
+    auto empty = rp.make_reader(cfg, model::timeout_clock::now() + 10ms).get0();
+    BOOST_REQUIRE(read_offsets(std::move(empty)).empty());
+
+    BOOST_REQUIRE(read_offsets(std::move(held)) == p.offsets);
+    BOOST_REQUIRE_EQUAL(limits.readers.available_units(), 1);
+}
+
+FIXTURE_TEST(test_remote_partition_offset_bounds, s3_imposter_fixture) { // NOLINT
+    archived_partition p;
+    set_expectations_and_listen({});
+
+    service_probe probe;
+    remote api(s3_connection_limit(10), get_configuration(), probe);
+    cache c(make_cache_dir(), 1_GiB);
+    c.start().get();
+    remote_read_limits limits(4, 1_MiB);
+    auto rp = std::make_unique<remote_partition>(
+      p.m, api, c, s3::bucket_name("bucket"), limits);
+    auto stop = ss::defer([&api, &c] {
+        c.stop().get();
+        api.stop().get();
+    });
+    BOOST_REQUIRE_EQUAL(*rp->start_offset(), model::offset(1));
+    BOOST_REQUIRE_EQUAL(*rp->last_offset(), p.offsets.back());
+
+    // the bounds follow the segments added by the archiver
+    auto base = p.m->get_last_offset() + model::offset(1);
+    p.m->add(
+      segment_name(ssx::sformat("{}-2-v1.log", base())),
+      manifest::segment_meta{
+        .is_compacted = false,
+        .size_bytes = 1,
+        .base_offset = base,
+        .committed_offset = base + model::offset(10),
+        .delta_offset = model::offset(0)});
+    BOOST_REQUIRE_EQUAL(*rp->start_offset(), model::offset(1));
+    BOOST_REQUIRE_EQUAL(*rp->last_offset(), base + model::offset(10));
+
+    // segments uploaded without the kafka offset delta are not served
+    p.m->add(
+      segment_name("0-1-v1.log"),
+      manifest::segment_meta{
+        .is_compacted = false,
+        .size_bytes = 1,
+        .base_offset = model::offset(0),
+        .committed_offset = model::offset(0)});
+    BOOST_REQUIRE_EQUAL(*rp->start_offset(), model::offset(1));
+
+    // nothing is served once the remote partition is stopped, the manifest
+    // is shared and outlives the archiver
+    rp->stop().get();
+    BOOST_REQUIRE(!rp->start_offset());
+    BOOST_REQUIRE(!rp->last_offset());
+    rp.reset();
+    BOOST_REQUIRE_EQUAL(p.m->size(), 4);
+}
+
+FIXTURE_TEST(test_remote_partition_kafka_offsets, s3_imposter_fixture) { // NOLINT
+    // two configuration batches precede the segment and one is in its middle
+    const auto delta = model::offset(2);
+    ss::circular_buffer<model::record_batch> batches;
+    std::vector<model::offset> expected;
+    auto next = model::offset(10);
+    for (int i = 0; i < 6; ++i) {
+        auto b = storage::test::make_random_batch(
+          next,
+          i == 3 ? 1 : 3,
+          false,
+          i == 3 ? model::record_batch_type::raft_configuration
+                 : model::record_batch_type::raft_data);
+        next = b.last_offset() + model::offset(1);
+        if (i != 3) {
+            expected.push_back(
+              b.base_offset() - delta - model::offset(i > 3 ? 1 : 0));
+        }
+        batches.push_back(std::move(b));
+    }
+    auto m = ss::make_lw_shared<manifest>(manifest_ntp, manifest_revision);
+    auto name = segment_name("10-2-v1.log");
+    auto body = make_segment_body(batches);
+    m->add(
+      name,
+      manifest::segment_meta{
+        .is_compacted = false,
+        .size_bytes = body.size(),
+        .base_offset = model::offset(10),
+        .committed_offset = batches.back().last_offset(),
+        .delta_offset = delta});
+    set_expectations_and_listen(
+      {{.url = "/" + m->get_remote_segment_path(name)().string(),
+        .body = std::move(body)}});
+
+    service_probe probe;
+    remote api(s3_connection_limit(10), get_configuration(), probe);
+    cache c(make_cache_dir(), 1_GiB);
+    c.start().get();
+    remote_read_limits limits(4, 1_MiB);
+    remote_partition rp(m, api, c, s3::bucket_name("bucket"), limits);
+    auto stop = ss::defer([&api, &c, &rp] {
+        rp.stop().get();
+        c.stop().get();
+        api.stop().get();
+    });
+    BOOST_REQUIRE_EQUAL(*rp.start_offset(), model::offset(10));
+    BOOST_REQUIRE_EQUAL(*rp.start_kafka_offset(), model::offset(8));
+
+    auto full = rp.make_reader(
+                    storage::log_reader_config(
+                      model::offset(0),
+                      model::model_limits<model::offset>::max(),
+                      ss::default_priority_class()),
+                    std::nullopt)
+                  .get0();
+    BOOST_REQUIRE(read_offsets(std::move(full)) == expected);
+
+    // a read that starts right after the configuration batch
+    auto tail = rp.make_reader(
+                    storage::log_reader_config(
+                      expected[3],
+                      model::model_limits<model::offset>::max(),
+                      ss::default_priority_class()),
+                    std::nullopt)
+                  .get0();
+    BOOST_REQUIRE(
+      read_offsets(std::move(tail))
+      == std::vector<model::offset>(expected.begin() + 3, expected.end()));
+}
@@ -134,6 +134,7 @@ SEASTAR_THREAD_TEST_CASE(test_manifest_serialization) {
         .size_bytes = 2048,
         .base_offset = model::offset(20),
         .committed_offset = model::offset(29),
+        .delta_offset = model::offset(3),
       });
     auto [is, size] = m.serialize();
     iobuf buf;
@@ -145,6 +146,11 @@ SEASTAR_THREAD_TEST_CASE(test_manifest_serialization) {
     restored.update(std::move(rstr)).get0();
 
     BOOST_REQUIRE(m == restored);
+    BOOST_REQUIRE(
+      !restored.get(segment_name("10-1-v1.log"))->delta_offset.has_value());
+    BOOST_REQUIRE_EQUAL(
+      *restored.get(segment_name("20-1-v1.log"))->delta_offset,
+      model::offset(3));
 }
 
 SEASTAR_THREAD_TEST_CASE(test_manifest_difference) {
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "model/fundamental.h"
+#include "model/record_batch_reader.h"
+#include "model/timeout_clock.h"
+#include "seastarx.h"
+#include "storage/types.h"
+
+#include <seastar/core/future.hh>
+
+#include <optional>
+
+namespace cluster {
+
+/**
+ * Read access to the data of a partition that was uploaded to archival
+ * storage, including the offsets that were already removed from the local
+ * log. The offset bounds are log offsets, like the ones of the local log.
+ * Reads use kafka offsets, the local translation history doesn't reach the
+ * offsets that were removed from the local log so the archived data is
+ * translated with the offset delta recorded for each archived segment.
+ *
+ * Implemented by the archival subsystem, which registers a reader with the
+ * partition manager for every partition it archives.
+ */
+class archival_reader {
+public:
+    archival_reader() = default;
+    archival_reader(const archival_reader&) = delete;
+    archival_reader& operator=(const archival_reader&) = delete;
+    archival_reader(archival_reader&&) = delete;
+    archival_reader& operator=(archival_reader&&) = delete;
+    virtual ~archival_reader() = default;
+
+    /// first offset available in archival storage, nullopt if none
+    virtual std::optional<model::offset> start_offset() const = 0;
+
+    /// last offset available in archival storage, nullopt if none
+    virtual std::optional<model::offset> last_offset() const = 0;
+
+    /// kafka offset of the first batch available in archival storage, nullopt
+    /// if none
+    virtual std::optional<model::offset> start_kafka_offset() const = 0;
+
+    /// reads the batches of the kafka offset range of \p cfg that are
+    /// available in archival storage, the batches carry kafka offsets. The
+    /// reader ends at the end of the uploaded data.
+    virtual ss::future<model::record_batch_reader> make_reader(
+      storage::log_reader_config cfg,
+      std::optional<model::timeout_clock::time_point> deadline)
+      = 0;
+};
+
+} // namespace cluster
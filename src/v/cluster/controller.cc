@@ -13,6 +13,7 @@
 #include "cluster/controller_api.h"
 #include "cluster/controller_backend.h"
 #include "cluster/controller_service.h"
+#include "cluster/leader_balancer.h"
 #include "cluster/logger.h"
 #include "cluster/members_frontend.h"
 #include "cluster/members_manager.h"
@@ -162,6 +163,20 @@ ss::future<> controller::start() {
             std::ref(_shard_table),
             std::ref(_connections),
             std::ref(_as));
+      })
+      .then([this] {
+          return _leader_balancer.start_single(
+            _raft0,
+            std::ref(_tp_state),
+            std::ref(_partition_leaders),
+            std::ref(_members_table),
+            std::ref(_shard_table),
+            std::ref(_partition_manager),
+            std::ref(_connections));
+      })
+      .then([this] {
+          return _leader_balancer.invoke_on(
+            leader_balancer::shard, &leader_balancer::start);
       });
 }
 
@@ -181,7 +196,8 @@ ss::future<> controller::stop() {
     }
 
     return f.then([this] {
-        return _api.stop()
+        return _leader_balancer.stop()
+          .then([this] { return _api.stop(); })
           .then([this] { return _backend.stop(); })
           .then([this] { return _tp_frontend.stop(); })
           .then([this] { return _security_frontend.stop(); })
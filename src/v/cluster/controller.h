@@ -61,6 +61,10 @@ public:
         return _members_frontend;
     }
 
+    ss::sharded<leader_balancer>& get_leader_balancer() {
+        return _leader_balancer;
+    }
+
     ss::future<> wire_up();
 
     ss::future<> start();
@@ -82,6 +86,7 @@ private:
     ss::sharded<controller_service> _service;        // instance per core
     ss::sharded<controller_api> _api;                // instance per core
     ss::sharded<members_frontend> _members_frontend; // instance per core
+    ss::sharded<leader_balancer> _leader_balancer;   // single instance
     ss::sharded<rpc::connection_cache>& _connections;
     ss::sharded<partition_manager>& _partition_manager;
     ss::sharded<shard_table>& _shard_table;
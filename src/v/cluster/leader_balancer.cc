@@ -0,0 +1,354 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/leader_balancer.h"
+
+#include "cluster/logger.h"
+#include "cluster/members_table.h"
+#include "cluster/partition_leaders_table.h"
+#include "cluster/partition_manager.h"
+#include "cluster/shard_table.h"
+#include "cluster/topic_table.h"
+#include "config/configuration.h"
+#include "raft/errc.h"
+#include "raft/raftgen_service.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+
+namespace cluster {
+
+leader_balancer::leader_balancer(
+  consensus_ptr raft0,
+  ss::sharded<topic_table>& topics,
+  ss::sharded<partition_leaders_table>& leaders,
+  ss::sharded<members_table>& members,
+  ss::sharded<shard_table>& shard_table,
+  ss::sharded<partition_manager>& partition_manager,
+  ss::sharded<rpc::connection_cache>& connections)
+  : _enabled(config::shard_local_cfg().enable_leader_balancer())
+  , _interval(config::shard_local_cfg().leader_balancer_interval_ms())
+  , _mute_timeout(config::shard_local_cfg().leader_balancer_mute_timeout_ms())
+  , _node_mute_timeout(
+      config::shard_local_cfg().leader_balancer_node_mute_timeout_ms())
+  , _transfers_per_round(
+      config::shard_local_cfg().leader_balancer_transfers_per_round())
+  , _raft0(std::move(raft0))
+  , _topics(topics)
+  , _leaders(leaders)
+  , _members(members)
+  , _shard_table(shard_table)
+  , _partition_manager(partition_manager)
+  , _connections(connections) {}
+
+ss::future<> leader_balancer::start() {
+    if (!_enabled) {
+        vlog(clusterlog.info, "Leader balancer is disabled");
+        return ss::now();
+    }
+    _timer.set_callback([this] { (void)balance(); });
+    arm_timer(_interval);
+    return ss::now();
+}
+
+ss::future<> leader_balancer::stop() {
+    _timer.cancel();
+    return _gate.close();
+}
+
+void leader_balancer::arm_timer(clock_type::duration timeout) {
+    if (!_gate.is_closed()) {
+        _timer.arm(timeout);
+    }
+}
+
+ss::future<> leader_balancer::balance() {
+    return ss::with_gate(_gate, [this] {
+               return do_balance().handle_exception(
+                 [](const std::exception_ptr& e) {
+                     vlog(
+                       clusterlog.warn,
+                       "Error while balancing partition leaders - {}",
+                       e);
+                 });
+           })
+      .finally([this] { arm_timer(_interval); })
+      .handle_exception_type([](const ss::gate_closed_exception&) {});
+}
+
+ss::future<> leader_balancer::do_balance() {
+    if (!_raft0->is_leader()) {
+        _active_since.reset();
+        _node_alive.clear();
+        _muted_nodes.clear();
+        _muted_groups.clear();
+        co_return;
+    }
+
+    const auto now = clock_type::now();
+    if (!_active_since) {
+        // controller leadership was just acquired, the leaders table is not
+        // yet up to date and the other nodes may still be starting up
+        vlog(clusterlog.info, "Leader balancer activated");
+        _active_since = now;
+    }
+    auto muted_nodes = update_muted_nodes();
+    auto muted_groups = leader_balancer::muted_groups();
+
+    auto strategy = make_strategy();
+    _shard_imbalance = strategy.shard_imbalance();
+    _node_imbalance = strategy.node_imbalance();
+    _last_leaders.clear();
+    for (const auto& [node, shards] : strategy.shard_leaders()) {
+        for (uint32_t core = 0; core < shards.size(); ++core) {
+            _last_leaders.push_back(shard_leaders{
+              .node = node, .core = core, .leaders = shards[core]});
+        }
+    }
+
+    if (now < *_active_since + _node_mute_timeout) {
+        vlog(
+          clusterlog.debug,
+          "Leader balancer is muted after activation, shard imbalance: {}",
+          _shard_imbalance);
+        co_return;
+    }
+
+    std::vector<leader_balancer_strategy::reassignment> movements;
+    while (movements.size() < _transfers_per_round) {
+        auto movement = strategy.find_movement(muted_groups, muted_nodes);
+        if (!movement) {
+            break;
+        }
+        strategy.apply_movement(*movement);
+        muted_groups.insert(movement->group);
+        movements.push_back(std::move(*movement));
+    }
+
+    if (movements.empty()) {
+        vlog(
+          clusterlog.trace,
+          "No leadership transfers, shard imbalance: {}, node imbalance: {}",
+          _shard_imbalance,
+          _node_imbalance);
+        co_return;
+    }
+
+    vlog(
+      clusterlog.info,
+      "Transferring leadership of {} groups, shard imbalance: {} -> {}, node "
+      "imbalance: {} -> {}",
+      movements.size(),
+      _shard_imbalance,
+      strategy.shard_imbalance(),
+      _node_imbalance,
+      strategy.node_imbalance());
+
+    for (auto& m : movements) {
+        _muted_groups[m.group] = now + _mute_timeout;
+    }
+
+    std::vector<ss::future<bool>> transfers;
+    transfers.reserve(movements.size());
+    for (auto& m : movements) {
+        transfers.push_back(transfer_leadership(std::move(m)));
+    }
+    auto results = co_await ss::when_all_succeed(
+      transfers.begin(), transfers.end());
+    for (auto success : results) {
+        ++_transfers;
+        if (!success) {
+            ++_failed_transfers;
+        }
+    }
+}
+
+leader_balancer_strategy leader_balancer::make_strategy() const {
+    absl::flat_hash_map<model::node_id, uint32_t> cores;
+    for (const auto& broker : _members.local().all_brokers()) {
+        if (
+          broker->get_membership_state() != model::membership_state::active) {
+            // draining nodes are neither given nor keep any leaders in the
+            // plan, the movements out of them are left to the decommissioning
+            continue;
+        }
+        cores.emplace(broker->id(), broker->properties().cores);
+    }
+
+    std::vector<leader_balancer_strategy::group_replicas> groups;
+    const auto& leaders = _leaders.local();
+    const auto& topics = _topics.local();
+    topics.for_each_partition_assignment(
+      [&](const model::topic_namespace& tp_ns, const partition_assignment& p) {
+          model::ntp ntp(tp_ns.ns, tp_ns.tp, p.id);
+          auto leader_id = leaders.get_leader(ntp);
+          if (!leader_id || !cores.contains(*leader_id)) {
+              return;
+          }
+          if (topics.is_update_in_progress(ntp)) {
+              return;
+          }
+          auto leader = std::find_if(
+            p.replicas.begin(),
+            p.replicas.end(),
+            [&leader_id](const model::broker_shard& bs) {
+                return bs.node_id == *leader_id;
+            });
+          if (leader == p.replicas.end()) {
+              return;
+          }
+          groups.push_back(leader_balancer_strategy::group_replicas{
+            .ntp = std::move(ntp),
+            .group = p.group,
+            .leader = *leader,
+            .replicas = p.replicas});
+      });
+
+    return leader_balancer_strategy(std::move(groups), std::move(cores));
+}
+
+absl::flat_hash_set<model::node_id> leader_balancer::update_muted_nodes() {
+    const auto now = clock_type::now();
+    for (const auto& f : _raft0->get_follower_metrics()) {
+        auto [it, inserted] = _node_alive.try_emplace(f.id, f.is_live);
+        if (!inserted && f.is_live && !it->second) {
+            vlog(
+              clusterlog.info,
+              "Node {} is back, muting it in leader balancer for {}ms",
+              f.id,
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                _node_mute_timeout)
+                .count());
+            _muted_nodes[f.id] = now + _node_mute_timeout;
+        }
+        it->second = f.is_live;
+        if (!f.is_live) {
+            // dead nodes are not able to take leadership
+            _muted_nodes[f.id] = now + _node_mute_timeout;
+        }
+    }
+
+    absl::flat_hash_set<model::node_id> muted;
+    absl::erase_if(
+      _muted_nodes, [now](const auto& p) { return p.second < now; });
+    for (const auto& [id, _] : _muted_nodes) {
+        muted.insert(id);
+    }
+    return muted;
+}
+
+absl::flat_hash_set<raft::group_id> leader_balancer::muted_groups() {
+    const auto now = clock_type::now();
+    absl::erase_if(
+      _muted_groups, [now](const auto& p) { return p.second < now; });
+    absl::flat_hash_set<raft::group_id> muted;
+    for (const auto& [group, _] : _muted_groups) {
+        muted.insert(group);
+    }
+    return muted;
+}
+
+ss::future<bool> leader_balancer::transfer_leadership(
+  leader_balancer_strategy::reassignment r) {
+    vlog(
+      clusterlog.debug,
+      "Transferring leadership of {} (group {}) from {} to {}",
+      r.ntp,
+      r.group,
+      r.from,
+      r.to);
+    if (r.from.node_id == _raft0->self().id()) {
+        return do_transfer_local(r.group, r.to.node_id);
+    }
+    return do_transfer_remote(r.from.node_id, r.group, r.to.node_id);
+}
+
+ss::future<bool> leader_balancer::do_transfer_local(
+  raft::group_id group, model::node_id target) {
+    if (!_shard_table.local().contains(group)) {
+        co_return false;
+    }
+    auto shard = _shard_table.local().shard_for(group);
+    auto ec = co_await _partition_manager.invoke_on(
+      shard, [group, target](partition_manager& pm) {
+          auto c = pm.consensus_for(group);
+          if (!c) {
+              return ss::make_ready_future<std::error_code>(
+                raft::errc::not_leader);
+          }
+          return c->transfer_leadership(target);
+      });
+    if (ec) {
+        vlog(
+          clusterlog.info,
+          "Leadership transfer of group {} to {} failed - {}",
+          group,
+          target,
+          ec.message());
+    }
+    co_return !ec;
+}
+
+ss::future<bool> leader_balancer::do_transfer_remote(
+  model::node_id leader, raft::group_id group, model::node_id target) {
+    auto timeout = std::chrono::duration_cast<model::timeout_clock::duration>(
+      _interval);
+    auto res = co_await _connections.local()
+                 .with_node_client<raft::raftgen_client_protocol>(
+                   _raft0->self().id(),
+                   ss::this_shard_id(),
+                   leader,
+                   timeout,
+                   [group, target, timeout](
+                     raft::raftgen_client_protocol cp) mutable {
+                       return cp.transfer_leadership(
+                         raft::transfer_leadership_request{
+                           .group = group, .target = target},
+                         rpc::client_opts(
+                           model::timeout_clock::now() + timeout));
+                   });
+    if (res.has_error()) {
+        vlog(
+          clusterlog.info,
+          "Leadership transfer of group {} on node {} failed - {}",
+          group,
+          leader,
+          res.error().message());
+        co_return false;
+    }
+    const auto& reply = res.value().data;
+    if (!reply.success) {
+        vlog(
+          clusterlog.info,
+          "Leadership transfer of group {} on node {} failed - {}",
+          group,
+          leader,
+          raft::make_error_code(reply.result).message());
+    }
+    co_return reply.success;
+}
+
+leader_balancer::status leader_balancer::get_status() const {
+    status st{
+      .enabled = _enabled,
+      .active = _active_since.has_value(),
+      .shard_imbalance = _shard_imbalance,
+      .node_imbalance = _node_imbalance,
+      .muted_groups = _muted_groups.size(),
+      .transfers = _transfers,
+      .failed_transfers = _failed_transfers,
+      .leaders = _last_leaders};
+    st.muted_nodes.reserve(_muted_nodes.size());
+    for (const auto& [id, _] : _muted_nodes) {
+        st.muted_nodes.push_back(id);
+    }
+    return st;
+}
+
+} // namespace cluster
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "cluster/fwd.h"
+#include "cluster/leader_balancer_strategy.h"
+#include "cluster/types.h"
+#include "model/metadata.h"
+#include "raft/consensus.h"
+#include "rpc/connection_cache.h"
+
+#include <seastar/core/gate.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/timer.hh>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+
+#include <chrono>
+
+namespace cluster {
+
+/**
+ * Leader balancer evens out the number of raft groups led by every core of
+ * the cluster. After a rolling restart most of the groups end up being led by
+ * the nodes that were restarted first.
+ *
+ * It runs on the controller leader only. Every balancing round reads the
+ * partition assignments (the core of every replica) from the topic table and
+ * the current leaders from the partition leaders table, plans a limited number
+ * of leadership transfers with the leader_balancer_strategy and dispatches
+ * them to the current leaders.
+ *
+ * Groups that were moved are muted for a while, the leaders table is updated
+ * asynchronously and it takes time before the new leader is known. Nodes that
+ * were just (re)started are muted as well, they are still recovering and the
+ * balancer would move leaders to them while other nodes are being restarted.
+ */
+class leader_balancer {
+public:
+    using clock_type = ss::lowres_clock;
+    static constexpr ss::shard_id shard = 0;
+
+    struct shard_leaders {
+        model::node_id node;
+        uint32_t core;
+        size_t leaders;
+    };
+
+    struct status {
+        bool enabled;
+        /// true on the controller leader only
+        bool active;
+        double shard_imbalance{0};
+        double node_imbalance{0};
+        size_t muted_groups{0};
+        std::vector<model::node_id> muted_nodes;
+        uint64_t transfers{0};
+        uint64_t failed_transfers{0};
+        std::vector<shard_leaders> leaders;
+    };
+
+    leader_balancer(
+      consensus_ptr raft0,
+      ss::sharded<topic_table>&,
+      ss::sharded<partition_leaders_table>&,
+      ss::sharded<members_table>&,
+      ss::sharded<shard_table>&,
+      ss::sharded<partition_manager>&,
+      ss::sharded<rpc::connection_cache>&);
+
+    ss::future<> start();
+    ss::future<> stop();
+
+    status get_status() const;
+
+private:
+    void arm_timer(clock_type::duration);
+    ss::future<> balance();
+    ss::future<> do_balance();
+
+    leader_balancer_strategy make_strategy() const;
+    absl::flat_hash_set<model::node_id> update_muted_nodes();
+    absl::flat_hash_set<raft::group_id> muted_groups();
+
+    ss::future<bool>
+    transfer_leadership(leader_balancer_strategy::reassignment);
+    ss::future<bool> do_transfer_local(raft::group_id, model::node_id);
+    ss::future<bool>
+      do_transfer_remote(model::node_id, raft::group_id, model::node_id);
+
+    bool _enabled;
+    clock_type::duration _interval;
+    clock_type::duration _mute_timeout;
+    clock_type::duration _node_mute_timeout;
+    size_t _transfers_per_round;
+
+    consensus_ptr _raft0;
+    ss::sharded<topic_table>& _topics;
+    ss::sharded<partition_leaders_table>& _leaders;
+    ss::sharded<members_table>& _members;
+    ss::sharded<shard_table>& _shard_table;
+    ss::sharded<partition_manager>& _partition_manager;
+    ss::sharded<rpc::connection_cache>& _connections;
+
+    /// time when this node became the controller leader
+    std::optional<clock_type::time_point> _active_since;
+    /// nodes which were seen alive by the controller leader
+    absl::flat_hash_map<model::node_id, bool> _node_alive;
+    absl::flat_hash_map<model::node_id, clock_type::time_point> _muted_nodes;
+    absl::flat_hash_map<raft::group_id, clock_type::time_point> _muted_groups;
+
+    double _shard_imbalance{0};
+    double _node_imbalance{0};
+    std::vector<shard_leaders> _last_leaders;
+    uint64_t _transfers{0};
+    uint64_t _failed_transfers{0};
+
+    ss::timer<clock_type> _timer;
+    ss::gate _gate;
+};
+
+} // namespace cluster
@@ -0,0 +1,155 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "cluster/leader_balancer_strategy.h"
+
+#include <algorithm>
+
+namespace cluster {
+
+leader_balancer_strategy::leader_balancer_strategy(
+  std::vector<group_replicas> groups,
+  absl::flat_hash_map<model::node_id, uint32_t> cores)
+  : _groups(std::move(groups))
+  , _cores(std::move(cores)) {
+    for (const auto& [node, n] : _cores) {
+        _shard_leaders[node].resize(n, 0);
+        _node_leaders[node] = 0;
+    }
+    for (const auto& g : _groups) {
+        ++shard_leaders(g.leader);
+        ++_node_leaders[g.leader.node_id];
+    }
+}
+
+size_t& leader_balancer_strategy::shard_leaders(model::broker_shard bs) {
+    auto& shards = _shard_leaders[bs.node_id];
+    if (shards.size() <= bs.shard) {
+        shards.resize(bs.shard + 1, 0);
+    }
+    return shards[bs.shard];
+}
+
+size_t leader_balancer_strategy::leaders(model::broker_shard bs) const {
+    auto it = _shard_leaders.find(bs.node_id);
+    if (it == _shard_leaders.end() || it->second.size() <= bs.shard) {
+        return 0;
+    }
+    return it->second[bs.shard];
+}
+
+size_t leader_balancer_strategy::leaders(model::node_id id) const {
+    auto it = _node_leaders.find(id);
+    return it == _node_leaders.end() ? 0 : it->second;
+}
+
+size_t leader_balancer_strategy::total_cores() const {
+    size_t total = 0;
+    for (const auto& [_, n] : _cores) {
+        total += n;
+    }
+    return total;
+}
+
+double leader_balancer_strategy::shard_imbalance() const {
+    const auto cores = total_cores();
+    if (cores == 0) {
+        return 0;
+    }
+    const double mean = double(_groups.size()) / cores;
+    double imbalance = 0;
+    for (const auto& [_, shards] : _shard_leaders) {
+        for (auto n : shards) {
+            imbalance += std::max(0.0, n - mean);
+        }
+    }
+    return imbalance;
+}
+
+double leader_balancer_strategy::node_imbalance() const {
+    const auto cores = total_cores();
+    if (cores == 0) {
+        return 0;
+    }
+    const double mean = double(_groups.size()) / cores;
+    double imbalance = 0;
+    for (const auto& [node, n] : _node_leaders) {
+        auto it = _cores.find(node);
+        const double expected = it == _cores.end() ? 0 : mean * it->second;
+        imbalance += std::max(0.0, n - expected);
+    }
+    return imbalance;
+}
+
+std::optional<leader_balancer_strategy::reassignment>
+leader_balancer_strategy::find_movement(
+  const absl::flat_hash_set<raft::group_id>& muted_groups,
+  const absl::flat_hash_set<model::node_id>& muted_nodes) const {
+    // load of a node relative to its number of cores
+    auto node_load = [this](model::node_id id) {
+        auto it = _cores.find(id);
+        const double cores = it == _cores.end() ? 1 : std::max(it->second, 1U);
+        return leaders(id) / cores;
+    };
+
+    std::optional<reassignment> best;
+    int64_t best_shard_diff = 0;
+    double best_node_diff = 0;
+    for (const auto& g : _groups) {
+        if (
+          muted_groups.contains(g.group)
+          || muted_nodes.contains(g.leader.node_id)) {
+            continue;
+        }
+        const auto from = static_cast<int64_t>(leaders(g.leader));
+        if (from < 2 || (best && from < best_shard_diff)) {
+            continue;
+        }
+        for (const auto& r : g.replicas) {
+            if (
+              r == g.leader || muted_nodes.contains(r.node_id)
+              || !_cores.contains(r.node_id)) {
+                continue;
+            }
+            const int64_t shard_diff = from
+                                       - static_cast<int64_t>(leaders(r));
+            if (shard_diff < 2) {
+                continue;
+            }
+            const double node_diff = node_load(g.leader.node_id)
+                                     - node_load(r.node_id);
+            const bool better_node = shard_diff == best_shard_diff
+                                     && node_diff > best_node_diff;
+            if (!best || shard_diff > best_shard_diff || better_node) {
+                best = reassignment{
+                  .ntp = g.ntp, .group = g.group, .from = g.leader, .to = r};
+                best_shard_diff = shard_diff;
+                best_node_diff = node_diff;
+            }
+        }
+    }
+    return best;
+}
+
+void leader_balancer_strategy::apply_movement(const reassignment& r) {
+    auto it = std::find_if(
+      _groups.begin(), _groups.end(), [&r](const group_replicas& g) {
+          return g.group == r.group;
+      });
+    if (it == _groups.end() || it->leader != r.from) {
+        return;
+    }
+    it->leader = r.to;
+    --shard_leaders(r.from);
+    ++shard_leaders(r.to);
+    --_node_leaders[r.from.node_id];
+    ++_node_leaders[r.to.node_id];
+}
+
+} // namespace cluster
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "model/fundamental.h"
+#include "model/metadata.h"
+#include "raft/types.h"
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+
+#include <optional>
+#include <vector>
+
+namespace cluster {
+
+/**
+ * Greedy leadership placement. The goal is for every core in the cluster to
+ * lead the same number of raft groups, it implies that the number of leaders
+ * on a node is proportional to its number of cores.
+ *
+ * A movement of leadership from a core leading `a` groups to a core leading
+ * `b` groups makes the distribution more even only if `a - b >= 2`. The
+ * strategy always picks the movement with the largest difference, between the
+ * cores the ties are broken by the difference of the node leader counts.
+ */
+class leader_balancer_strategy {
+public:
+    struct group_replicas {
+        model::ntp ntp;
+        raft::group_id group;
+        model::broker_shard leader;
+        std::vector<model::broker_shard> replicas;
+    };
+
+    struct reassignment {
+        model::ntp ntp;
+        raft::group_id group;
+        model::broker_shard from;
+        model::broker_shard to;
+    };
+
+    leader_balancer_strategy(
+      std::vector<group_replicas>,
+      absl::flat_hash_map<model::node_id, uint32_t> cores);
+
+    /// number of leaders above the even distribution over all the cores
+    double shard_imbalance() const;
+    /// number of leaders above the even distribution over all the nodes,
+    /// weighted by the number of cores of the node
+    double node_imbalance() const;
+
+    /// best movement, groups in `muted_groups` are not moved and `muted_nodes`
+    /// are neither the source nor the target of a movement
+    std::optional<reassignment> find_movement(
+      const absl::flat_hash_set<raft::group_id>& muted_groups,
+      const absl::flat_hash_set<model::node_id>& muted_nodes) const;
+
+    /// updates the leader counts as if the movement already happened
+    void apply_movement(const reassignment&);
+
+    size_t leaders(model::broker_shard) const;
+    size_t leaders(model::node_id) const;
+
+    const absl::flat_hash_map<model::node_id, std::vector<size_t>>&
+    shard_leaders() const {
+        return _shard_leaders;
+    }
+
+private:
+    size_t& shard_leaders(model::broker_shard);
+    size_t total_cores() const;
+
+    std::vector<group_replicas> _groups;
+    absl::flat_hash_map<model::node_id, uint32_t> _cores;
+    absl::flat_hash_map<model::node_id, std::vector<size_t>> _shard_leaders;
+    absl::flat_hash_map<model::node_id, size_t> _node_leaders;
+};
+
+} // namespace cluster
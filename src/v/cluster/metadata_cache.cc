@@ -88,6 +88,22 @@ std::vector<model::node_id> metadata_cache::all_broker_ids() const {
     return _members_table.local().all_broker_ids();
 }
 
+std::vector<model::node_id> metadata_cache::get_replicas_in_rack(
+  const model::ntp& ntp, const ss::sstring& rack) const {
+    std::vector<model::node_id> ret;
+    auto assignment = _topics_state.local().get_partition_assignment(ntp);
+    if (!assignment) {
+        return ret;
+    }
+    for (const auto& r : assignment->replicas) {
+        auto broker = _members_table.local().get_broker(r.node_id);
+        if (broker && (*broker)->rack() == rack) {
+            ret.push_back(r.node_id);
+        }
+    }
+    return ret;
+}
+
 bool metadata_cache::contains(
   model::topic_namespace_view tp, const model::partition_id pid) const {
     return _topics_state.local().contains(tp, pid);
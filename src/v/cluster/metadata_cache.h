@@ -90,6 +90,10 @@ public:
     /// broker can change
     std::optional<broker_ptr> get_broker(model::node_id) const;
 
+    /// Returns replicas of the partition hosted by the brokers in the rack
+    std::vector<model::node_id>
+    get_replicas_in_rack(const model::ntp&, const ss::sstring& rack) const;
+
     bool contains(model::topic_namespace_view, model::partition_id) const;
 
     bool contains(const model::ntp& ntp) const {
@@ -68,6 +68,15 @@ public:
         return _raft->make_reader(std::move(config), deadline);
     }
 
+    /**
+     * Resolves when the high watermark moves above the offset, i.e. when the
+     * batch at the offset becomes visible to the consumers.
+     */
+    ss::future<>
+    wait_for_visible_offset(model::offset o, ss::abort_source& as) {
+        return _raft->wait_for_visible_offset(o, as);
+    }
+
     model::offset start_offset() const { return _raft->start_offset(); }
 
     /**
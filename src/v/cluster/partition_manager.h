@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "cluster/archival_reader.h"
 #include "cluster/ntp_callbacks.h"
 #include "cluster/partition.h"
 #include "model/metadata.h"
@@ -112,6 +113,29 @@ public:
      */
     const ntp_table_container& partitions() const { return _ntp_table; }
 
+    /*
+     * readers of the data of partitions that was uploaded to archival
+     * storage. registered by the archival service while it archives the
+     * partition.
+     */
+    void register_archival_reader(
+      const model::ntp& ntp, ss::shared_ptr<archival_reader> reader) {
+        _archival_readers.insert_or_assign(ntp, std::move(reader));
+    }
+
+    void unregister_archival_reader(const model::ntp& ntp) {
+        _archival_readers.erase(ntp);
+    }
+
+    ss::shared_ptr<archival_reader>
+    get_archival_reader(const model::ntp& ntp) const {
+        if (auto it = _archival_readers.find(ntp);
+            it != _archival_readers.end()) {
+            return it->second;
+        }
+        return nullptr;
+    }
+
 private:
     storage::api& _storage;
     /// used to wait for concurrent recoveries
@@ -123,6 +147,8 @@ private:
     absl::flat_hash_map<raft::group_id, ss::lw_shared_ptr<partition>>
       _raft_table;
     ss::sharded<cluster::tx_gateway_frontend>& _tx_gateway_frontend;
+    absl::flat_hash_map<model::ntp, ss::shared_ptr<archival_reader>>
+      _archival_readers;
 
     friend std::ostream& operator<<(std::ostream&, const partition_manager&);
 };
@@ -0,0 +1,105 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#define BOOST_TEST_MODULE cluster
+#include "cluster/leader_balancer_strategy.h"
+#include "model/fundamental.h"
+#include "model/metadata.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+using strategy = cluster::leader_balancer_strategy;
+
+namespace {
+
+model::broker_shard bs(int node, uint32_t shard) {
+    return model::broker_shard{.node_id = model::node_id(node), .shard = shard};
+}
+
+/*
+ * `groups` raft groups replicated on three nodes with two cores each, the
+ * replicas of the group `i` are on the core `i % 2` of every node. all the
+ * groups are led by the node 0, as after a rolling restart.
+ */
+strategy make_skewed_strategy(int groups) {
+    std::vector<strategy::group_replicas> replicas;
+    for (int i = 0; i < groups; ++i) {
+        const uint32_t shard = i % 2;
+        replicas.push_back(strategy::group_replicas{
+          .ntp = model::ntp(
+            model::ns("kafka"), model::topic("tp"), model::partition_id(i)),
+          .group = raft::group_id(i),
+          .leader = bs(0, shard),
+          .replicas = {bs(0, shard), bs(1, shard), bs(2, shard)}});
+    }
+    absl::flat_hash_map<model::node_id, uint32_t> cores{
+      {model::node_id(0), 2}, {model::node_id(1), 2}, {model::node_id(2), 2}};
+    return strategy(std::move(replicas), std::move(cores));
+}
+
+size_t balance(
+  strategy& s,
+  const absl::flat_hash_set<model::node_id>& muted_nodes = {}) {
+    size_t moves = 0;
+    while (auto m = s.find_movement({}, muted_nodes)) {
+        BOOST_REQUIRE_EQUAL(m->from.shard, m->to.shard);
+        s.apply_movement(*m);
+        ++moves;
+    }
+    return moves;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_empty_cluster_has_no_movements) {
+    auto s = make_skewed_strategy(0);
+    BOOST_REQUIRE_EQUAL(s.shard_imbalance(), 0);
+    BOOST_REQUIRE(!s.find_movement({}, {}));
+}
+
+BOOST_AUTO_TEST_CASE(test_leaders_are_spread_over_all_cores) {
+    auto s = make_skewed_strategy(60);
+    BOOST_REQUIRE_EQUAL(s.leaders(model::node_id(0)), 60);
+    BOOST_REQUIRE_EQUAL(s.shard_imbalance(), 40);
+    BOOST_REQUIRE_EQUAL(s.node_imbalance(), 40);
+
+    BOOST_REQUIRE_EQUAL(balance(s), 40);
+    BOOST_REQUIRE_EQUAL(s.shard_imbalance(), 0);
+    BOOST_REQUIRE_EQUAL(s.node_imbalance(), 0);
+    for (int node = 0; node < 3; ++node) {
+        BOOST_REQUIRE_EQUAL(s.leaders(model::node_id(node)), 20);
+        BOOST_REQUIRE_EQUAL(s.leaders(bs(node, 0)), 10);
+        BOOST_REQUIRE_EQUAL(s.leaders(bs(node, 1)), 10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_muted_nodes_are_not_targets) {
+    auto s = make_skewed_strategy(60);
+    balance(s, {model::node_id(2)});
+    BOOST_REQUIRE_EQUAL(s.leaders(model::node_id(2)), 0);
+    BOOST_REQUIRE_EQUAL(s.leaders(model::node_id(0)), 30);
+    BOOST_REQUIRE_EQUAL(s.leaders(model::node_id(1)), 30);
+}
+
+BOOST_AUTO_TEST_CASE(test_muted_groups_are_not_moved) {
+    auto s = make_skewed_strategy(4);
+    // groups led by the core 0
+    absl::flat_hash_set<raft::group_id> muted{
+      raft::group_id(0), raft::group_id(2)};
+    auto m = s.find_movement(muted, {});
+    BOOST_REQUIRE(m);
+    BOOST_REQUIRE_EQUAL(m->from.shard, 1);
+    BOOST_REQUIRE(!muted.contains(m->group));
+
+    muted.insert(raft::group_id(1));
+    muted.insert(raft::group_id(3));
+    BOOST_REQUIRE(!s.find_movement(muted, {}));
+}
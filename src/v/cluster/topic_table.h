@@ -123,6 +123,21 @@ public:
     std::optional<partition_assignment>
     get_partition_assignment(const model::ntp&) const;
 
+    /// Calls `f(topic_namespace, partition_assignment)` for every partition
+    template<typename Func>
+    void for_each_partition_assignment(Func&& f) const {
+        for (const auto& [tp_ns, topic] : _topics) {
+            for (const auto& p_as : topic.assignments) {
+                f(tp_ns, p_as);
+            }
+        }
+    }
+
+    /// Checks if partition replica set is being updated
+    bool is_update_in_progress(const model::ntp& ntp) const {
+        return _update_in_progress.contains(ntp);
+    }
+
 private:
     struct waiter {
         explicit waiter(uint64_t id)
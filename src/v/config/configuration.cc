@@ -237,6 +237,14 @@ configuration::configuration()
       "Timeout for new member joins",
       required::no,
       30'000ms)
+  , group_offset_commit_coalesce_ms(
+      *this,
+      "group_offset_commit_coalesce_ms",
+      "Time during which the offset commits of a group are coalesced into a "
+      "single batch, with 0 only the commits arriving while the previous "
+      "commit of the group is replicated are coalesced",
+      required::no,
+      0ms)
   , metadata_dissemination_interval_ms(
       *this,
       "metadata_dissemination_interval_ms",
@@ -299,9 +307,24 @@ configuration::configuration()
       *this,
       "fetch_reads_debounce_timeout",
       "Time to wait for next read in fetch request when requested min bytes "
-      "wasn't reached",
+      "wasn't reached and the fetched partitions can not be watched for new "
+      "data",
       required::no,
       1ms)
+  , enable_follower_fetch(
+      *this,
+      "enable_follower_fetch",
+      "Serve fetches from followers and redirect consumers that set rack_id "
+      "to a replica in their rack (KIP-392)",
+      required::no,
+      false)
+  , enable_fetch_zero_copy(
+      *this,
+      "enable_fetch_zero_copy",
+      "Share the buffers batches were read into with fetch responses instead "
+      "of copying the records",
+      required::no,
+      true)
   , alter_topic_cfg_timeout_ms(
       *this,
       "alter_topic_cfg_timeout_ms",
@@ -451,6 +474,124 @@ configuration::configuration()
       "Max size of requests cached for replication",
       required::no,
       1_MiB)
+  , raft_max_inflight_append_entries_requests(
+      *this,
+      "raft_max_inflight_append_entries_requests",
+      "Max number of append entries requests in flight to a single follower",
+      required::no,
+      16)
+  , raft_max_inflight_append_entries_bytes(
+      *this,
+      "raft_max_inflight_append_entries_bytes",
+      "Max size of append entries requests in flight to a single follower",
+      required::no,
+      16_MiB)
+  , raft_append_entries_coalescing(
+      *this,
+      "raft_append_entries_coalescing",
+      "Send append entries requests of all the raft groups replicating to the "
+      "same node in a single RPC, all the nodes in the cluster must be able "
+      "to handle it before it is enabled",
+      required::no,
+      false)
+  , raft_append_entries_coalescing_window_us(
+      *this,
+      "raft_append_entries_coalescing_window_us",
+      "Window in microseconds during which append entries requests sent to the "
+      "same node are collected into a single RPC",
+      required::no,
+      200)
+  , raft_append_entries_coalescing_max_requests(
+      *this,
+      "raft_append_entries_coalescing_max_requests",
+      "Max number of append entries requests coalesced into a single RPC, the "
+      "RPC is sent right away when it is reached",
+      required::no,
+      128)
+  , raft_enable_quiescence(
+      *this,
+      "raft_enable_quiescence",
+      "Stop sending heartbeats for idle raft groups, their followers are kept "
+      "alive by node level heartbeats",
+      required::no,
+      false)
+  , raft_quiescence_idle_intervals(
+      *this,
+      "raft_quiescence_idle_intervals",
+      "Number of heartbeat intervals without any change in raft group state "
+      "after which the group is quiesced",
+      required::no,
+      10)
+  , raft_heartbeat_stream_vbyte(
+      *this,
+      "raft_heartbeat_stream_vbyte",
+      "Encode heartbeat requests with Stream VByte codec, all the nodes in the "
+      "cluster must be able to decode it before it is enabled",
+      required::no,
+      false)
+  , raft_enable_leader_lease(
+      *this,
+      "raft_enable_leader_lease",
+      "Serve linearizable reads on the leader without a round of heartbeats "
+      "while the majority of followers recognizes its leadership",
+      required::no,
+      false)
+  , raft_leader_lease_clock_drift_ms(
+      *this,
+      "raft_leader_lease_clock_drift_ms",
+      "Bound of the clock drift between the nodes, the leader lease is "
+      "shorter than the election timeout by this amount",
+      required::no,
+      200ms)
+  , raft_snapshot_chunk_size(
+      *this,
+      "raft_snapshot_chunk_size",
+      "Size of a single chunk of snapshot sent to a follower",
+      required::no,
+      128_KiB)
+  , raft_snapshot_max_inflight_chunks(
+      *this,
+      "raft_snapshot_max_inflight_chunks",
+      "Max number of snapshot chunks in flight to a single follower",
+      required::no,
+      4)
+  , raft_snapshot_resumable_transfer(
+      *this,
+      "raft_snapshot_resumable_transfer",
+      "Send snapshot chunks with a crc and up to "
+      "raft_snapshot_max_inflight_chunks at a time, followers validate the "
+      "chunks and interrupted transfers are resumed, enable only when all the "
+      "nodes support it",
+      required::no,
+      false)
+  , raft_recovery_max_bandwidth(
+      *this,
+      "raft_recovery_max_bandwidth",
+      "Max number of bytes per second sent by a node to recovering followers, "
+      "shared by all the raft groups, 0 disables the limit",
+      required::no,
+      0)
+  , raft_recovery_read_buffer_size(
+      *this,
+      "raft_recovery_read_buffer_size",
+      "Max size of a single read of the log for a recovering follower, the "
+      "buffers read ahead add up to the size of the current read",
+      required::no,
+      1_MiB)
+  , raft_recovery_max_read_ahead_memory(
+      *this,
+      "raft_recovery_max_read_ahead_memory",
+      "Max memory of the buffers read ahead for recovering followers on a "
+      "single core, recovery reads use default buffers when it is exhausted",
+      required::no,
+      32_MiB)
+  , raft_recovery_target_latency_ms(
+      *this,
+      "raft_recovery_target_latency_ms",
+      "Recovery reads grow while the follower replies to recovery requests "
+      "within this latency and shrink otherwise",
+      required::no,
+      100ms)
   , reclaim_min_size(
       *this,
       "reclaim_min_size",
@@ -537,6 +678,20 @@ configuration::configuration()
       "Maximum delay until buffered data is written",
       required::no,
       std::chrono::milliseconds(1s))
+  , segment_appender_flush_coalesce_window_us(
+      *this,
+      "segment_appender_flush_coalesce_window_us",
+      "Window in microseconds during which the segment flushes of a shard "
+      "are collected and synced together. 0 syncs each flush right away",
+      required::no,
+      0)
+  , segment_appender_adaptive_write_behind(
+      *this,
+      "segment_appender_adaptive_write_behind",
+      "Tune the chunks in flight and the fallocation step of segment "
+      "appenders from the observed write latency and throughput",
+      required::no,
+      false)
   , fetch_session_eviction_timeout_ms(
       *this,
       "fetch_session_eviction_timeout_ms",
@@ -585,6 +740,41 @@ configuration::configuration()
       "Timeout for executing node management operations",
       required::no,
       5s)
+  , enable_leader_balancer(
+      *this,
+      "enable_leader_balancer",
+      "Enable automatic balancing of partition leaders across the cores of "
+      "the cluster",
+      required::no,
+      true)
+  , leader_balancer_interval_ms(
+      *this,
+      "leader_balancer_interval_ms",
+      "Interval between leader balancer rounds",
+      required::no,
+      1min)
+  , leader_balancer_mute_timeout_ms(
+      *this,
+      "leader_balancer_mute_timeout_ms",
+      "Time during which a partition is not moved again by the leader balancer "
+      "after its leadership was transferred",
+      required::no,
+      5min)
+  , leader_balancer_node_mute_timeout_ms(
+      *this,
+      "leader_balancer_node_mute_timeout_ms",
+      "Time during which the leader balancer ignores a node after it was "
+      "restarted, and during which it does not move any leaders after it was "
+      "activated on the controller leader",
+      required::no,
+      1min)
+  , leader_balancer_transfers_per_round(
+      *this,
+      "leader_balancer_transfers_per_round",
+      "Maximum number of leadership transfers issued in a leader balancer "
+      "round",
+      required::no,
+      16)
   , compaction_ctrl_update_interval_ms(
       *this, "compaction_ctrl_update_interval_ms", "", required::no, 30s)
   , compaction_ctrl_p_coeff(
@@ -693,6 +883,41 @@ configuration::configuration()
       "during TLS handshake",
       required::no,
       std::nullopt)
+  , cloud_storage_cache_size(
+      *this,
+      "cloud_storage_cache_size",
+      "Max size of the disk cache of segments downloaded from archival "
+      "storage, split between the cores",
+      required::no,
+      20_GiB)
+  , cloud_storage_cache_directory(
+      *this,
+      "cloud_storage_cache_directory",
+      "Directory of the disk cache of segments downloaded from archival "
+      "storage, defaults to <data_directory>/cloud_storage_cache",
+      required::no,
+      std::nullopt)
+  , cloud_storage_enable_remote_read(
+      *this,
+      "cloud_storage_enable_remote_read",
+      "Serve fetches of offsets that were removed from the local log from "
+      "archival storage",
+      required::no,
+      false)
+  , cloud_storage_max_concurrent_reads(
+      *this,
+      "cloud_storage_max_concurrent_reads",
+      "Max number of readers of archival storage open at the same time on "
+      "each core",
+      required::no,
+      16)
+  , cloud_storage_max_read_memory(
+      *this,
+      "cloud_storage_max_read_memory",
+      "Max bytes of data read from archival storage that are buffered at the "
+      "same time on each core",
+      required::no,
+      64_MiB)
   , superusers(
       *this, "superusers", "List of superuser usernames", required::no, {})
   , kafka_qdc_latency_alpha(
@@ -755,6 +980,32 @@ configuration::configuration()
       "Update frequency for kafka queue depth control.",
       required::no,
       7s)
+  , segment_index_cache_max_memory(
+      *this,
+      "segment_index_cache_max_memory",
+      "Per-shard memory budget for the offset index entries of sealed "
+      "segments. Indices of cold segments are read from disk on demand",
+      required::no,
+      64_MiB)
+  , compaction_max_concurrent_jobs(
+      *this,
+      "compaction_max_concurrent_jobs",
+      "Maximum number of partitions compacted concurrently on each shard",
+      required::no,
+      2)
+  , compaction_max_bytes_per_sec(
+      *this,
+      "compaction_max_bytes_per_sec",
+      "Per-shard limit on the bytes processed by compaction each second, "
+      "scaled down by the compaction controller when the backlog is small",
+      required::no,
+      std::nullopt)
+  , compaction_max_segments_per_job(
+      *this,
+      "compaction_max_segments_per_job",
+      "Maximum number of adjacent segments merged by a single compaction",
+      required::no,
+      8)
   , _advertised_kafka_api(
       *this,
       "advertised_kafka_api",
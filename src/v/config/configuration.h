@@ -84,6 +84,7 @@ struct configuration final : public config_store {
     property<std::chrono::milliseconds> group_max_session_timeout_ms;
     property<std::chrono::milliseconds> group_initial_rebalance_delay;
     property<std::chrono::milliseconds> group_new_member_join_timeout;
+    property<std::chrono::milliseconds> group_offset_commit_coalesce_ms;
     property<std::chrono::milliseconds> metadata_dissemination_interval_ms;
     property<std::chrono::milliseconds> metadata_dissemination_retry_delay_ms;
     property<int16_t> metadata_dissemination_retries;
@@ -94,6 +95,8 @@ struct configuration final : public config_store {
     property<std::chrono::milliseconds> tx_timeout_delay_ms;
     property<model::violation_recovery_policy> rm_violation_recovery_policy;
     property<std::chrono::milliseconds> fetch_reads_debounce_timeout;
+    property<bool> enable_follower_fetch;
+    property<bool> enable_fetch_zero_copy;
     property<std::chrono::milliseconds> alter_topic_cfg_timeout_ms;
     property<model::cleanup_policy_bitflags> log_cleanup_policy;
     property<model::timestamp_type> log_message_timestamp_type;
@@ -123,6 +126,23 @@ struct configuration final : public config_store {
     property<std::chrono::milliseconds> replicate_append_timeout_ms;
     property<std::chrono::milliseconds> recovery_append_timeout_ms;
     property<size_t> raft_replicate_batch_window_size;
+    property<size_t> raft_max_inflight_append_entries_requests;
+    property<size_t> raft_max_inflight_append_entries_bytes;
+    property<bool> raft_append_entries_coalescing;
+    property<uint32_t> raft_append_entries_coalescing_window_us;
+    property<size_t> raft_append_entries_coalescing_max_requests;
+    property<bool> raft_enable_quiescence;
+    property<size_t> raft_quiescence_idle_intervals;
+    property<bool> raft_heartbeat_stream_vbyte;
+    property<bool> raft_enable_leader_lease;
+    property<std::chrono::milliseconds> raft_leader_lease_clock_drift_ms;
+    property<size_t> raft_snapshot_chunk_size;
+    property<size_t> raft_snapshot_max_inflight_chunks;
+    property<bool> raft_snapshot_resumable_transfer;
+    property<size_t> raft_recovery_max_bandwidth;
+    property<size_t> raft_recovery_read_buffer_size;
+    property<size_t> raft_recovery_max_read_ahead_memory;
+    property<std::chrono::milliseconds> raft_recovery_target_latency_ms;
 
     property<size_t> reclaim_min_size;
     property<size_t> reclaim_max_size;
@@ -140,6 +160,8 @@ struct configuration final : public config_store {
       raft_transfer_leader_recovery_timeout_ms;
     property<bool> release_cache_on_segment_roll;
     property<std::chrono::milliseconds> segment_appender_flush_timeout_ms;
+    property<uint32_t> segment_appender_flush_coalesce_window_us;
+    property<bool> segment_appender_adaptive_write_behind;
     property<std::chrono::milliseconds> fetch_session_eviction_timeout_ms;
     property<size_t> max_compacted_log_segment_size;
     property<int16_t> id_allocator_log_capacity;
@@ -148,6 +170,12 @@ struct configuration final : public config_store {
     property<std::chrono::milliseconds>
       controller_backend_housekeeping_interval_ms;
     property<std::chrono::milliseconds> node_management_operation_timeout_ms;
+    // Leader balancer
+    property<bool> enable_leader_balancer;
+    property<std::chrono::milliseconds> leader_balancer_interval_ms;
+    property<std::chrono::milliseconds> leader_balancer_mute_timeout_ms;
+    property<std::chrono::milliseconds> leader_balancer_node_mute_timeout_ms;
+    property<size_t> leader_balancer_transfers_per_round;
     // Compaction controller
     property<std::chrono::milliseconds> compaction_ctrl_update_interval_ms;
     property<double> compaction_ctrl_p_coeff;
@@ -169,6 +197,11 @@ struct configuration final : public config_store {
     property<bool> cloud_storage_disable_tls;
     property<int16_t> cloud_storage_api_endpoint_port;
     property<std::optional<ss::sstring>> cloud_storage_trust_file;
+    property<size_t> cloud_storage_cache_size;
+    property<std::optional<ss::sstring>> cloud_storage_cache_directory;
+    property<bool> cloud_storage_enable_remote_read;
+    property<size_t> cloud_storage_max_concurrent_reads;
+    property<size_t> cloud_storage_max_read_memory;
     one_or_many_property<ss::sstring> superusers;
 
     // kakfa queue depth control: latency ewma
@@ -185,6 +218,14 @@ struct configuration final : public config_store {
     property<size_t> kafka_qdc_max_depth;
     property<std::chrono::milliseconds> kafka_qdc_depth_update_ms;
 
+    // per-shard memory budget for hydrated segment indices
+    property<size_t> segment_index_cache_max_memory;
+
+    // compaction scheduler
+    property<size_t> compaction_max_concurrent_jobs;
+    property<std::optional<size_t>> compaction_max_bytes_per_sec;
+    property<size_t> compaction_max_segments_per_job;
+
     configuration();
 
     void read_yaml(const YAML::Node& root_node) override;
@@ -204,6 +245,14 @@ struct configuration final : public config_store {
     std::filesystem::path pidfile_path() const {
         return data_directory().path / "pid.lock";
     }
+    // cache of remote segments: `<data_directory>/cloud_storage_cache` unless
+    // overridden
+    std::filesystem::path cloud_storage_cache_path() const {
+        if (auto dir = cloud_storage_cache_directory(); dir) {
+            return std::filesystem::path(*dir);
+        }
+        return data_directory().path / "cloud_storage_cache";
+    }
     const one_or_many_property<model::broker_endpoint>&
     advertised_kafka_api_property() {
         return _advertised_kafka_api;
@@ -17,6 +17,8 @@
 #include "model/record.h"
 #include "seastarx.h"
 
+#include <seastar/util/bool_class.hh>
+
 namespace kafka {
 
 /**
@@ -33,16 +35,25 @@ public:
         model::offset last_offset;
     };
 
+    using share_records = ss::bool_class<struct share_records_tag>;
+
     kafka_batch_serializer() noexcept
       : _wr(_buf) {}
 
+    /// with share_records::yes the records of large batches are not copied,
+    /// the result shares the buffers the batches were read into
+    explicit kafka_batch_serializer(share_records share) noexcept
+      : _wr(_buf)
+      , _share_records(share) {}
+
     kafka_batch_serializer(const kafka_batch_serializer& o) = delete;
     kafka_batch_serializer& operator=(const kafka_batch_serializer& o) = delete;
     kafka_batch_serializer& operator=(kafka_batch_serializer&& o) = delete;
 
     kafka_batch_serializer(kafka_batch_serializer&& o) noexcept
       : _buf(std::move(o._buf))
-      , _wr(_buf) {}
+      , _wr(_buf)
+      , _share_records(o._share_records) {}
 
     ss::future<ss::stop_iteration> operator()(model::record_batch&& batch) {
         if (unlikely(record_count_ == 0)) {
@@ -66,12 +77,17 @@ public:
 
 private:
     void write_batch(model::record_batch&& batch) {
-        writer_serialize_batch(_wr, std::move(batch));
+        if (_share_records) {
+            writer_serialize_batch_shared(_wr, std::move(batch));
+        } else {
+            writer_serialize_batch(_wr, std::move(batch));
+        }
     }
 
 private:
     iobuf _buf;
     response_writer _wr;
+    share_records _share_records{share_records::no};
     model::offset _base_offset;
     model::offset _last_offset;
     uint32_t record_count_ = 0;
@@ -19,12 +19,16 @@
 #include "model/record.h"
 #include "raft/types.h"
 #include "storage/parser_utils.h"
+#include "units.h"
+#include "utils/vint.h"
 #include "vassert.h"
 
 #include <seastar/core/smp.hh>
 
 #include <fmt/ostream.h>
 
+#include <algorithm>
+#include <optional>
 #include <stdexcept>
 
 namespace kafka {
@@ -90,37 +94,201 @@ model::record_batch_header kafka_batch_adapter::read_header(iobuf_parser& in) {
     return header;
 }
 
-void kafka_batch_adapter::verify_crc(int32_t expected_crc, iobuf_parser in) {
+namespace internal {
+
+void record_framing_validator::feed(const char* src, size_t n) {
+    const char* const end = src + n;
+    while (src != end) {
+        switch (_state) {
+        case state::invalid:
+            return;
+        case state::key:
+        case state::value:
+        case state::header_key:
+        case state::header_value: {
+            auto len = std::min<size_t>(end - src, _blob_left);
+            src += len;
+            _pos += len;
+            _blob_left -= len;
+            if (_blob_left == 0) {
+                field_done(0);
+            }
+            break;
+        }
+        case state::attributes:
+            ++src;
+            ++_pos;
+            field_done(0);
+            break;
+        default: {
+            uint64_t byte = static_cast<uint8_t>(*src++);
+            ++_pos;
+            _vint |= (byte & 0x7f) << _vint_shift;
+            if (byte & 0x80) {
+                _vint_shift += 7;
+                if (_vint_shift > 63) {
+                    _state = state::invalid;
+                }
+                break;
+            }
+            auto value = vint::decode_zigzag(_vint);
+            _vint = 0;
+            _vint_shift = 0;
+            field_done(value);
+        }
+        }
+    }
+}
+
+void record_framing_validator::field_done(int64_t value) {
+    if (_state != state::record_size && _pos > _record_end) {
+        _state = state::invalid;
+        return;
+    }
+    switch (_state) {
+    case state::record_size:
+        if (_records_left <= 0 || value <= 0) {
+            _state = state::invalid;
+            return;
+        }
+        _record_end = _pos + value;
+        _state = state::attributes;
+        return;
+    case state::attributes:
+        _state = state::timestamp_delta;
+        return;
+    case state::timestamp_delta:
+        _state = state::offset_delta;
+        return;
+    case state::offset_delta:
+        _state = state::key_length;
+        return;
+    case state::key_length:
+        start_blob(value, state::key);
+        return;
+    case state::key:
+        _state = state::value_length;
+        return;
+    case state::value_length:
+        start_blob(value, state::value);
+        return;
+    case state::value:
+        _state = state::header_count;
+        return;
+    case state::header_count:
+        if (value < 0) {
+            _state = state::invalid;
+            return;
+        }
+        _headers_left = value;
+        next_header();
+        return;
+    case state::header_key_length:
+        start_blob(value, state::header_key);
+        return;
+    case state::header_key:
+        _state = state::header_value_length;
+        return;
+    case state::header_value_length:
+        start_blob(value, state::header_value);
+        return;
+    case state::header_value:
+        next_header();
+        return;
+    case state::invalid:
+        return;
+    }
+}
+
+void record_framing_validator::start_blob(int64_t length, state blob) {
+    // -1 stands for a null key or value
+    if (length < -1 || _pos + std::max<int64_t>(length, 0) > _record_end) {
+        _state = state::invalid;
+        return;
+    }
+    _state = blob;
+    if (length <= 0) {
+        field_done(0);
+        return;
+    }
+    _blob_left = length;
+}
+
+void record_framing_validator::next_header() {
+    if (_headers_left > 0) {
+        --_headers_left;
+        _state = state::header_key_length;
+        return;
+    }
+    // end of the record
+    if (_pos != _record_end) {
+        _state = state::invalid;
+        return;
+    }
+    --_records_left;
+    _state = state::record_size;
+}
+
+} // namespace internal
+
+/*
+ * Computes the batch CRC and validates the framing of the uncompressed records
+ * in a single pass. The input is walked in small chunks, every chunk is
+ * checksummed and parsed while it is still in the cache.
+ */
+bool kafka_batch_adapter::verify_batch(
+  const model::record_batch_header& header, const iobuf& kbatch) {
+    static constexpr size_t chunk_size = 8_KiB;
+
     auto crc = crc::crc32c();
+    std::optional<internal::record_framing_validator> framing;
+    if (header.attrs.compression() == model::compression::none) {
+        framing.emplace(header.record_count);
+    }
 
-    // 1. move the cursor to correct endpoint
-    //   - 8 base offset
-    //   - 4 batch length
-    //   - 4 partition leader epoch
-    //   - 1 magic
-    //   - 4 exepcted crc
-    in.skip(21);
-
-    // 2. consume & checksum the CRC
-    in.consume(in.bytes_left(), [&crc](const char* src, size_t n) {
-        // NOLINTNEXTLINE
-        crc.extend(reinterpret_cast<const uint8_t*>(src), n);
-        return ss::stop_iteration::no;
-    });
+    size_t pos = 0;
+    for (const auto& f : kbatch) {
+        const char* src = f.get();
+        size_t n = f.size();
+        while (n > 0) {
+            const auto len = std::min(n, chunk_size);
+            const auto crc_skip
+              = pos < internal::kafka_crc_data_offset
+                  ? std::min(len, internal::kafka_crc_data_offset - pos)
+                  : 0;
+            crc.extend(src + crc_skip, len - crc_skip);
+            const auto header_skip
+              = pos < internal::kafka_header_size
+                  ? std::min(len, internal::kafka_header_size - pos)
+                  : 0;
+            if (framing && header_skip < len) {
+                framing->feed(src + header_skip, len - header_skip);
+            }
+            src += len;
+            n -= len;
+            pos += len;
+        }
+    }
 
     // the crc is calculated over the bytes we receive as a uint32_t, but the
     // crc arrives off the wire as a signed 32-bit value.
-    if (unlikely((uint32_t)expected_crc != crc.value())) {
+    if (unlikely((uint32_t)header.crc != crc.value())) {
         valid_crc = false;
         vlog(
           klog.error,
           "Cannot validate Kafka record batch. Missmatching CRC. Expected:{}, "
           "Got:{}",
-          expected_crc,
+          header.crc,
           crc.value());
-    } else {
-        valid_crc = true;
+        return false;
+    }
+    valid_crc = true;
+
+    if (framing && !framing->valid()) {
+        vlog(klog.error, "Invalid framing of uncompressed records: {}", header);
+        return false;
     }
+    return true;
 }
 
 iobuf kafka_batch_adapter::adapt(iobuf&& kbatch) {
@@ -145,7 +313,7 @@ iobuf kafka_batch_adapter::adapt(iobuf&& kbatch) {
       batch_length, kbatch.size_bytes() - batch_length);
     kbatch.trim_back(remainder.size_bytes());
 
-    auto crcparser = iobuf_parser(kbatch.share(0, kbatch.size_bytes()));
+    auto batch_data = kbatch.share(0, kbatch.size_bytes());
     auto parser = iobuf_parser(std::move(kbatch));
 
     auto header = read_header(parser);
@@ -156,9 +324,10 @@ iobuf kafka_batch_adapter::adapt(iobuf&& kbatch) {
         return remainder;
     }
 
-    verify_crc(header.crc, std::move(crcparser));
-    if (unlikely(!valid_crc)) {
-        vlog(klog.error, "batch has invalid CRC: {}", header);
+    if (unlikely(!verify_batch(header, batch_data))) {
+        if (!valid_crc) {
+            vlog(klog.error, "batch has invalid CRC: {}", header);
+        }
         return remainder;
     }
 
@@ -166,24 +335,8 @@ iobuf kafka_batch_adapter::adapt(iobuf&& kbatch) {
                         - model::packed_record_batch_header_size;
     auto records = parser.share(records_size);
 
-    auto new_batch = model::record_batch(
+    batch = model::record_batch(
       header, std::move(records), model::record_batch::tag_ctor_ng{});
-
-    /**
-     * Perform some type of validation on the uncompressed input. In this case
-     * we make sure that the records can be materialized but we avoid
-     * re-encoding them using the lazy-record optimization.
-     */
-    if (!new_batch.compressed()) {
-        try {
-            new_batch.for_each_record([](model::record r) { (void)r; });
-        } catch (const std::exception& e) {
-            vlog(klog.error, "Parsing uncompressed records: {}", e.what());
-            return remainder;
-        }
-    }
-
-    batch = std::move(new_batch);
     return remainder;
 }
 
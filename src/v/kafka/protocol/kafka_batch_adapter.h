@@ -36,6 +36,65 @@ constexpr size_t kafka_header_size = sizeof(int64_t) + // base offset
                                      sizeof(int32_t) + // base sequence
                                      sizeof(int32_t);  // num records
 
+/// the batch CRC covers the bytes following the crc field
+constexpr size_t kafka_crc_data_offset = sizeof(int64_t) + // base offset
+                                         sizeof(int32_t) + // batch length
+                                         sizeof(int32_t) + // leader epoch
+                                         sizeof(int8_t) +  // magic
+                                         sizeof(int32_t);  // crc
+
+/**
+ * Incremental validation of the framing of uncompressed v2 records. The
+ * records are fed in chunks of any size, e.g. the fragments of the request
+ * iobuf, so that the framing is checked in the same pass as the batch CRC.
+ * Only the varint fields are decoded, keys, values and headers are skipped.
+ */
+class record_framing_validator {
+public:
+    explicit record_framing_validator(int32_t record_count)
+      : _records_left(record_count) {}
+
+    void feed(const char*, size_t);
+
+    /// true when exactly `record_count` well formed records were fed
+    bool valid() const {
+        return _state == state::record_size && _records_left == 0
+               && _vint_shift == 0;
+    }
+
+private:
+    enum class state : uint8_t {
+        record_size,
+        attributes,
+        timestamp_delta,
+        offset_delta,
+        key_length,
+        key,
+        value_length,
+        value,
+        header_count,
+        header_key_length,
+        header_key,
+        header_value_length,
+        header_value,
+        invalid,
+    };
+
+    void field_done(int64_t);
+    void start_blob(int64_t, state);
+    void next_header();
+
+    state _state{state::record_size};
+    int64_t _records_left;
+    int64_t _headers_left{0};
+    /// offsets relative to the first fed byte
+    size_t _pos{0};
+    size_t _record_end{0};
+    size_t _blob_left{0};
+    uint64_t _vint{0};
+    uint32_t _vint_shift{0};
+};
+
 } // namespace internal
 
 /**
@@ -70,7 +129,7 @@ public:
     void adapt_with_version(iobuf, api_version);
 
 private:
-    void verify_crc(int32_t, iobuf_parser);
+    bool verify_batch(const model::record_batch_header&, const iobuf&);
     model::record_batch_header read_header(iobuf_parser&);
     void convert_message_set(storage::record_batch_builder&, iobuf, bool);
 };
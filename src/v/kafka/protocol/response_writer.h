@@ -34,6 +34,8 @@ namespace kafka {
 
 class response_writer;
 void writer_serialize_batch(response_writer& w, model::record_batch&& batch);
+void writer_serialize_batch_shared(
+  response_writer& w, model::record_batch&& batch);
 
 class response_writer {
     template<typename ExplicitIntegerType, typename IntegerType>
@@ -125,14 +127,14 @@ public:
         if (!rdr) {
             return write(std::optional<iobuf>());
         }
-        return write(std::move(*rdr).release());
+        return write_records(std::move(*rdr).release());
     }
 
     uint32_t write(std::optional<batch_reader>& rdr) {
         if (!rdr) {
             return write(std::optional<iobuf>());
         }
-        return write(std::move(*rdr).release());
+        return write_records(std::move(*rdr).release());
     }
 
     // write bytes directly to output without a length prefix
@@ -142,6 +144,18 @@ public:
         return size;
     }
 
+    // write bytes directly to output without a length prefix, the fragments
+    // are shared with the output instead of being copied into it
+    uint32_t write_fragments(iobuf&& f) {
+        auto size = f.size_bytes();
+        _out->append_fragments(std::move(f));
+        return size;
+    }
+
+    // buffers smaller than that are copied into the output, sharing them would
+    // cost more than the copy
+    static constexpr size_t min_shared_size = 4096;
+
     template<typename T, typename Tag>
     uint32_t write(const named_type<T, Tag>& t) {
         return write(t());
@@ -234,11 +248,23 @@ public:
     }
 
 private:
+    // record sets are length prefixed like bytes, large ones are shared
+    uint32_t write_records(iobuf&& data) {
+        auto size = serialize_int<int32_t>(data.size_bytes())
+                    + data.size_bytes();
+        if (data.size_bytes() < min_shared_size) {
+            _out->append(std::move(data));
+        } else {
+            _out->append_fragments(std::move(data));
+        }
+        return size;
+    }
+
     iobuf* _out;
 };
 
-inline void
-writer_serialize_batch(response_writer& w, model::record_batch&& batch) {
+inline void writer_serialize_batch_header(
+  response_writer& w, const model::record_batch& batch) {
     /*
      * calculate batch size expected by kafka client.
      *
@@ -272,7 +298,33 @@ writer_serialize_batch(response_writer& w, model::record_batch&& batch) {
     w.write(int16_t(batch.header().producer_epoch));
     w.write(int32_t(batch.header().base_sequence));
     w.write(int32_t(batch.record_count()));
+}
+
+inline void
+writer_serialize_batch(response_writer& w, model::record_batch&& batch) {
+    writer_serialize_batch_header(w, batch);
     w.write_direct(std::move(batch).release_data());
 }
 
+/**
+ * Zero copy variant of writer_serialize_batch. The records of large batches
+ * are shared with the output instead of being copied into it, only the kafka
+ * batch header is written.
+ */
+inline void writer_serialize_batch_shared(
+  response_writer& w, model::record_batch&& batch) {
+    if (batch.data().size_bytes() < response_writer::min_shared_size) {
+        writer_serialize_batch(w, std::move(batch));
+        return;
+    }
+    // the header gets its own small fragment, appended to the output after the
+    // records of the previous batch it would allocate a fragment sized after
+    // those records
+    iobuf header;
+    response_writer hw(header);
+    writer_serialize_batch_header(hw, batch);
+    w.write_fragments(std::move(header));
+    w.write_fragments(std::move(batch).release_data());
+}
+
 } // namespace kafka
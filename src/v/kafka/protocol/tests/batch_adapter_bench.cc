@@ -0,0 +1,111 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/bytes.h"
+#include "bytes/iobuf_parser.h"
+#include "hashing/crc32c.h"
+#include "kafka/protocol/batch_consumer.h"
+#include "kafka/protocol/kafka_batch_adapter.h"
+#include "model/record.h"
+#include "model/record_batch_reader.h"
+#include "random/generators.h"
+#include "storage/record_batch_builder.h"
+#include "units.h"
+#include "vassert.h"
+
+#include <seastar/testing/perf_tests.hh>
+
+#include <algorithm>
+#include <vector>
+
+/*
+ * validation of produced batches. `fused` is the kafka batch adapter, it
+ * checksums and validates the framing of the records in a single pass over
+ * every chunk of the batch. `two_pass` computes the CRC over the whole batch
+ * and then materializes the records, as the adapter did before.
+ */
+template<size_t batch_size, size_t record_size>
+struct batch_adapter_bench {
+    static constexpr size_t total_size = 4_MiB;
+    static constexpr size_t batch_count = std::max<size_t>(
+      total_size / batch_size, 1);
+
+    batch_adapter_bench() {
+        for (size_t i = 0; i < batch_count; ++i) {
+            storage::record_batch_builder builder(
+              model::record_batch_type::raft_data, model::offset(0));
+            for (size_t n = 0; n < batch_size / record_size; ++n) {
+                builder.add_raw_kv(
+                  std::nullopt,
+                  bytes_to_iobuf(random_generators::get_bytes(record_size)));
+            }
+            auto res = model::make_memory_record_batch_reader(
+                         std::move(builder).build())
+                         .consume(
+                           kafka::kafka_batch_serializer{}, model::no_timeout)
+                         .get0();
+            batches.push_back(std::move(res.data));
+        }
+    }
+
+    size_t fused() {
+        perf_tests::start_measuring_time();
+        for (auto& b : batches) {
+            kafka::kafka_batch_adapter adapter;
+            adapter.adapt(b.share(0, b.size_bytes()));
+            vassert(adapter.batch, "invalid batch");
+            perf_tests::do_not_optimize(adapter.batch);
+        }
+        perf_tests::stop_measuring_time();
+        return batches.size();
+    }
+
+    size_t two_pass() {
+        perf_tests::start_measuring_time();
+        for (auto& b : batches) {
+            iobuf_parser parser(b.share(0, b.size_bytes()));
+            parser.skip(kafka::internal::kafka_crc_data_offset);
+            auto crc = crc::crc32c();
+            parser.consume(
+              parser.bytes_left(), [&crc](const char* src, size_t n) {
+                  crc.extend(src, n);
+                  return ss::stop_iteration::no;
+              });
+            perf_tests::do_not_optimize(crc.value());
+
+            iobuf_parser records(b.share(0, b.size_bytes()));
+            records.skip(kafka::internal::kafka_header_size);
+            size_t count = 0;
+            while (records.bytes_left()) {
+                auto r = model::parse_one_record_from_buffer(records);
+                perf_tests::do_not_optimize(r);
+                ++count;
+            }
+            vassert(count == batch_size / record_size, "invalid batch");
+        }
+        perf_tests::stop_measuring_time();
+        return batches.size();
+    }
+
+    std::vector<iobuf> batches;
+};
+
+using batch_1k = batch_adapter_bench<1_KiB, 100>;
+using batch_64k = batch_adapter_bench<64_KiB, 1_KiB>;
+using batch_1m = batch_adapter_bench<1_MiB, 1_KiB>;
+using batch_1m_small_records = batch_adapter_bench<1_MiB, 16>;
+
+PERF_TEST_F(batch_1k, fused) { return fused(); }
+PERF_TEST_F(batch_1k, two_pass) { return two_pass(); }
+PERF_TEST_F(batch_64k, fused) { return fused(); }
+PERF_TEST_F(batch_64k, two_pass) { return two_pass(); }
+PERF_TEST_F(batch_1m, fused) { return fused(); }
+PERF_TEST_F(batch_1m, two_pass) { return two_pass(); }
+PERF_TEST_F(batch_1m_small_records, fused) { return fused(); }
+PERF_TEST_F(batch_1m_small_records, two_pass) { return two_pass(); }
@@ -7,6 +7,7 @@
 // the Business Source License, use of this software will be governed
 // by the Apache License, Version 2.0
 
+#include "bytes/bytes.h"
 #include "bytes/details/io_iterator_consumer.h"
 #include "bytes/iobuf_parser.h"
 #include "kafka/protocol/batch_consumer.h"
@@ -221,3 +222,67 @@ SEASTAR_THREAD_TEST_CASE(batch_reader_record_batch_reader_impl_fail_magic) {
           return e.error == kafka::error_code::corrupt_message;
       });
 }
+
+SEASTAR_THREAD_TEST_CASE(batch_serializer_shared_records) {
+    // large batches have their records shared, small ones are copied
+    ss::circular_buffer<model::record_batch> input;
+    for (int i = 0; i < 10; ++i) {
+        input.push_back(storage::test::make_random_batch(
+          model::offset(i * 100), i % 2 == 0 ? 1 : 100, false));
+    }
+    ss::circular_buffer<model::record_batch> copy;
+    for (auto& b : input) {
+        copy.push_back(b.copy());
+    }
+
+    auto shared = model::make_memory_record_batch_reader(std::move(input))
+                    .consume(
+                      kafka::kafka_batch_serializer(
+                        kafka::kafka_batch_serializer::share_records::yes),
+                      model::no_timeout)
+                    .get();
+    auto copied = model::make_memory_record_batch_reader(std::move(copy))
+                    .consume(
+                      kafka::kafka_batch_serializer{}, model::no_timeout)
+                    .get();
+
+    BOOST_REQUIRE_EQUAL(shared.record_count, copied.record_count);
+    BOOST_REQUIRE_EQUAL(shared.data, copied.data);
+
+    auto rdr = model::make_record_batch_reader<kafka::batch_reader>(
+      std::move(shared.data));
+    auto batches = model::consume_reader_to_memory(
+                     std::move(rdr), model::no_timeout)
+                     .get();
+    BOOST_REQUIRE_EQUAL(batches.size(), 10);
+}
+
+SEASTAR_THREAD_TEST_CASE(record_framing_validator_chunks) {
+    auto batch = storage::test::make_random_batch(model::offset(0), 20, false);
+    auto records = iobuf_to_bytes(batch.data());
+
+    auto feed = [&records](int32_t record_count, size_t size, size_t chunk) {
+        kafka::internal::record_framing_validator validator(record_count);
+        for (size_t pos = 0; pos < size; pos += chunk) {
+            validator.feed(
+              // NOLINTNEXTLINE
+              reinterpret_cast<const char*>(records.data()) + pos,
+              std::min(chunk, size - pos));
+        }
+        return validator.valid();
+    };
+
+    for (size_t chunk : {size_t(1), size_t(7), records.size()}) {
+        BOOST_REQUIRE(feed(20, records.size(), chunk));
+        // truncated record
+        BOOST_REQUIRE(!feed(20, records.size() - 1, chunk));
+        // trailing record
+        BOOST_REQUIRE(!feed(19, records.size(), chunk));
+        // missing record
+        BOOST_REQUIRE(!feed(21, records.size(), chunk));
+    }
+
+    // corrupted size of the first record
+    ++records[0];
+    BOOST_REQUIRE(!feed(20, records.size(), records.size()));
+}
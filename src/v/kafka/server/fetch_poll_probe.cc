@@ -0,0 +1,50 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/fetch_poll_probe.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+
+#include <seastar/core/metrics.hh>
+
+namespace kafka {
+
+void fetch_poll_probe::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("kafka:fetch_poll"),
+      {
+        sm::make_gauge(
+          "parked",
+          [this] { return _parked; },
+          sm::description("Number of fetch requests waiting for new data")),
+        sm::make_derive(
+          "wakeups",
+          [this] { return _wakeups; },
+          sm::description(
+            "Number of parked fetch requests woken up by new data")),
+        sm::make_derive(
+          "timeouts",
+          [this] { return _timeouts; },
+          sm::description("Number of parked fetch requests which reached "
+                          "their max wait time")),
+        sm::make_histogram(
+          "wake_latency",
+          sm::description("Latency between the high watermark update and "
+                          "the parked fetch resuming in microseconds"),
+          [this] { return _wake_latency.seastar_histogram_logform(); }),
+      });
+}
+
+} // namespace kafka
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "seastarx.h"
+#include "utils/hdr_hist.h"
+
+#include <seastar/core/metrics_registration.hh>
+
+#include <chrono>
+#include <cstdint>
+
+namespace kafka {
+
+/**
+ * Metrics of the fetch requests parked until new data becomes visible in one
+ * of the fetched partitions, owned by the kafka protocol of the shard. The
+ * wake latency is the time between the high watermark moving on the
+ * partition shard and the parked fetch being resumed on the connection shard.
+ */
+class fetch_poll_probe {
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    void fetch_parked() { ++_parked; }
+
+    void fetch_woken(clock_type::time_point woken_at) {
+        --_parked;
+        ++_wakeups;
+        _wake_latency.record(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+            clock_type::now() - woken_at)
+            .count());
+    }
+
+    void fetch_timed_out() {
+        --_parked;
+        ++_timeouts;
+    }
+
+    void setup_metrics();
+
+private:
+    uint64_t _parked{0};
+    uint64_t _wakeups{0};
+    uint64_t _timeouts{0};
+    hdr_hist _wake_latency;
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace kafka
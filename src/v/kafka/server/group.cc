@@ -1729,74 +1729,147 @@ group::store_txn_offsets(txn_offset_commit_request r) {
     co_return txn_offset_commit_response(r, error_code::none);
 }
 
-group::offset_commit_stages group::store_offsets(offset_commit_request&& r) {
-    cluster::simple_batch_builder builder(
-      model::record_batch_type::raft_data, model::offset(0));
-
-    std::vector<std::pair<model::topic_partition, offset_metadata>>
-      offset_commits;
+bool group::is_committed(
+  const model::topic_partition& tp, const offset_metadata& md) const {
+    if (_pending_offset_commits.contains(tp)) {
+        return false;
+    }
+    auto it = _offsets.find(tp);
+    return it != _offsets.end() && it->second.offset == md.offset
+           && it->second.metadata == md.metadata;
+}
 
+group::offset_commit_stages group::store_offsets(offset_commit_request&& r) {
     for (const auto& t : r.data.topics) {
         for (const auto& p : t.partitions) {
-            group_log_record_key key{
-              .record_type = group_log_record_key::type::offset_commit,
-              .key = reflection::to_iobuf(group_log_offset_key{
-                _id,
-                t.name,
-                p.partition_index,
-              }),
-            };
-            group_log_offset_metadata val{
-              p.committed_offset,
-              p.committed_leader_epoch,
-              p.committed_metadata,
-            };
-            builder.add_kv(std::move(key), std::move(val));
-
             model::topic_partition tp(t.name, p.partition_index);
             offset_metadata md{
               .offset = p.committed_offset,
               .metadata = p.committed_metadata.value_or(""),
             };
 
-            offset_commits.emplace_back(std::make_pair(tp, md));
+            // consumers periodically commit the same offsets while they are
+            // idle, there is no need to append them again
+            if (is_committed(tp, md)) {
+                continue;
+            }
+
+            if (!_offset_commit_batch) {
+                _offset_commit_batch
+                  = ss::make_lw_shared<offset_commit_batch>();
+                auto window = _conf.group_offset_commit_coalesce_ms();
+                if (window > std::chrono::milliseconds(0)) {
+                    _offset_commit_timer.set_callback(
+                      [this] { maybe_flush_offset_commits(); });
+                    _offset_commit_timer.arm(window);
+                }
+            }
 
             // record the offset commits as pending commits which will be
             // inspected after the append to catch concurrent updates.
             _pending_offset_commits[tp] = md;
+            _offset_commit_batch->commits.insert_or_assign(
+              std::move(tp),
+              offset_commit_batch::commit{
+                .leader_epoch = p.committed_leader_epoch,
+                .metadata = p.committed_metadata,
+                .md = std::move(md),
+              });
         }
     }
 
-    auto batch = std::move(builder).build();
-    auto reader = model::make_memory_record_batch_reader(std::move(batch));
+    if (!_offset_commit_batch) {
+        return offset_commit_stages(
+          offset_commit_response(r, error_code::none));
+    }
 
+    auto dispatched = _offset_commit_batch->dispatched.get_shared_future();
+    auto f = _offset_commit_batch->replicated.get_shared_future().then(
+      [req = std::move(r)](error_code error) mutable {
+          return offset_commit_response(req, error);
+      });
+    maybe_flush_offset_commits();
+    return offset_commit_stages(std::move(dispatched), std::move(f));
+}
+
+/*
+ * a single offset commit batch of the group is replicated at a time, the
+ * commits arriving in the meantime are coalesced into the next batch.
+ */
+void group::maybe_flush_offset_commits() {
+    if (
+      _offset_commit_batch && !_offset_commit_in_flight
+      && !_offset_commit_timer.armed()) {
+        flush_offset_commits();
+    }
+}
+
+void group::flush_offset_commits() {
+    auto batch = std::exchange(_offset_commit_batch, nullptr);
+    cluster::simple_batch_builder builder(
+      model::record_batch_type::raft_data, model::offset(0));
+
+    for (const auto& [tp, c] : batch->commits) {
+        group_log_record_key key{
+          .record_type = group_log_record_key::type::offset_commit,
+          .key = reflection::to_iobuf(group_log_offset_key{
+            _id,
+            tp.topic,
+            tp.partition,
+          }),
+        };
+        group_log_offset_metadata val{
+          c.md.offset,
+          c.leader_epoch,
+          c.metadata,
+        };
+        builder.add_kv(std::move(key), std::move(val));
+    }
+
+    auto reader = model::make_memory_record_batch_reader(
+      std::move(builder).build());
+
+    _offset_commit_in_flight = true;
     auto replicate_stages = _partition->replicate_in_stages(
       std::move(reader),
       raft::replicate_options(raft::consistency_level::quorum_ack));
 
-    auto f = replicate_stages.replicate_finished.then(
-      [this, req = std::move(r), commits = std::move(offset_commits)](
-        result<raft::replicate_result> r) mutable {
-          error_code error = r ? error_code::none : error_code::not_coordinator;
-          if (in_state(group_state::dead)) {
-              return offset_commit_response(req, error);
+    (void)replicate_stages.request_enqueued.then_wrapped(
+      [batch](ss::future<> f) {
+          if (f.failed()) {
+              batch->dispatched.set_exception(f.get_exception());
+          } else {
+              batch->dispatched.set_value();
           }
+      });
 
-          if (error == error_code::none) {
-              for (auto& e : commits) {
-                  e.second.log_offset = r.value().last_offset;
-                  complete_offset_commit(e.first, e.second);
-              }
-          } else {
-              for (const auto& e : commits) {
-                  fail_offset_commit(e.first, e.second);
+    (void)replicate_stages.replicate_finished.then_wrapped(
+      [this, batch](ss::future<result<raft::replicate_result>> f) {
+          _offset_commit_in_flight = false;
+          if (f.failed()) {
+              for (const auto& [tp, c] : batch->commits) {
+                  fail_offset_commit(tp, c.md);
               }
+              batch->replicated.set_exception(f.get_exception());
+              maybe_flush_offset_commits();
+              return;
           }
 
-          return offset_commit_response(req, error);
+          auto r = f.get0();
+          error_code error = r ? error_code::none : error_code::not_coordinator;
+          if (!in_state(group_state::dead)) {
+              for (auto& [tp, c] : batch->commits) {
+                  if (error == error_code::none) {
+                      c.md.log_offset = r.value().last_offset;
+                      complete_offset_commit(tp, c.md);
+                  } else {
+                      fail_offset_commit(tp, c.md);
+                  }
+              }
+          }
+          batch->replicated.set_value(error);
+          maybe_flush_offset_commits();
       });
-    return offset_commit_stages(
-      std::move(replicate_stages.request_enqueued), std::move(f));
 }
 
 ss::future<cluster::commit_group_tx_reply>
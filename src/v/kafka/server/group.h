@@ -25,7 +25,9 @@
 
 #include <seastar/core/future.hh>
 #include <seastar/core/lowres_clock.hh>
+#include <seastar/core/shared_future.hh>
 #include <seastar/core/shared_ptr.hh>
+#include <seastar/core/timer.hh>
 #include <seastar/util/log.hh>
 
 #include <absl/container/node_hash_map.h>
@@ -551,6 +553,28 @@ private:
 
     model::record_batch checkpoint(const assignments_type& assignments);
 
+    /*
+     * offset commits of the group waiting to be replicated. a batch holds the
+     * last commit of every partition, the commits superseded before the batch
+     * is replicated never reach the log.
+     */
+    struct offset_commit_batch {
+        struct commit {
+            int32_t leader_epoch;
+            std::optional<ss::sstring> metadata;
+            offset_metadata md;
+        };
+
+        absl::node_hash_map<model::topic_partition, commit> commits;
+        ss::shared_promise<> dispatched;
+        ss::shared_promise<error_code> replicated;
+    };
+
+    bool is_committed(const model::topic_partition&, const offset_metadata&)
+      const;
+    void maybe_flush_offset_commits();
+    void flush_offset_commits();
+
     cluster::abort_origin
     get_abort_origin(const model::producer_identity&, model::tx_seq) const;
 
@@ -579,6 +603,9 @@ private:
       _fence_pid_epoch;
     absl::node_hash_map<model::topic_partition, offset_metadata>
       _pending_offset_commits;
+    ss::lw_shared_ptr<offset_commit_batch> _offset_commit_batch;
+    bool _offset_commit_in_flight{false};
+    ss::timer<clock_type> _offset_commit_timer;
 
     struct volatile_offset {
         model::offset offset;
@@ -9,16 +9,19 @@
 
 #include "kafka/server/handlers/fetch.h"
 
+#include "cluster/metadata_cache.h"
 #include "cluster/partition_manager.h"
 #include "cluster/shard_table.h"
 #include "config/configuration.h"
 #include "kafka/protocol/batch_consumer.h"
 #include "kafka/protocol/errors.h"
 #include "kafka/protocol/fetch.h"
+#include "kafka/server/fetch_poll_probe.h"
 #include "kafka/server/fetch_session.h"
 #include "kafka/server/handlers/fetch/fetch_plan_executor.h"
 #include "kafka/server/handlers/fetch/fetch_planner.h"
 #include "kafka/server/materialized_partition.h"
+#include "kafka/server/offset_translator.h"
 #include "kafka/server/partition_proxy.h"
 #include "kafka/server/replicated_partition.h"
 #include "likely.h"
@@ -31,9 +34,13 @@
 #include "storage/parser_utils.h"
 #include "utils/to_string.h"
 
+#include <seastar/core/abort_source.hh>
 #include <seastar/core/do_with.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/shared_future.hh>
 #include <seastar/core/sleep.hh>
 #include <seastar/core/thread.hh>
+#include <seastar/core/timer.hh>
 #include <seastar/util/log.hh>
 
 #include <boost/range/irange.hpp>
@@ -121,6 +128,39 @@ model::record_batch adapt_fetch_batch(model::record_batch&& batch) {
       header, std::move(records), model::record_batch::tag_ctor_ng{});
 }
 
+/**
+ * Shares the fragments of a buffer owned by another shard. The buffer is
+ * released on its shard once all the shared fragments are destroyed.
+ */
+static iobuf share_foreign_data(read_result::foreign_data_t d) {
+    auto owner = ss::make_lw_shared<read_result::foreign_data_t>(std::move(d));
+    iobuf ret;
+    for (const auto& f : **owner) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        ss::temporary_buffer<char> buf(
+          const_cast<char*>(f.get()),
+          f.size(),
+          ss::make_deleter([owner] {}));
+        ret.append_take_ownership(
+          new iobuf::fragment(std::move(buf), iobuf::fragment::full{}));
+    }
+    return ret;
+}
+
+iobuf read_result::release_data() && {
+    return ss::visit(
+      data,
+      [](data_t& d) { return std::move(*d); },
+      [](foreign_data_t& d) {
+          if (config::shard_local_cfg().enable_fetch_zero_copy()) {
+              return share_foreign_data(std::move(d));
+          }
+          auto ret = d->copy();
+          d.reset();
+          return ret;
+      });
+}
+
 /**
  * Low-level handler for reading from an ntp. Runs on ntp's home core.
  */
@@ -150,7 +190,9 @@ static ss::future<read_result> read_from_partition(
     reader_config.strict_max_bytes = config.strict_max_bytes;
     auto rdr = co_await part.make_reader(reader_config);
     auto result = co_await std::move(rdr).consume(
-      kafka_batch_serializer(), deadline ? *deadline : model::no_timeout);
+      kafka_batch_serializer(kafka_batch_serializer::share_records(
+        config::shard_local_cfg().enable_fetch_zero_copy())),
+      deadline ? *deadline : model::no_timeout);
     auto data = std::make_unique<iobuf>(std::move(result.data));
     std::vector<cluster::rm_stm::tx_range> aborted_transactions;
     part.probe().add_records_fetched(result.record_count);
@@ -171,6 +213,30 @@ static ss::future<read_result> read_from_partition(
       std::move(data), start_o, hw, lso, std::move(aborted_transactions));
 }
 
+/**
+ * Chooses the replica a consumer is redirected to (KIP-392). Only the
+ * followers that are alive and caught up with the leader are considered, the
+ * most up to date one is preferred.
+ */
+static std::optional<model::node_id> select_preferred_replica(
+  cluster::partition& partition, const std::vector<model::node_id>& replicas) {
+    std::optional<model::node_id> ret;
+    model::offset match_index;
+    for (const auto& f : partition.raft()->get_follower_metrics()) {
+        if (
+          !f.is_live || f.under_replicated
+          || std::find(replicas.begin(), replicas.end(), f.id)
+               == replicas.end()) {
+            continue;
+        }
+        if (!ret || f.match_index > match_index) {
+            ret = f.id;
+            match_index = f.match_index;
+        }
+    }
+    return ret;
+}
+
 /**
  * Entry point for reading from an ntp. This is executed on NTP home core and
  * build error responses if anything goes wrong.
@@ -188,7 +254,7 @@ static ss::future<read_result> do_read_from_ntp(
         return ss::make_ready_future<read_result>(
           error_code::unknown_topic_or_partition);
     }
-    if (unlikely(!partition->is_leader())) {
+    if (unlikely(!partition->is_leader() && !ntp_config.cfg.follower_read)) {
         return ss::make_ready_future<read_result>(
           error_code::not_leader_for_partition);
     }
@@ -213,6 +279,19 @@ static ss::future<read_result> do_read_from_ntp(
           error_code::offset_out_of_range);
     }
 
+    if (partition->is_leader() && !ntp_config.cfg.rack_replicas.empty()) {
+        auto replica = select_preferred_replica(
+          *partition, ntp_config.cfg.rack_replicas);
+        if (replica) {
+            read_result res(
+              kafka_partition->start_offset(),
+              kafka_partition->high_watermark(),
+              kafka_partition->last_stable_offset());
+            res.preferred_replica = replica;
+            return ss::make_ready_future<read_result>(std::move(res));
+        }
+    }
+
     return read_from_partition(
       std::move(*kafka_partition), ntp_config.cfg, foreign_read, deadline);
 }
@@ -270,6 +349,9 @@ static void fill_fetch_responses(
         resp.log_start_offset = res.start_offset;
         resp.high_watermark = res.high_watermark;
         resp.last_stable_offset = res.last_stable_offset;
+        if (res.preferred_replica) {
+            resp.preferred_read_replica = *res.preferred_replica;
+        }
 
         /**
          * According to KIP-74 we have to return first batch even if it would
@@ -385,12 +467,39 @@ class simple_fetch_planner final : public fetch_planner::impl {
         fetch_plan plan(ss::smp::count);
         auto resp_it = octx.response_begin();
         auto bytes_left_in_plan = octx.bytes_left;
+        /**
+         * consumers using fetch version 11 may be served by followers. the
+         * ones that set their rack id are redirected to a replica in their rack
+         * when this broker is not in that rack itself.
+         *
+         * the last stable offset of a follower is not bounded by how far its
+         * rm_stm applied the log, so read committed consumers of
+         * transactional data stay on the leader. followers reply to them with
+         * not_leader_for_partition
+         */
+        const bool read_committed
+          = config::shard_local_cfg().enable_transactions()
+            && octx.request.data.isolation_level
+                 == model::isolation_level::read_committed;
+        const bool follower_fetch
+          = config::shard_local_cfg().enable_follower_fetch()
+            && octx.rctx.header().version >= api_version(11)
+            && !read_committed;
+        const auto& consumer_rack = octx.request.data.rack_id;
+        const bool rack_aware = follower_fetch && !consumer_rack.empty()
+                                && config::shard_local_cfg().rack()
+                                     != consumer_rack;
         /**
          * group fetch requests by shard
          */
         octx.for_each_fetch_partition(
-          [&resp_it, &octx, &plan, &bytes_left_in_plan](
-            const fetch_session_partition& fp) {
+          [&resp_it,
+           &octx,
+           &plan,
+           &bytes_left_in_plan,
+           follower_fetch,
+           rack_aware,
+           &consumer_rack](const fetch_session_partition& fp) {
               // if this is not an initial fetch we are allowed to skip
               // partions that aleready have an error or we have enough data
               if (!octx.initial_fetch) {
@@ -449,7 +558,13 @@ class simple_fetch_planner final : public fetch_planner::impl {
                 .timeout = octx.deadline.value_or(model::no_timeout),
                 .strict_max_bytes = octx.response_size > 0,
                 .skip_read = bytes_left_in_plan == 0 && max_bytes == 0,
+                .follower_read = follower_fetch,
               };
+              if (rack_aware) {
+                  config.rack_replicas
+                    = octx.rctx.metadata_cache().get_replicas_in_rack(
+                      ntp, consumer_rack);
+              }
 
               plan.fetches_per_shard[*shard].push_back(
                 make_ntp_fetch_config(materialized_ntp, config), resp_it++);
@@ -483,10 +598,220 @@ class simple_fetch_planner final : public fetch_planner::impl {
  * order as the partitions in the request.
  */
 
+/**
+ * Partition of a parked fetch, the fetch is resumed when the high watermark
+ * moves above the (kafka) offset.
+ */
+struct partition_wait {
+    model::ntp ntp;
+    model::offset offset;
+};
+
+/**
+ * Partition read by a fetch plan together with the response it fills.
+ */
+struct planned_partition {
+    ss::shard_id shard;
+    model::materialized_ntp ntp;
+    model::offset fetch_offset;
+    op_context::response_iterator response;
+};
+
+using wake_time = std::optional<fetch_poll_probe::clock_type::time_point>;
+
+static std::vector<planned_partition>
+planned_partitions(const fetch_plan& plan) {
+    std::vector<planned_partition> ret;
+    for (ss::shard_id shard = 0; shard < plan.fetches_per_shard.size();
+         ++shard) {
+        const auto& fetch = plan.fetches_per_shard[shard];
+        for (size_t i = 0; i < fetch.requests.size(); ++i) {
+            ret.push_back(planned_partition{
+              .shard = shard,
+              .ntp = fetch.requests[i].materialized_ntp,
+              .fetch_offset = fetch.requests[i].cfg.start_offset,
+              .response = fetch.responses[i]});
+        }
+    }
+    return ret;
+}
+
+/**
+ * Waits for new data in the partitions of a single shard, it lives on the
+ * shard owning the partitions. Resolves with the time the data became visible
+ * or with nothing when the deadline was reached or the fetch was resumed by
+ * another shard. The remaining waits are aborted as soon as one of them
+ * resolves.
+ */
+struct partition_waits {
+    ss::shared_promise<wake_time> done;
+    ss::abort_source as;
+    ss::timer<model::timeout_clock> timer;
+    bool finished{false};
+
+    void finish(wake_time t) {
+        if (finished) {
+            return;
+        }
+        finished = true;
+        timer.cancel();
+        as.request_abort();
+        done.set_value(t);
+    }
+};
+
+using partition_waits_ptr
+  = ss::foreign_ptr<ss::lw_shared_ptr<partition_waits>>;
+
+static partition_waits_ptr start_partition_waits(
+  cluster::partition_manager& mgr,
+  std::vector<partition_wait> waits,
+  model::timeout_clock::time_point deadline) {
+    auto st = ss::make_lw_shared<partition_waits>();
+    st->timer.set_callback([st = st.get()] { st->finish(std::nullopt); });
+    st->timer.arm(deadline);
+    for (auto& w : waits) {
+        auto partition = mgr.get(w.ntp);
+        if (!partition) {
+            // partition was moved away, the next read reports the error
+            st->finish(fetch_poll_probe::clock_type::now());
+            break;
+        }
+        auto offset = offset_translator(partition->get_cfg_manager())
+                        .from_kafka_offset(w.offset);
+        // waits aborted by the first one to resolve are no-ops, a partition
+        // being stopped resumes the fetch so that the error is reported
+        (void)partition->wait_for_visible_offset(offset, st->as)
+          .then_wrapped([st, partition](ss::future<> f) {
+              f.ignore_ready_future();
+              st->finish(fetch_poll_probe::clock_type::now());
+          });
+    }
+    return ss::make_foreign(std::move(st));
+}
+
+/**
+ * Parks the fetch until the high watermark of any of the partitions moves
+ * above the offset that was read or the fetch deadline is reached. Every
+ * shard watches its own partitions, the fetch is resumed by the first shard
+ * reporting new data and the waits of the other shards are aborted then.
+ *
+ * Materialized partitions are not watched, when the fetch contains any of
+ * them the wait is limited to the fetch reads debounce timeout.
+ */
+static ss::future<>
+park_fetch(op_context& octx, std::vector<planned_partition> partitions) {
+    auto deadline = octx.deadline.value_or(model::no_timeout);
+    std::vector<std::vector<partition_wait>> waits(ss::smp::count);
+    std::vector<ss::shard_id> shards;
+    for (auto& p : partitions) {
+        const auto& resp = *p.response->partition_response;
+        if (resp.error_code != error_code::none) {
+            continue;
+        }
+        if (p.ntp.is_materialized()) {
+            deadline = std::min(
+              deadline,
+              model::timeout_clock::now()
+                + config::shard_local_cfg().fetch_reads_debounce_timeout());
+            continue;
+        }
+        if (waits[p.shard].empty()) {
+            shards.push_back(p.shard);
+        }
+        waits[p.shard].push_back(partition_wait{
+          .ntp = p.ntp.source_ntp(),
+          .offset = std::max(p.fetch_offset, resp.high_watermark)});
+    }
+
+    if (shards.empty()) {
+        // nothing to watch, debounce next read retry
+        co_await ss::sleep(std::min(
+          config::shard_local_cfg().fetch_reads_debounce_timeout(),
+          octx.request.data.max_wait_ms));
+        co_return;
+    }
+
+    struct state {
+        ss::promise<wake_time> done;
+        size_t pending;
+        bool finished{false};
+        // waits of every shard, kept until all of them resolved
+        std::vector<partition_waits_ptr> shard_waits;
+    };
+    auto st = ss::make_lw_shared<state>(state{.pending = shards.size()});
+    st->shard_waits.resize(ss::smp::count);
+    auto& mgr = octx.rctx.partition_manager();
+    co_await ss::parallel_for_each(
+      shards, [&mgr, &octx, &waits, &st, deadline](ss::shard_id shard) {
+          return mgr
+            .invoke_on(
+              shard,
+              octx.ssg,
+              [deadline, waits = std::move(waits[shard])](
+                cluster::partition_manager& mgr) mutable {
+                  return start_partition_waits(
+                    mgr, std::move(waits), deadline);
+              })
+            .then([&st, shard](partition_waits_ptr w) {
+                st->shard_waits[shard] = std::move(w);
+            });
+      });
+
+    auto woken = st->done.get_future();
+    for (auto shard : shards) {
+        (void)mgr
+          .invoke_on(
+            shard,
+            octx.ssg,
+            [w = st->shard_waits[shard].get()](cluster::partition_manager&) {
+                return w->done.get_shared_future();
+            })
+          .then_wrapped([st](ss::future<wake_time> f) {
+              wake_time t;
+              if (f.failed()) {
+                  // resume the fetch, the next read reports the error
+                  f.ignore_ready_future();
+                  t = fetch_poll_probe::clock_type::now();
+              } else {
+                  t = f.get0();
+              }
+              --st->pending;
+              if (st->finished || (!t && st->pending > 0)) {
+                  return;
+              }
+              st->finished = true;
+              st->done.set_value(t);
+          });
+    }
+
+    auto& probe = octx.rctx.get_fetch_poll_probe();
+    probe.fetch_parked();
+    auto t = co_await std::move(woken);
+    if (t) {
+        probe.fetch_woken(*t);
+    } else {
+        probe.fetch_timed_out();
+    }
+    // abort the waits of the shards which did not resume the fetch, they
+    // would otherwise hold the partitions watched until the deadline
+    for (auto shard : shards) {
+        (void)mgr
+          .invoke_on(
+            shard,
+            octx.ssg,
+            [w = st->shard_waits[shard].get()](cluster::partition_manager&) {
+                w->finish(std::nullopt);
+            })
+          .handle_exception([st](const std::exception_ptr&) {});
+    }
+}
+
 static ss::future<> fetch_topic_partitions(op_context& octx) {
     auto planner = make_fetch_planner<simple_fetch_planner>();
 
     auto fetch_plan = planner.create_plan(octx);
+    auto partitions = planned_partitions(fetch_plan);
 
     fetch_plan_executor executor
       = make_fetch_plan_executor<parallel_fetch_plan_executor>();
@@ -497,10 +822,8 @@ static ss::future<> fetch_topic_partitions(op_context& octx) {
     }
 
     octx.reset_context();
-    // debounce next read retry
-    co_await ss::sleep(std::min(
-      config::shard_local_cfg().fetch_reads_debounce_timeout(),
-      octx.request.data.max_wait_ms));
+    // wait for the next read until there is new data to fetch
+    co_await park_fetch(octx, std::move(partitions));
 }
 
 template<>
@@ -691,7 +1014,10 @@ void op_context::response_iterator::set(
       _it->partition_response->partition_index,
       response.partition_index);
 
-    if (response.error_code != error_code::none) {
+    if (
+      response.error_code != error_code::none
+      || response.preferred_read_replica != model::node_id(-1)) {
+        // a consumer redirected to another replica does not wait for data
         _ctx->response_error = true;
     }
     auto& current_resp_data = _it->partition_response->records;
@@ -146,6 +146,11 @@ struct fetch_config {
     model::timeout_clock::time_point timeout;
     bool strict_max_bytes{false};
     bool skip_read{false};
+    /// the read may be served by a follower up to its high watermark
+    bool follower_read{false};
+    /// replicas in the rack of the consumer, the leader redirects the consumer
+    /// to one of them if it is not in the rack itself (KIP-392)
+    std::vector<model::node_id> rack_replicas;
 
     friend std::ostream& operator<<(std::ostream& o, const fetch_config& cfg) {
         fmt::print(
@@ -229,16 +234,9 @@ struct read_result {
           });
     }
 
-    iobuf release_data() && {
-        return ss::visit(
-          data,
-          [](data_t& d) { return std::move(*d); },
-          [](foreign_data_t& d) {
-              auto ret = d->copy();
-              d.reset();
-              return ret;
-          });
-    }
+    /// data read on another shard is shared with the returned buffer when
+    /// enable_fetch_zero_copy is set, it is copied otherwise
+    iobuf release_data() &&;
 
     variant_t data;
     model::offset start_offset;
@@ -247,6 +245,7 @@ struct read_result {
     error_code error;
     model::partition_id partition;
     std::vector<cluster::rm_stm::tx_range> aborted_transactions;
+    std::optional<model::node_id> preferred_replica;
 };
 // struct aggregating fetch requests and corresponding response iterators for
 // the same shard
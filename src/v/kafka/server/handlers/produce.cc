@@ -16,6 +16,7 @@
 #include "config/configuration.h"
 #include "kafka/protocol/errors.h"
 #include "kafka/protocol/kafka_batch_adapter.h"
+#include "kafka/server/produce_probe.h"
 #include "kafka/server/replicated_partition.h"
 #include "likely.h"
 #include "model/fundamental.h"
@@ -110,7 +111,14 @@ static raft::replicate_options acks_to_replicate_options(int16_t acks) {
 }
 
 static inline model::record_batch_reader
-reader_from_lcore_batch(model::record_batch&& batch) {
+reader_from_lcore_batch(model::record_batch&& batch, ss::shard_id shard) {
+    /*
+     * partition led by the shard of the connection, the batch is appended
+     * as is without being copied
+     */
+    if (shard == ss::this_shard_id()) {
+        return model::make_memory_record_batch_reader(std::move(batch));
+    }
     /*
      * The remainder of work for this partition is handled on its home
      * core. The foreign memory record batch reader requires that once the
@@ -234,7 +242,9 @@ static partition_produce_stages produce_topic_partition(
     auto bid = model::batch_identity::from(hdr);
 
     auto num_records = batch.record_count();
-    auto reader = reader_from_lcore_batch(std::move(batch));
+    octx.rctx.get_produce_probe().batch_produced(
+      batch.size_bytes(), *shard != ss::this_shard_id());
+    auto reader = reader_from_lcore_batch(std::move(batch), *shard);
     auto start = std::chrono::steady_clock::now();
 
     auto dispatch = std::make_unique<ss::promise<>>();
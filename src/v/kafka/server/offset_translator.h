@@ -51,13 +51,7 @@ public:
     }
 
 private:
-    int64_t delta(model::offset o) const {
-        auto it = _cfg_mgr.lower_bound(o);
-        if (it != _cfg_mgr.begin()) {
-            --it;
-        }
-        return it->second.idx();
-    }
+    int64_t delta(model::offset o) const { return _cfg_mgr.offset_delta(o); }
 
     const raft::configuration_manager& _cfg_mgr;
 };
@@ -22,7 +22,8 @@ std::optional<partition_proxy> make_partition_proxy(
   ss::lw_shared_ptr<cluster::partition> partition,
   cluster::partition_manager& pm) {
     if (!mntp.is_materialized()) {
-        return make_partition_proxy<replicated_partition>(partition);
+        return make_partition_proxy<replicated_partition>(
+          partition, pm.get_archival_reader(mntp.input_ntp()));
     }
     if (auto log = pm.log(mntp.input_ntp()); log) {
         return make_partition_proxy<materialized_partition>(*log);
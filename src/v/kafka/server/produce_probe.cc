@@ -0,0 +1,47 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "kafka/server/produce_probe.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+
+#include <seastar/core/metrics.hh>
+
+namespace kafka {
+
+void produce_probe::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("kafka:produce"),
+      {
+        sm::make_derive(
+          "bytes",
+          [this] { return _bytes; },
+          sm::description("Number of produced bytes")),
+        sm::make_derive(
+          "cross_shard_bytes",
+          [this] { return _cross_shard_bytes; },
+          sm::description("Number of produced bytes of partitions led by "
+                          "another shard than the one of the connection")),
+        sm::make_gauge(
+          "cross_shard_ratio",
+          [this] {
+              return _bytes == 0 ? 0.0
+                                 : double(_cross_shard_bytes) / double(_bytes);
+          },
+          sm::description("Fraction of the produced bytes crossing shards")),
+      });
+}
+
+} // namespace kafka
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "seastarx.h"
+
+#include <seastar/core/metrics_registration.hh>
+
+#include <cstdint>
+
+namespace kafka {
+
+/**
+ * Metrics of the produced batches routing, owned by the kafka protocol of the
+ * shard. Batches of partitions led by the shard of the connection are
+ * appended in place, the others are handed over to the shard of the partition
+ * and copied there.
+ */
+class produce_probe {
+public:
+    void batch_produced(uint64_t bytes, bool cross_shard) {
+        _bytes += bytes;
+        if (cross_shard) {
+            _cross_shard_bytes += bytes;
+        }
+    }
+
+    void setup_metrics();
+
+private:
+    uint64_t _bytes{0};
+    uint64_t _cross_shard_bytes{0};
+    ss::metrics::metric_groups _metrics;
+};
+
+} // namespace kafka
@@ -14,7 +14,9 @@
 #include "cluster/fwd.h"
 #include "config/configuration.h"
 #include "kafka/server/fetch_metadata_cache.hh"
+#include "kafka/server/fetch_poll_probe.h"
 #include "kafka/server/fwd.h"
+#include "kafka/server/produce_probe.h"
 #include "kafka/server/queue_depth_monitor.h"
 #include "rpc/server.h"
 #include "security/authorizer.h"
@@ -116,6 +118,16 @@ public:
         return _fetch_metadata_cache;
     }
 
+    fetch_poll_probe& get_fetch_poll_probe() { return _fetch_poll_probe; }
+    produce_probe& get_produce_probe() { return _produce_probe; }
+
+    /// registers the metrics of the protocol probes, only one protocol of a
+    /// shard can register them
+    void setup_metrics() {
+        _fetch_poll_probe.setup_metrics();
+        _produce_probe.setup_metrics();
+    }
+
 private:
     ss::smp_service_group _smp_group;
     ss::sharded<cluster::topics_frontend>& _topics_frontend;
@@ -136,6 +148,8 @@ private:
     ss::sharded<cluster::tx_gateway_frontend>& _tx_gateway_frontend;
     std::optional<qdc_monitor> _qdc_mon;
     kafka::fetch_metadata_cache _fetch_metadata_cache;
+    fetch_poll_probe _fetch_poll_probe;
+    produce_probe _produce_probe;
 };
 
 } // namespace kafka
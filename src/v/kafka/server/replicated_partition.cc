@@ -17,20 +17,59 @@
 
 #include <seastar/core/coroutine.hh>
 
+#include <algorithm>
 #include <optional>
 
 namespace kafka {
 replicated_partition::replicated_partition(
-  ss::lw_shared_ptr<cluster::partition> p) noexcept
+  ss::lw_shared_ptr<cluster::partition> p,
+  ss::shared_ptr<cluster::archival_reader> archive) noexcept
   : _partition(p)
   , _translator(
-      ss::make_lw_shared<offset_translator>(_partition->get_cfg_manager())){
+      ss::make_lw_shared<offset_translator>(_partition->get_cfg_manager()))
+  , _archive(std::move(archive)) {}
+
+std::optional<model::offset>
+replicated_partition::archive_start_offset() const {
+    if (!_archive) {
+        return std::nullopt;
+    }
+    // archived data is only readable if it reaches the local log, otherwise
+    // there would be a gap in the offsets
+    auto local = _partition->start_offset();
+    auto start = _archive->start_offset();
+    auto last = _archive->last_offset();
+    if (
+      !start || !last || *start >= local
+      || *last + model::offset(1) < local) {
+        return std::nullopt;
+    }
+    return _archive->start_kafka_offset();
+}
+
+model::offset replicated_partition::start_offset() const {
+    if (auto archived = archive_start_offset(); archived) {
+        return *archived;
+    }
+    return _translator->to_kafka_offset(_partition->start_offset());
+}
 
-    };
 // TODO: use previous translation speed up lookup
 ss::future<model::record_batch_reader> replicated_partition::make_reader(
   storage::log_reader_config cfg,
   std::optional<model::timeout_clock::time_point> deadline) {
+    const auto local_start = _translator->to_kafka_offset(
+      _partition->start_offset());
+    if (cfg.start_offset < local_start && archive_start_offset()) {
+        // catch-up read of data that only remains in archival storage, it
+        // is read with kafka offsets as the translation history below the
+        // local log is gone. the reader stops at the local log, the next
+        // fetch continues there
+        cfg.max_offset = std::min(
+          cfg.max_offset, local_start - model::offset(1));
+        cfg.type_filter = {model::record_batch_type::raft_data};
+        co_return co_await _archive->make_reader(cfg, deadline);
+    }
     cfg.start_offset = _translator->from_kafka_offset(cfg.start_offset);
     cfg.max_offset = _translator->from_kafka_offset(cfg.max_offset);
     cfg.type_filter = {model::record_batch_type::raft_data};
@@ -10,6 +10,7 @@
  */
 #pragma once
 
+#include "cluster/archival_reader.h"
 #include "cluster/partition.h"
 #include "cluster/partition_probe.h"
 #include "kafka/server/offset_translator.h"
@@ -24,16 +25,20 @@
 
 namespace kafka {
 
+/**
+ * Kafka view of a raft partition. When the partition is archived, the offsets
+ * that were already removed from the local log are read from archival storage
+ * through the archival reader.
+ */
 class replicated_partition final : public kafka::partition_proxy::impl {
 public:
     explicit replicated_partition(
-      ss::lw_shared_ptr<cluster::partition> p) noexcept;
+      ss::lw_shared_ptr<cluster::partition> p,
+      ss::shared_ptr<cluster::archival_reader> archive = nullptr) noexcept;
 
     const model::ntp& ntp() const final { return _partition->ntp(); }
 
-    model::offset start_offset() const final {
-        return _translator->to_kafka_offset(_partition->start_offset());
-    }
+    model::offset start_offset() const final;
 
     model::offset high_watermark() const final {
         return _translator->to_kafka_offset(_partition->high_watermark());
@@ -79,8 +84,13 @@ public:
     cluster::partition_probe& probe() final { return _partition->probe(); }
 
 private:
+    /// first kafka offset readable from archival storage, nullopt when
+    /// the archived data does not reach the local log
+    std::optional<model::offset> archive_start_offset() const;
+
     ss::lw_shared_ptr<cluster::partition> _partition;
     ss::lw_shared_ptr<offset_translator> _translator;
+    ss::shared_ptr<cluster::archival_reader> _archive;
 };
 
 } // namespace kafka
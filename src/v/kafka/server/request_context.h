@@ -132,6 +132,14 @@ public:
         return _conn->server().get_fetch_metadata_cache();
     }
 
+    fetch_poll_probe& get_fetch_poll_probe() {
+        return _conn->server().get_fetch_poll_probe();
+    }
+
+    produce_probe& get_produce_probe() {
+        return _conn->server().get_produce_probe();
+    }
+
     // clang-format off
     template<typename ResponseType>
     CONCEPT(requires requires (
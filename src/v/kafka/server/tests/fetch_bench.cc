@@ -0,0 +1,182 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "config/configuration.h"
+#include "kafka/protocol/batch_consumer.h"
+#include "kafka/protocol/response_writer.h"
+#include "kafka/server/handlers/fetch.h"
+#include "model/record_batch_reader.h"
+#include "storage/tests/utils/random_batch.h"
+
+#include <seastar/core/sharded.hh>
+#include <seastar/testing/perf_tests.hh>
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using ranges_t = std::vector<std::pair<const char*, const char*>>;
+
+ranges_t fragment_ranges(const iobuf& buf) {
+    ranges_t ret;
+    for (const auto& f : buf) {
+        ret.emplace_back(f.get(), f.get() + f.size());
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+// bytes of `out` pointing into the `in` buffers
+size_t shared_bytes(const ranges_t& in, const iobuf& out) {
+    size_t ret = 0;
+    for (const auto& f : out) {
+        auto it = std::upper_bound(
+          in.begin(),
+          in.end(),
+          std::make_pair(f.get(), f.get() + f.size()),
+          [](const auto& a, const auto& b) { return a.first < b.first; });
+        if (it == in.begin()) {
+            continue;
+        }
+        --it;
+        if (f.get() >= it->first && f.get() + f.size() <= it->second) {
+            ret += f.size();
+        }
+    }
+    return ret;
+}
+
+} // namespace
+
+/*
+ * fetch response payload. batches read from the log are serialized to the
+ * kafka format on the partition shard, handed over to the connection shard
+ * and written into the response. the bytes that do not point into the
+ * buffers of the previous step were copied, the harness prints the bytes
+ * copied per byte served by every step when it is destroyed.
+ */
+template<int records>
+struct fetch_bench {
+    static constexpr int batch_count = 100;
+
+    struct copies {
+        size_t served{0};
+        size_t serialize{0};
+        size_t release{0};
+        size_t encode{0};
+    };
+
+    fetch_bench() {
+        config::shard_local_cfg().get("disable_metrics").set_value(true);
+        for (int i = 0; i < batch_count; ++i) {
+            auto b = storage::test::make_random_batch(
+              model::offset(i * records), records, false);
+            for (const auto& f : b.data()) {
+                source.emplace_back(f.get(), f.get() + f.size());
+            }
+            batches.push_back(std::move(b));
+        }
+        std::sort(source.begin(), source.end());
+    }
+
+    fetch_bench(const fetch_bench&) = delete;
+    fetch_bench& operator=(const fetch_bench&) = delete;
+
+    ~fetch_bench() {
+        for (auto zero_copy : {false, true}) {
+            const auto& c = stats[zero_copy];
+            if (c.served == 0) {
+                continue;
+            }
+            auto per_byte = [&c](size_t copied) {
+                return double(copied) / double(c.served);
+            };
+            fmt::print(
+              "records per batch: {}, zero copy: {}, bytes copied per byte "
+              "served: {:.2f} (serialize: {:.2f}, release: {:.2f}, encode: "
+              "{:.2f})\n",
+              records,
+              zero_copy,
+              per_byte(c.serialize + c.release + c.encode),
+              per_byte(c.serialize),
+              per_byte(c.release),
+              per_byte(c.encode));
+        }
+    }
+
+    size_t serve(bool zero_copy) {
+        config::shard_local_cfg()
+          .get("enable_fetch_zero_copy")
+          .set_value(zero_copy);
+        ss::circular_buffer<model::record_batch> input;
+        size_t records_size = 0;
+        for (auto& b : batches) {
+            records_size += b.data().size_bytes();
+            input.push_back(b.share());
+        }
+        auto rdr = model::make_memory_record_batch_reader(std::move(input));
+
+        perf_tests::start_measuring_time();
+        auto serialized = std::move(rdr)
+                            .consume(
+                              kafka::kafka_batch_serializer(
+                                kafka::kafka_batch_serializer::share_records(
+                                  zero_copy)),
+                              model::no_timeout)
+                            .get0();
+        // shares keep the buffers of every step alive, their memory can not
+        // be reused by the copies made in the next steps
+        auto data = std::move(serialized.data);
+        auto serialized_ranges = fragment_ranges(data);
+        auto serialized_size = data.size_bytes();
+        auto serialized_keep = data.share(0, serialized_size);
+        kafka::read_result res(
+          ss::make_foreign(std::make_unique<iobuf>(std::move(data))),
+          model::offset(0),
+          model::offset(batch_count * records),
+          model::offset(batch_count * records),
+          {});
+        auto released = std::move(res).release_data();
+        auto released_ranges = fragment_ranges(released);
+        auto released_keep = released.share(0, released.size_bytes());
+        iobuf response;
+        kafka::response_writer wr(response);
+        wr.write(std::optional<kafka::batch_reader>(
+          kafka::batch_reader(std::move(released))));
+        perf_tests::do_not_optimize(response);
+        perf_tests::stop_measuring_time();
+
+        auto& c = stats[zero_copy];
+        c.served += records_size;
+        c.serialize += records_size
+                       - std::min(
+                         records_size, shared_bytes(source, serialized_keep));
+        c.release += serialized_size
+                     - shared_bytes(serialized_ranges, released_keep);
+        c.encode += serialized_size - shared_bytes(released_ranges, response);
+        return batch_count;
+    }
+
+    std::vector<model::record_batch> batches;
+    ranges_t source;
+    std::array<copies, 2> stats;
+};
+
+using fetch_small_batches = fetch_bench<1>;
+using fetch_large_batches = fetch_bench<200>;
+
+PERF_TEST_F(fetch_small_batches, copy) { return serve(false); }
+PERF_TEST_F(fetch_small_batches, zero_copy) { return serve(true); }
+PERF_TEST_F(fetch_large_batches, copy) { return serve(false); }
+PERF_TEST_F(fetch_large_batches, zero_copy) { return serve(true); }
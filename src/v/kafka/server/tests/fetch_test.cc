@@ -7,15 +7,27 @@
 // the Business Source License, use of this software will be governed
 // by the Apache License, Version 2.0
 
+#include "cluster/metadata_cache.h"
+#include "cluster/partition_manager.h"
+#include "cluster/shard_table.h"
+#include "cluster/tests/cluster_test_fixture.h"
+#include "cluster/topics_frontend.h"
+#include "config/configuration.h"
+#include "kafka/client/transport.h"
 #include "kafka/protocol/batch_consumer.h"
 #include "kafka/server/handlers/fetch.h"
 #include "kafka/types.h"
 #include "model/fundamental.h"
+#include "model/record_batch_reader.h"
 #include "redpanda/tests/fixture.h"
 #include "resource_mgmt/io_priority.h"
+#include "storage/tests/utils/random_batch.h"
 #include "test_utils/async.h"
+#include "utils/unresolved_address.h"
 
+#include <seastar/core/sleep.hh>
 #include <seastar/core/smp.hh>
+#include <seastar/util/defer.hh>
 
 #include <chrono>
 #include <limits>
@@ -504,6 +516,76 @@ FIXTURE_TEST(fetch_one_debounce, redpanda_thread_fixture) {
     BOOST_REQUIRE(resp.data.topics[0].partitions[0].records->size_bytes() > 0);
 }
 
+FIXTURE_TEST(fetch_one_wakes_on_new_data, redpanda_thread_fixture) {
+    model::topic topic("foo");
+    model::partition_id pid(0);
+    auto ntp = make_default_ntp(topic, pid);
+
+    wait_for_controller_leadership().get0();
+
+    add_topic(model::topic_namespace_view(ntp)).get();
+    wait_for_partition_offset(ntp, model::offset(0)).get0();
+
+    // parked fetch must be woken up by the new data, not by the debounce
+    // timeout
+    auto debounce
+      = config::shard_local_cfg().fetch_reads_debounce_timeout.value();
+    config::shard_local_cfg()
+      .get("fetch_reads_debounce_timeout")
+      .set_value(std::chrono::milliseconds(10000));
+    auto reset_debounce = ss::defer([debounce] {
+        config::shard_local_cfg()
+          .get("fetch_reads_debounce_timeout")
+          .set_value(debounce);
+    });
+
+    kafka::fetch_request req;
+    req.data.max_bytes = std::numeric_limits<int32_t>::max();
+    req.data.min_bytes = 1;
+    req.data.max_wait_ms = std::chrono::milliseconds(10000);
+    req.data.session_id = kafka::invalid_fetch_session_id;
+    req.data.topics = {{
+      .name = topic,
+      .fetch_partitions = {{
+        .partition_index = pid,
+        .fetch_offset = model::offset(0),
+      }},
+    }};
+
+    auto client = make_kafka_client().get0();
+    client.connect().get();
+    auto start = model::timeout_clock::now();
+    auto fresp = client.dispatch(req, kafka::api_version(4));
+    ss::sleep(std::chrono::milliseconds(200)).get();
+    auto shard = app.shard_table.local().shard_for(ntp);
+    app.partition_manager
+      .invoke_on(
+        *shard,
+        [ntp](cluster::partition_manager& mgr) {
+            auto partition = mgr.get(ntp);
+            auto batches = storage::test::make_random_batches(
+              model::offset(0), 5);
+            auto rdr = model::make_memory_record_batch_reader(
+              std::move(batches));
+            return partition->replicate(
+              std::move(rdr),
+              raft::replicate_options(raft::consistency_level::quorum_ack));
+        })
+      .get0();
+
+    auto resp = fresp.get0();
+    auto elapsed = model::timeout_clock::now() - start;
+    client.stop().then([&client] { client.shutdown(); }).get();
+
+    BOOST_REQUIRE(elapsed < std::chrono::milliseconds(5000));
+    BOOST_REQUIRE(resp.data.topics.size() == 1);
+    BOOST_REQUIRE(resp.data.topics[0].partitions.size() == 1);
+    BOOST_REQUIRE(
+      resp.data.topics[0].partitions[0].error_code == kafka::error_code::none);
+    BOOST_REQUIRE(resp.data.topics[0].partitions[0].records);
+    BOOST_REQUIRE(resp.data.topics[0].partitions[0].records->size_bytes() > 0);
+}
+
 FIXTURE_TEST(fetch_multi_topics, redpanda_thread_fixture) {
     // create a topic partition with some data
     model::topic topic_1("foo");
@@ -660,3 +742,297 @@ FIXTURE_TEST(fetch_request_max_bytes, redpanda_thread_fixture) {
     BOOST_REQUIRE(
       fetch_one_byte.data.topics[0].partitions[0].records->size_bytes() > 0);
 }
+
+FIXTURE_TEST(fetch_no_replicas_in_rack, redpanda_thread_fixture) {
+    model::topic topic("foo");
+    model::partition_id pid(0);
+    auto ntp = make_default_ntp(topic, pid);
+    auto log_config = make_default_config();
+    {
+        using namespace storage;
+        storage::disk_log_builder builder(log_config);
+        storage::ntp_config ntp_cfg(
+          ntp, log_config.base_dir, nullptr, model::revision_id(2));
+        builder | start(std::move(ntp_cfg)) | add_segment(model::offset(0))
+          | add_random_batch(model::offset(0), 10, maybe_compress_batches::yes)
+          | stop();
+    }
+    wait_for_controller_leadership().get0();
+
+    add_topic(model::topic_namespace_view(ntp)).get();
+    auto shard = app.shard_table.local().shard_for(ntp);
+
+    tests::cooperative_spin_wait_with_timeout(10s, [this, shard, ntp] {
+        return app.partition_manager.invoke_on(
+          *shard, [ntp](cluster::partition_manager& mgr) {
+              auto partition = mgr.get(ntp);
+              return partition
+                     && partition->committed_offset() >= model::offset(1);
+          });
+    }).get();
+
+    ss::smp::invoke_on_all([] {
+        config::shard_local_cfg().get("enable_follower_fetch").set_value(true);
+    }).get();
+    auto reset = ss::defer([] {
+        ss::smp::invoke_on_all([] {
+            config::shard_local_cfg()
+              .get("enable_follower_fetch")
+              .set_value(false);
+        }).get();
+    });
+
+    kafka::fetch_request req;
+    req.data.max_bytes = std::numeric_limits<int32_t>::max();
+    req.data.min_bytes = 1;
+    req.data.max_wait_ms = std::chrono::milliseconds(0);
+    req.data.session_id = kafka::invalid_fetch_session_id;
+    req.data.session_epoch = kafka::final_fetch_session_epoch;
+    req.data.rack_id = "other-rack";
+    req.data.topics = {{
+      .name = topic,
+      .fetch_partitions = {{
+        .partition_index = pid,
+        .fetch_offset = model::offset(0),
+      }},
+    }};
+
+    auto client = make_kafka_client().get0();
+    client.connect().get();
+    auto resp = client.dispatch(req, kafka::api_version(11)).get0();
+    client.stop().then([&client] { client.shutdown(); }).get();
+
+    // there is no replica in the rack of the consumer, the leader serves it
+    BOOST_REQUIRE(resp.data.topics.size() == 1);
+    BOOST_REQUIRE(resp.data.topics[0].partitions.size() == 1);
+    const auto& p = resp.data.topics[0].partitions[0];
+    BOOST_REQUIRE(p.error_code == kafka::error_code::none);
+    BOOST_REQUIRE_EQUAL(p.preferred_read_replica, model::node_id(-1));
+    BOOST_REQUIRE(p.records);
+    BOOST_REQUIRE(p.records->size_bytes() > 0);
+}
+
+/**
+ * Three brokers where all but the first one are in the rack of the consumer.
+ * Brokers capture their rack when they start. The configuration shared by all
+ * of them then places the broker handling a fetch in the first rack.
+ */
+class follower_fetch_fixture : public cluster_test_fixture {
+public:
+    static constexpr int brokers = 3;
+    static constexpr auto broker_rack = "broker-rack";
+    static constexpr auto consumer_rack = "consumer-rack";
+
+    follower_fetch_fixture() {
+        for (auto id : boost::irange(0, brokers)) {
+            auto rack = id == 0 ? broker_rack : consumer_rack;
+            set_configuration("rack", std::optional<ss::sstring>(rack));
+            create_node_application(model::node_id(id));
+        }
+        wait_for_all_members(10s).get();
+        set_configuration("rack", std::optional<ss::sstring>(broker_rack));
+        set_configuration("enable_follower_fetch", true);
+    }
+
+    ~follower_fetch_fixture() {
+        set_configuration("enable_follower_fetch", false);
+        set_configuration("rack", std::optional<ss::sstring>());
+        set_configuration("disable_metrics", false);
+    }
+
+    model::ntp create_replicated_topic() {
+        model::ntp ntp(
+          model::kafka_namespace, model::topic("foo"), model::partition_id(0));
+        wait_for_controller_leadership(model::node_id(0)).get();
+        auto controller_leader
+          = get_local_cache(model::node_id(0)).get_controller_leader_id();
+        BOOST_REQUIRE(controller_leader);
+        auto res = get_node_application(*controller_leader)
+                     ->controller->get_topics_frontend()
+                     .local()
+                     .autocreate_topics(
+                       {cluster::topic_configuration(
+                         ntp.ns, ntp.tp.topic, 1, brokers)},
+                       2s)
+                     .get0();
+        BOOST_REQUIRE_EQUAL(res.size(), 1);
+        BOOST_REQUIRE(res[0].ec == cluster::errc::success);
+        for (auto id : boost::irange(0, brokers)) {
+            wait_for_partition(model::node_id(id), ntp);
+        }
+        return ntp;
+    }
+
+    void wait_for_partition(model::node_id id, const model::ntp& ntp) {
+        tests::cooperative_spin_wait_with_timeout(10s, [this, id, ntp] {
+            auto shard = get_shard_table(id).shard_for(ntp);
+            if (!shard) {
+                return ss::make_ready_future<bool>(false);
+            }
+            return get_partition_manager(id).invoke_on(
+              *shard, [ntp](cluster::partition_manager& pm) {
+                  return static_cast<bool>(pm.get(ntp));
+              });
+        }).get();
+    }
+
+    model::node_id leader_of(const model::ntp& ntp) {
+        return get_local_cache(model::node_id(0))
+          .get_leader(ntp, ss::lowres_clock::now() + 10s)
+          .get0();
+    }
+
+    void produce(model::node_id leader, const model::ntp& ntp) {
+        auto shard = get_shard_table(leader).shard_for(ntp).value();
+        auto replicated
+          = get_partition_manager(leader)
+              .invoke_on(
+                shard,
+                [ntp](cluster::partition_manager& pm) {
+                    auto batches = storage::test::make_random_batches(
+                      model::offset(0), 10);
+                    return pm.get(ntp)
+                      ->replicate(
+                        model::make_memory_record_batch_reader(
+                          std::move(batches)),
+                        raft::replicate_options(
+                          raft::consistency_level::quorum_ack))
+                      .then([](result<raft::replicate_result> r) {
+                          return r.has_value();
+                      });
+                })
+              .get0();
+        BOOST_REQUIRE(replicated);
+    }
+
+    model::offset high_watermark(model::node_id id, const model::ntp& ntp) {
+        auto shard = get_shard_table(id).shard_for(ntp).value();
+        return get_partition_manager(id)
+          .invoke_on(
+            shard,
+            [ntp](cluster::partition_manager& pm) {
+                return pm.get(ntp)->high_watermark();
+            })
+          .get0();
+    }
+
+    ss::future<kafka::fetch_response> fetch(
+      model::node_id id,
+      const model::ntp& ntp,
+      ss::sstring rack,
+      model::isolation_level isolation
+      = model::isolation_level::read_uncommitted) {
+        kafka::fetch_request req;
+        req.data.isolation_level = isolation;
+        req.data.max_bytes = std::numeric_limits<int32_t>::max();
+        req.data.min_bytes = 1;
+        req.data.max_wait_ms = std::chrono::milliseconds(0);
+        req.data.session_id = kafka::invalid_fetch_session_id;
+        req.data.session_epoch = kafka::final_fetch_session_epoch;
+        req.data.rack_id = std::move(rack);
+        req.data.topics = {{
+          .name = ntp.tp.topic,
+          .fetch_partitions = {{
+            .partition_index = ntp.tp.partition,
+            .fetch_offset = model::offset(0),
+          }},
+        }};
+        // every broker listens on its own kafka port
+        return ss::do_with(
+          kafka::client::transport(rpc::base_transport::configuration{
+            .server_addr = unresolved_address("127.0.0.1", 9092 + id()),
+          }),
+          [req = std::move(req)](kafka::client::transport& client) mutable {
+              return client.connect()
+                .then([&client, req = std::move(req)]() mutable {
+                    return client.dispatch(
+                      std::move(req), kafka::api_version(11));
+                })
+                .finally([&client] {
+                    return client.stop().then(
+                      [&client] { client.shutdown(); });
+                });
+          });
+    }
+};
+
+FIXTURE_TEST(fetch_redirect_to_replica_in_rack, follower_fetch_fixture) {
+    auto ntp = create_replicated_topic();
+    auto leader = leader_of(ntp);
+    produce(leader, ntp);
+
+    // followers are only preferred once they caught up with the leader
+    kafka::fetch_response resp;
+    tests::cooperative_spin_wait_with_timeout(
+      10s, [this, leader, ntp, &resp] {
+          return fetch(leader, ntp, consumer_rack)
+            .then([&resp](kafka::fetch_response r) {
+                resp = std::move(r);
+                return resp.data.topics[0].partitions[0].preferred_read_replica
+                       != model::node_id(-1);
+            });
+      })
+      .get();
+
+    // the consumer is sent to a follower in its rack without any records
+    const auto& p = resp.data.topics[0].partitions[0];
+    BOOST_REQUIRE(p.error_code == kafka::error_code::none);
+    BOOST_REQUIRE_NE(p.preferred_read_replica, leader);
+    BOOST_REQUIRE_NE(p.preferred_read_replica, model::node_id(0));
+    BOOST_REQUIRE(!p.records || p.records->empty());
+}
+
+FIXTURE_TEST(fetch_from_follower_up_to_high_watermark, follower_fetch_fixture) {
+    auto ntp = create_replicated_topic();
+    auto leader = leader_of(ntp);
+    auto follower = model::node_id(leader() == 0 ? 1 : 0);
+    produce(leader, ntp);
+    const auto leader_hw = high_watermark(leader, ntp);
+
+    // the follower learns the last visible offset of the leader with the next
+    // append entries or heartbeat
+    kafka::fetch_response resp;
+    tests::cooperative_spin_wait_with_timeout(
+      10s, [this, follower, ntp, leader_hw, &resp] {
+          return fetch(follower, ntp, "").then(
+            [&resp, leader_hw](kafka::fetch_response r) {
+                resp = std::move(r);
+                return resp.data.topics[0].partitions[0].high_watermark
+                       == leader_hw;
+            });
+      })
+      .get();
+
+    // the follower serves the records but none past the leader high watermark
+    const auto& p = resp.data.topics[0].partitions[0];
+    BOOST_REQUIRE(p.error_code == kafka::error_code::none);
+    BOOST_REQUIRE_EQUAL(p.preferred_read_replica, model::node_id(-1));
+    BOOST_REQUIRE(p.records);
+    BOOST_REQUIRE(!p.records->empty());
+    BOOST_REQUIRE_LT(p.records->last_offset(), leader_hw);
+}
+
+FIXTURE_TEST(fetch_read_committed_from_follower, follower_fetch_fixture) {
+    auto ntp = create_replicated_topic();
+    auto leader = leader_of(ntp);
+    auto follower = model::node_id(leader() == 0 ? 1 : 0);
+    produce(leader, ntp);
+
+    set_configuration("enable_transactions", true);
+    auto reset = ss::defer(
+      [] { set_configuration("enable_transactions", false); });
+
+    // the follower may not have applied the transactions up to its high
+    // watermark, read committed consumers go back to the leader
+    const auto read_committed = model::isolation_level::read_committed;
+    auto resp = fetch(follower, ntp, "", read_committed).get0();
+    BOOST_REQUIRE(
+      resp.data.topics[0].partitions[0].error_code
+      == kafka::error_code::not_leader_for_partition);
+
+    // and the leader does not redirect them to a follower
+    resp = fetch(leader, ntp, consumer_rack, read_committed).get0();
+    const auto& p = resp.data.topics[0].partitions[0];
+    BOOST_REQUIRE(p.error_code == kafka::error_code::none);
+    BOOST_REQUIRE_EQUAL(p.preferred_read_replica, model::node_id(-1));
+}
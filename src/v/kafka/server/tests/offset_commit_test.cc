@@ -7,15 +7,25 @@
 // the Business Source License, use of this software will be governed
 // by the Apache License, Version 2.0
 
+#include "config/configuration.h"
+#include "kafka/protocol/find_coordinator.h"
 #include "kafka/protocol/offset_commit.h"
+#include "model/namespace.h"
 #include "redpanda/tests/fixture.h"
 #include "resource_mgmt/io_priority.h"
 #include "test_utils/async.h"
 
+#include <seastar/core/loop.hh>
 #include <seastar/core/smp.hh>
+#include <seastar/util/defer.hh>
+
+#include <boost/range/irange.hpp>
 
 #include <chrono>
 #include <limits>
+#include <vector>
+
+using namespace std::chrono_literals;
 
 FIXTURE_TEST(
   offset_commit_static_membership_not_supported, redpanda_thread_fixture) {
@@ -36,3 +46,162 @@ FIXTURE_TEST(
       resp.data.topics[0].partitions[0].error_code
       == kafka::error_code::unsupported_version);
 }
+
+FIXTURE_TEST(offset_commit_skips_committed_offsets, redpanda_thread_fixture) {
+    wait_for_controller_leadership().get();
+
+    auto client = make_kafka_client().get0();
+    client.connect().get();
+
+    // creates the group topic
+    kafka::find_coordinator_request coordinator_req("g");
+    client.dispatch(coordinator_req, kafka::api_version(1)).get();
+
+    kafka::offset_commit_request req;
+    req.data.group_id = kafka::group_id("g");
+    auto commit = [&client, &req](model::offset o) {
+        req.data.topics = {{
+          .name = model::topic("t"),
+          .partitions = {{
+            .partition_index = model::partition_id(0),
+            .committed_offset = o,
+          }},
+        }};
+        return client.dispatch(req, kafka::api_version(6))
+          .then([](kafka::offset_commit_response resp) {
+              return resp.data.topics[0].partitions[0].error_code;
+          });
+    };
+
+    // wait for the group topic partition to be loaded
+    tests::cooperative_spin_wait_with_timeout(10s, [&commit] {
+        return commit(model::offset(10)).then([](kafka::error_code ec) {
+            return ec == kafka::error_code::none;
+        });
+    }).get();
+
+    auto group_ntp = model::ntp(
+      model::kafka_internal_namespace,
+      model::kafka_group_topic,
+      model::partition_id(0));
+    auto partition = app.partition_manager.local().get(group_ntp);
+    BOOST_REQUIRE(partition);
+    auto dirty_offset = partition->dirty_offset();
+
+    // committing the same offset again is not appended
+    BOOST_REQUIRE_EQUAL(
+      commit(model::offset(10)).get0(), kafka::error_code::none);
+    BOOST_REQUIRE_EQUAL(partition->dirty_offset(), dirty_offset);
+
+    BOOST_REQUIRE_EQUAL(
+      commit(model::offset(11)).get0(), kafka::error_code::none);
+    BOOST_REQUIRE_GT(partition->dirty_offset(), dirty_offset);
+
+    client.stop().then([&client] { client.shutdown(); }).get();
+}
+
+namespace {
+
+ss::future<kafka::error_code>
+commit_offset(kafka::client::transport& client, model::offset o) {
+    kafka::offset_commit_request req;
+    req.data.group_id = kafka::group_id("g");
+    req.data.topics = {{
+      .name = model::topic("t"),
+      .partitions = {{
+        .partition_index = model::partition_id(0),
+        .committed_offset = o,
+      }},
+    }};
+    return client.dispatch(std::move(req), kafka::api_version(6))
+      .then([](kafka::offset_commit_response resp) {
+          return resp.data.topics[0].partitions[0].error_code;
+      });
+}
+
+/*
+ * commits consecutive offsets of the same partition concurrently, one per
+ * client, and returns the number of records appended to the group topic.
+ */
+int64_t commit_concurrently(
+  redpanda_thread_fixture& f, int clients, model::offset first_offset) {
+    std::vector<kafka::client::transport> transports;
+    transports.reserve(clients);
+    for (int i = 0; i < clients; ++i) {
+        transports.push_back(f.make_kafka_client().get0());
+        transports.back().connect().get();
+    }
+
+    // creates the group topic and waits for the group to be loaded
+    kafka::find_coordinator_request coordinator_req("g");
+    transports[0].dispatch(coordinator_req, kafka::api_version(1)).get();
+    tests::cooperative_spin_wait_with_timeout(10s, [&transports] {
+        return commit_offset(transports[0], model::offset(10))
+          .then([](kafka::error_code ec) {
+              return ec == kafka::error_code::none;
+          });
+    }).get();
+
+    auto group_ntp = model::ntp(
+      model::kafka_internal_namespace,
+      model::kafka_group_topic,
+      model::partition_id(0));
+    auto partition = f.app.partition_manager.local().get(group_ntp);
+    BOOST_REQUIRE(partition);
+    auto dirty_offset = partition->dirty_offset();
+
+    std::vector<kafka::error_code> errors(clients);
+    ss::parallel_for_each(
+      boost::irange(0, clients),
+      [&transports, &errors, first_offset](int i) {
+          return commit_offset(
+                   transports[i], first_offset + model::offset(i))
+            .then([&errors, i](kafka::error_code ec) { errors[i] = ec; });
+      })
+      .get();
+
+    for (auto ec : errors) {
+        BOOST_REQUIRE_EQUAL(ec, kafka::error_code::none);
+    }
+
+    for (auto& t : transports) {
+        t.stop().then([&t] { t.shutdown(); }).get();
+    }
+    return (partition->dirty_offset() - dirty_offset)();
+}
+
+} // namespace
+
+FIXTURE_TEST(offset_commit_coalesces_in_flight, redpanda_thread_fixture) {
+    wait_for_controller_leadership().get();
+
+    // without a coalescing window the first commit is replicated right away
+    // and the commits arriving while it is in flight are merged into a
+    // single follow up batch
+    const int clients = 10;
+    auto appended = commit_concurrently(*this, clients, model::offset(100));
+    BOOST_REQUIRE_GT(appended, 0);
+    BOOST_REQUIRE_LT(appended, clients);
+}
+
+FIXTURE_TEST(offset_commit_coalesces_within_window, redpanda_thread_fixture) {
+    wait_for_controller_leadership().get();
+
+    ss::smp::invoke_on_all([] {
+        config::shard_local_cfg()
+          .get("group_offset_commit_coalesce_ms")
+          .set_value(std::chrono::milliseconds(1000));
+    }).get();
+    auto reset = ss::defer([] {
+        ss::smp::invoke_on_all([] {
+            config::shard_local_cfg()
+              .get("group_offset_commit_coalesce_ms")
+              .set_value(std::chrono::milliseconds(0));
+        }).get();
+    });
+
+    // all commits of the same partition arriving within the window are
+    // appended as a single record
+    auto appended = commit_concurrently(*this, 5, model::offset(100));
+    BOOST_REQUIRE_EQUAL(appended, 1);
+}
@@ -0,0 +1,132 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "raft/append_entries_coalescer.h"
+
+#include "config/configuration.h"
+#include "raft/errc.h"
+#include "raft/raftgen_service.h"
+#include "rpc/transport.h"
+
+namespace raft {
+
+append_entries_coalescer::append_entries_coalescer(
+  model::node_id self,
+  model::node_id target,
+  ss::sharded<rpc::connection_cache>& cache)
+  : _self(self)
+  , _target(target)
+  , _connection_cache(cache)
+  , _window(
+      config::shard_local_cfg().raft_append_entries_coalescing_window_us())
+  , _max_requests(std::max<size_t>(
+      config::shard_local_cfg().raft_append_entries_coalescing_max_requests(),
+      1)) {
+    _flush_timer.set_callback([this] { flush(); });
+}
+
+append_entries_coalescer::~append_entries_coalescer() noexcept {
+    _flush_timer.cancel();
+    for (auto& p : _replies) {
+        p.set_value(reply_t(make_error_code(errc::shutting_down)));
+    }
+}
+
+ss::future<append_entries_coalescer::reply_t>
+append_entries_coalescer::append_entries(
+  append_entries_request&& r, rpc::client_opts opts) {
+    if (_requests.empty() || opts.timeout < _timeout) {
+        _timeout = opts.timeout;
+    }
+    _requests.push_back(std::move(r));
+    auto f = _replies.emplace_back().get_future();
+
+    if (_requests.size() >= _max_requests) {
+        _flush_timer.cancel();
+        flush();
+    } else if (!_flush_timer.armed()) {
+        _flush_timer.arm(_window);
+    }
+    return f;
+}
+
+void append_entries_coalescer::flush() {
+    if (_requests.empty()) {
+        return;
+    }
+    // nothing to coalesce with, send a plain append entries request
+    if (_requests.size() == 1) {
+        dispatch_single();
+    } else {
+        dispatch_batch();
+    }
+    _requests.clear();
+    _replies.clear();
+}
+
+void append_entries_coalescer::dispatch_single() {
+    (void)_connection_cache.local()
+      .with_node_client<raftgen_client_protocol>(
+        _self,
+        ss::this_shard_id(),
+        _target,
+        _timeout,
+        [r = std::move(_requests.front()),
+         timeout = _timeout](raftgen_client_protocol client) mutable {
+            return client
+              .append_entries(std::move(r), rpc::client_opts(timeout))
+              .then(&rpc::get_ctx_data<append_entries_reply>);
+        })
+      .then_wrapped([p = std::move(_replies.front())](
+                      ss::future<reply_t> f) mutable {
+          f.forward_to(std::move(p));
+      });
+}
+
+void append_entries_coalescer::dispatch_batch() {
+    using batch_reply_t = result<append_entries_batch_reply>;
+    (void)_connection_cache.local()
+      .with_node_client<raftgen_client_protocol>(
+        _self,
+        ss::this_shard_id(),
+        _target,
+        _timeout,
+        [r = append_entries_batch_request{std::move(_requests)},
+         timeout = _timeout](raftgen_client_protocol client) mutable {
+            return client
+              .append_entries_batch(std::move(r), rpc::client_opts(timeout))
+              .then(&rpc::get_ctx_data<append_entries_batch_reply>);
+        })
+      .then_wrapped([replies = std::move(_replies)](
+                      ss::future<batch_reply_t> f) mutable {
+          if (f.failed()) {
+              auto e = f.get_exception();
+              for (auto& p : replies) {
+                  p.set_exception(e);
+              }
+              return;
+          }
+          auto r = f.get0();
+          if (r && r.value().replies.size() != replies.size()) {
+              r = batch_reply_t(
+                make_error_code(errc::append_entries_dispatch_error));
+          }
+          if (!r) {
+              for (auto& p : replies) {
+                  p.set_value(reply_t(r.error()));
+              }
+              return;
+          }
+          for (size_t i = 0; i < replies.size(); ++i) {
+              replies[i].set_value(std::move(r.value().replies[i]));
+          }
+      });
+}
+
+} // namespace raft
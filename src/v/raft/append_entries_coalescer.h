@@ -0,0 +1,74 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "model/metadata.h"
+#include "outcome.h"
+#include "raft/types.h"
+#include "rpc/connection_cache.h"
+#include "rpc/types.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/timer.hh>
+
+#include <chrono>
+#include <vector>
+
+namespace raft {
+
+/**
+ * Collects append entries requests of all the raft groups on a shard that are
+ * sent to the same node and sends them in a single append_entries_batch RPC.
+ *
+ * Requests are collected for a short window after the first one arrives, the
+ * RPC is sent when the window expires or when the max number of requests is
+ * reached. The batch RPC timeout is the earliest timeout of its requests. A
+ * failure of the batch RPC fails all of its requests.
+ */
+class append_entries_coalescer {
+public:
+    using reply_t = result<append_entries_reply>;
+
+    append_entries_coalescer(
+      model::node_id self,
+      model::node_id target,
+      ss::sharded<rpc::connection_cache>&);
+
+    append_entries_coalescer(const append_entries_coalescer&) = delete;
+    append_entries_coalescer& operator=(const append_entries_coalescer&)
+      = delete;
+    append_entries_coalescer(append_entries_coalescer&&) = delete;
+    append_entries_coalescer& operator=(append_entries_coalescer&&) = delete;
+    ~append_entries_coalescer() noexcept;
+
+    ss::future<reply_t>
+    append_entries(append_entries_request&&, rpc::client_opts);
+
+private:
+    void flush();
+    void dispatch_single();
+    void dispatch_batch();
+
+    model::node_id _self;
+    model::node_id _target;
+    ss::sharded<rpc::connection_cache>& _connection_cache;
+    std::chrono::microseconds _window;
+    size_t _max_requests;
+
+    std::vector<append_entries_request> _requests;
+    std::vector<ss::promise<reply_t>> _replies;
+    rpc::clock_type::time_point _timeout;
+    ss::timer<> _flush_timer;
+};
+
+} // namespace raft
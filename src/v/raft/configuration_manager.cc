@@ -174,6 +174,17 @@ configuration_manager::get_latest_index() const {
       "Configuration manager should always have at least one configuration");
     return _configurations.rbegin()->second.idx;
 }
+int64_t configuration_manager::offset_delta(model::offset offset) const {
+    auto it = _configurations.lower_bound(offset);
+    if (it == _configurations.begin()) {
+        // configurations before the offset were prefix truncated
+        return it == _configurations.end()
+                 ? 0
+                 : std::max<int64_t>(it->second.idx() - 1, 0);
+    }
+    return std::prev(it)->second.idx();
+}
+
 std::optional<group_configuration>
 configuration_manager::get(model::offset offset) const {
     auto it = _configurations.lower_bound(offset);
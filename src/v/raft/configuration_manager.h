@@ -155,6 +155,14 @@ public:
      */
     ss::future<> remove_persistent_state();
 
+    /**
+     * Number of configuration batches in the log before given offset, it is
+     * the difference between a log offset and the corresponding kafka offset.
+     * The configurations removed by prefix truncation are still accounted for
+     * by the indexes of the ones that remain.
+     */
+    int64_t offset_delta(model::offset) const;
+
     const_iterator begin() const { return _configurations.begin(); }
     const_iterator end() const { return _configurations.end(); }
     const_iterator lower_bound(model::offset o) const {
@@ -9,21 +9,25 @@
 
 #include "raft/consensus.h"
 
+#include "bytes/utils.h"
 #include "config/configuration.h"
 #include "likely.h"
 #include "model/metadata.h"
+#include "model/namespace.h"
 #include "prometheus/prometheus_sanitize.h"
 #include "raft/consensus_client_protocol.h"
 #include "raft/consensus_utils.h"
 #include "raft/errc.h"
 #include "raft/group_configuration.h"
 #include "raft/logger.h"
+#include "raft/node_liveness.h"
 #include "raft/prevote_stm.h"
 #include "raft/recovery_stm.h"
 #include "raft/rpc_client_protocol.h"
 #include "raft/types.h"
 #include "raft/vote_stm.h"
 #include "reflection/adl.h"
+#include "resource_mgmt/io_priority.h"
 #include "storage/api.h"
 #include "vlog.h"
 
@@ -64,6 +68,17 @@ consensus::consensus(
       config::shard_local_cfg().replicate_append_timeout_ms())
   , _recovery_append_timeout(
       config::shard_local_cfg().recovery_append_timeout_ms())
+  , _max_inflight_requests(std::max<size_t>(
+      config::shard_local_cfg().raft_max_inflight_append_entries_requests(),
+      1))
+  , _max_inflight_bytes(std::max<size_t>(
+      config::shard_local_cfg().raft_max_inflight_append_entries_bytes(), 1))
+  , _quiescence_enabled(config::shard_local_cfg().raft_enable_quiescence())
+  , _leader_lease_enabled(config::shard_local_cfg().raft_enable_leader_lease())
+  , _leader_lease_duration(std::max<clock_type::duration>(
+      _jit.base_duration()
+        - config::shard_local_cfg().raft_leader_lease_clock_drift_ms(),
+      clock_type::duration::zero()))
   , _storage(storage)
   , _snapshot_mgr(
       std::filesystem::path(_log.config().work_directory()),
@@ -141,6 +156,8 @@ void consensus::shutdown_input() {
         _as.request_abort();
         _commit_index_updated.broken();
         _disk_append.broken();
+        _append_window_released.broken();
+        _consumable_offset_monitor.stop();
     }
 }
 
@@ -272,6 +289,9 @@ consensus::success_reply consensus::update_follower_index(
         return success_reply::no;
     }
 
+    // follower recognized this node as the leader of the current term
+    update_leader_lease(idx, seq);
+
     // If recovery is in progress the recovery STM will handle follower index
     // updates
     if (!idx.is_recovering) {
@@ -414,8 +434,13 @@ void consensus::dispatch_recovery(follower_index_metadata& idx) {
     idx.is_recovering = true;
     // background
     (void)with_gate(_bg, [this, node_id = idx.node_id] {
-        auto recovery = std::make_unique<recovery_stm>(
-          this, node_id, _io_priority);
+        // recovery reads are long sequential reads of historical data, they
+        // are scheduled separately from the reads and writes of the raft
+        // protocol itself. controller recovery keeps the controller priority,
+        // it must not queue behind the recovery of data partitions
+        auto prio = ntp() == model::controller_ntp ? _io_priority
+                                                   : raft_recovery_priority();
+        auto recovery = std::make_unique<recovery_stm>(this, node_id, prio);
         auto ptr = recovery.get();
         return ptr->apply()
           .handle_exception([this, node_id](const std::exception_ptr& e) {
@@ -439,6 +464,10 @@ ss::future<result<model::offset>> consensus::linearizable_barrier() {
     if (_vstate != vote_state::leader) {
         co_return result<model::offset>(make_error_code(errc::not_leader));
     }
+    if (has_valid_leader_lease()) {
+        _probe.leader_lease_read();
+        co_return ret_t(_commit_index);
+    }
     // store current commit index
     auto cfg = config();
     auto dirty_offset = _log.offsets().dirty_offset;
@@ -685,7 +714,7 @@ bool consensus::should_skip_vote(bool ignore_heartbeat) {
 
     if (likely(!ignore_heartbeat)) {
         auto last_election = clock_type::now() - _jit.base_duration();
-        skip_vote |= (_hbeat > last_election); // nothing to do.
+        skip_vote |= is_leader_alive(last_election); // nothing to do.
     }
 
     skip_vote |= _vstate == vote_state::leader; // already a leader
@@ -963,6 +992,12 @@ ss::future<> consensus::start() {
               // set last heartbeat timestamp to prevent skipping first
               // election
               _hbeat = clock_type::time_point::min();
+              // the leader may still hold a lease acknowledged by this node
+              // before it restarted
+              if (_leader_lease_enabled) {
+                  _vote_blocked_until = clock_type::now()
+                                        + _jit.base_duration();
+              }
               auto conf = _configuration_manager.get_latest().brokers();
               if (!conf.empty() && _self.id() == conf.begin()->id()) {
                   // for single node scenarios arm immediate election,
@@ -1197,6 +1232,12 @@ ss::future<vote_reply> consensus::do_vote(vote_request&& r) {
         reply.granted = false;
         return ss::make_ready_future<vote_reply>(reply);
     }
+    // the leader asking for a vote in a later term no longer leads the group,
+    // e.g. its node restarted. the node liveness kept fresh by the other
+    // groups it leads must not keep this group leaderless
+    if (_leader_id && r.node_id == *_leader_id && r.term > _term) {
+        _caught_up_with_leader = false;
+    }
     /// Stable leadership optimization
     ///
     /// When current node is a leader (we set _hbeat to max after
@@ -1206,10 +1247,22 @@ ss::future<vote_reply> consensus::do_vote(vote_request&& r) {
     // Check if we updated the heartbeat timepoint in the last election
     // timeout duration When the vote was requested because of leadership
     // transfer grant the vote immediately.
-    auto prev_election = clock_type::now() - _jit.base_duration();
+    //
+    // The vote we already granted may be requested again. With leader leases
+    // only a retry in the same term bypasses the check, the vote we granted
+    // in an earlier term says nothing about the leaders whose lease this node
+    // acknowledged since.
+    //
+    // With leader leases the vote is also withheld until _vote_blocked_until,
+    // the lease the leader holds may include an acknowledgement this node
+    // does not remember.
+    const auto now = clock_type::now();
+    auto prev_election = now - _jit.base_duration();
+    const bool vote_retry = r.node_id == _voted_for
+                            && (!_leader_lease_enabled || r.term == _term);
     if (
-      _hbeat > prev_election && !r.leadership_transfer
-      && r.node_id != _voted_for) {
+      (is_leader_alive(prev_election) || now < _vote_blocked_until)
+      && !r.leadership_transfer && !vote_retry) {
         vlog(
           _ctxlog.trace,
           "Already heard from the leader, not granting vote to node {}",
@@ -1238,6 +1291,9 @@ ss::future<vote_reply> consensus::do_vote(vote_request&& r) {
             // would cause subsequent votes to fail (_hbeat is updated by the
             // leader)
             _hbeat = clock_type::time_point::min();
+            if (_leader_lease_enabled) {
+                _vote_blocked_until = clock_type::now() + _jit.base_duration();
+            }
             return ss::make_ready_future<vote_reply>(reply);
         }
     }
@@ -1262,6 +1318,7 @@ ss::future<vote_reply> consensus::do_vote(vote_request&& r) {
               } else {
                   _voted_for = r.node_id;
                   _hbeat = clock_type::now();
+                  _caught_up_with_leader = false;
                   granted = true;
               }
 
@@ -1273,6 +1330,7 @@ ss::future<vote_reply> consensus::do_vote(vote_request&& r) {
         reply.granted = (r.node_id == _voted_for);
         if (reply.granted) {
             _hbeat = clock_type::now();
+            _caught_up_with_leader = false;
         }
         return ss::make_ready_future<vote_reply>(std::move(reply));
     }
@@ -1331,6 +1389,7 @@ consensus::do_append_entries(append_entries_request&& r) {
     // raft.pdf:If AppendEntries RPC received from new leader: convert to
     // follower (§5.2)
     _vstate = vote_state::follower;
+    _caught_up_with_leader = false;
     if (unlikely(_leader_id != r.node_id)) {
         _leader_id = r.node_id;
         _follower_reply.broadcast();
@@ -1398,7 +1457,10 @@ consensus::do_append_entries(append_entries_request&& r) {
         maybe_update_last_visible_index(last_visible);
         return maybe_update_follower_commit_idx(
                  model::offset(r.meta.commit_index))
-          .then([reply = std::move(reply)]() mutable {
+          .then([this, m = r.meta, reply = std::move(reply)]() mutable {
+              _caught_up_with_leader
+                = m.commit_index == _commit_index
+                  && m.prev_log_index == _log.offsets().dirty_offset;
               reply.result = append_entries_reply::status::success;
               return ss::make_ready_future<append_entries_reply>(
                 std::move(reply));
@@ -1562,14 +1624,13 @@ consensus::do_install_snapshot(install_snapshot_request&& r) {
     vlog(_ctxlog.trace, "Install snapshot request: {}", r);
 
     install_snapshot_reply reply{
-      .term = _term, .bytes_stored = r.chunk.size_bytes(), .success = false};
+      .term = _term, .bytes_stored = 0, .success = false};
     reply.target_node_id = r.node_id;
 
     if (unlikely(is_request_target_node_invalid("install_snapshot", r))) {
         return ss::make_ready_future<install_snapshot_reply>(reply);
     }
 
-    bool is_done = r.done;
     // Raft paper: Reply immediately if term < currentTerm (§7.1)
     if (r.term < _term) {
         return ss::make_ready_future<install_snapshot_reply>(reply);
@@ -1586,6 +1647,30 @@ consensus::do_install_snapshot(install_snapshot_request&& r) {
         return do_install_snapshot(std::move(r));
     }
 
+    if (!r.chunk_crc) {
+        // leader does not support resumable transfers
+        return append_snapshot_chunk(std::move(r), reply);
+    }
+
+    const bool resumable = _snapshot_writer.has_value()
+                           && r.last_included_index == _received_snapshot_index;
+    if (resumable) {
+        reply.bytes_stored = _received_snapshot_bytes;
+    }
+
+    crc::crc32c crc;
+    crc_extend_iobuf(crc, r.chunk);
+    if (crc.value() != *r.chunk_crc) {
+        // leader resumes the transfer from the bytes we already stored
+        vlog(
+          _ctxlog.warn,
+          "Snapshot chunk at offset {} crc mismatch, expected: {}, got: {}",
+          r.file_offset,
+          *r.chunk_crc,
+          crc.value());
+        return ss::make_ready_future<install_snapshot_reply>(reply);
+    }
+
     auto f = ss::now();
     // Create new snapshot file if first chunk (offset is 0) (§7.2)
     if (r.file_offset == 0) {
@@ -1594,48 +1679,151 @@ consensus::do_install_snapshot(install_snapshot_request&& r) {
             f = _snapshot_writer->close().then(
               [this] { return _snapshot_mgr.remove_partial_snapshots(); });
         }
-        f = f.then([this] {
+        f = f.then([this, index = r.last_included_index] {
+            reset_received_snapshot();
             return _snapshot_mgr.start_snapshot().then(
-              [this](storage::snapshot_writer w) {
+              [this, index](storage::snapshot_writer w) {
                   _snapshot_writer.emplace(std::move(w));
+                  _received_snapshot_index = index;
               });
         });
+    } else if (!resumable) {
+        // chunk of a transfer we know nothing about (i.e. we were restarted),
+        // leader has to start over from the first chunk
+        return ss::make_ready_future<install_snapshot_reply>(reply);
     }
 
     // Write data into snapshot file at given offset (§7.3)
+    auto index = r.last_included_index;
+    f = f.then([this, r = std::move(r)]() mutable {
+        return store_snapshot_chunk(std::move(r));
+    });
+
+    return f.then([this, index, reply]() mutable {
+        reply.bytes_stored = _received_snapshot_bytes;
+        reply.success = true;
+        // Reply and wait for more data chunks if not all of them were
+        // received (§7.4)
+        if (
+          !_received_snapshot_size
+          || *_received_snapshot_size != _received_snapshot_bytes) {
+            return ss::make_ready_future<install_snapshot_reply>(reply);
+        }
+        // Last chunk, finish storing snapshot
+        return finish_snapshot(index, reply);
+    });
+}
+
+ss::future<install_snapshot_reply> consensus::append_snapshot_chunk(
+  install_snapshot_request r, install_snapshot_reply reply) {
+    // the leader sends a single chunk at a time and expects the size of the
+    // chunk in the reply
+    reply.bytes_stored = r.chunk.size_bytes();
+    auto f = ss::now();
+    // Create new snapshot file if first chunk (offset is 0) (§7.2)
+    if (r.file_offset == 0) {
+        // discard old chunks, previous snaphost wasn't finished
+        if (_snapshot_writer) {
+            f = _snapshot_writer->close().then(
+              [this] { return _snapshot_mgr.remove_partial_snapshots(); });
+        }
+        f = f.then([this, index = r.last_included_index] {
+            reset_received_snapshot();
+            return _snapshot_mgr.start_snapshot().then(
+              [this, index](storage::snapshot_writer w) {
+                  _snapshot_writer.emplace(std::move(w));
+                  _received_snapshot_index = index;
+              });
+        });
+    } else if (!_snapshot_writer) {
+        // chunk of a transfer we know nothing about (i.e. we were restarted)
+        return ss::make_ready_future<install_snapshot_reply>(reply);
+    }
+
+    // Write data into snapshot file at given offset (§7.3)
+    const bool done = r.done;
+    auto index = r.last_included_index;
     f = f.then([this, chunk = std::move(r.chunk)]() mutable {
+        _received_snapshot_bytes += chunk.size_bytes();
         return write_iobuf_to_output_stream(
           std::move(chunk), _snapshot_writer->output());
     });
 
     // Reply and wait for more data chunks if done is false (§7.4)
-    if (!is_done) {
+    if (!done) {
         return f.then([reply]() mutable {
             reply.success = true;
             return reply;
         });
     }
     // Last chunk, finish storing snapshot
-    return f.then([this, r = std::move(r), reply]() mutable {
-        return finish_snapshot(std::move(r), reply);
+    return f.then([this, index, reply]() mutable {
+        return finish_snapshot(index, reply);
     });
 }
 
+ss::future<> consensus::store_snapshot_chunk(install_snapshot_request r) {
+    if (r.done) {
+        _received_snapshot_size = r.file_offset + r.chunk.size_bytes();
+    }
+    // several chunks are in flight, they may be reordered or retransmitted
+    // after the leader resumed the transfer
+    if (r.file_offset < _received_snapshot_bytes) {
+        return ss::now();
+    }
+    if (r.file_offset > _received_snapshot_bytes) {
+        _pending_snapshot_chunks.insert_or_assign(
+          r.file_offset, std::move(r.chunk));
+        return ss::now();
+    }
+    _received_snapshot_bytes += r.chunk.size_bytes();
+    return write_iobuf_to_output_stream(
+             std::move(r.chunk), _snapshot_writer->output())
+      .then([this] {
+          return ss::do_until(
+            [this] {
+                return _pending_snapshot_chunks.empty()
+                       || _pending_snapshot_chunks.begin()->first
+                            > _received_snapshot_bytes;
+            },
+            [this] {
+                auto it = _pending_snapshot_chunks.begin();
+                auto chunk = std::move(it->second);
+                auto offset = it->first;
+                _pending_snapshot_chunks.erase(it);
+                if (offset < _received_snapshot_bytes) {
+                    return ss::now();
+                }
+                _received_snapshot_bytes += chunk.size_bytes();
+                return write_iobuf_to_output_stream(
+                  std::move(chunk), _snapshot_writer->output());
+            });
+      });
+}
+
+void consensus::reset_received_snapshot() {
+    _received_snapshot_index = model::offset{};
+    _received_snapshot_bytes = 0;
+    _received_snapshot_size.reset();
+    _pending_snapshot_chunks.clear();
+}
+
 ss::future<install_snapshot_reply> consensus::finish_snapshot(
-  install_snapshot_request r, install_snapshot_reply reply) {
+  model::offset last_included_index, install_snapshot_reply reply) {
     if (!_snapshot_writer) {
         reply.bytes_stored = 0;
         return ss::make_ready_future<install_snapshot_reply>(reply);
     }
 
     auto f = _snapshot_writer->close();
+    reset_received_snapshot();
     // discard any existing or partial snapshot with a smaller index (§7.5)
-    if (r.last_included_index < _last_snapshot_index) {
+    if (last_included_index < _last_snapshot_index) {
         vlog(
           _ctxlog.warn,
           "Stale snapshot with last index {} received. Previously "
           "received snapshot last included index {}",
-          r.last_included_index,
+          last_included_index,
           _last_snapshot_index);
 
         return f
@@ -1867,12 +2055,50 @@ void consensus::update_node_hbeat_timestamp(vnode id) {
 
 follower_req_seq consensus::next_follower_sequence(vnode id) {
     if (auto it = _fstats.find(id); it != _fstats.end()) {
-        return it->second.last_sent_seq++;
+        auto& f = it->second;
+        if (_leader_lease_enabled && !f.lease_probe_seq) {
+            f.lease_probe_seq = f.last_sent_seq;
+            f.lease_probe_timestamp = clock_type::now();
+        }
+        return f.last_sent_seq++;
     }
 
     return follower_req_seq{};
 }
 
+bool consensus::has_append_window(vnode id) const {
+    if (auto it = _fstats.find(id); it != _fstats.end()) {
+        // always allow a single request, even if it exceeds the bytes limit
+        return it->second.inflight_requests == 0
+               || (it->second.inflight_requests < _max_inflight_requests
+                   && it->second.inflight_bytes < _max_inflight_bytes);
+    }
+    return true;
+}
+
+void consensus::acquire_append_window(vnode id, size_t bytes) {
+    if (auto it = _fstats.find(id); it != _fstats.end()) {
+        ++it->second.inflight_requests;
+        it->second.inflight_bytes += bytes;
+    }
+}
+
+void consensus::release_append_window(vnode id, size_t bytes) {
+    if (auto it = _fstats.find(id); it != _fstats.end()) {
+        auto& meta = it->second;
+        // follower stats may be recreated while request is in flight
+        meta.inflight_requests -= std::min<size_t>(
+          meta.inflight_requests, 1);
+        meta.inflight_bytes -= std::min(meta.inflight_bytes, bytes);
+    }
+    _append_window_released.broadcast();
+}
+
+ss::future<> consensus::wait_for_append_window(vnode id) {
+    return _append_window_released.wait(
+      [this, id] { return has_append_window(id); });
+}
+
 absl::flat_hash_map<vnode, follower_req_seq>
 consensus::next_followers_request_seq() {
     absl::flat_hash_map<vnode, follower_req_seq> ret;
@@ -2024,6 +2250,8 @@ consensus::maybe_update_follower_commit_idx(model::offset request_commit_idx) {
 void consensus::update_follower_stats(const group_configuration& cfg) {
     vlog(_ctxlog.trace, "Updating follower stats with config {}", cfg);
     _fstats.update_with_configuration(cfg);
+    // wake up dispatchers waiting for the window of a removed follower
+    _append_window_released.broadcast();
 }
 
 void consensus::trigger_leadership_notification() {
@@ -2312,7 +2540,13 @@ consensus::transfer_leadership(std::optional<model::node_id> target) {
         });
     });
 
-    return f.finally([this] { _transferring_leadership = false; });
+    return f.finally([this] {
+        _transferring_leadership = false;
+        // the transfer target may still win an election as its vote requests
+        // bypass the stable leadership check, the lease can not be trusted
+        // until they time out
+        _leader_lease_blocked_until = clock_type::now() + _jit.base_duration();
+    });
 }
 
 ss::future<> consensus::remove_persistent_state() {
@@ -2371,6 +2605,96 @@ void consensus::update_suppress_heartbeats(
     }
 }
 
+bool consensus::update_idle_intervals(size_t quiesce_after) {
+    auto m = meta();
+    if (
+      m.term != _idle_meta.term || m.commit_index != _idle_meta.commit_index
+      || m.prev_log_index != _idle_meta.prev_log_index
+      || m.last_visible_index != _idle_meta.last_visible_index) {
+        _idle_meta = m;
+        _idle_intervals = 0;
+        return false;
+    }
+    ++_idle_intervals;
+    return _idle_intervals >= quiesce_after;
+}
+
+bool consensus::try_quiesce_follower(vnode id) {
+    auto it = _fstats.find(id);
+    if (it == _fstats.end()) {
+        return false;
+    }
+    auto& f = it->second;
+    const auto dirty = _log.offsets().dirty_offset;
+    if (
+      f.is_recovering || f.match_index != dirty
+      || f.last_dirty_log_index != dirty
+      || f.last_committed_log_index < _commit_index) {
+        return false;
+    }
+    // follower is up to date, its liveness is tracked per node
+    f.last_hbeat_timestamp = std::max(
+      f.last_hbeat_timestamp,
+      shard_local_node_liveness().last_heartbeat(id.id()));
+    return true;
+}
+
+void consensus::update_leader_lease(
+  follower_index_metadata& f, follower_req_seq seq) {
+    if (f.lease_probe_seq && seq >= *f.lease_probe_seq) {
+        f.lease_ack_timestamp = std::max(
+          f.lease_ack_timestamp, f.lease_probe_timestamp);
+        f.lease_probe_seq.reset();
+    }
+}
+
+/**
+ * Followers do not grant votes for an election timeout after they heard from
+ * the leader (see stable leadership optimization in do_vote). When the
+ * majority of voters replied to requests sent within the last election timeout
+ * no other leader can be elected. The lease duration is the election timeout
+ * shortened by the bound of the clock drift between the nodes.
+ */
+bool consensus::has_valid_leader_lease() const {
+    if (
+      !_leader_lease_enabled
+      || _leader_lease_duration == clock_type::duration::zero()
+      || _transferring_leadership) {
+        return false;
+    }
+    const auto now = clock_type::now();
+    if (now < _leader_lease_blocked_until) {
+        return false;
+    }
+    // replies to requests sent before this node became the leader do not
+    // count, they might have been sent in a previous term
+    const auto since = std::max(
+      now - _leader_lease_duration, _became_leader_at);
+    return config().majority([this, since](vnode id) {
+        if (id == _self) {
+            return true;
+        }
+        auto it = _fstats.find(id);
+        return it != _fstats.end() && it->second.lease_ack_timestamp > since;
+    });
+}
+
+bool consensus::is_leader_alive(clock_type::time_point since) const {
+    if (_hbeat > since) {
+        return true;
+    }
+    if (!_quiescence_enabled || !_caught_up_with_leader || !_leader_id) {
+        return false;
+    }
+    // leader might have been removed from the configuration, the group must
+    // be able to elect a new one
+    if (!_configuration_manager.get_latest().is_voter(*_leader_id)) {
+        return false;
+    }
+    return shard_local_node_liveness().last_heartbeat(_leader_id->id())
+           > since;
+}
+
 voter_priority consensus::next_target_priority() {
     return voter_priority(std::max<voter_priority::type>(
       (_target_priority / 5) * 4, min_voter_priority));
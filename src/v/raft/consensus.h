@@ -38,6 +38,8 @@
 #include <seastar/core/sharded.hh>
 #include <seastar/util/bool_class.hh>
 
+#include <absl/container/btree_map.h>
+
 #include <optional>
 
 namespace raft {
@@ -130,9 +132,16 @@ public:
      * to returned offsets are linearizable. (i.e. majority of followers have
      * updated their commit indices to at least reaturned offset). For more
      * details see paragraph 6.4 of Raft protocol dissertation.
+     *
+     * With leader leases enabled a leader holding a valid lease answers the
+     * barrier locally without a round of heartbeats (paragraph 6.4.1).
      */
     ss::future<result<model::offset>> linearizable_barrier();
 
+    /// true if the majority of voters recognized this node as the leader
+    /// recently enough for no other leader to be elected
+    bool has_valid_leader_lease() const;
+
     vnode self() const { return _self; }
     protocol_metadata meta() const {
         auto lstats = _log.offsets();
@@ -206,6 +215,16 @@ public:
       storage::log_reader_config,
       std::optional<clock_type::time_point> = std::nullopt);
 
+    /**
+     * Resolves when the last visible index reaches the offset. The wait fails
+     * with offset_monitor::wait_aborted when the abort is requested or the
+     * consensus instance is stopped.
+     */
+    ss::future<>
+    wait_for_visible_offset(model::offset o, ss::abort_source& as) {
+        return _consumable_offset_monitor.wait(o, model::no_timeout, as);
+    }
+
     model::offset get_latest_configuration_offset() const;
     model::offset committed_offset() const { return _commit_index; }
 
@@ -300,6 +319,17 @@ public:
     void update_suppress_heartbeats(
       vnode, follower_req_seq, heartbeats_suppressed);
 
+    /**
+     * Raft group quiescence. Heartbeat manager calls `update_idle_intervals`
+     * every heartbeat interval, when the group state (term, commit index, log
+     * end and visibility) didn't change for a given number of intervals
+     * heartbeats are not sent to the followers which are up to date. Quiesced
+     * followers are kept alive by node level heartbeats (see node_liveness).
+     * Any change of the group state or an election wakes the group up.
+     */
+    bool update_idle_intervals(size_t quiesce_after);
+    bool try_quiesce_follower(vnode);
+
     std::vector<follower_metrics> get_follower_metrics() const;
 
     const configuration_manager& get_configuration_manager() const {
@@ -335,7 +365,19 @@ private:
      */
     ss::future<> truncate_to_latest_snapshot();
     ss::future<install_snapshot_reply>
-      finish_snapshot(install_snapshot_request, install_snapshot_reply);
+      finish_snapshot(model::offset, install_snapshot_reply);
+    /**
+     * Writes chunk into the snapshot being received, chunks received ahead of
+     * the ones that are still missing are buffered
+     */
+    ss::future<> store_snapshot_chunk(install_snapshot_request);
+    /**
+     * Appends chunk sent by a leader which does not support resumable
+     * transfers, chunks are written in the order they arrive
+     */
+    ss::future<install_snapshot_reply>
+      append_snapshot_chunk(install_snapshot_request, install_snapshot_reply);
+    void reset_received_snapshot();
 
     ss::future<> do_write_snapshot(model::offset, iobuf&&);
     append_entries_reply
@@ -380,6 +422,10 @@ private:
     void dispatch_vote(bool leadership_transfer);
     ss::future<bool> dispatch_prevote(bool leadership_transfer);
     bool should_skip_vote(bool ignore_heartbeat);
+    /// true if we heard from the leader after the given time point, either
+    /// directly or through node liveness when the group is quiesced
+    bool is_leader_alive(clock_type::time_point) const;
+    void update_leader_lease(follower_index_metadata&, follower_req_seq);
 
     /// Replicates configuration to other nodes,
     //  caller have to pass in _op_sem semaphore units
@@ -405,6 +451,15 @@ private:
 
     absl::flat_hash_map<vnode, follower_req_seq> next_followers_request_seq();
 
+    /// Append entries requests are pipelined up to the per follower window,
+    /// the window is acquired before dispatching a request and released when
+    /// the reply (or error) is received.
+    bool has_append_window(vnode) const;
+    void acquire_append_window(vnode, size_t);
+    void release_append_window(vnode, size_t);
+    /// resolves when follower has free window space or it was removed
+    ss::future<> wait_for_append_window(vnode);
+
     void setup_metrics();
 
     bytes voted_for_key() const {
@@ -529,11 +584,36 @@ private:
 
     std::chrono::milliseconds _replicate_append_timeout;
     std::chrono::milliseconds _recovery_append_timeout;
+    size_t _max_inflight_requests;
+    size_t _max_inflight_bytes;
+    bool _quiescence_enabled;
+    // leader lease, a leader that was recognized by the majority of voters
+    // within the lease duration does not need a round trip to serve
+    // linearizable reads
+    bool _leader_lease_enabled;
+    clock_type::duration _leader_lease_duration;
+    clock_type::time_point _leader_lease_blocked_until
+      = clock_type::time_point::min();
+    // follower side, with leases the vote is withheld for an election timeout
+    // whenever this node may have forgotten that it heard from the leader
+    // (after start and after resetting _hbeat on a higher term vote request)
+    clock_type::time_point _vote_blocked_until = clock_type::time_point::min();
+    // leader side group quiescence tracking
+    protocol_metadata _idle_meta;
+    size_t _idle_intervals = 0;
+    // follower side, set when the last heartbeat from the leader found the
+    // follower up to date, only such follower may be quiesced by the leader
+    bool _caught_up_with_leader = false;
     ss::metrics::metric_groups _metrics;
     ss::abort_source _as;
     storage::api& _storage;
     storage::snapshot_manager _snapshot_mgr;
     std::optional<storage::snapshot_writer> _snapshot_writer;
+    // follower side state of the snapshot being received
+    model::offset _received_snapshot_index;
+    uint64_t _received_snapshot_bytes = 0;
+    std::optional<uint64_t> _received_snapshot_size;
+    absl::btree_map<uint64_t, iobuf> _pending_snapshot_chunks;
     model::offset _last_snapshot_index;
     model::term_id _last_snapshot_term;
     configuration_manager _configuration_manager;
@@ -551,6 +631,7 @@ private:
     offset_monitor _consumable_offset_monitor;
     ss::condition_variable _disk_append;
     ss::condition_variable _follower_reply;
+    ss::condition_variable _append_window_released;
     append_entries_buffer _append_requests_buffer;
     friend std::ostream& operator<<(std::ostream&, const consensus&);
 };
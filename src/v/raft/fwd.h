@@ -14,5 +14,6 @@
 namespace raft {
 
 class consensus;
+class configuration_manager;
 
 } // namespace raft
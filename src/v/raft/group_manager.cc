@@ -109,7 +109,11 @@ void group_manager::setup_metrics() {
       {sm::make_gauge(
         "group_count",
         [this] { return _groups.size(); },
-        sm::description("Number of raft groups"))});
+        sm::description("Number of raft groups")),
+       sm::make_gauge(
+        "quiesced_group_count",
+        [this] { return _heartbeats.quiesced_groups(); },
+        sm::description("Number of raft groups with suppressed heartbeats"))});
 }
 
 } // namespace raft
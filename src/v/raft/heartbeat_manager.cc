@@ -16,6 +16,7 @@
 #include "raft/consensus_client_protocol.h"
 #include "raft/errc.h"
 #include "raft/group_configuration.h"
+#include "raft/node_liveness.h"
 #include "raft/raftgen_service.h"
 #include "raft/types.h"
 #include "rpc/reconnect_transport.h"
@@ -35,12 +36,39 @@ ss::logger hbeatlog{"r/heartbeat"};
 using consensus_ptr = heartbeat_manager::consensus_ptr;
 using consensus_set = heartbeat_manager::consensus_set;
 
+static void create_follower_request(
+  consensus_ptr ptr,
+  const vnode& rni,
+  absl::flat_hash_map<
+    model::node_id,
+    std::vector<std::pair<heartbeat_metadata, follower_req_seq>>>&
+    pending_beats) {
+    auto seq_id = ptr->next_follower_sequence(rni);
+    ptr->update_suppress_heartbeats(rni, seq_id, heartbeats_suppressed::yes);
+    pending_beats[rni.id()].emplace_back(
+      heartbeat_metadata{ptr->meta(), ptr->self(), rni}, seq_id);
+}
+
+/**
+ * When quiesce_after is greater than 0, groups that were idle for given number
+ * of heartbeat intervals are not included into the requests sent to up to date
+ * followers. Every node that hosts quiesced followers still receives a request
+ * (with a heartbeat of one of the quiesced groups if nothing else is pending)
+ * as it is used as node level liveness beat.
+ */
 static std::vector<heartbeat_manager::node_heartbeat> requests_for_range(
-  const consensus_set& c, clock_type::duration heartbeat_interval) {
+  const consensus_set& c,
+  clock_type::duration heartbeat_interval,
+  size_t quiesce_after,
+  size_t& quiesced_groups) {
     absl::flat_hash_map<
       model::node_id,
       std::vector<std::pair<heartbeat_metadata, follower_req_seq>>>
       pending_beats;
+    // one quiesced group per node, used when there are no other heartbeats
+    absl::flat_hash_map<model::node_id, std::pair<consensus_ptr, vnode>>
+      liveness_beats;
+    quiesced_groups = 0;
     if (c.empty()) {
         return {};
     }
@@ -49,10 +77,16 @@ static std::vector<heartbeat_manager::node_heartbeat> requests_for_range(
         if (!ptr->is_leader()) {
             continue;
         }
+        const bool idle = quiesce_after > 0
+                          && ptr->update_idle_intervals(quiesce_after);
+        bool quiesced = idle;
 
         auto maybe_create_follower_request = [ptr,
                                               last_heartbeat,
-                                              &pending_beats](
+                                              idle,
+                                              &quiesced,
+                                              &pending_beats,
+                                              &liveness_beats](
                                                const vnode& rni) mutable {
             // special case self beat
             // self beat is used to make sure that the protocol will make
@@ -63,6 +97,12 @@ static std::vector<heartbeat_manager::node_heartbeat> requests_for_range(
                 return;
             }
 
+            if (idle && ptr->try_quiesce_follower(rni)) {
+                liveness_beats.try_emplace(rni.id(), ptr, rni);
+                return;
+            }
+            quiesced = false;
+
             if (ptr->are_heartbeats_suppressed(rni)) {
                 return;
             }
@@ -81,16 +121,26 @@ static std::vector<heartbeat_manager::node_heartbeat> requests_for_range(
                 return;
             }
 
-            auto seq_id = ptr->next_follower_sequence(rni);
-            ptr->update_suppress_heartbeats(
-              rni, seq_id, heartbeats_suppressed::yes);
-            pending_beats[rni.id()].emplace_back(
-              heartbeat_metadata{ptr->meta(), ptr->self(), rni}, seq_id);
+            create_follower_request(ptr, rni, pending_beats);
         };
 
         auto group = ptr->config();
         // collect voters
         group.for_each_broker_id(maybe_create_follower_request);
+        if (quiesced) {
+            ++quiesced_groups;
+        }
+    }
+
+    for (auto& [node, beat] : liveness_beats) {
+        if (pending_beats.contains(node)) {
+            continue;
+        }
+        auto& [ptr, rni] = beat;
+        if (ptr->are_heartbeats_suppressed(rni)) {
+            continue;
+        }
+        create_follower_request(ptr, rni, pending_beats);
     }
 
     std::vector<heartbeat_manager::node_heartbeat> reqs;
@@ -124,6 +174,11 @@ heartbeat_manager::heartbeat_manager(
   duration_type heartbeat_timeout)
   : _heartbeat_interval(interval)
   , _heartbeat_timeout(heartbeat_timeout)
+  , _quiesce_after(
+      config::shard_local_cfg().raft_enable_quiescence()
+        ? std::max<size_t>(
+          config::shard_local_cfg().raft_quiescence_idle_intervals(), 1)
+        : 0)
   , _client_protocol(std::move(proto))
   , _self(self) {
     _heartbeat_timer.set_callback([this] { dispatch_heartbeats(); });
@@ -149,7 +204,11 @@ heartbeat_manager::send_heartbeats(std::vector<node_heartbeat> reqs) {
 }
 
 ss::future<> heartbeat_manager::do_dispatch_heartbeats() {
-    auto reqs = requests_for_range(_consensus_groups, _heartbeat_interval);
+    auto reqs = requests_for_range(
+      _consensus_groups,
+      _heartbeat_interval,
+      _quiesce_after,
+      _quiesced_groups);
     return send_heartbeats(std::move(reqs));
 }
 
@@ -225,6 +284,8 @@ void heartbeat_manager::process_reply(
         }
         return;
     }
+    // reply is a proof of node liveness for all the quiesced groups
+    shard_local_node_liveness().heartbeat(n);
     for (auto& m : r.value().meta) {
         auto it = _consensus_groups.find(m.group);
         if (it == _consensus_groups.end()) {
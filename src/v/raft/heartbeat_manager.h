@@ -123,6 +123,9 @@ public:
     ss::future<> start();
     ss::future<> stop();
 
+    /// number of leader groups which were quiesced in last heartbeat round
+    size_t quiesced_groups() const { return _quiesced_groups; }
+
 private:
     void dispatch_heartbeats();
 
@@ -153,6 +156,10 @@ private:
     clock_type::time_point _hbeat = clock_type::now();
     duration_type _heartbeat_interval;
     duration_type _heartbeat_timeout;
+    /// number of idle heartbeat intervals after which group is quiesced, 0
+    /// when quiescence is disabled
+    size_t _quiesce_after;
+    size_t _quiesced_groups{0};
     timer_type _heartbeat_timer;
     /// \brief used to wait for background ops before shutting down
     ss::gate _bghbeats;
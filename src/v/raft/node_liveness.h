@@ -0,0 +1,47 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "model/metadata.h"
+#include "raft/types.h"
+
+#include <absl/container/flat_hash_map.h>
+
+namespace raft {
+
+/**
+ * Shard local record of the last heartbeat exchanged with every node.
+ *
+ * Leaders do not send heartbeats for quiesced raft groups. Instead every
+ * heartbeat request received from (or replied by) a node is recorded here and
+ * used as a proof of liveness of all quiesced groups led by that node.
+ */
+class node_liveness {
+public:
+    void heartbeat(model::node_id id) {
+        _last_heartbeat.insert_or_assign(id, clock_type::now());
+    }
+
+    clock_type::time_point last_heartbeat(model::node_id id) const {
+        if (auto it = _last_heartbeat.find(id); it != _last_heartbeat.end()) {
+            return it->second;
+        }
+        return clock_type::time_point::min();
+    }
+
+private:
+    absl::flat_hash_map<model::node_id, clock_type::time_point> _last_heartbeat;
+};
+
+node_liveness& shard_local_node_liveness();
+
+} // namespace raft
@@ -46,6 +46,12 @@ void probe::setup_metrics(const model::ntp& ntp) {
          [this] { return _append_requests; },
          sm::description("Number of append requests received"),
          labels),
+       sm::make_derive(
+         "received_coalesced_append_requests",
+         [this] { return _coalesced_append_requests; },
+         sm::description(
+           "Number of append requests received in append entries batches"),
+         labels),
        sm::make_derive(
          "sent_vote_requests",
          [this] { return _vote_requests_sent; },
@@ -89,6 +95,17 @@ void probe::setup_metrics(const model::ntp& ntp) {
          [this] { return _leadership_changes; },
          sm::description("Number of leadership changes"),
          labels),
+       sm::make_derive(
+         "leader_lease_reads",
+         [this] { return _leader_lease_reads; },
+         sm::description(
+           "Number of linearizable barriers served by the leader lease"),
+         labels),
+       sm::make_derive(
+         "recovery_bytes_sent",
+         [this] { return _recovery_bytes_sent; },
+         sm::description("Number of bytes sent to recovering followers"),
+         labels),
        sm::make_derive(
          "replicate_request_errors",
          [this] { return _replicate_request_error; },
@@ -21,6 +21,10 @@ class probe {
 public:
     void vote_request() { ++_vote_requests; }
     void append_request() { ++_append_requests; }
+    void coalesced_append_request() { ++_coalesced_append_requests; }
+    uint64_t get_coalesced_append_requests() const {
+        return _coalesced_append_requests;
+    }
 
     void vote_request_sent() { ++_vote_requests_sent; }
 
@@ -34,9 +38,11 @@ public:
 
     void replicate_batch_flushed() { ++_replicate_batch_flushed; }
     void recovery_append_request() { ++_recovery_requests; }
+    void recovery_bytes_sent(size_t bytes) { _recovery_bytes_sent += bytes; }
     void configuration_update() { ++_configuration_updates; }
 
     void leadership_changed() { ++_leadership_changes; }
+    void leader_lease_read() { ++_leader_lease_reads; }
 
     static std::vector<ss::metrics::label_instance>
     create_metric_labels(const model::ntp& ntp);
@@ -50,6 +56,7 @@ public:
 private:
     uint64_t _vote_requests = 0;
     uint64_t _append_requests = 0;
+    uint64_t _coalesced_append_requests = 0;
     uint64_t _vote_requests_sent = 0;
     uint64_t _replicate_requests_ack_all = 0;
     uint64_t _replicate_requests_ack_leader = 0;
@@ -60,7 +67,9 @@ private:
     uint32_t _log_truncations = 0;
     uint32_t _configuration_updates = 0;
     uint64_t _recovery_requests = 0;
+    uint64_t _recovery_bytes_sent = 0;
     uint64_t _leadership_changes = 0;
+    uint64_t _leader_lease_reads = 0;
     uint64_t _heartbeat_request_error = 0;
     uint64_t _replicate_request_error = 0;
     uint64_t _recovery_request_error = 0;
@@ -9,6 +9,9 @@
 
 #include "raft/recovery_stm.h"
 
+#include "bytes/utils.h"
+#include "config/configuration.h"
+#include "hashing/crc32c.h"
 #include "model/fundamental.h"
 #include "model/record_batch_reader.h"
 #include "outcome_future_utils.h"
@@ -17,6 +20,8 @@
 #include "raft/errc.h"
 #include "raft/logger.h"
 #include "raft/raftgen_service.h"
+#include "raft/recovery_throttle.h"
+#include "storage/log_reader.h"
 
 #include <seastar/core/future-util.hh>
 
@@ -31,7 +36,17 @@ recovery_stm::recovery_stm(
   , _node_id(node_id)
   , _term(_ptr->term())
   , _prio(prio)
-  , _ctxlog(_ptr->_ctxlog) {}
+  , _ctxlog(_ptr->_ctxlog)
+  , _snapshot_chunk_size(std::max<size_t>(
+      config::shard_local_cfg().raft_snapshot_chunk_size(), 1))
+  , _max_inflight_chunks(std::max<size_t>(
+      config::shard_local_cfg().raft_snapshot_max_inflight_chunks(), 1))
+  , _snapshot_window(_max_inflight_chunks)
+  , _max_read_size(std::max(
+      config::shard_local_cfg().raft_recovery_read_buffer_size(),
+      min_read_size))
+  , _target_latency(
+      config::shard_local_cfg().raft_recovery_target_latency_ms()) {}
 
 ss::future<> recovery_stm::do_recover() {
     // We have to send all the records that leader have, event those that are
@@ -44,9 +59,36 @@ ss::future<> recovery_stm::do_recover() {
         return ss::make_ready_future<>();
     }
 
+    /**
+     * Recovery requests are pipelined, the next request is sent without
+     * waiting for the reply to the previous one. When pipeline has to be
+     * restarted i.e. follower rejected one of the requests we wait for all
+     * in flight requests to finish and continue from follower next index.
+     */
+    if (_drain) {
+        if (_inflight > 0) {
+            return wait_for_inflight_reply();
+        }
+        _drain = false;
+        _pipelined_next_offset.reset();
+    }
+
+    if (!_ptr->has_append_window(_node_id)) {
+        return _ptr->wait_for_append_window(_node_id)
+          .handle_exception_type([this](const ss::broken_condition_variable&) {
+              _stop_requested = true;
+          });
+    }
+
+    auto follower_next_offset = _pipelined_next_offset.value_or(
+      meta.value()->next_index);
     auto lstats = _ptr->_log.offsets();
     // follower last index was already evicted at the leader, use snapshot
-    if (meta.value()->next_index < lstats.start_offset) {
+    if (follower_next_offset < lstats.start_offset) {
+        if (_inflight > 0) {
+            _drain = true;
+            return wait_for_inflight_reply();
+        }
         return install_snapshot();
     }
 
@@ -82,13 +124,16 @@ ss::future<> recovery_stm::do_recover() {
      */
     _committed_offset = _ptr->committed_offset();
 
-    auto follower_next_offset = meta.value()->next_index;
     auto follower_committed_match_index = meta.value()->match_committed_index();
     auto f = ss::now();
 
     // we do not have next entry for the follower yet, wait for next disk append
     // of follower state change
     if (lstats.dirty_offset < follower_next_offset) {
+        // all the entries were already sent, wait for the replies
+        if (_inflight > 0) {
+            return wait_for_inflight_reply();
+        }
         f = meta.value()
               ->follower_state_change.wait([this] { return state_changed(); })
               .handle_exception_type(
@@ -168,15 +213,32 @@ ss::future<> recovery_stm::read_range_for_recovery(
       start_offset,
       end_offset,
       1,
-      // 32KB is a modest estimate. It has good batching and it also prevents an
-      // OOM situation where we have a lot of raft groups recovering at the same
-      // time and all drawing from memory. If this setting proves difficult,
-      // we'll need to throttle with a core-local semaphore
-      32 * 1024,
+      // starts with a modest 32KB estimate. It has good batching and it also
+      // prevents an OOM situation where we have a lot of raft groups
+      // recovering at the same time and all drawing from memory. The size
+      // grows while the follower keeps up with the requests.
+      _read_size,
       _prio,
       std::nullopt,
       std::nullopt,
       _ptr->_as);
+    // recovery reads historical data sequentially, read ahead and do not
+    // evict the hot tail of the log from the batch cache. the reader is
+    // dropped after this round, so the read ahead buffers add up to the
+    // current read size rather than to the largest one. they are taken from
+    // the shard budget, the default buffers are used when it is exhausted
+    cfg.skip_batch_cache = true;
+    ss::semaphore_units<> read_ahead_units;
+    auto& read_ahead_memory = shard_local_recovery_read_ahead_memory();
+    constexpr auto read_ahead_buffers
+      = storage::log_segment_batch_reader::read_ahead_buffers;
+    const auto read_buffer_size = _read_size / read_ahead_buffers;
+    const auto read_ahead_size = read_buffer_size * read_ahead_buffers;
+    if (read_ahead_memory.try_wait(read_ahead_size)) {
+        read_ahead_units = ss::semaphore_units<>(
+          read_ahead_memory, read_ahead_size);
+        cfg.read_buffer_size = read_buffer_size;
+    }
 
     vlog(
       _ctxlog.trace,
@@ -187,9 +249,11 @@ ss::future<> recovery_stm::read_range_for_recovery(
 
     // TODO: add timeout of maybe 1minute?
     return _ptr->_log.make_reader(cfg)
-      .then([](model::record_batch_reader reader) {
+      .then([units = std::move(read_ahead_units)](
+              model::record_batch_reader reader) mutable {
           return model::consume_reader_to_memory(
-            std::move(reader), model::no_timeout);
+                   std::move(reader), model::no_timeout)
+            .finally([units = std::move(units)] {});
       })
       .then([this, start_offset, follower_committed_match_index](
               ss::circular_buffer<model::record_batch> batches) {
@@ -207,57 +271,156 @@ ss::future<> recovery_stm::read_range_for_recovery(
           _base_batch_offset = gap_filled_batches.begin()->base_offset();
           _last_batch_offset = gap_filled_batches.back().last_offset();
 
+          size_t bytes = 0;
+          for (const auto& b : gap_filled_batches) {
+              bytes += b.size_bytes();
+          }
+
           auto f_reader = model::make_foreign_memory_record_batch_reader(
             std::move(gap_filled_batches));
 
           return replicate(
-            std::move(f_reader), should_flush(follower_committed_match_index));
+            std::move(f_reader),
+            should_flush(follower_committed_match_index),
+            bytes);
       });
 }
 
 ss::future<> recovery_stm::open_snapshot_reader() {
+    _snapshot_index = _ptr->_last_snapshot_index;
+    _snapshot_resumable
+      = config::shard_local_cfg().raft_snapshot_resumable_transfer();
     return _ptr->_snapshot_mgr.open_snapshot().then(
       [this](std::optional<storage::snapshot_reader> rdr) {
-          if (rdr) {
-              _snapshot_reader = std::make_unique<storage::snapshot_reader>(
-                std::move(*rdr));
-              return _snapshot_reader->get_snapshot_size().then(
-                [this](size_t sz) { _snapshot_size = sz; });
+          if (!rdr) {
+              return ss::now();
           }
-          return ss::now();
+          _snapshot_reader = std::make_unique<storage::snapshot_reader>(
+            std::move(*rdr));
+          return _snapshot_reader->get_snapshot_size().then([this](size_t sz) {
+              _snapshot_size = sz;
+              _read_snapshot_bytes = 0;
+              auto meta = get_follower_meta();
+              if (!meta) {
+                  return ss::now();
+              }
+              // resume previous transfer of the same snapshot
+              if (
+                !_snapshot_resumable
+                || (*meta)->snapshot_transfer_index != _snapshot_index
+                || (*meta)->snapshot_bytes_stored > _snapshot_size) {
+                  (*meta)->snapshot_transfer_index = _snapshot_index;
+                  (*meta)->snapshot_bytes_stored = 0;
+              }
+              if ((*meta)->snapshot_bytes_stored == 0) {
+                  return ss::now();
+              }
+              _read_snapshot_bytes = (*meta)->snapshot_bytes_stored;
+              vlog(
+                _ctxlog.debug,
+                "Resuming snapshot transfer to {} at offset {}",
+                _node_id,
+                _read_snapshot_bytes);
+              return _snapshot_reader->input().skip(_read_snapshot_bytes);
+          });
       });
 }
 
-ss::future<> recovery_stm::send_install_snapshot_request() {
-    // send 32KB at a time
-    return read_iobuf_exactly(_snapshot_reader->input(), 32_KiB)
-      .then([this](iobuf chunk) mutable {
-          auto chunk_size = chunk.size_bytes();
+ss::future<> recovery_stm::send_install_snapshot_requests() {
+    _snapshot_transfer_failed = false;
+    return ss::do_until(
+             [this] {
+                 return _snapshot_transfer_failed
+                        || _read_snapshot_bytes >= _snapshot_size
+                        || _term != _ptr->term() || !_ptr->is_leader();
+             },
+             [this] {
+                 // a chunk takes the whole window when resumable transfers
+                 // are disabled, older followers expect them one at a time
+                 return ss::get_units(
+                          _snapshot_window,
+                          _snapshot_resumable ? 1 : _max_inflight_chunks)
+                   .then([this](ss::semaphore_units<> u) {
+                       if (_snapshot_transfer_failed) {
+                           return ss::now();
+                       }
+                       return send_install_snapshot_request(std::move(u));
+                   });
+             })
+      .then([this] {
+          // wait for all chunks in flight
+          return _snapshot_window.wait(_max_inflight_chunks).then([this] {
+              _snapshot_window.signal(_max_inflight_chunks);
+          });
+      });
+}
+
+ss::future<> recovery_stm::send_install_snapshot_request(
+  ss::semaphore_units<> units) {
+    const auto chunk_size = std::min(
+      _snapshot_chunk_size, _snapshot_size - _read_snapshot_bytes);
+    return shard_local_recovery_throttle()
+      .throttle(chunk_size)
+      .then([this, chunk_size] {
+          return read_iobuf_exactly(_snapshot_reader->input(), chunk_size);
+      })
+      .then([this, chunk_size, units = std::move(units)](iobuf chunk) mutable {
+          if (chunk.size_bytes() != chunk_size) {
+              vlog(
+                _ctxlog.warn,
+                "Unable to read snapshot chunk at offset {}, snapshot size: {}",
+                _read_snapshot_bytes,
+                _snapshot_size);
+              _snapshot_transfer_failed = true;
+              return;
+          }
+          std::optional<uint32_t> chunk_crc;
+          if (_snapshot_resumable) {
+              crc::crc32c crc;
+              crc_extend_iobuf(crc, chunk);
+              chunk_crc = crc.value();
+          }
           install_snapshot_request req{
             .target_node_id = _node_id,
             .term = _ptr->term(),
             .group = _ptr->group(),
             .node_id = _ptr->_self,
-            .last_included_index = _ptr->_last_snapshot_index,
-            .file_offset = _sent_snapshot_bytes,
+            .last_included_index = _snapshot_index,
+            .file_offset = _read_snapshot_bytes,
             .chunk = std::move(chunk),
-            .done = (_sent_snapshot_bytes + chunk_size) == _snapshot_size};
+            .chunk_crc = chunk_crc,
+            .done = (_read_snapshot_bytes + chunk_size) == _snapshot_size};
+          _read_snapshot_bytes += chunk_size;
+          _ptr->_probe.recovery_bytes_sent(chunk_size);
 
           vlog(
             _ctxlog.trace,
-            "Sending install snapshot request to {}, last included index: {}",
+            "Sending install snapshot request to {}, last included index: {}, "
+            "file offset: {}",
             _node_id,
-            req.last_included_index);
-          return _ptr->_client_protocol
-            .install_snapshot(
-              _node_id.id(),
-              std::move(req),
-              rpc::client_opts(append_entries_timeout()))
-            .then([this](result<install_snapshot_reply> reply) {
-                return handle_install_snapshot_reply(
-                  _ptr->validate_reply_target_node(
-                    "install_snapshot", std::move(reply)));
-            });
+            req.last_included_index,
+            req.file_offset);
+          // dispatched in background, number of chunks in flight is limited
+          // by the window units
+          (void)ss::with_gate(
+            _inflight_requests,
+            [this, req = std::move(req)]() mutable {
+                return _ptr->_client_protocol
+                  .install_snapshot(
+                    _node_id.id(),
+                    std::move(req),
+                    rpc::client_opts(append_entries_timeout()))
+                  .then([this](result<install_snapshot_reply> reply) {
+                      return handle_install_snapshot_reply(
+                        _ptr->validate_reply_target_node(
+                          "install_snapshot", std::move(reply)));
+                  });
+            })
+            .handle_exception([this](const std::exception_ptr& e) {
+                vlog(_ctxlog.warn, "Error sending snapshot chunk - {}", e);
+                _snapshot_transfer_failed = true;
+            })
+            .finally([units = std::move(units)] {});
       });
 }
 
@@ -265,37 +428,63 @@ ss::future<> recovery_stm::close_snapshot_reader() {
     return _snapshot_reader->close().then([this] {
         _snapshot_reader.reset();
         _snapshot_size = 0;
-        _sent_snapshot_bytes = 0;
+        _read_snapshot_bytes = 0;
     });
 }
 
 ss::future<> recovery_stm::handle_install_snapshot_reply(
   result<install_snapshot_reply> reply) {
-    // snapshot delivery failed
-    if (reply.has_error() || !reply.value().success) {
-        return close_snapshot_reader();
+    // snapshot delivery failed, the transfer is resumed from the last chunk
+    // stored by the follower
+    if (reply.has_error()) {
+        _snapshot_transfer_failed = true;
+        return ss::now();
     }
     if (reply.value().term > _ptr->_term) {
-        return close_snapshot_reader().then(
-          [this, term = reply.value().term] { return _ptr->step_down(term); });
-    }
-    _sent_snapshot_bytes = reply.value().bytes_stored;
-
-    // we will send next chunk as a part of recovery loop
-    if (_sent_snapshot_bytes != _snapshot_size) {
-        return ss::now();
+        _snapshot_transfer_failed = true;
+        return _ptr->step_down(reply.value().term);
     }
-
     auto meta = get_follower_meta();
     if (!meta) {
         // stop recovery when node was removed
         _stop_requested = true;
-        return ss::make_ready_future<>();
+        _snapshot_transfer_failed = true;
+        return ss::now();
+    }
+    if (!_snapshot_resumable) {
+        // single chunk in flight, the reply carries the size of the chunk.
+        // the transfer can not be resumed, it starts over on failure
+        if (!reply.value().success) {
+            _snapshot_transfer_failed = true;
+            (*meta)->snapshot_bytes_stored = 0;
+            return ss::now();
+        }
+        (*meta)->snapshot_bytes_stored += reply.value().bytes_stored;
+        return ss::now();
     }
+    if (!reply.value().success) {
+        // follower tells where to resume from, zero when it has to start over
+        _snapshot_transfer_failed = true;
+        (*meta)->snapshot_bytes_stored = reply.value().bytes_stored;
+        return ss::now();
+    }
+    (*meta)->snapshot_bytes_stored = std::max(
+      (*meta)->snapshot_bytes_stored, reply.value().bytes_stored);
+    return ss::now();
+}
 
-    // snapshot received by the follower, continue with recovery
-    (*meta)->match_index = _ptr->_last_snapshot_index;
-    (*meta)->next_index = details::next_offset(_ptr->_last_snapshot_index);
+ss::future<> recovery_stm::finish_install_snapshot() {
+    auto meta = get_follower_meta();
+    if (
+      meta && _term == _ptr->term()
+      && (*meta)->snapshot_bytes_stored == _snapshot_size) {
+        // snapshot received by the follower, continue with recovery
+        (*meta)->match_index = _snapshot_index;
+        (*meta)->next_index = details::next_offset(_snapshot_index);
+        (*meta)->snapshot_transfer_index = model::offset{};
+        (*meta)->snapshot_bytes_stored = 0;
+    }
+    // we will resume the transfer as a part of recovery loop
     return close_snapshot_reader();
 }
 
@@ -311,13 +500,15 @@ ss::future<> recovery_stm::install_snapshot() {
             return ss::now();
         }
 
-        return send_install_snapshot_request();
+        return send_install_snapshot_requests().then(
+          [this] { return finish_install_snapshot(); });
     });
 }
 
 ss::future<> recovery_stm::replicate(
   model::record_batch_reader&& reader,
-  append_entries_request::flush_after_append flush) {
+  append_entries_request::flush_after_append flush,
+  size_t bytes) {
     // collect metadata for append entries request
     // last persisted offset is last_offset of batch before the first one in the
     // reader
@@ -332,6 +523,11 @@ ss::future<> recovery_stm::replicate(
         prev_log_term = model::term_id{};
     } else if (prev_log_idx == _ptr->_last_snapshot_index) {
         prev_log_term = _ptr->_last_snapshot_term;
+    } else if (_inflight > 0) {
+        // log was prefix truncated while requests were in flight, restart
+        // the pipeline
+        _drain = true;
+        return ss::now();
     } else {
         // no entry for prev_log_idx, fallback to install snapshot
         return install_snapshot();
@@ -359,57 +555,112 @@ ss::future<> recovery_stm::replicate(
 
     auto seq = _ptr->next_follower_sequence(_node_id);
     _ptr->update_suppress_heartbeats(_node_id, seq, heartbeats_suppressed::yes);
-    return dispatch_append_entries(std::move(r))
-      .finally([this, seq] {
-          _ptr->update_suppress_heartbeats(
-            _node_id, seq, heartbeats_suppressed::no);
+    _pipelined_next_offset = details::next_offset(_last_batch_offset);
+    // do not wait for the reply, next request can be sent right away
+    (void)ss::with_gate(
+      _inflight_requests,
+      [this,
+       r = std::move(r),
+       seq,
+       bytes,
+       dirty_offset = lstats.dirty_offset,
+       base_offset = _base_batch_offset]() mutable {
+          ++_inflight;
+          _ptr->acquire_append_window(_node_id, bytes);
+          _ptr->_probe.recovery_bytes_sent(bytes);
+          auto sent = clock_type::now();
+          return dispatch_append_entries(std::move(r))
+            .finally([this, seq] {
+                _ptr->update_suppress_heartbeats(
+                  _node_id, seq, heartbeats_suppressed::no);
+            })
+            .then([this, seq, dirty_offset, base_offset, sent](
+                    result<append_entries_reply> r) {
+                if (r) {
+                    update_read_size(clock_type::now() - sent);
+                }
+                handle_append_entries_reply(
+                  std::move(r), seq, dirty_offset, base_offset);
+            })
+            .handle_exception([this](const std::exception_ptr& e) {
+                vlog(_ctxlog.warn, "Error sending recovery request - {}", e);
+                _stop_requested = true;
+            })
+            .finally([this, bytes] {
+                if (--_inflight == 0 && !_drain) {
+                    _pipelined_next_offset.reset();
+                }
+                _ptr->release_append_window(_node_id, bytes);
+                _inflight_reply.broadcast();
+            });
       })
-      .then([this, seq, dirty_offset = lstats.dirty_offset](auto r) {
-          if (!r) {
-              vlog(
-                _ctxlog.error,
-                "recovery_stm: not replicate entry: {} - {}",
-                r,
-                r.error().message());
-              _stop_requested = true;
-              _ptr->get_probe().recovery_request_error();
-          }
-          _ptr->process_append_entries_reply(
-            _node_id.id(), r.value(), seq, dirty_offset);
-          // If follower stats aren't present we have to stop recovery as
-          // follower was removed from configuration
-          if (!_ptr->_fstats.contains(_node_id)) {
-              _stop_requested = true;
-              return;
-          }
-          // If request was reordered we have to stop recovery as follower state
-          // is not known
-          if (seq < _ptr->_fstats.get(_node_id).last_received_seq) {
-              _stop_requested = true;
-              return;
-          }
-          // move the follower next index backward if recovery were not
-          // successfull
-          //
-          // Raft paper:
-          // If AppendEntries fails because of log inconsistency: decrement
-          // nextIndex and retry(§5.3)
-
-          if (r.value().result == append_entries_reply::status::failure) {
-              auto meta = get_follower_meta();
-              if (!meta) {
-                  _stop_requested = true;
-                  return;
-              }
-              meta.value()->next_index = std::max(
-                model::offset(0), details::prev_offset(_base_batch_offset));
-              vlog(
-                _ctxlog.trace,
-                "Move node {} next index {} backward",
-                _node_id,
-                meta.value()->next_index);
-          }
-      });
+      .handle_exception_type([](const ss::gate_closed_exception&) {});
+    return ss::now();
+}
+
+void recovery_stm::handle_append_entries_reply(
+  result<append_entries_reply> r,
+  follower_req_seq seq,
+  model::offset dirty_offset,
+  model::offset base_offset) {
+    if (!r) {
+        vlog(
+          _ctxlog.error,
+          "recovery_stm: not replicate entry: {} - {}",
+          r,
+          r.error().message());
+        _stop_requested = true;
+        _ptr->get_probe().recovery_request_error();
+        _ptr->process_append_entries_reply(
+          _node_id.id(), std::move(r), seq, dirty_offset);
+        return;
+    }
+    auto status = r.value().result;
+    _ptr->process_append_entries_reply(
+      _node_id.id(), std::move(r), seq, dirty_offset);
+    // If follower stats aren't present we have to stop recovery as
+    // follower was removed from configuration
+    if (!_ptr->_fstats.contains(_node_id)) {
+        _stop_requested = true;
+        return;
+    }
+    // If request was reordered we have to stop recovery as follower state
+    // is not known
+    if (seq < _ptr->_fstats.get(_node_id).last_received_seq) {
+        _stop_requested = true;
+        return;
+    }
+    // move the follower next index backward if recovery were not
+    // successfull
+    //
+    // Raft paper:
+    // If AppendEntries fails because of log inconsistency: decrement
+    // nextIndex and retry(§5.3)
+
+    if (status == append_entries_reply::status::failure) {
+        auto meta = get_follower_meta();
+        if (!meta) {
+            _stop_requested = true;
+            return;
+        }
+        auto next_index = std::max(
+          model::offset(0), details::prev_offset(base_offset));
+        // requests that were sent after the rejected one are rejected as
+        // well, keep the lowest index
+        meta.value()->next_index = _drain ? std::min(
+                                     meta.value()->next_index, next_index)
+                                          : next_index;
+        _drain = true;
+        vlog(
+          _ctxlog.trace,
+          "Move node {} next index {} backward",
+          _node_id,
+          meta.value()->next_index);
+    }
+}
+
+ss::future<> recovery_stm::wait_for_inflight_reply() {
+    return _inflight_reply.wait();
 }
 
 clock_type::time_point recovery_stm::append_entries_timeout() {
@@ -429,6 +680,15 @@ recovery_stm::dispatch_append_entries(append_entries_request&& r) {
       });
 }
 
+void recovery_stm::update_read_size(clock_type::duration latency) {
+    // follower keeps up with the requests, read more at once
+    if (latency <= _target_latency) {
+        _read_size = std::min(_read_size * 2, _max_read_size);
+        return;
+    }
+    _read_size = std::max(_read_size / 2, min_read_size);
+}
+
 bool recovery_stm::is_recovery_finished() {
     if (_ptr->_bg.is_closed()) {
         return true;
@@ -466,11 +726,13 @@ ss::future<> recovery_stm::apply() {
     return ss::with_gate(
              _ptr->_bg,
              [this] {
-                 return do_recover().then([this] {
-                     return ss::do_until(
-                       [this] { return is_recovery_finished(); },
-                       [this] { return do_recover(); });
-                 });
+                 return do_recover()
+                   .then([this] {
+                       return ss::do_until(
+                         [this] { return is_recovery_finished(); },
+                         [this] { return do_recover(); });
+                   })
+                   .finally([this] { return _inflight_requests.close(); });
              })
       .finally([this] {
           vlog(_ctxlog.trace, "Finished node {} recovery", _node_id);
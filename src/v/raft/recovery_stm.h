@@ -16,10 +16,16 @@
 #include "raft/logger.h"
 #include "storage/snapshot.h"
 
+#include <seastar/core/condition-variable.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/semaphore.hh>
+
 namespace raft {
 
 class recovery_stm {
 public:
+    static constexpr size_t min_read_size = 32 * 1024;
+
     recovery_stm(consensus*, vnode, ss::io_priority_class);
     ss::future<> apply();
 
@@ -28,15 +34,26 @@ private:
     ss::future<>
       read_range_for_recovery(model::offset, model::offset, model::offset);
     ss::future<> replicate(
-      model::record_batch_reader&&, append_entries_request::flush_after_append);
+      model::record_batch_reader&&,
+      append_entries_request::flush_after_append,
+      size_t);
+    void handle_append_entries_reply(
+      result<append_entries_reply>,
+      follower_req_seq,
+      model::offset,
+      model::offset);
+    ss::future<> wait_for_inflight_reply();
     ss::future<result<append_entries_reply>>
     dispatch_append_entries(append_entries_request&&);
     std::optional<follower_index_metadata*> get_follower_meta();
     clock_type::time_point append_entries_timeout();
+    void update_read_size(clock_type::duration);
 
     ss::future<> install_snapshot();
-    ss::future<> send_install_snapshot_request();
+    ss::future<> send_install_snapshot_requests();
+    ss::future<> send_install_snapshot_request(ss::semaphore_units<>);
     ss::future<> handle_install_snapshot_reply(result<install_snapshot_reply>);
+    ss::future<> finish_install_snapshot();
     ss::future<> open_snapshot_reader();
     ss::future<> close_snapshot_reader();
     bool state_changed();
@@ -53,10 +70,32 @@ private:
     ctx_log _ctxlog;
     // tracking follower snapshot delivery
     std::unique_ptr<storage::snapshot_reader> _snapshot_reader;
-    size_t _sent_snapshot_bytes = 0;
+    model::offset _snapshot_index;
+    size_t _read_snapshot_bytes = 0;
     size_t _snapshot_size = 0;
+    size_t _snapshot_chunk_size;
+    // snapshot chunks are sent in parallel, limited by the window
+    size_t _max_inflight_chunks;
+    ss::semaphore _snapshot_window;
+    // chunks carry a crc, several of them are in flight and the follower
+    // replies with the contiguous bytes it stored. older followers get a
+    // single chunk at a time and reply with the size of the chunk
+    bool _snapshot_resumable = false;
+    bool _snapshot_transfer_failed = false;
+    // size of a single recovery read, adjusted to the follower ack latency
+    size_t _read_size = min_read_size;
+    size_t _max_read_size;
+    clock_type::duration _target_latency;
     // needed to early exit. (node down)
     bool _stop_requested = false;
+    // pipelined requests tracking, next offset to send when there are
+    // requests in flight
+    std::optional<model::offset> _pipelined_next_offset;
+    size_t _inflight = 0;
+    // set when pipeline has to be restarted after in flight requests finish
+    bool _drain = false;
+    ss::condition_variable _inflight_reply;
+    ss::gate _inflight_requests;
 };
 
 } // namespace raft
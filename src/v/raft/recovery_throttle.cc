@@ -0,0 +1,87 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "raft/recovery_throttle.h"
+
+#include "config/configuration.h"
+
+#include <seastar/core/smp.hh>
+#include <seastar/core/sleep.hh>
+
+#include <algorithm>
+#include <chrono>
+
+namespace raft {
+
+recovery_throttle::recovery_throttle(uint64_t bytes_per_second)
+  : _rate(bytes_per_second)
+  , _available(static_cast<int64_t>(bytes_per_second))
+  , _last_refill(clock_type::now()) {}
+
+void recovery_throttle::refill() {
+    const auto now = clock_type::now();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      now - _last_refill);
+    const auto tokens = static_cast<int64_t>(
+      (static_cast<double>(_rate) * elapsed.count()) / 1'000'000);
+    if (tokens <= 0) {
+        return;
+    }
+    _available = std::min(_available + tokens, static_cast<int64_t>(_rate));
+    _last_refill = now;
+}
+
+void recovery_throttle::set_rate(uint64_t bytes_per_second) {
+    if (bytes_per_second == _rate) {
+        return;
+    }
+    if (_rate == 0) {
+        // the throttle was disabled, start with a full bucket
+        _available = static_cast<int64_t>(bytes_per_second);
+        _last_refill = clock_type::now();
+    } else {
+        refill();
+        _available = std::min(
+          _available, static_cast<int64_t>(bytes_per_second));
+    }
+    _rate = bytes_per_second;
+}
+
+ss::future<> recovery_throttle::throttle(uint64_t bytes) {
+    if (_rate == 0) {
+        return ss::now();
+    }
+    refill();
+    _available -= static_cast<int64_t>(bytes);
+    if (_available >= 0) {
+        return ss::now();
+    }
+    // wait for the debt, including the debt of the callers waiting ahead
+    const auto delay = std::chrono::microseconds(
+      (-_available * 1'000'000) / static_cast<int64_t>(_rate));
+    return ss::sleep<clock_type>(
+      std::chrono::duration_cast<clock_type::duration>(delay));
+}
+
+recovery_throttle& shard_local_recovery_throttle() {
+    const auto rate = config::shard_local_cfg().raft_recovery_max_bandwidth()
+                      / ss::smp::count;
+    static thread_local recovery_throttle throttle(rate);
+    // the property can be changed at runtime
+    throttle.set_rate(rate);
+    return throttle;
+}
+
+ss::semaphore& shard_local_recovery_read_ahead_memory() {
+    static thread_local ss::semaphore memory(
+      config::shard_local_cfg().raft_recovery_max_read_ahead_memory());
+    return memory;
+}
+
+} // namespace raft
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "seastarx.h"
+
+#include <seastar/core/future.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/semaphore.hh>
+
+#include <cstdint>
+
+namespace raft {
+
+/**
+ * Shard local limit of the bandwidth used to send snapshots to recovering
+ * followers. It is shared by all the recovery_stm instances of the shard, the
+ * node level limit is split evenly between the shards.
+ *
+ * The throttle is a token bucket which is allowed to go into debt, every
+ * caller takes its tokens immediately and waits until the debt is repaid. The
+ * bucket holds at most one second worth of tokens.
+ */
+class recovery_throttle {
+public:
+    using clock_type = ss::lowres_clock;
+
+    /// zero rate disables the limit
+    explicit recovery_throttle(uint64_t bytes_per_second);
+
+    /// resolves when `bytes` can be sent
+    ss::future<> throttle(uint64_t bytes);
+
+    uint64_t rate() const { return _rate; }
+    void set_rate(uint64_t bytes_per_second);
+
+private:
+    void refill();
+
+    uint64_t _rate;
+    int64_t _available;
+    clock_type::time_point _last_refill;
+};
+
+/// throttle with the rate of the current raft_recovery_max_bandwidth value
+recovery_throttle& shard_local_recovery_throttle();
+
+/// shard local budget of the buffers read ahead for recovering followers,
+/// sized with raft_recovery_max_read_ahead_memory
+ss::semaphore& shard_local_recovery_read_ahead_memory();
+
+} // namespace raft
@@ -111,16 +111,20 @@ ss::future<> replicate_entries_stm::dispatch_one(vnode id) {
     return ss::with_gate(
              _req_bg,
              [this, id]() mutable {
-                 return dispatch_single_retry(id).then(
-                   [this, id](result<append_entries_reply> reply) {
+                 const bool is_follower = id != _ptr->self();
+                 if (is_follower) {
+                     _ptr->acquire_append_window(id, _request_bytes);
+                 }
+                 return dispatch_single_retry(id)
+                   .then([this, id](result<append_entries_reply> reply) {
                        raft::follower_req_seq seq{0};
                        if (id != _ptr->self()) {
                            auto it = _followers_seq.find(id);
                            vassert(
                              it != _followers_seq.end(),
-                             "Follower request sequence is required to exists "
-                             "for each follower. No follower sequence found "
-                             "for {}",
+                             "Follower request sequence is required to "
+                             "exists for each follower. No follower sequence "
+                             "found for {}",
                              id);
                            seq = it->second;
                        }
@@ -130,6 +134,11 @@ ss::future<> replicate_entries_stm::dispatch_one(vnode id) {
                        }
                        _ptr->process_append_entries_reply(
                          id.id(), reply, seq, _dirty_offset);
+                   })
+                   .finally([this, id, is_follower] {
+                       if (is_follower) {
+                           _ptr->release_append_window(id, _request_bytes);
+                       }
                    });
              })
       .handle_exception_type([](const ss::gate_closed_exception&) {});
@@ -168,7 +177,7 @@ replicate_entries_stm::append_to_self() {
       });
 }
 /**
- *  We skip sending follower requests it those two cases:
+ *  We skip sending follower requests it those three cases:
  *   - follower is recovering - when follower is not fully caught up it will not
  *     accept append entries request, missing data will be replicated to
  *     follower during recovery process
@@ -179,6 +188,9 @@ replicate_entries_stm::append_to_self() {
  *     pressure. Follower will still receive heartbeats, as we skip sending
  *     append entries request, after recovery follower will start receiving
  *     requests.
+ *   - follower append window is full - there are already too many requests
+ *     in flight to the follower, the follower is behind and it will be
+ *     caught up by the recovery triggered on the next heartbeat reply.
  */
 inline bool replicate_entries_stm::should_skip_follower_request(vnode id) {
     if (auto it = _ptr->_fstats.find(id); it != _ptr->_fstats.end()) {
@@ -186,7 +198,7 @@ inline bool replicate_entries_stm::should_skip_follower_request(vnode id) {
                              - _ptr->_replicate_append_timeout;
 
         return it->second.last_hbeat_timestamp < timeout
-               || it->second.is_recovering;
+               || it->second.is_recovering || !_ptr->has_append_window(id);
     }
 
     return false;
@@ -211,6 +223,7 @@ replicate_entries_stm::apply(std::vector<ss::semaphore_units<>> u) {
                 append_result);
           }
           _dirty_offset = append_result.value().last_offset;
+          _request_bytes = append_result.value().byte_size;
           // dispatch requests to followers & leader flush
           uint16_t requests_count = 0;
           cfg.for_each_broker_id([this, &requests_count](const vnode& rni) {
@@ -118,6 +118,8 @@ private:
     ss::gate _req_bg;
     ctx_log _ctxlog;
     model::offset _dirty_offset;
+    /// size of the request, accounted in follower append window
+    size_t _request_bytes = 0;
 };
 
 } // namespace raft
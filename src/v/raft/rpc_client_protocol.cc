@@ -9,6 +9,7 @@
 
 #include "raft/rpc_client_protocol.h"
 
+#include "config/configuration.h"
 #include "outcome_future_utils.h"
 #include "raft/raftgen_service.h"
 #include "rpc/connection_cache.h"
@@ -34,6 +35,9 @@ ss::future<result<vote_reply>> rpc_client_protocol::vote(
 
 ss::future<result<append_entries_reply>> rpc_client_protocol::append_entries(
   model::node_id n, append_entries_request&& r, rpc::client_opts opts) {
+    if (config::shard_local_cfg().raft_append_entries_coalescing()) {
+        return coalescer_for(n).append_entries(std::move(r), std::move(opts));
+    }
     return _connection_cache.local().with_node_client<raftgen_client_protocol>(
       _self,
       ss::this_shard_id(),
@@ -46,6 +50,20 @@ ss::future<result<append_entries_reply>> rpc_client_protocol::append_entries(
       });
 }
 
+append_entries_coalescer&
+rpc_client_protocol::coalescer_for(model::node_id n) {
+    auto it = _coalescers.find(n);
+    if (it == _coalescers.end()) {
+        it = _coalescers
+               .emplace(
+                 n,
+                 std::make_unique<append_entries_coalescer>(
+                   _self, n, _connection_cache))
+               .first;
+    }
+    return *it->second;
+}
+
 ss::future<result<heartbeat_reply>> rpc_client_protocol::heartbeat(
   model::node_id n, heartbeat_request&& r, rpc::client_opts opts) {
     return _connection_cache.local().with_node_client<raftgen_client_protocol>(
@@ -13,12 +13,16 @@
 
 #include "model/metadata.h"
 #include "outcome_future_utils.h"
+#include "raft/append_entries_coalescer.h"
 #include "raft/consensus_client_protocol.h"
 #include "raft/errc.h"
 #include "raft/raftgen_service.h"
 #include "rpc/connection_cache.h"
 #include "rpc/transport.h"
 
+#include <absl/container/flat_hash_map.h>
+
+#include <memory>
 #include <system_error>
 
 namespace raft {
@@ -47,8 +51,14 @@ public:
     timeout_now(model::node_id, timeout_now_request&&, rpc::client_opts) final;
 
 private:
+    append_entries_coalescer& coalescer_for(model::node_id);
+
     model::node_id _self;
     ss::sharded<rpc::connection_cache>& _connection_cache;
+    // append entries requests coalesced per target node
+    absl::
+      flat_hash_map<model::node_id, std::unique_ptr<append_entries_coalescer>>
+        _coalescers;
 };
 
 inline consensus_client_protocol make_rpc_client_protocol(
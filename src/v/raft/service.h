@@ -11,8 +11,10 @@
 
 #pragma once
 
+#include "config/configuration.h"
 #include "likely.h"
 #include "raft/consensus.h"
+#include "raft/node_liveness.h"
 #include "raft/raftgen_service.h"
 #include "raft/types.h"
 #include "seastarx.h"
@@ -22,6 +24,7 @@
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/timed_out_error.hh>
 #include <seastar/core/with_timeout.hh>
+#include <seastar/util/bool_class.hh>
 
 #include <absl/container/flat_hash_map.h>
 
@@ -57,7 +60,9 @@ public:
       : raftgen_service(sc, ssg)
       , _group_manager(mngr)
       , _shard_table(tbl)
-      , _heartbeat_interval(heartbeat_interval) {
+      , _heartbeat_interval(heartbeat_interval)
+      , _quiescence_enabled(
+          config::shard_local_cfg().raft_enable_quiescence()) {
         finjector::shard_local_badger().register_probe(
           failure_probes::name(), &_probe);
     }
@@ -69,6 +74,7 @@ public:
     [[gnu::always_inline]] ss::future<heartbeat_reply>
     heartbeat(heartbeat_request&& r, rpc::streaming_context&) final {
         using ret_t = std::vector<append_entries_reply>;
+        auto liveness = update_node_liveness(r);
         std::vector<append_entries_request> reqs;
         reqs.reserve(r.heartbeats.size());
         for (auto& m : r.heartbeats) {
@@ -116,6 +122,13 @@ public:
               std::move(
                 missing.begin(), missing.end(), std::back_inserter(ret));
               return heartbeat_reply{std::move(ret)};
+          })
+          .then([liveness = std::move(liveness)](
+                  heartbeat_reply reply) mutable {
+              return std::move(liveness).then(
+                [reply = std::move(reply)]() mutable {
+                    return std::move(reply);
+                });
           });
     }
 
@@ -134,12 +147,26 @@ public:
     [[gnu::always_inline]] ss::future<append_entries_reply>
     append_entries(append_entries_request&& r, rpc::streaming_context&) final {
         return _probe.append_entries().then([this, r = std::move(r)]() mutable {
-            auto gr = r.target_group();
-            return dispatch_request(
-              append_entries_request::make_foreign(std::move(r)),
-              [gr]() { return make_missing_group_reply(gr); },
-              [](append_entries_request&& r, consensus_ptr c) {
-                  return c->append_entries(std::move(r));
+            return dispatch_append_entries_request(std::move(r));
+        });
+    }
+
+    [[gnu::always_inline]] ss::future<append_entries_batch_reply>
+    append_entries_batch(
+      append_entries_batch_request&& r, rpc::streaming_context&) final {
+        return _probe.append_entries_batch().then([this,
+                                                   r = std::move(r)]() mutable {
+            // requests are dispatched in order, requests of the same group
+            // are delivered to the group in the order they were sent
+            std::vector<ss::future<append_entries_reply>> futures;
+            futures.reserve(r.requests.size());
+            for (auto& req : r.requests) {
+                futures.push_back(dispatch_append_entries_request(
+                  std::move(req), coalesced_request::yes));
+            }
+            return ss::when_all_succeed(futures.begin(), futures.end())
+              .then([](std::vector<append_entries_reply> replies) {
+                  return append_entries_batch_reply{std::move(replies)};
               });
         });
     }
@@ -170,8 +197,35 @@ public:
         });
     }
 
+    [[gnu::always_inline]] ss::future<transfer_leadership_reply>
+    transfer_leadership(
+      transfer_leadership_request&& r, rpc::streaming_context&) final {
+        return _probe.transfer_leadership().then([this,
+                                                  r = std::move(r)]() mutable {
+            return dispatch_request(
+              std::move(r),
+              &service::make_failed_transfer_leadership_reply,
+              [](transfer_leadership_request&& r, consensus_ptr c) {
+                  return c->transfer_leadership(r.target).then(
+                    [](std::error_code ec) {
+                        if (!ec) {
+                            return transfer_leadership_reply{
+                              .success = true, .result = errc::success};
+                        }
+                        return transfer_leadership_reply{
+                          .success = false,
+                          .result = ec.category() == error_category()
+                                      ? errc(ec.value())
+                                      : errc::not_leader};
+                    });
+              });
+        });
+    }
+
 private:
     using consensus_ptr = seastar::lw_shared_ptr<consensus>;
+    /// request was received in an append entries batch
+    using coalesced_request = ss::bool_class<struct coalesced_request_tag>;
     using hbeats_t = std::vector<append_entries_request>;
     using hbeats_ptr = ss::foreign_ptr<std::unique_ptr<hbeats_t>>;
     struct shard_groupped_hbeat_requests {
@@ -202,6 +256,13 @@ private:
         return ss::make_ready_future<timeout_now_reply>(timeout_now_reply{});
     }
 
+    static ss::future<transfer_leadership_reply>
+    make_failed_transfer_leadership_reply() {
+        return ss::make_ready_future<transfer_leadership_reply>(
+          transfer_leadership_reply{
+            .success = false, .result = errc::not_leader});
+    }
+
     template<typename Req, typename ErrorFactory, typename Func>
     auto dispatch_request(Req&& req, ErrorFactory&& ef, Func&& f) {
         auto group = req.target_group();
@@ -232,6 +293,21 @@ private:
           });
     }
 
+    ss::future<append_entries_reply> dispatch_append_entries_request(
+      append_entries_request&& r,
+      coalesced_request coalesced = coalesced_request::no) {
+        auto gr = r.target_group();
+        return dispatch_request(
+          append_entries_request::make_foreign(std::move(r)),
+          [gr]() { return make_missing_group_reply(gr); },
+          [coalesced](append_entries_request&& r, consensus_ptr c) {
+              if (coalesced) {
+                  c->get_probe().coalesced_append_request();
+              }
+              return c->append_entries(std::move(r));
+          });
+    }
+
     ss::future<std::vector<append_entries_reply>>
     dispatch_hbeats_to_core(ss::shard_id shard, hbeats_ptr requests) {
         return with_scheduling_group(
@@ -293,6 +369,30 @@ private:
         return ret;
     }
 
+    /// heartbeats of quiesced groups are not sent, every heartbeat request
+    /// is a liveness beat of the sending node for all of them, the groups
+    /// may be placed on any shard. other shards are updated at most once per
+    /// heartbeat interval, far below the election timeout the liveness is
+    /// checked against
+    ss::future<> update_node_liveness(const heartbeat_request& r) {
+        if (!_quiescence_enabled || r.heartbeats.empty()) {
+            return ss::now();
+        }
+        auto node = r.heartbeats.front().node_id.id();
+        shard_local_node_liveness().heartbeat(node);
+
+        const auto now = clock_type::now();
+        auto [it, inserted] = _liveness_broadcast.try_emplace(node, now);
+        if (!inserted) {
+            if (now - it->second < _heartbeat_interval) {
+                return ss::now();
+            }
+            it->second = now;
+        }
+        return ss::smp::invoke_on_all(
+          [node] { shard_local_node_liveness().heartbeat(node); });
+    }
+
     ss::future<append_entries_reply>
     dispatch_append_entries(ConsensusManager& m, append_entries_request&& r) {
         auto group = group_id(r.meta.group);
@@ -307,5 +407,9 @@ private:
     ss::sharded<ConsensusManager>& _group_manager;
     ShardLookup& _shard_table;
     clock_type::duration _heartbeat_interval;
+    bool _quiescence_enabled;
+    /// last time the liveness of a node was propagated to the other shards
+    absl::flat_hash_map<model::node_id, clock_type::time_point>
+      _liveness_broadcast;
 };
 } // namespace raft
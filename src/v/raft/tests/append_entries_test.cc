@@ -8,6 +8,7 @@
 // by the Apache License, Version 2.0
 
 #include "bytes/bytes.h"
+#include "config/configuration.h"
 #include "finjector/hbadger.h"
 #include "model/fundamental.h"
 #include "model/metadata.h"
@@ -25,6 +26,9 @@
 #include "storage/tests/utils/random_batch.h"
 #include "test_utils/async.h"
 
+#include <seastar/core/sleep.hh>
+#include <seastar/util/defer.hh>
+
 #include <system_error>
 
 FIXTURE_TEST(test_entries_are_replicated_to_all_nodes, raft_test_fixture) {
@@ -94,6 +98,49 @@ FIXTURE_TEST(test_replicate_multiple_entries, raft_test_fixture) {
       "State is consistent");
 };
 
+FIXTURE_TEST(test_replicate_with_coalesced_append_entries, raft_test_fixture) {
+    config::shard_local_cfg()
+      .get("raft_append_entries_coalescing")
+      .set_value(true);
+    // wide window, so that consecutive requests are always coalesced
+    config::shard_local_cfg()
+      .get("raft_append_entries_coalescing_window_us")
+      .set_value(uint32_t(20000));
+    auto reset_coalescing = ss::defer([] {
+        config::shard_local_cfg()
+          .get("raft_append_entries_coalescing")
+          .set_value(false);
+        config::shard_local_cfg()
+          .get("raft_append_entries_coalescing_window_us")
+          .set_value(uint32_t(200));
+    });
+    raft_group gr = raft_group(raft::group_id(0), 3);
+    gr.enable_all();
+    // requests replicated with relaxed consistency are pipelined, several of
+    // them are coalesced into a single RPC
+    for (int i = 0; i < 5; ++i) {
+        bool success = replicate_random_batches(
+                         gr, 5, raft::consistency_level::leader_ack)
+                         .get0();
+        BOOST_REQUIRE(success);
+    }
+    bool success = replicate_random_batches(gr, 5).get0();
+    BOOST_REQUIRE(success);
+
+    wait_for(
+      10s,
+      [this, &gr] { return are_all_commit_indexes_the_same(gr); },
+      "State is consistent after replication");
+    validate_logs_replication(gr);
+
+    // followers received the requests in append entries batches
+    uint64_t coalesced = 0;
+    for (auto& [_, m] : gr.get_members()) {
+        coalesced += m.consensus->get_probe().get_coalesced_append_requests();
+    }
+    BOOST_REQUIRE_GT(coalesced, 0);
+};
+
 FIXTURE_TEST(test_replicate_with_expected_term_leader, raft_test_fixture) {
     raft_group gr = raft_group(raft::group_id(0), 3);
     gr.enable_all();
@@ -352,6 +399,155 @@ FIXTURE_TEST(test_recovery_of_crashed_leader_truncation, raft_test_fixture) {
       "After recovery state should be consistent");
 };
 
+/// pipelined append entries tests use a small window and replies delayed by
+/// the simulated round trip time, so that several requests are in flight
+static constexpr size_t pipelined_window = 4;
+static constexpr auto pipelined_rtt = 20ms;
+
+static auto set_pipelined_window() {
+    config::shard_local_cfg()
+      .get("raft_max_inflight_append_entries_requests")
+      .set_value(pipelined_window);
+    return ss::defer([] {
+        config::shard_local_cfg()
+          .get("raft_max_inflight_append_entries_requests")
+          .set_value(size_t(16));
+    });
+}
+
+/// replicates batches of a fixed size, a single recovery read holds at most
+/// a couple of them
+static bool
+replicate_batches_of_size(raft_group& gr, int count, size_t size) {
+    for (int i = 0; i < count; ++i) {
+        bool success
+          = retry_with_leader(gr, 5, 2s, [size](raft_node& leader_node) {
+                storage::record_batch_builder builder(
+                  model::record_batch_type::raft_data, model::offset(0));
+                builder.add_raw_kv(
+                  {}, bytes_to_iobuf(random_generators::get_bytes(size)));
+                auto rdr = model::make_memory_record_batch_reader(
+                  {std::move(builder).build()});
+                return leader_node.consensus
+                  ->replicate(std::move(rdr), default_replicate_opts)
+                  .then([](result<raft::replicate_result> res) {
+                      return res.has_value();
+                  });
+            }).get0();
+        if (!success) {
+            return false;
+        }
+    }
+    return true;
+}
+
+FIXTURE_TEST(test_pipelined_recovery, raft_test_fixture) {
+    auto reset_window = set_pipelined_window();
+    raft_group gr = raft_group(raft::group_id(0), 3);
+    gr.set_append_entries_delay(pipelined_rtt);
+    gr.enable_all();
+    auto leader_id = wait_for_group_leader(gr);
+    model::node_id disabled_id;
+    for (auto& [id, _] : gr.get_members()) {
+        if (leader_id != id) {
+            disabled_id = id;
+            gr.disable_node(id);
+            break;
+        }
+    }
+    BOOST_REQUIRE(replicate_batches_of_size(gr, 40, 16_KiB));
+
+    gr.enable_node(disabled_id);
+    wait_for(
+      10s,
+      [this, &gr] { return are_all_commit_indexes_the_same(gr); },
+      "After recovery state is consistent");
+    validate_logs_replication(gr);
+
+    // recovery requests were pipelined, up to the window size
+    const auto& inflight = gr.get_append_entries_inflight();
+    BOOST_REQUIRE_GT(inflight.max.at(disabled_id), 1);
+    BOOST_REQUIRE_LE(inflight.max.at(disabled_id), pipelined_window);
+};
+
+FIXTURE_TEST(test_pipelined_recovery_of_diverged_follower, raft_test_fixture) {
+    auto reset_window = set_pipelined_window();
+    raft_group gr = raft_group(raft::group_id(0), 3);
+    gr.set_append_entries_delay(pipelined_rtt);
+    gr.enable_all();
+    auto first_leader_id = wait_for_group_leader(gr);
+    BOOST_REQUIRE(replicate_batches_of_size(gr, 5, 16_KiB));
+    validate_logs_replication(gr);
+
+    // isolated leader appends entries that are never committed
+    std::vector<model::node_id> followers;
+    for (auto& [id, _] : gr.get_members()) {
+        if (id != first_leader_id) {
+            followers.push_back(id);
+        }
+    }
+    for (auto id : followers) {
+        gr.disable_node(id);
+    }
+    auto leader_raft = gr.get_member(first_leader_id).consensus;
+    for (int i = 0; i < 10; ++i) {
+        leader_raft
+          ->replicate(
+            random_batches_reader(2),
+            raft::replicate_options(raft::consistency_level::leader_ack))
+          .get0();
+    }
+    gr.disable_node(first_leader_id);
+
+    // new leader writes a longer log in a higher term
+    for (auto id : followers) {
+        gr.enable_node(id);
+    }
+    BOOST_REQUIRE(replicate_batches_of_size(gr, 30, 16_KiB));
+
+    // follower rejects the pipelined requests and truncates its log
+    gr.enable_node(first_leader_id);
+    wait_for(
+      10s,
+      [this, &gr] { return are_all_commit_indexes_the_same(gr); },
+      "After recovery state is consistent");
+    validate_logs_replication(gr);
+};
+
+FIXTURE_TEST(test_pipelined_recovery_with_reconnect, raft_test_fixture) {
+    auto reset_window = set_pipelined_window();
+    raft_group gr = raft_group(raft::group_id(0), 3);
+    gr.set_append_entries_delay(pipelined_rtt);
+    gr.enable_all();
+    auto leader_id = wait_for_group_leader(gr);
+    model::node_id disabled_id;
+    for (auto& [id, _] : gr.get_members()) {
+        if (leader_id != id) {
+            disabled_id = id;
+            gr.disable_node(id);
+            break;
+        }
+    }
+    BOOST_REQUIRE(replicate_batches_of_size(gr, 60, 16_KiB));
+
+    // restart the follower while recovery requests are in flight
+    gr.enable_node(disabled_id);
+    tests::cooperative_spin_wait_with_timeout(10s, [&gr, disabled_id] {
+        const auto& inflight = gr.get_append_entries_inflight();
+        auto it = inflight.current.find(disabled_id);
+        return it != inflight.current.end() && it->second > 1;
+    }).get0();
+    gr.disable_node(disabled_id);
+    gr.enable_node(disabled_id);
+
+    BOOST_REQUIRE(replicate_batches_of_size(gr, 5, 16_KiB));
+    wait_for(
+      10s,
+      [this, &gr] { return are_all_commit_indexes_the_same(gr); },
+      "After recovery state is consistent");
+    validate_logs_replication(gr);
+};
+
 FIXTURE_TEST(test_append_entries_with_relaxed_consistency, raft_test_fixture) {
     raft_group gr = raft_group(raft::group_id(0), 3);
     gr.enable_all();
@@ -656,6 +852,91 @@ FIXTURE_TEST(test_snapshot_recovery_last_config, raft_test_fixture) {
     validate_logs_replication(gr);
 };
 
+struct snapshot_chunks_test_fixture : public raft_test_fixture {
+    // small chunks so that the snapshot spans many of them
+    void recover_from_snapshot_chunks(bool resumable) {
+        config::shard_local_cfg()
+          .get("raft_snapshot_chunk_size")
+          .set_value(size_t(4_KiB));
+        config::shard_local_cfg()
+          .get("raft_snapshot_max_inflight_chunks")
+          .set_value(size_t(8));
+        config::shard_local_cfg()
+          .get("raft_snapshot_resumable_transfer")
+          .set_value(resumable);
+        auto reset_snapshot_cfg = ss::defer([] {
+            config::shard_local_cfg()
+              .get("raft_snapshot_chunk_size")
+              .set_value(size_t(128_KiB));
+            config::shard_local_cfg()
+              .get("raft_snapshot_max_inflight_chunks")
+              .set_value(size_t(4));
+            config::shard_local_cfg()
+              .get("raft_snapshot_resumable_transfer")
+              .set_value(false);
+        });
+        raft_group gr = raft_group(raft::group_id(0), 3);
+        gr.enable_all();
+        auto leader_id = wait_for_group_leader(gr);
+        model::node_id disabled_id;
+        for (auto& [id, _] : gr.get_members()) {
+            // disable one of the non leader nodes
+            if (leader_id != id) {
+                disabled_id = id;
+                gr.disable_node(id);
+                break;
+            }
+        }
+        bool success = replicate_random_batches(gr, 5).get0();
+        BOOST_REQUIRE(success);
+        validate_logs_replication(gr);
+
+        tests::cooperative_spin_wait_with_timeout(2s, [&gr] {
+            auto offset
+              = gr.get_members().begin()->second.consensus->committed_offset();
+            if (offset <= model::offset(0)) {
+                return false;
+            }
+            return are_all_commit_indexes_the_same(gr);
+        }).get0();
+
+        // store snapshot spanning many chunks
+        auto snapshot_data = bytes_to_iobuf(
+          random_generators::get_bytes(100'000));
+        for (auto& [_, member] : gr.get_members()) {
+            member.consensus
+              ->write_snapshot(raft::write_snapshot_cfg(
+                get_leader_raft(gr)->committed_offset(),
+                snapshot_data.copy(),
+                raft::write_snapshot_cfg::should_prefix_truncate::yes))
+              .get0();
+        }
+        gr.enable_node(disabled_id);
+        success = replicate_random_batches(gr, 5).get0();
+        BOOST_REQUIRE(success);
+
+        wait_for(
+          10s,
+          [this, &gr] { return are_all_commit_indexes_the_same(gr); },
+          "After recovery state is consistent");
+
+        validate_logs_replication(gr);
+    }
+};
+
+FIXTURE_TEST(
+  test_snapshot_recovery_multiple_chunks, snapshot_chunks_test_fixture) {
+    // several chunks are in flight
+    recover_from_snapshot_chunks(true);
+};
+
+FIXTURE_TEST(
+  test_snapshot_recovery_multiple_chunks_not_resumable,
+  snapshot_chunks_test_fixture) {
+    // chunks sent one at a time, as expected by older followers
+    recover_from_snapshot_chunks(false);
+};
+
 FIXTURE_TEST(test_last_visible_offset_relaxed_consistency, raft_test_fixture) {
     raft_group gr = raft_group(raft::group_id(0), 3);
     gr.enable_all();
@@ -764,6 +1045,144 @@ FIXTURE_TEST(test_linarizable_barrier_single_node, raft_test_fixture) {
     }
 };
 
+FIXTURE_TEST(test_linarizable_barrier_with_leader_lease, raft_test_fixture) {
+    config::shard_local_cfg().get("raft_enable_leader_lease").set_value(true);
+    auto reset_lease = ss::defer([] {
+        config::shard_local_cfg()
+          .get("raft_enable_leader_lease")
+          .set_value(false);
+    });
+    raft_group gr = raft_group(raft::group_id(0), 3);
+    gr.enable_all();
+    auto leader_id = wait_for_group_leader(gr);
+
+    bool success = replicate_random_batches(gr, 5).get0();
+    BOOST_REQUIRE(success);
+
+    leader_id = wait_for_group_leader(gr);
+    auto leader_raft = gr.get_member(leader_id).consensus;
+    wait_for(
+      10s,
+      [leader_raft] { return leader_raft->has_valid_leader_lease(); },
+      "Leader holds a lease");
+
+    // served locally, the commit index is the one of the leader
+    auto r = leader_raft->linearizable_barrier().get();
+    BOOST_REQUIRE(r);
+    BOOST_REQUIRE_EQUAL(r.value(), leader_raft->committed_offset());
+};
+
+FIXTURE_TEST(test_linarizable_barrier_after_lease_lapsed, raft_test_fixture) {
+    config::shard_local_cfg().get("raft_enable_leader_lease").set_value(true);
+    auto reset_lease = ss::defer([] {
+        config::shard_local_cfg()
+          .get("raft_enable_leader_lease")
+          .set_value(false);
+    });
+    raft_group gr = raft_group(raft::group_id(0), 3);
+    gr.enable_all();
+    auto leader_id = wait_for_group_leader(gr);
+
+    bool success = replicate_random_batches(gr, 5).get0();
+    BOOST_REQUIRE(success);
+
+    leader_id = wait_for_group_leader(gr);
+    auto leader_raft = gr.get_member(leader_id).consensus;
+    wait_for(
+      10s,
+      [leader_raft] { return leader_raft->has_valid_leader_lease(); },
+      "Leader holds a lease");
+
+    // followers stop acknowledging the leader
+    std::vector<model::node_id> followers;
+    for (auto& [id, _] : gr.get_members()) {
+        if (id != leader_id) {
+            followers.push_back(id);
+        }
+    }
+    for (auto id : followers) {
+        gr.disable_node(id);
+    }
+    wait_for(
+      10s,
+      [leader_raft] { return !leader_raft->has_valid_leader_lease(); },
+      "Leader lease lapsed");
+
+    // barrier falls back to the round of heartbeats which can not reach the
+    // majority
+    auto barrier = leader_raft->linearizable_barrier();
+    ss::sleep(1s).get();
+    BOOST_REQUIRE(!barrier.available());
+
+    for (auto id : followers) {
+        gr.enable_node(id);
+    }
+    // either confirmed by the followers or failed if they elected a new leader
+    barrier.get();
+};
+
+FIXTURE_TEST(test_restarted_follower_withholds_vote, raft_test_fixture) {
+    config::shard_local_cfg().get("raft_enable_leader_lease").set_value(true);
+    auto reset_lease = ss::defer([] {
+        config::shard_local_cfg()
+          .get("raft_enable_leader_lease")
+          .set_value(false);
+    });
+    raft_group gr = raft_group(raft::group_id(0), 3);
+    // long enough for the follower to restart within a single timeout
+    gr.set_election_timeout(2s);
+    gr.enable_all();
+    auto leader_id = wait_for_group_leader(gr);
+
+    bool success = replicate_random_batches(gr, 5).get0();
+    BOOST_REQUIRE(success);
+
+    leader_id = wait_for_group_leader(gr);
+    auto leader_raft = gr.get_member(leader_id).consensus;
+    wait_for(
+      10s,
+      [leader_raft] { return leader_raft->has_valid_leader_lease(); },
+      "Leader holds a lease");
+
+    std::vector<model::node_id> followers;
+    for (auto& [id, _] : gr.get_members()) {
+        if (id != leader_id) {
+            followers.push_back(id);
+        }
+    }
+    // the leader is gone before the restarted follower could hear from it
+    // again, the follower must not forget the lease it acknowledged
+    gr.disable_node(leader_id);
+    gr.disable_node(followers[0]);
+    gr.enable_node(followers[0]);
+
+    auto restarted = gr.get_member(followers[0]).consensus;
+    auto candidate = gr.get_member(followers[1]).consensus;
+    auto meta = candidate->meta();
+    auto reply = restarted
+                   ->vote(raft::vote_request{
+                     .node_id = candidate->self(),
+                     .target_node_id = restarted->self(),
+                     .group = meta.group,
+                     .term = meta.term + model::term_id(1),
+                     .prev_log_index = meta.prev_log_index,
+                     .prev_log_term = meta.prev_log_term,
+                     .leadership_transfer = false})
+                   .get0();
+    BOOST_REQUIRE(!reply.granted);
+
+    // once the lease could have lapsed the remaining nodes elect a leader
+    wait_for(
+      20s,
+      [&gr] {
+          return std::any_of(
+            gr.get_members().begin(),
+            gr.get_members().end(),
+            [](auto& m) { return m.second.consensus->is_leader(); });
+      },
+      "New leader elected");
+};
+
 FIXTURE_TEST(test_big_batches_replication, raft_test_fixture) {
     raft_group gr = raft_group(raft::group_id(0), 1);
     gr.enable_all();
@@ -178,6 +178,23 @@ FIXTURE_TEST(test_prefix_truncation, config_manager_fixture) {
       std::invalid_argument);
 }
 
+FIXTURE_TEST(test_offset_delta, config_manager_fixture) {
+    test_configurations();
+    // configurations at 0, 20, 33, 34, 60 and 1254
+    BOOST_REQUIRE_EQUAL(_cfg_mgr.offset_delta(model::offset(0)), 0);
+    BOOST_REQUIRE_EQUAL(_cfg_mgr.offset_delta(model::offset(1)), 1);
+    BOOST_REQUIRE_EQUAL(_cfg_mgr.offset_delta(model::offset(21)), 2);
+    BOOST_REQUIRE_EQUAL(_cfg_mgr.offset_delta(model::offset(35)), 4);
+    BOOST_REQUIRE_EQUAL(_cfg_mgr.offset_delta(model::offset(2000)), 6);
+
+    // the delta of the offsets that remain in the log does not change
+    _cfg_mgr.prefix_truncate(model::offset(30)).get0();
+    BOOST_REQUIRE_EQUAL(_cfg_mgr.offset_delta(model::offset(30)), 2);
+    BOOST_REQUIRE_EQUAL(_cfg_mgr.offset_delta(model::offset(33)), 2);
+    BOOST_REQUIRE_EQUAL(_cfg_mgr.offset_delta(model::offset(35)), 4);
+    BOOST_REQUIRE_EQUAL(_cfg_mgr.offset_delta(model::offset(2000)), 6);
+}
+
 FIXTURE_TEST(test_truncation, config_manager_fixture) {
     auto configurations = test_configurations();
 
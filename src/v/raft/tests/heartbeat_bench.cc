@@ -0,0 +1,116 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "config/configuration.h"
+#include "random/generators.h"
+#include "raft/types.h"
+#include "reflection/async_adl.h"
+
+#include <seastar/testing/perf_tests.hh>
+
+#include <vector>
+
+/*
+ * heartbeat request serialization with the varint and Stream VByte encodings
+ * of the heartbeat columns. a request carries heartbeats of all the groups
+ * led by a node and followed by the target node.
+ */
+template<size_t Groups>
+struct heartbeat_bench {
+    heartbeat_bench() {
+        request.heartbeats.reserve(Groups);
+        for (size_t i = 0; i < Groups; ++i) {
+            auto commit_index = model::offset(
+              random_generators::get_int<int64_t>(0, 10'000'000));
+            auto term = model::term_id(random_generators::get_int(1, 10));
+            request.heartbeats.push_back(raft::heartbeat_metadata{
+              .meta = raft::protocol_metadata{
+                .group = raft::group_id(i),
+                .commit_index = commit_index,
+                .term = term,
+                .prev_log_index = commit_index
+                                  + model::offset(
+                                    random_generators::get_int(0, 10)),
+                .prev_log_term = term,
+                .last_visible_index = commit_index},
+              .node_id = raft::vnode(
+                model::node_id(1),
+                model::revision_id(random_generators::get_int(0, 1000))),
+              .target_node_id = raft::vnode(
+                model::node_id(2),
+                model::revision_id(random_generators::get_int(0, 1000)))});
+        }
+    }
+
+    static void set_stream_vbyte(bool enabled) {
+        config::shard_local_cfg()
+          .get("raft_heartbeat_stream_vbyte")
+          .set_value(enabled);
+    }
+
+    iobuf serialize() {
+        iobuf buf;
+        reflection::async_adl<raft::heartbeat_request>{}
+          .to(buf, raft::heartbeat_request{request.heartbeats})
+          .get();
+        return buf;
+    }
+
+    size_t encode(bool stream_vbyte) {
+        set_stream_vbyte(stream_vbyte);
+        raft::heartbeat_request r{request.heartbeats};
+        iobuf buf;
+        perf_tests::start_measuring_time();
+        reflection::async_adl<raft::heartbeat_request>{}
+          .to(buf, std::move(r))
+          .get();
+        perf_tests::do_not_optimize(buf);
+        perf_tests::stop_measuring_time();
+        return Groups;
+    }
+
+    size_t decode(bool stream_vbyte) {
+        set_stream_vbyte(stream_vbyte);
+        iobuf_parser parser(serialize());
+        perf_tests::start_measuring_time();
+        auto r = reflection::async_adl<raft::heartbeat_request>{}
+                   .from(parser)
+                   .get0();
+        perf_tests::do_not_optimize(r);
+        perf_tests::stop_measuring_time();
+        return Groups;
+    }
+
+    raft::heartbeat_request request;
+};
+
+using heartbeats_1k = heartbeat_bench<1'000>;
+using heartbeats_10k = heartbeat_bench<10'000>;
+using heartbeats_100k = heartbeat_bench<100'000>;
+using heartbeats_1m = heartbeat_bench<1'000'000>;
+
+PERF_TEST_F(heartbeats_1k, encode_varint) { return encode(false); }
+PERF_TEST_F(heartbeats_1k, encode_stream_vbyte) { return encode(true); }
+PERF_TEST_F(heartbeats_1k, decode_varint) { return decode(false); }
+PERF_TEST_F(heartbeats_1k, decode_stream_vbyte) { return decode(true); }
+
+PERF_TEST_F(heartbeats_10k, encode_varint) { return encode(false); }
+PERF_TEST_F(heartbeats_10k, encode_stream_vbyte) { return encode(true); }
+PERF_TEST_F(heartbeats_10k, decode_varint) { return decode(false); }
+PERF_TEST_F(heartbeats_10k, decode_stream_vbyte) { return decode(true); }
+
+PERF_TEST_F(heartbeats_100k, encode_varint) { return encode(false); }
+PERF_TEST_F(heartbeats_100k, encode_stream_vbyte) { return encode(true); }
+PERF_TEST_F(heartbeats_100k, decode_varint) { return decode(false); }
+PERF_TEST_F(heartbeats_100k, decode_stream_vbyte) { return decode(true); }
+
+PERF_TEST_F(heartbeats_1m, encode_varint) { return encode(false); }
+PERF_TEST_F(heartbeats_1m, encode_stream_vbyte) { return encode(true); }
+PERF_TEST_F(heartbeats_1m, decode_varint) { return decode(false); }
+PERF_TEST_F(heartbeats_1m, decode_stream_vbyte) { return decode(true); }
@@ -7,12 +7,17 @@
 // the Business Source License, use of this software will be governed
 // by the Apache License, Version 2.0
 
+#include "config/configuration.h"
 #include "finjector/hbadger.h"
 #include "model/metadata.h"
 #include "model/timeout_clock.h"
+#include "raft/node_liveness.h"
 #include "raft/tests/raft_group_fixture.h"
 #include "raft/types.h"
 
+#include <seastar/core/timer.hh>
+#include <seastar/util/defer.hh>
+
 FIXTURE_TEST(test_single_node_group, raft_test_fixture) {
     raft_group gr = raft_group(raft::group_id(0), 1);
     gr.enable_all();
@@ -110,4 +115,76 @@ FIXTURE_TEST(
     // wait for next leader to be elected after recovery
     wait_for_group_leader(gr);
     assert_at_most_one_leader(gr);
-};
\ No newline at end of file
+};
+
+static void enable_quiescence() {
+    config::shard_local_cfg().get("raft_enable_quiescence").set_value(true);
+    config::shard_local_cfg()
+      .get("raft_quiescence_idle_intervals")
+      .set_value(size_t(2));
+}
+
+static void disable_quiescence() {
+    config::shard_local_cfg().get("raft_enable_quiescence").set_value(false);
+    config::shard_local_cfg()
+      .get("raft_quiescence_idle_intervals")
+      .set_value(size_t(10));
+}
+
+FIXTURE_TEST(test_quiesced_group_keeps_its_leader, raft_test_fixture) {
+    enable_quiescence();
+    auto reset = ss::defer([] { disable_quiescence(); });
+    raft_group gr = raft_group(raft::group_id(0), 3);
+    gr.enable_all();
+    auto leader_id = wait_for_group_leader(gr);
+    validate_logs_replication(gr);
+
+    // idle group is quiesced, followers must not start an election
+    wait_for(
+      10s,
+      [&gr, leader_id] {
+          return gr.get_member(leader_id).hbeats->quiesced_groups() == 1;
+      },
+      "group is quiesced");
+    assert_stable_leadership(gr, 10);
+
+    // followers of quiesced group must detect leader failure
+    gr.disable_node(leader_id);
+    auto new_leader_id = wait_for_group_leader(gr);
+    BOOST_REQUIRE_NE(leader_id, new_leader_id);
+};
+
+FIXTURE_TEST(test_quiesced_group_leader_node_restart, raft_test_fixture) {
+    enable_quiescence();
+    auto reset = ss::defer([] { disable_quiescence(); });
+    raft_group gr = raft_group(raft::group_id(0), 3);
+    gr.enable_all();
+    auto leader_id = wait_for_group_leader(gr);
+    validate_logs_replication(gr);
+
+    wait_for(
+      10s,
+      [&gr, leader_id] {
+          return gr.get_member(leader_id).hbeats->quiesced_groups() == 1;
+      },
+      "group is quiesced");
+
+    // the groups still led by the restarted node keep its liveness fresh
+    ss::timer<> liveness([leader_id] {
+        raft::shard_local_node_liveness().heartbeat(leader_id);
+    });
+    liveness.arm_periodic(100ms);
+
+    // group comes back as a follower on the restarted node, a new leader must
+    // be elected even though the node is alive
+    gr.disable_node(leader_id);
+    gr.enable_node(leader_id);
+    wait_for(
+      10s,
+      [&gr] {
+          auto id = gr.get_leader_id();
+          return id && gr.get_member(*id).consensus->is_leader();
+      },
+      "new leader elected after leader node restart");
+    assert_at_most_one_leader(gr);
+};
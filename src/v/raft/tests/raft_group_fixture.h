@@ -34,16 +34,19 @@
 #include "storage/tests/utils/random_batch.h"
 #include "storage/types.h"
 #include "test_utils/fixture.h"
+#include "vassert.h"
 
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/sleep.hh>
 #include <seastar/net/socket_defs.hh>
 #include <seastar/util/noncopyable_function.hh>
 
+#include <absl/container/flat_hash_map.h>
 #include <boost/range/iterator_range_core.hpp>
 #include <fmt/core.h>
 
 #include <chrono>
+#include <limits>
 
 inline ss::logger tstlog("raft_test");
 
@@ -73,6 +76,72 @@ struct consume_to_vector {
     std::vector<model::record_batch> batches;
 };
 
+/// Number of append entries requests in flight to every follower of a group,
+/// current and the highest seen
+struct append_entries_inflight {
+    absl::flat_hash_map<model::node_id, size_t> current;
+    absl::flat_hash_map<model::node_id, size_t> max;
+};
+
+/// Delays delivery of append entries replies to simulate the network round
+/// trip time between the leader and its followers
+struct delayed_append_entries_protocol final
+  : raft::consensus_client_protocol::impl {
+    delayed_append_entries_protocol(
+      raft::consensus_client_protocol protocol,
+      std::chrono::milliseconds delay,
+      ss::lw_shared_ptr<append_entries_inflight> inflight)
+      : _protocol(std::move(protocol))
+      , _delay(delay)
+      , _inflight(std::move(inflight)) {}
+
+    ss::future<result<raft::vote_reply>> vote(
+      model::node_id n, raft::vote_request&& r, rpc::client_opts o) final {
+        return _protocol.vote(n, std::move(r), std::move(o));
+    }
+
+    ss::future<result<raft::append_entries_reply>> append_entries(
+      model::node_id n,
+      raft::append_entries_request&& r,
+      rpc::client_opts o) final {
+        auto current = ++_inflight->current[n];
+        auto& max = _inflight->max[n];
+        max = std::max(max, current);
+        return _protocol.append_entries(n, std::move(r), std::move(o))
+          .then([delay = _delay](result<raft::append_entries_reply> reply) {
+              return ss::sleep(delay).then(
+                [reply = std::move(reply)]() mutable {
+                    return std::move(reply);
+                });
+          })
+          .finally([inflight = _inflight, n] { --inflight->current[n]; });
+    }
+
+    ss::future<result<raft::heartbeat_reply>> heartbeat(
+      model::node_id n, raft::heartbeat_request&& r, rpc::client_opts o) final {
+        return _protocol.heartbeat(n, std::move(r), std::move(o));
+    }
+
+    ss::future<result<raft::install_snapshot_reply>> install_snapshot(
+      model::node_id n,
+      raft::install_snapshot_request&& r,
+      rpc::client_opts o) final {
+        return _protocol.install_snapshot(n, std::move(r), std::move(o));
+    }
+
+    ss::future<result<raft::timeout_now_reply>> timeout_now(
+      model::node_id n,
+      raft::timeout_now_request&& r,
+      rpc::client_opts o) final {
+        return _protocol.timeout_now(n, std::move(r), std::move(o));
+    }
+
+private:
+    raft::consensus_client_protocol _protocol;
+    std::chrono::milliseconds _delay;
+    ss::lw_shared_ptr<append_entries_inflight> _inflight;
+};
+
 struct raft_node {
     using log_t = std::vector<model::record_batch>;
     using leader_clb_t
@@ -88,7 +157,10 @@ struct raft_node {
       storage::log_config::storage_type storage_type,
       leader_clb_t l_clb,
       model::cleanup_policy_bitflags cleanup_policy,
-      size_t segment_size)
+      size_t segment_size,
+      std::chrono::milliseconds append_entries_delay = 0ms,
+      ss::lw_shared_ptr<append_entries_inflight> inflight
+      = ss::make_lw_shared<append_entries_inflight>())
       : broker(std::move(broker))
       , leader_callback(std::move(l_clb)) {
         cache.start().get();
@@ -121,6 +193,12 @@ struct raft_node {
 
         // setup consensus
         auto self_id = broker.id();
+        auto protocol = raft::make_rpc_client_protocol(self_id, cache);
+        if (append_entries_delay > 0ms) {
+            protocol = raft::make_consensus_client_protocol<
+              delayed_append_entries_protocol>(
+              std::move(protocol), append_entries_delay, std::move(inflight));
+        }
         consensus = ss::make_lw_shared<raft::consensus>(
           self_id,
           gr_id,
@@ -129,7 +207,7 @@ struct raft_node {
           *log,
           seastar::default_priority_class(),
           std::chrono::seconds(10),
-          raft::make_rpc_client_protocol(self_id, cache),
+          std::move(protocol),
           [this](raft::leadership_status st) { leader_callback(st); },
           storage.local());
 
@@ -321,6 +399,18 @@ struct raft_group {
       , _storage_dir("test.raft." + random_generators::gen_alphanum_string(6))
       , _cleanup_policy(cleanup_policy)
       , _segment_size(segment_size) {
+        // groups running side by side must not share the rpc ports
+        vassert(
+          size <= max_group_size,
+          "group size {} exceeds max group size {}",
+          size,
+          max_group_size);
+        vassert(
+          base_port + (id() + 1) * max_group_size
+            <= std::numeric_limits<uint16_t>::max(),
+          "rpc ports of group {} exceed the port range",
+          id);
+        base_port += static_cast<uint16_t>(id() * max_group_size);
         std::vector<model::broker> brokers;
         for (auto i : boost::irange(0, size)) {
             _initial_brokers.push_back(make_broker(model::node_id(i)));
@@ -332,6 +422,10 @@ struct raft_group {
     }
 
     model::broker make_broker(model::node_id id) {
+        vassert(
+          id() < max_group_size,
+          "node {} is out of the rpc port range of the group",
+          id);
         return model::broker(
           model::node_id(id),
           unresolved_address("localhost", 9092),
@@ -351,14 +445,16 @@ struct raft_group {
           make_broker(node_id),
           _id,
           raft::group_configuration(_initial_brokers, model::revision_id(0)),
-          raft::timeout_jitter(heartbeat_interval * 2),
+          raft::timeout_jitter(_election_timeout),
           ssx::sformat("{}/{}", _storage_dir, node_id()),
           _storage_type,
           [this, node_id](raft::leadership_status st) {
               election_callback(node_id, st);
           },
           _cleanup_policy,
-          _segment_size);
+          _segment_size,
+          _append_entries_delay,
+          _append_entries_inflight);
         it->second.start();
     }
 
@@ -372,14 +468,16 @@ struct raft_group {
           broker,
           _id,
           raft::group_configuration({}, model::revision_id(0)),
-          raft::timeout_jitter(heartbeat_interval * 2),
+          raft::timeout_jitter(_election_timeout),
           ssx::sformat("{}/{}", _storage_dir, node_id()),
           _storage_type,
           [this, node_id](raft::leadership_status st) {
               election_callback(node_id, st);
           },
           _cleanup_policy,
-          _segment_size);
+          _segment_size,
+          _append_entries_delay,
+          _append_entries_inflight);
         it->second.start();
 
         for (auto& [_, n] : _members) {
@@ -468,7 +566,24 @@ struct raft_group {
 
     const ss::sstring& get_data_dir() const { return _storage_dir; }
 
+    /// applies to the nodes enabled after the call
+    void set_append_entries_delay(std::chrono::milliseconds delay) {
+        _append_entries_delay = delay;
+    }
+
+    /// applies to the nodes enabled after the call
+    void set_election_timeout(std::chrono::milliseconds timeout) {
+        _election_timeout = timeout;
+    }
+
+    /// append entries requests in flight, tracked when the replies are
+    /// delayed
+    const append_entries_inflight& get_append_entries_inflight() const {
+        return *_append_entries_inflight;
+    }
+
 private:
+    static constexpr int max_group_size = 16;
     uint16_t base_port = 35000;
     raft::group_id _id;
     members_t _members;
@@ -480,6 +595,10 @@ private:
     ss::sstring _storage_dir;
     model::cleanup_policy_bitflags _cleanup_policy;
     size_t _segment_size;
+    std::chrono::milliseconds _append_entries_delay{0};
+    std::chrono::milliseconds _election_timeout{heartbeat_interval * 2};
+    ss::lw_shared_ptr<append_entries_inflight> _append_entries_inflight
+      = ss::make_lw_shared<append_entries_inflight>();
 };
 
 static model::record_batch_reader random_batches_reader(int max_batches) {
@@ -0,0 +1,232 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "config/configuration.h"
+#include "raft/tests/raft_group_fixture.h"
+#include "storage/tests/utils/random_batch.h"
+#include "utils/hdr_hist.h"
+
+#include <seastar/core/memory.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/testing/perf_tests.hh>
+
+#include <fmt/ostream.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// three node group with append entries replies delayed by the simulated
+// round trip time, the window limits the number of append entries requests in
+// flight to a single follower
+template<size_t window, int rtt_ms>
+struct replication_bench {
+    static constexpr int producers = 64;
+    static constexpr int recovery_batches = 200;
+
+    replication_bench()
+      : group(raft::group_id(0), 3) {
+        config::shard_local_cfg().get("disable_metrics").set_value(true);
+        config::shard_local_cfg()
+          .get("raft_max_inflight_append_entries_requests")
+          .set_value(window);
+        group.set_append_entries_delay(std::chrono::milliseconds(rtt_ms));
+        group.enable_all();
+        leader = wait_for_group_leader(group);
+    }
+
+    raft_node& leader_node() { return group.get_member(leader); }
+
+    model::node_id follower() const {
+        return leader == model::node_id(0) ? model::node_id(1)
+                                           : model::node_id(0);
+    }
+
+    void replicate(int count) {
+        std::vector<ss::future<result<raft::replicate_result>>> f;
+        f.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            f.push_back(leader_node().consensus->replicate(
+              random_batches_reader(1), default_replicate_opts));
+        }
+        ss::when_all_succeed(f.begin(), f.end()).get();
+    }
+
+    void wait_for_follower(model::node_id id) {
+        auto& node = group.get_member(id);
+        while (node.log->offsets().dirty_offset
+               < leader_node().log->offsets().dirty_offset) {
+            ss::sleep(std::chrono::milliseconds(1)).get();
+        }
+    }
+
+    raft_group group;
+    model::node_id leader;
+};
+
+// concurrent producers replicating to all followers
+template<typename Bench>
+size_t replicate_test(Bench& b) {
+    perf_tests::start_measuring_time();
+    b.replicate(Bench::producers);
+    perf_tests::stop_measuring_time();
+    return Bench::producers;
+}
+
+// follower catching up with the leader after it was down
+template<typename Bench>
+size_t recovery_test(Bench& b) {
+    auto id = b.follower();
+    b.group.disable_node(id);
+    b.replicate(Bench::recovery_batches);
+    b.group.enable_node(id);
+    perf_tests::start_measuring_time();
+    b.wait_for_follower(id);
+    perf_tests::stop_measuring_time();
+    return Bench::recovery_batches;
+}
+
+using rtt_1ms_window_1 = replication_bench<1, 1>;
+using rtt_1ms_window_16 = replication_bench<16, 1>;
+using rtt_10ms_window_1 = replication_bench<1, 10>;
+using rtt_10ms_window_16 = replication_bench<16, 10>;
+
+PERF_TEST_F(rtt_1ms_window_1, replicate) { return replicate_test(*this); }
+PERF_TEST_F(rtt_1ms_window_16, replicate) { return replicate_test(*this); }
+PERF_TEST_F(rtt_10ms_window_1, replicate) { return replicate_test(*this); }
+PERF_TEST_F(rtt_10ms_window_16, replicate) { return replicate_test(*this); }
+
+PERF_TEST_F(rtt_1ms_window_1, recovery) { return recovery_test(*this); }
+PERF_TEST_F(rtt_1ms_window_16, recovery) { return recovery_test(*this); }
+PERF_TEST_F(rtt_10ms_window_1, recovery) { return recovery_test(*this); }
+PERF_TEST_F(rtt_10ms_window_16, recovery) { return recovery_test(*this); }
+
+// in-process cluster load, `groups` three node groups replicating side by
+// side with every producer appending batches of `records` records. all the
+// groups share the reactor, the rpc traffic goes over the loopback
+// interface. besides the throughput reported by perf_tests the harness prints
+// the replicate latency percentiles, the allocations per batch and the
+// reactor utilization of the measured runs when it is destroyed.
+template<size_t groups, int records, raft::consistency_level level>
+struct cluster_load_bench {
+    using clock_type = std::chrono::steady_clock;
+    static constexpr int producers_per_group = 16;
+
+    cluster_load_bench() {
+        config::shard_local_cfg().get("disable_metrics").set_value(true);
+        _groups.reserve(groups);
+        _leaders.reserve(groups);
+        for (size_t i = 0; i < groups; ++i) {
+            _groups.push_back(
+              std::make_unique<raft_group>(raft::group_id(i), 3));
+            _groups.back()->enable_all();
+        }
+        for (auto& g : _groups) {
+            _leaders.push_back(wait_for_group_leader(*g));
+        }
+    }
+
+    cluster_load_bench(const cluster_load_bench&) = delete;
+    cluster_load_bench& operator=(const cluster_load_bench&) = delete;
+
+    ~cluster_load_bench() {
+        if (_batches == 0) {
+            return;
+        }
+        auto elapsed = std::chrono::duration<double>(_elapsed).count();
+        auto busy = std::chrono::duration<double>(_busy).count();
+        fmt::print(
+          "groups: {}, records per batch: {}, consistency: {}\n"
+          "  batches: {}, failed: {}, throughput: {:.2f} MiB/s\n"
+          "  replicate latency p50: {}us, p99: {}us\n"
+          "  allocations per batch: {:.1f}, reactor utilization: {:.1f}%\n",
+          groups,
+          records,
+          level,
+          _batches,
+          _failed,
+          elapsed > 0 ? double(_bytes) / (1024 * 1024) / elapsed : 0,
+          _latency.get_value_at(50.0),
+          _latency.get_value_at(99.0),
+          double(_mallocs) / double(_batches),
+          elapsed > 0 ? busy / elapsed * 100 : 0);
+    }
+
+    size_t run() {
+        std::vector<ss::future<>> f;
+        f.reserve(groups * producers_per_group);
+        const auto mallocs = ss::memory::stats().mallocs();
+        const auto busy = ss::engine().total_busy_time();
+        const auto start = clock_type::now();
+        perf_tests::start_measuring_time();
+        for (size_t i = 0; i < groups; ++i) {
+            for (int p = 0; p < producers_per_group; ++p) {
+                f.push_back(replicate(i));
+            }
+        }
+        ss::when_all_succeed(f.begin(), f.end()).get();
+        perf_tests::stop_measuring_time();
+        _elapsed += clock_type::now() - start;
+        _busy += ss::engine().total_busy_time() - busy;
+        _mallocs += ss::memory::stats().mallocs() - mallocs;
+        _batches += f.size();
+        return f.size();
+    }
+
+    ss::future<> replicate(size_t idx) {
+        auto batch = storage::test::make_random_batch(
+          model::offset(0), records, false);
+        batch.set_term(model::term_id(0));
+        _bytes += batch.size_bytes();
+        ss::circular_buffer<model::record_batch> batches;
+        batches.push_back(std::move(batch));
+        auto& leader = _groups[idx]->get_member(_leaders[idx]);
+        auto m = _latency.auto_measure();
+        return leader.consensus
+          ->replicate(
+            model::make_memory_record_batch_reader(std::move(batches)),
+            raft::replicate_options(level))
+          .then([this, m = std::move(m)](result<raft::replicate_result> r) {
+              if (!r) {
+                  ++_failed;
+              }
+          });
+    }
+
+    std::vector<std::unique_ptr<raft_group>> _groups;
+    std::vector<model::node_id> _leaders;
+    hdr_hist _latency;
+    clock_type::duration _elapsed{0};
+    std::chrono::nanoseconds _busy{0};
+    uint64_t _mallocs{0};
+    uint64_t _batches{0};
+    uint64_t _failed{0};
+    uint64_t _bytes{0};
+};
+
+using load_1_group_small_quorum
+  = cluster_load_bench<1, 1, raft::consistency_level::quorum_ack>;
+using load_1_group_large_quorum
+  = cluster_load_bench<1, 100, raft::consistency_level::quorum_ack>;
+using load_1_group_small_leader
+  = cluster_load_bench<1, 1, raft::consistency_level::leader_ack>;
+using load_16_groups_small_quorum
+  = cluster_load_bench<16, 1, raft::consistency_level::quorum_ack>;
+using load_16_groups_large_quorum
+  = cluster_load_bench<16, 100, raft::consistency_level::quorum_ack>;
+using load_16_groups_small_leader
+  = cluster_load_bench<16, 1, raft::consistency_level::leader_ack>;
+
+PERF_TEST_F(load_1_group_small_quorum, replicate) { return run(); }
+PERF_TEST_F(load_1_group_large_quorum, replicate) { return run(); }
+PERF_TEST_F(load_1_group_small_leader, replicate) { return run(); }
+PERF_TEST_F(load_16_groups_small_quorum, replicate) { return run(); }
+PERF_TEST_F(load_16_groups_large_quorum, replicate) { return run(); }
+PERF_TEST_F(load_16_groups_small_leader, replicate) { return run(); }
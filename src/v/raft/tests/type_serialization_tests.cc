@@ -8,6 +8,7 @@
 // by the Apache License, Version 2.0
 
 #include "compression/stream_zstd.h"
+#include "config/configuration.h"
 #include "model/metadata.h"
 #include "model/record.h"
 #include "model/record_batch_reader.h"
@@ -202,6 +203,61 @@ SEASTAR_THREAD_TEST_CASE(heartbeat_request_roundtrip_with_negative) {
           raft::vnode(model::node_id(0), model::revision_id{}));
     }
 }
+SEASTAR_THREAD_TEST_CASE(heartbeat_request_stream_vbyte_roundtrip) {
+    // not a multiple of the codec block size
+    static constexpr int64_t group_count = 10001;
+    config::shard_local_cfg()
+      .get("raft_heartbeat_stream_vbyte")
+      .set_value(true);
+    raft::heartbeat_request req;
+    req.heartbeats = std::vector<raft::heartbeat_metadata>(group_count);
+    for (int64_t i = 0; i < group_count; ++i) {
+        auto& hb = req.heartbeats[i];
+        hb.node_id = raft::vnode(
+          model::node_id(1),
+          model::revision_id(random_generators::get_int(0, 1000)));
+        hb.target_node_id = raft::vnode(
+          model::node_id(2),
+          model::revision_id(random_generators::get_int(0, 1000)));
+        hb.meta.group = raft::group_id(i);
+        hb.meta.commit_index = model::offset(
+          random_generators::get_int<int64_t>(0, 1'000'000'000'000));
+        hb.meta.term = model::term_id(random_generators::get_int(0, 10));
+        hb.meta.prev_log_index = hb.meta.commit_index
+                                 + model::offset(
+                                   random_generators::get_int(0, 100));
+        hb.meta.prev_log_term = hb.meta.term;
+        hb.meta.last_visible_index = hb.meta.commit_index;
+    }
+    absl::flat_hash_map<raft::group_id, raft::heartbeat_metadata> expected;
+    for (const auto& hb : req.heartbeats) {
+        expected.emplace(hb.meta.group, hb);
+    }
+    iobuf buf;
+    reflection::async_adl<raft::heartbeat_request>{}
+      .to(buf, std::move(req))
+      .get();
+    config::shard_local_cfg()
+      .get("raft_heartbeat_stream_vbyte")
+      .set_value(false);
+    BOOST_TEST_MESSAGE("Stream VByte encoded. Buffer size: " << buf);
+    auto parser = iobuf_parser(std::move(buf));
+    auto res
+      = reflection::async_adl<raft::heartbeat_request>{}.from(parser).get0();
+    BOOST_REQUIRE_EQUAL(parser.bytes_left(), 0);
+    BOOST_REQUIRE_EQUAL(res.heartbeats.size(), expected.size());
+    for (const auto& hb : res.heartbeats) {
+        const auto& e = expected[hb.meta.group];
+        BOOST_REQUIRE_EQUAL(hb.meta.commit_index, e.meta.commit_index);
+        BOOST_REQUIRE_EQUAL(hb.meta.term, e.meta.term);
+        BOOST_REQUIRE_EQUAL(hb.meta.prev_log_index, e.meta.prev_log_index);
+        BOOST_REQUIRE_EQUAL(hb.meta.prev_log_term, e.meta.prev_log_term);
+        BOOST_REQUIRE_EQUAL(
+          hb.meta.last_visible_index, e.meta.last_visible_index);
+        BOOST_REQUIRE_EQUAL(hb.node_id, e.node_id);
+        BOOST_REQUIRE_EQUAL(hb.target_node_id, e.target_node_id);
+    }
+}
 SEASTAR_THREAD_TEST_CASE(heartbeat_response_roundtrip) {
     static constexpr int64_t group_count = 10000;
     raft::heartbeat_reply reply;
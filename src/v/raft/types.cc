@@ -9,18 +9,21 @@
 
 #include "raft/types.h"
 
+#include "config/configuration.h"
 #include "model/fundamental.h"
 #include "model/metadata.h"
 #include "raft/consensus_utils.h"
 #include "raft/errc.h"
 #include "raft/group_configuration.h"
 #include "reflection/adl.h"
+#include "utils/stream_vbyte.h"
 #include "utils/to_string.h"
 #include "vassert.h"
 #include "vlog.h"
 
 #include <fmt/ostream.h>
 
+#include <array>
 #include <type_traits>
 
 namespace raft {
@@ -62,6 +65,8 @@ std::ostream& operator<<(std::ostream& o, const follower_index_metadata& i) {
              << ", last_dirty_log_idx: " << i.last_dirty_log_index
              << ", match_index: " << i.match_index
              << ", next_index: " << i.next_index
+             << ", inflight_requests: " << i.inflight_requests
+             << ", inflight_bytes: " << i.inflight_bytes
              << ", is_learner: " << i.is_learner
              << ", is_recovering: " << i.is_recovering << "}";
 }
@@ -131,7 +136,7 @@ std::ostream& operator<<(std::ostream& o, const install_snapshot_request& r) {
       o,
       "{{term: {}, group: {}, target_node_id: {}, node_id: {}, "
       "last_included_index: {}, "
-      "file_offset: {}, chunk_size: {}, done: {}}}",
+      "file_offset: {}, chunk_size: {}, chunk_crc: {}, done: {}}}",
       r.term,
       r.group,
       r.target_node_id,
@@ -139,6 +144,7 @@ std::ostream& operator<<(std::ostream& o, const install_snapshot_request& r) {
       r.last_included_index,
       r.file_offset,
       r.chunk.size_bytes(),
+      r.chunk_crc ? std::to_string(*r.chunk_crc) : "none",
       r.done);
     return o;
 }
@@ -219,6 +225,21 @@ async_adl<raft::append_entries_request>::from(iobuf_parser& in) {
     return ss::make_ready_future<raft::append_entries_request>(std::move(ret));
 }
 
+ss::future<> async_adl<raft::append_entries_batch_request>::to(
+  iobuf& out, raft::append_entries_batch_request&& request) {
+    return detail::async_adl_list<std::vector<raft::append_entries_request>>{}
+      .to(out, std::move(request.requests));
+}
+
+ss::future<raft::append_entries_batch_request>
+async_adl<raft::append_entries_batch_request>::from(iobuf_parser& in) {
+    return detail::async_adl_list<std::vector<raft::append_entries_request>>{}
+      .from(in)
+      .then([](std::vector<raft::append_entries_request> requests) {
+          return raft::append_entries_batch_request{std::move(requests)};
+      });
+}
+
 void adl<raft::protocol_metadata>::to(
   iobuf& out, raft::protocol_metadata request) {
     std::array<bytes::value_type, 6 * vint::max_length> staging{};
@@ -279,6 +300,19 @@ struct hbeat_soa {
     std::vector<model::offset> last_visible_indices;
     std::vector<model::revision_id> revisions;
     std::vector<model::revision_id> target_revisions;
+
+    /// columns in the order of serialization
+    template<typename Func>
+    void for_each_column(Func&& f) const {
+        f(groups);
+        f(commit_indices);
+        f(terms);
+        f(prev_log_indices);
+        f(prev_log_terms);
+        f(last_visible_indices);
+        f(revisions);
+        f(target_revisions);
+    }
 };
 
 struct hbeat_response_array {
@@ -330,6 +364,159 @@ T read_one_varint_delta(iobuf_parser& in, const T& prev) {
     auto dst = varlong_reader<T>(in);
     return prev + dst;
 }
+
+/// set in the heartbeats count of requests with Stream VByte encoded columns
+static constexpr uint32_t stream_vbyte_flag = 1U << 31U;
+/// columns are encoded in blocks of at most this many values, it bounds the
+/// size of the staging buffers
+static constexpr size_t stream_vbyte_block_size = 256;
+
+/// same delta encoding as `encode_one_delta_array`, the zigzag encoded deltas
+/// are written with the Stream VByte codec
+template<typename T>
+void encode_one_stream_vbyte_array(iobuf& o, const std::vector<T>& v) {
+    std::array<uint64_t, stream_vbyte_block_size> deltas;
+    std::array<uint8_t, stream_vbyte::max_encoded_size(stream_vbyte_block_size)>
+      staging;
+    int64_t prev = 0;
+    for (size_t i = 0; i < v.size(); i += stream_vbyte_block_size) {
+        const size_t n = std::min(stream_vbyte_block_size, v.size() - i);
+        for (size_t j = 0; j < n; ++j) {
+            const auto current = static_cast<int64_t>(v[i + j]());
+            deltas[j] = vint::encode_zigzag(current - prev);
+            prev = current;
+        }
+        const size_t sz = stream_vbyte::encode(
+          deltas.data(), n, staging.data());
+        // NOLINTNEXTLINE
+        o.append(reinterpret_cast<const char*>(staging.data()), sz);
+    }
+}
+
+/// decodes `size` values of a column, calls `f(index, value)` for each of them
+template<typename T, typename Func>
+void read_one_stream_vbyte_array(iobuf_parser& in, size_t size, Func&& f) {
+    std::array<uint64_t, stream_vbyte_block_size> deltas;
+    std::array<
+      uint8_t,
+      stream_vbyte::max_encoded_size(stream_vbyte_block_size)
+        + stream_vbyte::decode_padding>
+      staging{};
+    int64_t prev = 0;
+    for (size_t i = 0; i < size; i += stream_vbyte_block_size) {
+        const size_t n = std::min(stream_vbyte_block_size, size - i);
+        const size_t control = stream_vbyte::control_size(n);
+        in.consume_to(control, staging.data());
+        in.consume_to(
+          stream_vbyte::data_size(staging.data(), n),
+          staging.data() + control);
+        stream_vbyte::decode(staging.data(), n, deltas.data());
+        for (size_t j = 0; j < n; ++j) {
+            prev += vint::decode_zigzag(deltas[j]);
+            f(i + j, T(prev));
+        }
+    }
+}
+
+static void read_varint_columns(
+  iobuf_parser& in,
+  raft::heartbeat_request& req,
+  model::node_id node_id,
+  model::node_id target_node) {
+    const size_t max = req.heartbeats.size();
+    req.heartbeats[0].meta.group = varlong_reader<raft::group_id>(in);
+    for (size_t i = 1; i < max; ++i) {
+        req.heartbeats[i].meta.group
+          = internal::read_one_varint_delta<raft::group_id>(
+            in, req.heartbeats[i - 1].meta.group);
+    }
+    req.heartbeats[0].meta.commit_index = varlong_reader<model::offset>(in);
+    for (size_t i = 1; i < max; ++i) {
+        req.heartbeats[i].meta.commit_index
+          = internal::read_one_varint_delta<model::offset>(
+            in, req.heartbeats[i - 1].meta.commit_index);
+    }
+    req.heartbeats[0].meta.term = varlong_reader<model::term_id>(in);
+    for (size_t i = 1; i < max; ++i) {
+        req.heartbeats[i].meta.term
+          = internal::read_one_varint_delta<model::term_id>(
+            in, req.heartbeats[i - 1].meta.term);
+    }
+    req.heartbeats[0].meta.prev_log_index = varlong_reader<model::offset>(in);
+    for (size_t i = 1; i < max; ++i) {
+        req.heartbeats[i].meta.prev_log_index
+          = internal::read_one_varint_delta<model::offset>(
+            in, req.heartbeats[i - 1].meta.prev_log_index);
+    }
+    req.heartbeats[0].meta.prev_log_term = varlong_reader<model::term_id>(in);
+    for (size_t i = 1; i < max; ++i) {
+        req.heartbeats[i].meta.prev_log_term
+          = internal::read_one_varint_delta<model::term_id>(
+            in, req.heartbeats[i - 1].meta.prev_log_term);
+    }
+    req.heartbeats[0].meta.last_visible_index = varlong_reader<model::offset>(
+      in);
+    for (size_t i = 1; i < max; ++i) {
+        req.heartbeats[i].meta.last_visible_index
+          = internal::read_one_varint_delta<model::offset>(
+            in, req.heartbeats[i - 1].meta.last_visible_index);
+    }
+
+    req.heartbeats[0].node_id = raft::vnode(
+      node_id, varlong_reader<model::revision_id>(in));
+    for (size_t i = 1; i < max; ++i) {
+        req.heartbeats[i].node_id = raft::vnode(
+          node_id,
+          internal::read_one_varint_delta<model::revision_id>(
+            in, req.heartbeats[i - 1].node_id.revision()));
+    }
+
+    req.heartbeats[0].target_node_id = raft::vnode(
+      target_node, varlong_reader<model::revision_id>(in));
+    for (size_t i = 1; i < max; ++i) {
+        req.heartbeats[i].target_node_id = raft::vnode(
+          target_node,
+          internal::read_one_varint_delta<model::revision_id>(
+            in, req.heartbeats[i - 1].target_node_id.revision()));
+    }
+}
+
+static void read_stream_vbyte_columns(
+  iobuf_parser& in,
+  raft::heartbeat_request& req,
+  model::node_id node_id,
+  model::node_id target_node) {
+    auto& hbs = req.heartbeats;
+    const size_t max = hbs.size();
+    read_one_stream_vbyte_array<raft::group_id>(
+      in, max, [&hbs](size_t i, raft::group_id v) { hbs[i].meta.group = v; });
+    read_one_stream_vbyte_array<model::offset>(
+      in, max, [&hbs](size_t i, model::offset v) {
+          hbs[i].meta.commit_index = v;
+      });
+    read_one_stream_vbyte_array<model::term_id>(
+      in, max, [&hbs](size_t i, model::term_id v) { hbs[i].meta.term = v; });
+    read_one_stream_vbyte_array<model::offset>(
+      in, max, [&hbs](size_t i, model::offset v) {
+          hbs[i].meta.prev_log_index = v;
+      });
+    read_one_stream_vbyte_array<model::term_id>(
+      in, max, [&hbs](size_t i, model::term_id v) {
+          hbs[i].meta.prev_log_term = v;
+      });
+    read_one_stream_vbyte_array<model::offset>(
+      in, max, [&hbs](size_t i, model::offset v) {
+          hbs[i].meta.last_visible_index = v;
+      });
+    read_one_stream_vbyte_array<model::revision_id>(
+      in, max, [&hbs, node_id](size_t i, model::revision_id v) {
+          hbs[i].node_id = raft::vnode(node_id, v);
+      });
+    read_one_stream_vbyte_array<model::revision_id>(
+      in, max, [&hbs, target_node](size_t i, model::revision_id v) {
+          hbs[i].target_node_id = raft::vnode(target_node, v);
+      });
+}
 } // namespace internal
 
 ss::future<> async_adl<raft::heartbeat_request>::to(
@@ -343,8 +530,10 @@ ss::future<> async_adl<raft::heartbeat_request>::to(
     };
     std::sort(
       request.heartbeats.begin(), request.heartbeats.end(), sorter_fn{});
+    const bool use_stream_vbyte
+      = config::shard_local_cfg().raft_heartbeat_stream_vbyte();
     return ss::make_ready_future<>()
-      .then([&out, request = std::move(request)] {
+      .then([&out, use_stream_vbyte, request = std::move(request)] {
           internal::hbeat_soa encodee(request.heartbeats.size());
           // target physical node id is always the same it differs only by
           // revision
@@ -380,25 +569,23 @@ ss::future<> async_adl<raft::heartbeat_request>::to(
             out, request.heartbeats.front().node_id.id());
           adl<model::node_id>{}.to(
             out, request.heartbeats.front().target_node_id.id());
-          adl<uint32_t>{}.to(out, size);
+          adl<uint32_t>{}.to(
+            out,
+            use_stream_vbyte ? size | internal::stream_vbyte_flag
+                             : uint32_t(size));
 
           return encodee;
       })
-      .then([&out](internal::hbeat_soa encodee) {
-          internal::encode_one_delta_array<raft::group_id>(out, encodee.groups);
-          internal::encode_one_delta_array<model::offset>(
-            out, encodee.commit_indices);
-          internal::encode_one_delta_array<model::term_id>(out, encodee.terms);
-          internal::encode_one_delta_array<model::offset>(
-            out, encodee.prev_log_indices);
-          internal::encode_one_delta_array<model::term_id>(
-            out, encodee.prev_log_terms);
-          internal::encode_one_delta_array<model::offset>(
-            out, encodee.last_visible_indices);
-          internal::encode_one_delta_array<model::revision_id>(
-            out, encodee.revisions);
-          internal::encode_one_delta_array<model::revision_id>(
-            out, encodee.target_revisions);
+      .then([&out, use_stream_vbyte](internal::hbeat_soa encodee) {
+          if (use_stream_vbyte) {
+              encodee.for_each_column([&out](const auto& column) {
+                  internal::encode_one_stream_vbyte_array(out, column);
+              });
+              return;
+          }
+          encodee.for_each_column([&out](const auto& column) {
+              internal::encode_one_delta_array(out, column);
+          });
       });
 }
 
@@ -412,66 +599,16 @@ async_adl<raft::heartbeat_request>::from(iobuf_parser& in) {
     raft::heartbeat_request req;
     auto node_id = adl<model::node_id>{}.from(in);
     auto target_node = adl<model::node_id>{}.from(in);
+    const auto count = adl<uint32_t>{}.from(in);
     req.heartbeats = std::vector<raft::heartbeat_metadata>(
-      adl<uint32_t>{}.from(in));
+      count & ~internal::stream_vbyte_flag);
     if (req.heartbeats.empty()) {
         return ss::make_ready_future<raft::heartbeat_request>(std::move(req));
     }
-    const size_t max = req.heartbeats.size();
-    req.heartbeats[0].meta.group = varlong_reader<raft::group_id>(in);
-    for (size_t i = 1; i < max; ++i) {
-        req.heartbeats[i].meta.group
-          = internal::read_one_varint_delta<raft::group_id>(
-            in, req.heartbeats[i - 1].meta.group);
-    }
-    req.heartbeats[0].meta.commit_index = varlong_reader<model::offset>(in);
-    for (size_t i = 1; i < max; ++i) {
-        req.heartbeats[i].meta.commit_index
-          = internal::read_one_varint_delta<model::offset>(
-            in, req.heartbeats[i - 1].meta.commit_index);
-    }
-    req.heartbeats[0].meta.term = varlong_reader<model::term_id>(in);
-    for (size_t i = 1; i < max; ++i) {
-        req.heartbeats[i].meta.term
-          = internal::read_one_varint_delta<model::term_id>(
-            in, req.heartbeats[i - 1].meta.term);
-    }
-    req.heartbeats[0].meta.prev_log_index = varlong_reader<model::offset>(in);
-    for (size_t i = 1; i < max; ++i) {
-        req.heartbeats[i].meta.prev_log_index
-          = internal::read_one_varint_delta<model::offset>(
-            in, req.heartbeats[i - 1].meta.prev_log_index);
-    }
-    req.heartbeats[0].meta.prev_log_term = varlong_reader<model::term_id>(in);
-    for (size_t i = 1; i < max; ++i) {
-        req.heartbeats[i].meta.prev_log_term
-          = internal::read_one_varint_delta<model::term_id>(
-            in, req.heartbeats[i - 1].meta.prev_log_term);
-    }
-    req.heartbeats[0].meta.last_visible_index = varlong_reader<model::offset>(
-      in);
-    for (size_t i = 1; i < max; ++i) {
-        req.heartbeats[i].meta.last_visible_index
-          = internal::read_one_varint_delta<model::offset>(
-            in, req.heartbeats[i - 1].meta.last_visible_index);
-    }
-
-    req.heartbeats[0].node_id = raft::vnode(
-      node_id, varlong_reader<model::revision_id>(in));
-    for (size_t i = 1; i < max; ++i) {
-        req.heartbeats[i].node_id = raft::vnode(
-          node_id,
-          internal::read_one_varint_delta<model::revision_id>(
-            in, req.heartbeats[i - 1].node_id.revision()));
-    }
-
-    req.heartbeats[0].target_node_id = raft::vnode(
-      target_node, varlong_reader<model::revision_id>(in));
-    for (size_t i = 1; i < max; ++i) {
-        req.heartbeats[i].target_node_id = raft::vnode(
-          target_node,
-          internal::read_one_varint_delta<model::revision_id>(
-            in, req.heartbeats[i - 1].target_node_id.revision()));
+    if (count & internal::stream_vbyte_flag) {
+        internal::read_stream_vbyte_columns(in, req, node_id, target_node);
+    } else {
+        internal::read_varint_columns(in, req, node_id, target_node);
     }
 
     for (auto& hb : req.heartbeats) {
@@ -626,6 +763,58 @@ async_adl<raft::heartbeat_reply>::from(iobuf_parser& in) {
     return ss::make_ready_future<raft::heartbeat_reply>(std::move(reply));
 }
 
+/*
+ * the layout is the one of the original request. the chunk crc is appended
+ * after the last field and its presence is flagged by the highest bit of the
+ * file offset, in the same way as the heartbeat request encoding flag, so
+ * that nodes which do not know the crc can still parse requests without it.
+ * the flag also tells the follower that the leader may have several chunks
+ * in flight and expects the contiguous bytes stored in the reply
+ */
+static constexpr uint64_t snapshot_chunk_crc_flag = uint64_t(1) << 63;
+
+void adl<raft::install_snapshot_request>::to(
+  iobuf& out, raft::install_snapshot_request&& request) {
+    vassert(
+      (request.file_offset & snapshot_chunk_crc_flag) == 0,
+      "Snapshot file offset out of range: {}",
+      request.file_offset);
+    const auto file_offset = request.chunk_crc
+                               ? request.file_offset | snapshot_chunk_crc_flag
+                               : request.file_offset;
+    reflection::serialize(
+      out,
+      request.target_node_id,
+      request.term,
+      request.group,
+      request.node_id,
+      request.last_included_index,
+      file_offset,
+      std::move(request.chunk),
+      request.done);
+    if (request.chunk_crc) {
+        adl<uint32_t>{}.to(out, *request.chunk_crc);
+    }
+}
+
+raft::install_snapshot_request
+adl<raft::install_snapshot_request>::from(iobuf_parser& in) {
+    raft::install_snapshot_request ret;
+    ret.target_node_id = adl<raft::vnode>{}.from(in);
+    ret.term = adl<model::term_id>{}.from(in);
+    ret.group = adl<raft::group_id>{}.from(in);
+    ret.node_id = adl<raft::vnode>{}.from(in);
+    ret.last_included_index = adl<model::offset>{}.from(in);
+    const auto file_offset = adl<uint64_t>{}.from(in);
+    ret.file_offset = file_offset & ~snapshot_chunk_crc_flag;
+    ret.chunk = adl<iobuf>{}.from(in);
+    ret.done = adl<bool>{}.from(in);
+    if (file_offset & snapshot_chunk_crc_flag) {
+        ret.chunk_crc = adl<uint32_t>{}.from(in);
+    }
+    return ret;
+}
+
 raft::snapshot_metadata adl<raft::snapshot_metadata>::from(iobuf_parser& in) {
     auto last_included_index = adl<model::offset>{}.from(in);
     auto last_included_term = adl<model::term_id>{}.from(in);
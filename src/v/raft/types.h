@@ -127,6 +127,22 @@ struct follower_index_metadata {
 
     follower_req_seq last_sent_seq{0};
     follower_req_seq last_received_seq{0};
+    // Leader lease tracking. The oldest request that was sent but is not yet
+    // known to be replied to is the lease probe. A reply to the probe, or to
+    // any later request, proves that the follower recognized the leader at
+    // the time the probe was sent.
+    std::optional<follower_req_seq> lease_probe_seq;
+    clock_type::time_point lease_probe_timestamp;
+    clock_type::time_point lease_ack_timestamp = clock_type::time_point::min();
+    // Append entries requests are pipelined, the number and the size of
+    // requests that were sent to the follower but not yet replied to is
+    // limited by a per follower window.
+    size_t inflight_requests = 0;
+    size_t inflight_bytes = 0;
+    // Snapshot delivery progress. Snapshot chunks stored by the follower are
+    // not sent again when a transfer interrupted by an error is resumed.
+    model::offset snapshot_transfer_index;
+    uint64_t snapshot_bytes_stored = 0;
     bool is_learner = false;
     bool is_recovering = false;
 
@@ -248,6 +264,15 @@ struct heartbeat_metadata {
     vnode target_node_id;
 };
 
+/// append entries requests of many raft groups sent to the same node are
+/// coalesced into a single RPC, the replies are in the order of the requests
+struct append_entries_batch_request {
+    std::vector<append_entries_request> requests;
+};
+struct append_entries_batch_reply {
+    std::vector<append_entries_reply> replies;
+};
+
 /// \brief this is our _biggest_ modification to how raft works
 /// to accomodate for millions of raft groups in a cluster.
 /// internally, the receiving side will simply iterate and dispatch one
@@ -351,6 +376,13 @@ struct install_snapshot_request {
     uint64_t file_offset;
     // snapshot chunk, raw bytes
     iobuf chunk;
+    // crc32c of the chunk, chunks are validated before they are stored so
+    // that a transfer interrupted by a corruption is resumed from the last
+    // stored chunk. sent only when raft_snapshot_resumable_transfer is
+    // enabled, older nodes do not know the field. a chunk without the crc is
+    // handled as by older nodes: chunks are appended in the order they arrive
+    // and the reply carries the size of the chunk
+    std::optional<uint32_t> chunk_crc;
     // true if this is the last chunk
     bool done;
 
@@ -379,6 +411,7 @@ public:
           .last_included_index = _ptr->last_included_index,
           .file_offset = _ptr->file_offset,
           .chunk = _ptr->chunk.copy(),
+          .chunk_crc = _ptr->chunk_crc,
           .done = _ptr->done};
     }
     raft::group_id target_group() const { return _ptr->target_group(); }
@@ -401,6 +434,8 @@ struct install_snapshot_reply {
     //  as the value for byte_offset in the next request (most importantly,
     //  when a follower reboots, it returns 0 here and the leader starts at
     //  offset 0 in the next request).
+    //  Requests without the chunk crc are answered with the size of the
+    //  chunk, as older nodes do.
     uint64_t bytes_stored;
     // indicates if the request was successfull
     bool success = false;
@@ -457,6 +492,20 @@ struct timeout_now_reply {
     status result;
 };
 
+/// \brief request sent to the current leader of the group, used to move
+/// leadership of groups led by other nodes
+struct transfer_leadership_request {
+    group_id group;
+    std::optional<model::node_id> target;
+
+    raft::group_id target_group() const { return group; }
+};
+
+struct transfer_leadership_reply {
+    bool success{false};
+    raft::errc result;
+};
+
 // key types used to store data in key-value store
 enum class metadata_key : int8_t {
     voted_for = 0,
@@ -495,6 +544,11 @@ struct async_adl<raft::append_entries_request> {
     ss::future<raft::append_entries_request> from(iobuf_parser& in);
 };
 template<>
+struct async_adl<raft::append_entries_batch_request> {
+    ss::future<> to(iobuf& out, raft::append_entries_batch_request&& request);
+    ss::future<raft::append_entries_batch_request> from(iobuf_parser& in);
+};
+template<>
 struct adl<raft::protocol_metadata> {
     void to(iobuf& out, raft::protocol_metadata request);
     raft::protocol_metadata from(iobuf_parser& in);
@@ -511,6 +565,12 @@ struct async_adl<raft::heartbeat_reply> {
     ss::future<raft::heartbeat_reply> from(iobuf_parser& in);
 };
 
+template<>
+struct adl<raft::install_snapshot_request> {
+    void to(iobuf& out, raft::install_snapshot_request&& request);
+    raft::install_snapshot_request from(iobuf_parser& in);
+};
+
 template<>
 struct adl<raft::snapshot_metadata> {
     void to(iobuf& out, raft::snapshot_metadata&& request);
@@ -16,6 +16,7 @@
 #include "cluster/controller_api.h"
 #include "cluster/errc.h"
 #include "cluster/fwd.h"
+#include "cluster/leader_balancer.h"
 #include "cluster/members_frontend.h"
 #include "cluster/metadata_cache.h"
 #include "cluster/partition_manager.h"
@@ -30,6 +31,7 @@
 #include "model/namespace.h"
 #include "raft/types.h"
 #include "redpanda/admin/api-doc/broker.json.h"
+#include "redpanda/admin/api-doc/cluster.json.h"
 #include "redpanda/admin/api-doc/config.json.h"
 #include "redpanda/admin/api-doc/hbadger.json.h"
 #include "redpanda/admin/api-doc/kafka.json.h"
@@ -123,6 +125,8 @@ void admin_server::configure_admin_routes() {
     rb->register_api_file(_server._routes, "hbadger");
     rb->register_function(_server._routes, insert_comma);
     rb->register_api_file(_server._routes, "broker");
+    rb->register_function(_server._routes, insert_comma);
+    rb->register_api_file(_server._routes, "cluster");
 
     register_config_routes();
     register_raft_routes();
@@ -132,6 +136,7 @@ void admin_server::configure_admin_routes() {
     register_broker_routes();
     register_partition_routes();
     register_hbadger_routes();
+    register_cluster_routes();
 }
 
 void admin_server::configure_dashboard() {
@@ -968,3 +973,35 @@ void admin_server::register_hbadger_routes() {
               [] { return ss::json::json_return_type(ss::json::json_void()); });
       });
 }
+
+void admin_server::register_cluster_routes() {
+    ss::httpd::cluster_json::get_leader_balancer_status.set(
+      _server._routes, [this](std::unique_ptr<ss::httpd::request>) {
+          return _controller->get_leader_balancer()
+            .invoke_on(
+              cluster::leader_balancer::shard,
+              [](cluster::leader_balancer& lb) { return lb.get_status(); })
+            .then([](cluster::leader_balancer::status st) {
+                ss::httpd::cluster_json::leader_balancer_status ret;
+                ret.enabled = st.enabled;
+                ret.active = st.active;
+                ret.shard_imbalance = st.shard_imbalance;
+                ret.node_imbalance = st.node_imbalance;
+                ret.transfers = st.transfers;
+                ret.failed_transfers = st.failed_transfers;
+                ret.muted_groups = st.muted_groups;
+                for (auto id : st.muted_nodes) {
+                    ret.muted_nodes.push(id());
+                }
+                for (const auto& l : st.leaders) {
+                    ss::httpd::cluster_json::shard_leaders sl;
+                    sl.node_id = l.node;
+                    sl.core = l.core;
+                    sl.leaders = l.leaders;
+                    ret.leaders.push(sl);
+                }
+                return ss::make_ready_future<ss::json::json_return_type>(
+                  std::move(ret));
+            });
+      });
+}
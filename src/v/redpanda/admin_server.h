@@ -79,6 +79,7 @@ private:
     void register_broker_routes();
     void register_partition_routes();
     void register_hbadger_routes();
+    void register_cluster_routes();
 
     struct level_reset {
         using time_point = ss::timer<>::clock::time_point;
@@ -45,6 +45,8 @@
 #include "storage/chunk_cache.h"
 #include "storage/compaction_controller.h"
 #include "storage/directories.h"
+#include "storage/flush_coordinator.h"
+#include "storage/write_behind_controller.h"
 #include "syschecks/syschecks.h"
 #include "test_utils/logs.h"
 #include "utils/file_io.h"
@@ -475,6 +477,12 @@ void application::wire_up_redpanda_services() {
     ss::smp::invoke_on_all([] {
         return storage::internal::chunks().start();
     }).get();
+    ss::smp::invoke_on_all([] {
+        storage::internal::flusher().start(std::chrono::microseconds(
+          config::shard_local_cfg().segment_appender_flush_coalesce_window_us()));
+        storage::internal::write_behind().start(
+          config::shard_local_cfg().segment_appender_adaptive_write_behind());
+    }).get();
 
     // cluster
     syschecks::systemd_message("Adding raft client cache").get();
@@ -486,6 +494,14 @@ void application::wire_up_redpanda_services() {
     auto log_cfg = manager_config_from_global_config(_scheduling_groups);
     log_cfg.reclaim_opts.background_reclaimer_sg
       = _scheduling_groups.cache_background_reclaim_sg();
+    log_cfg.index_cache_max_memory
+      = config::shard_local_cfg().segment_index_cache_max_memory();
+    log_cfg.compaction_max_concurrent_jobs
+      = config::shard_local_cfg().compaction_max_concurrent_jobs();
+    log_cfg.compaction_max_bytes_per_sec
+      = config::shard_local_cfg().compaction_max_bytes_per_sec();
+    log_cfg.compaction_max_segments_per_job
+      = config::shard_local_cfg().compaction_max_segments_per_job();
     construct_service(storage, kvstore_config_from_global_config(), log_cfg)
       .get();
 
@@ -550,6 +566,13 @@ void application::wire_up_redpanda_services() {
       .get();
 
     if (archival_storage_enabled()) {
+        syschecks::systemd_message("Creating cloud storage cache").get();
+        construct_service(
+          cloud_storage_cache,
+          config::shard_local_cfg().cloud_storage_cache_path(),
+          config::shard_local_cfg().cloud_storage_cache_size())
+          .get();
+
         syschecks::systemd_message("Starting archival scheduler").get();
         ss::sharded<archival::configuration> configs;
         configs.start().get();
@@ -565,7 +588,8 @@ void application::wire_up_redpanda_services() {
           std::ref(storage),
           std::ref(partition_manager),
           std::ref(controller->get_topics_state()),
-          std::ref(configs))
+          std::ref(configs),
+          std::ref(cloud_storage_cache))
           .get();
         configs.stop().get();
     }
@@ -887,6 +911,7 @@ void application::start_redpanda() {
 
     if (archival_storage_enabled()) {
         syschecks::systemd_message("Starting archival storage").get();
+        cloud_storage_cache.invoke_on_all(&cloud_storage::cache::start).get();
         archival_scheduler
           .invoke_on_all(
             [](archival::scheduler_service& svc) { return svc.start(); })
@@ -931,6 +956,7 @@ void application::start_redpanda() {
             controller->get_api(),
             tx_gateway_frontend,
             qdc_config);
+          proto->setup_metrics();
           s.set_protocol(std::move(proto));
       })
       .get();
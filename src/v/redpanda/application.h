@@ -12,6 +12,7 @@
 #pragma once
 
 #include "archival/service.h"
+#include "cloud_storage/cache_service.h"
 #include "cluster/controller.h"
 #include "cluster/fwd.h"
 #include "cluster/rm_partition_frontend.h"
@@ -85,6 +86,7 @@ public:
     ss::sharded<kafka::quota_manager> quota_mgr;
     ss::sharded<cluster::id_allocator_frontend> id_allocator_frontend;
     ss::sharded<archival::scheduler_service> archival_scheduler;
+    ss::sharded<cloud_storage::cache> cloud_storage_cache;
     ss::sharded<kafka::rm_group_frontend> rm_group_frontend;
     ss::sharded<cluster::rm_partition_frontend> rm_partition_frontend;
     ss::sharded<cluster::tx_gateway_frontend> tx_gateway_frontend;
@@ -20,6 +20,9 @@
 class priority_manager {
 public:
     ss::io_priority_class raft_priority() { return _raft_priority; }
+    ss::io_priority_class raft_recovery_priority() {
+        return _raft_recovery_priority;
+    }
     ss::io_priority_class controller_priority() { return _controller_priority; }
     ss::io_priority_class kafka_read_priority() { return _kafka_read_priority; }
     ss::io_priority_class compaction_priority() { return _compaction_priority; }
@@ -32,6 +35,8 @@ public:
 private:
     priority_manager()
       : _raft_priority(ss::engine().register_one_priority_class("raft", 1000))
+      , _raft_recovery_priority(
+          ss::engine().register_one_priority_class("raft_recovery", 500))
       , _controller_priority(
           ss::engine().register_one_priority_class("controller", 1000))
       , _kafka_read_priority(
@@ -40,6 +45,7 @@ private:
           ss::engine().register_one_priority_class("compaction", 200)) {}
 
     ss::io_priority_class _raft_priority;
+    ss::io_priority_class _raft_recovery_priority;
     ss::io_priority_class _controller_priority;
     ss::io_priority_class _kafka_read_priority;
     ss::io_priority_class _compaction_priority;
@@ -49,6 +55,10 @@ inline ss::io_priority_class raft_priority() {
     return priority_manager::local().raft_priority();
 }
 
+inline ss::io_priority_class raft_recovery_priority() {
+    return priority_manager::local().raft_recovery_priority();
+}
+
 inline ss::io_priority_class controller_priority() {
     return priority_manager::local().controller_priority();
 }
@@ -127,6 +127,9 @@ ss::future<> backlog_controller::update() {
 ss::future<> backlog_controller::set() {
     vlog(_log.debug, "updating shares {}", _current_shares);
     _scheduling_group.set_shares(static_cast<float>(_current_shares));
+    if (_listener) {
+        _listener(_current_shares, _max_shares);
+    }
     return ss::engine().update_shares_for_class(_io_priority, _current_shares);
 }
 
@@ -14,6 +14,7 @@
 #include <seastar/core/io_priority_class.hh>
 #include <seastar/core/metrics_registration.hh>
 #include <seastar/core/timer.hh>
+#include <seastar/util/noncopyable_function.hh>
 #include <seastar/util/log.hh>
 
 namespace storage {
@@ -99,6 +100,12 @@ public:
 
     void setup_metrics(const ss::sstring&);
 
+    /// \brief called with the current and max shares every time the output
+    /// of the controller is applied, to control resources other than the
+    /// scheduling group and io priority class
+    using shares_listener = ss::noncopyable_function<void(int, int)>;
+    void set_shares_listener(shares_listener l) { _listener = std::move(l); }
+
 private:
     ss::future<> set();
     ss::future<> update();
@@ -124,6 +131,7 @@ private:
     int _current_shares;
     int _min_shares;
     int _max_shares;
+    shares_listener _listener;
     ss::gate _gate;
     ss::metrics::metric_groups _metrics;
 };
@@ -12,6 +12,7 @@
 #include "storage/compaction_controller.h"
 
 #include "storage/api.h"
+#include "storage/compaction_scheduler.h"
 
 #include <seastar/core/coroutine.hh>
 
@@ -27,6 +28,15 @@ compaction_controller::compaction_controller(
   : _ctrl(
     std::make_unique<compaction_backlog_sampler>(api), compaction_log, cfg) {
     _ctrl.setup_metrics("storage:compaction");
+    // the compaction i/o budget follows the controller output, it is fully
+    // available only when the backlog requires max shares
+    _ctrl.set_shares_listener([&api](int shares, int max_shares) {
+        if (max_shares <= 0 || !api.local_is_initialized()) {
+            return;
+        }
+        api.local().log_mgr().get_compaction_scheduler().set_rate_scale(
+          static_cast<double>(shares) / max_shares);
+    });
 }
 
 } // namespace storage
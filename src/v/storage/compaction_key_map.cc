@@ -0,0 +1,74 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/compaction_key_map.h"
+
+#include "likely.h"
+
+#include <xxhash.h>
+
+#include <cstring>
+
+namespace storage::internal {
+
+key_fingerprint key_fingerprint::of(bytes_view key) {
+    static constexpr uint64_t hi_seed = 0x9e3779b97f4a7c15;
+    key_fingerprint fp{
+      .lo = XXH64(key.data(), key.size(), 0),
+      .hi = XXH64(key.data(), key.size(), hi_seed),
+    };
+    // all zeros marks an empty slot
+    if (unlikely(fp.empty())) {
+        fp.hi = 1;
+    }
+    return fp;
+}
+
+bytes_view key_arena::append(bytes_view key) {
+    // large keys get a chunk of their own so they don't waste the tail of the
+    // current one
+    if (key.size() > _chunk_size / 4) {
+        auto& data = _chunks.emplace_back(
+          std::make_unique<uint8_t[]>(key.size()));
+        std::memcpy(data.get(), key.data(), key.size());
+        _allocated += key.size();
+        return bytes_view(data.get(), key.size());
+    }
+    if (!_current || _used_in_current + key.size() > _chunk_size) {
+        auto& data = _chunks.emplace_back(
+          std::make_unique<uint8_t[]>(_chunk_size));
+        _current = data.get();
+        _allocated += _chunk_size;
+        _used_in_current = 0;
+    }
+    auto* dst = _current + _used_in_current;
+    std::memcpy(dst, key.data(), key.size());
+    _used_in_current += key.size();
+    return bytes_view(dst, key.size());
+}
+
+size_t key_arena::memory_usage_after_append(size_t key_size) const {
+    if (key_size > _chunk_size / 4) {
+        return _allocated + key_size;
+    }
+    if (!_current || _used_in_current + key_size > _chunk_size) {
+        return _allocated + _chunk_size;
+    }
+    return _allocated;
+}
+
+void key_arena::clear() {
+    _chunks.clear();
+    _chunks.shrink_to_fit();
+    _current = nullptr;
+    _used_in_current = 0;
+    _allocated = 0;
+}
+
+} // namespace storage::internal
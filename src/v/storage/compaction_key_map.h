@@ -0,0 +1,251 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "bytes/bytes.h"
+#include "vassert.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace storage::internal {
+
+/**
+ * 128 bit fingerprint of a key. Like the offset map of the kafka log
+ * cleaner, the compaction maps identify keys by a wide hash instead of holding
+ * the key bytes: with the few hundred thousand keys a map holds at once the
+ * odds of a collision are below 1e-27.
+ */
+struct key_fingerprint {
+    uint64_t lo{0};
+    uint64_t hi{0};
+
+    static key_fingerprint of(bytes_view);
+
+    bool empty() const { return lo == 0 && hi == 0; }
+    friend bool operator==(const key_fingerprint&, const key_fingerprint&)
+      = default;
+};
+
+/**
+ * Open addressing (linear probing) hash table from key fingerprints to a
+ * trivially copyable value, stored inline in a single flat array of packed
+ * slots. Unlike a node map there is no allocation per key.
+ *
+ * The table doubles up to the capacity that fits in `max_memory`, after
+ * which callers must evict entries before inserting (see `has_room()`).
+ */
+template<typename Value>
+class key_fingerprint_map {
+    static_assert(std::is_trivially_copyable_v<Value>);
+
+public:
+    struct [[gnu::packed]] slot {
+        uint64_t fp_lo;
+        uint64_t fp_hi;
+        Value value;
+
+        key_fingerprint fingerprint() const { return {fp_lo, fp_hi}; }
+        bool empty() const { return fp_lo == 0 && fp_hi == 0; }
+    };
+    static constexpr size_t slot_size = sizeof(slot);
+    static constexpr size_t initial_capacity = 16;
+
+    explicit key_fingerprint_map(size_t max_memory)
+      : _max_capacity(std::max<size_t>(2, max_memory / slot_size)) {}
+
+    /// \brief calls \p f with a mutable copy of the value of \p fp, which is
+    /// written back. slots are packed, so values are not handed out by
+    /// reference. returns false if \p fp is not in the map
+    template<typename Func>
+    bool update(const key_fingerprint& fp, Func&& f) {
+        if (_slots.empty()) {
+            return false;
+        }
+        for (size_t i = bucket(fp);; i = next(i)) {
+            auto& s = _slots[i];
+            if (s.empty()) {
+                return false;
+            }
+            if (s.fp_lo == fp.lo && s.fp_hi == fp.hi) {
+                Value v = s.value;
+                f(v);
+                s.value = v;
+                return true;
+            }
+        }
+    }
+
+    /// \brief false once the table is at its memory budget and full
+    bool has_room() const {
+        return _size < max_entries(_max_capacity);
+    }
+
+    /// \brief inserts a fingerprint that is not in the map. requires
+    /// `has_room()`
+    void insert(const key_fingerprint& fp, Value v) {
+        vassert(has_room(), "key map is full, size:{}", _size);
+        if (_size >= max_entries(_slots.size())) {
+            grow();
+        }
+        do_insert(slot{fp.lo, fp.hi, v});
+        ++_size;
+    }
+
+    /// \brief removes a pseudo random entry. Fingerprints are uniformly
+    /// distributed so walking the slots evicts random keys.
+    std::pair<key_fingerprint, Value> evict_one() {
+        vassert(_size > 0, "cannot evict from an empty key map");
+        while (_slots[_cursor].empty()) {
+            _cursor = next(_cursor);
+        }
+        const auto fp = _slots[_cursor].fingerprint();
+        const Value v = _slots[_cursor].value;
+        erase_at(_cursor);
+        return {fp, v};
+    }
+
+    /// \brief memory usage if one more entry was inserted
+    size_t memory_usage_after_insert() const {
+        if (_size >= max_entries(_slots.size())) {
+            return next_capacity() * slot_size;
+        }
+        return memory_usage();
+    }
+    size_t memory_usage() const { return _slots.capacity() * slot_size; }
+
+    template<typename Func>
+    void for_each(Func&& f) const {
+        for (const auto& s : _slots) {
+            if (!s.empty()) {
+                const Value v = s.value;
+                f(s.fingerprint(), v);
+            }
+        }
+    }
+
+    void clear() {
+        _slots = {};
+        _size = 0;
+        _cursor = 0;
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    size_t max_capacity() const { return _max_capacity; }
+
+private:
+    // linear probing degrades quickly past 80% load
+    static size_t max_entries(size_t capacity) {
+        return std::max<size_t>(
+          std::min<size_t>(capacity, 1), capacity * 4 / 5);
+    }
+
+    size_t next_capacity() const {
+        if (_slots.empty()) {
+            return std::min(initial_capacity, _max_capacity);
+        }
+        return std::min(_slots.size() * 2, _max_capacity);
+    }
+
+    // maps the fingerprint to [0, capacity) without a division
+    size_t bucket(const key_fingerprint& fp) const {
+        return static_cast<size_t>(
+          (static_cast<unsigned __int128>(fp.lo) * _slots.size()) >> 64);
+    }
+    size_t bucket(const slot& s) const { return bucket(s.fingerprint()); }
+    size_t next(size_t i) const { return i + 1 == _slots.size() ? 0 : i + 1; }
+
+    void do_insert(const slot& s) {
+        size_t i = bucket(s);
+        while (!_slots[i].empty()) {
+            i = next(i);
+        }
+        _slots[i] = s;
+    }
+
+    void grow() {
+        auto old = std::exchange(_slots, std::vector<slot>(next_capacity()));
+        _cursor = 0;
+        for (const auto& s : old) {
+            if (!s.empty()) {
+                do_insert(s);
+            }
+        }
+    }
+
+    // backward shift deletion, keeps every probe sequence intact without
+    // tombstones
+    void erase_at(size_t i) {
+        size_t j = i;
+        while (true) {
+            _slots[i] = slot{};
+            while (true) {
+                j = next(j);
+                if (_slots[j].empty()) {
+                    --_size;
+                    return;
+                }
+                // the entry at j can fill the hole at i unless its home
+                // bucket lies cyclically in (i, j]
+                const size_t k = bucket(_slots[j]);
+                const bool stays = i <= j ? (i < k && k <= j)
+                                          : (i < k || k <= j);
+                if (!stays) {
+                    break;
+                }
+            }
+            _slots[i] = _slots[j];
+            i = j;
+        }
+    }
+
+    std::vector<slot> _slots;
+    size_t _size{0};
+    size_t _cursor{0};
+    size_t _max_capacity;
+};
+
+/**
+ * Bump allocator for key bytes. Keys are never freed individually, the whole
+ * arena is released with `clear()`. Views returned by `append()` are stable
+ * until then.
+ */
+class key_arena {
+public:
+    static constexpr size_t max_chunk_size = 32 * 1024;
+
+    explicit key_arena(size_t chunk_size)
+      : _chunk_size(std::clamp<size_t>(chunk_size, 256, max_chunk_size)) {}
+
+    bytes_view append(bytes_view);
+
+    /// \brief memory usage if \p key_size bytes were appended
+    size_t memory_usage_after_append(size_t key_size) const;
+    size_t memory_usage() const { return _allocated; }
+
+    void clear();
+
+private:
+    size_t _chunk_size;
+    std::vector<std::unique_ptr<uint8_t[]>> _chunks;
+    uint8_t* _current{nullptr};
+    size_t _used_in_current{0};
+    size_t _allocated{0};
+};
+
+} // namespace storage::internal
@@ -35,38 +35,23 @@ ss::future<ss::stop_iteration>
 compaction_key_reducer::operator()(compacted_index::entry&& e) {
     using stop_t = ss::stop_iteration;
     const model::offset o = e.offset + model::offset(e.delta);
+    const auto fp = key_fingerprint::of(e.key);
 
-    auto it = _indices.find(e.key);
-    if (it != _indices.end()) {
-        if (o > it->second.offset) {
+    const bool found = _indices.update(fp, [this, o](value_type& v) {
+        if (o() > v.offset) {
             // cannot be std::max() because _natural_index must be preserved
-            it->second.offset = o;
-            it->second.natural_index = _natural_index;
+            v.offset = o();
+            v.natural_index = _natural_index;
         }
-    } else {
-        // not found - insert
-        auto const key_size = e.key.size();
-        auto const expected_size = [this, key_size] {
-            return idx_mem_usage() + _keys_mem_usage + key_size;
-        };
-
-        // if index allocates to much memory remove some entries.
-        while (expected_size() >= _max_mem && !_indices.empty()) {
-            /**
-             * Evict first entry, we use hash function that guarante good
-             * randomness so evicting first entry is actually evicting a
-             * pseudo random elemnent
-             */
-            auto mit = _indices.begin();
-            _keys_mem_usage -= mit->first.size();
-
+    });
+    if (!found) {
+        // if index is at its memory budget remove some entries.
+        while (!_indices.has_room()) {
             // write the entry again - we ran out of scratch space
-            _inverted.add(mit->second.natural_index);
-            _indices.erase(mit);
+            _inverted.add(_indices.evict_one().second.natural_index);
         }
-        _keys_mem_usage += e.key.size();
         // 2. do the insertion
-        _indices.emplace(std::move(e.key), value_type(o, _natural_index));
+        _indices.insert(fp, value_type{o(), _natural_index});
     }
 
     ++_natural_index; // MOST important
@@ -75,9 +60,10 @@ compaction_key_reducer::operator()(compacted_index::entry&& e) {
 Roaring compaction_key_reducer::end_of_stream() {
     // TODO: optimization - detect if the index does not need compaction
     // by linear scan of natural_index from 0-N with no gaps.
-    for (auto& e : _indices) {
-        _inverted.add(e.second.natural_index);
-    }
+    _indices.for_each([this](const key_fingerprint&, const value_type& v) {
+        _inverted.add(v.natural_index);
+    });
+    _indices.clear();
     _inverted.shrinkToFit();
     return std::move(_inverted);
 }
@@ -85,6 +71,9 @@ Roaring compaction_key_reducer::end_of_stream() {
 ss::future<ss::stop_iteration>
 index_copy_reducer::operator()(compacted_index::entry&& e) {
     using stop_t = ss::stop_iteration;
+    if (_filter) {
+        _filter->add(e.key);
+    }
     return _writer->append(std::move(e)).then([] {
         return ss::make_ready_future<stop_t>(stop_t::no);
     });
@@ -97,6 +86,9 @@ index_filtered_copy_reducer::operator()(compacted_index::entry&& e) {
     ++_natural_index;
     if (should_add) {
         bytes_view bv = e.key;
+        if (_filter) {
+            _filter->add(bv);
+        }
         return _writer->index(bv, e.offset, e.delta)
           .then([k = std::move(e.key)] {
               return ss::make_ready_future<stop_t>(stop_t::no);
@@ -105,6 +97,17 @@ index_filtered_copy_reducer::operator()(compacted_index::entry&& e) {
     return ss::make_ready_future<stop_t>(stop_t::no);
 }
 
+ss::future<ss::stop_iteration>
+key_filter_probe_reducer::operator()(compacted_index::entry&& e) {
+    using stop_t = ss::stop_iteration;
+    const auto h = key_bloom_filter::hash(e.key);
+    _found = std::any_of(
+      _filters->begin(), _filters->end(), [h](const key_bloom_filter& f) {
+          return f.may_contain_hash(h);
+      });
+    return ss::make_ready_future<stop_t>(stop_t(_found));
+}
+
 ss::future<ss::stop_iteration>
 compacted_offset_list_reducer::operator()(compacted_index::entry&& e) {
     using stop_t = ss::stop_iteration;
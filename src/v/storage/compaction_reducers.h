@@ -17,13 +17,14 @@
 #include "storage/compacted_index.h"
 #include "storage/compacted_index_writer.h"
 #include "storage/compacted_offset_list.h"
+#include "storage/compaction_key_map.h"
 #include "storage/index_state.h"
+#include "storage/key_bloom_filter.h"
 #include "storage/logger.h"
 #include "storage/segment_appender.h"
 #include "units.h"
 
 #include <absl/container/btree_map.h>
-#include <absl/container/node_hash_map.h>
 #include <fmt/core.h>
 #include <roaring/roaring.hh>
 
@@ -34,35 +35,22 @@ struct compaction_reducer {};
 class compaction_key_reducer : public compaction_reducer {
 public:
     static constexpr const size_t default_max_memory_usage = 5_MiB;
-    struct value_type {
-        value_type(model::offset o, uint32_t i)
-          : offset(o)
-          , natural_index(i) {}
-        model::offset offset;
+    // packed, it is stored inline in the slots of the key map
+    struct [[gnu::packed]] value_type {
+        int64_t offset;
         uint32_t natural_index;
     };
-    using underlying_t = absl::node_hash_map<
-      bytes,
-      value_type,
-      bytes_hasher<uint64_t, xxhash_64>,
-      bytes_type_eq>;
+    using underlying_t = key_fingerprint_map<value_type>;
 
     explicit compaction_key_reducer(size_t max_mem = default_max_memory_usage)
-      : _max_mem(max_mem) {}
+      : _indices(max_mem) {}
 
     ss::future<ss::stop_iteration> operator()(compacted_index::entry&&);
     Roaring end_of_stream();
 
 private:
-    size_t idx_mem_usage() {
-        using debug = absl::container_internal::hashtable_debug_internal::
-          HashtableDebugAccess<underlying_t>;
-        return debug::AllocatedByteSize(_indices);
-    }
     Roaring _inverted;
     underlying_t _indices;
-    size_t _keys_mem_usage{0};
-    size_t _max_mem{0};
     uint32_t _natural_index{0};
 };
 
@@ -70,9 +58,12 @@ private:
 /// wether ot keep the entry or not
 class index_filtered_copy_reducer : public compaction_reducer {
 public:
-    index_filtered_copy_reducer(Roaring b, compacted_index_writer& w)
+    /// \brief when \p f is not null every copied key is also added to it
+    index_filtered_copy_reducer(
+      Roaring b, compacted_index_writer& w, key_bloom_filter* f = nullptr)
       : _bm(std::move(b))
-      , _writer(&w) {}
+      , _writer(&w)
+      , _filter(f) {}
 
     ss::future<ss::stop_iteration> operator()(compacted_index::entry&&);
     void end_of_stream() {}
@@ -81,18 +72,40 @@ private:
     uint32_t _natural_index = 0;
     Roaring _bm;
     compacted_index_writer* _writer;
+    key_bloom_filter* _filter;
+};
+
+/// \brief stops at the first key that may be present in the filter. returns
+/// false only when none of the consumed keys is in the filter
+class key_filter_probe_reducer : public compaction_reducer {
+public:
+    /// \brief looks up every key in all of \p filters
+    explicit key_filter_probe_reducer(
+      const std::vector<key_bloom_filter>& filters)
+      : _filters(&filters) {}
+
+    ss::future<ss::stop_iteration> operator()(compacted_index::entry&&);
+    bool end_of_stream() const { return _found; }
+
+private:
+    const std::vector<key_bloom_filter>* _filters;
+    bool _found = false;
 };
 
 class index_copy_reducer : public compaction_reducer {
 public:
-    explicit index_copy_reducer(compacted_index_writer& w)
-      : _writer(&w) {}
+    /// \brief when \p f is not null every copied key is also added to it
+    explicit index_copy_reducer(
+      compacted_index_writer& w, key_bloom_filter* f = nullptr)
+      : _writer(&w)
+      , _filter(f) {}
 
     ss::future<ss::stop_iteration> operator()(compacted_index::entry&&);
     void end_of_stream() {}
 
 private:
     compacted_index_writer* _writer;
+    key_bloom_filter* _filter;
 };
 
 class compacted_offset_list_reducer : public compaction_reducer {
@@ -0,0 +1,163 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/compaction_scheduler.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "storage/logger.h"
+#include "vlog.h"
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/sleep.hh>
+
+#include <fmt/ostream.h>
+
+#include <algorithm>
+
+namespace storage {
+
+compaction_scheduler::compaction_scheduler(
+  size_t max_concurrent_jobs, std::optional<size_t> max_bytes_per_sec)
+  : _max_concurrent_jobs(std::max<size_t>(1, max_concurrent_jobs))
+  , _jobs(_max_concurrent_jobs)
+  , _max_bytes_per_sec(max_bytes_per_sec) {
+    if (_max_bytes_per_sec) {
+        _tokens = static_cast<double>(*_max_bytes_per_sec);
+    }
+}
+
+ss::future<ss::semaphore_units<>> compaction_scheduler::acquire_job_slot() {
+    return ss::get_units(_jobs, 1);
+}
+
+ss::future<>
+compaction_scheduler::run_job(ss::noncopyable_function<ss::future<>()> job) {
+    ++_running;
+    try {
+        co_await job();
+        ++_finished_jobs;
+    } catch (...) {
+        ++_failed_jobs;
+        --_running;
+        throw;
+    }
+    --_running;
+}
+
+std::optional<double> compaction_scheduler::bytes_per_sec() const {
+    if (!_max_bytes_per_sec) {
+        return std::nullopt;
+    }
+    // never stall compaction completely
+    return std::max(
+      1.0, static_cast<double>(*_max_bytes_per_sec) * _rate_scale);
+}
+
+void compaction_scheduler::refill(double rate) {
+    const auto now = clock_type::now();
+    const std::chrono::duration<double> elapsed = now - _last_refill;
+    _last_refill = now;
+    _tokens = std::min(rate, _tokens + elapsed.count() * rate);
+}
+
+ss::future<>
+compaction_scheduler::throttle(size_t bytes, ss::abort_source& as) {
+    _processed_bytes += bytes;
+    auto rate = bytes_per_sec();
+    if (!rate) {
+        co_return;
+    }
+    refill(*rate);
+    _tokens -= static_cast<double>(bytes);
+    if (_tokens >= 0) {
+        co_return;
+    }
+    const auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::duration<double>(-_tokens / *rate));
+    vlog(
+      stlog.trace,
+      "throttling compaction of {} bytes for {}ms",
+      bytes,
+      delay.count());
+    _throttled += delay;
+    co_await ss::sleep_abortable<clock_type>(delay, as);
+}
+
+void compaction_scheduler::set_rate_scale(double scale) {
+    _rate_scale = std::clamp(scale, 0.0, 1.0);
+}
+
+void compaction_scheduler::stop() { _jobs.broken(); }
+
+void compaction_scheduler::setup_metrics(
+  ss::noncopyable_function<int64_t()> backlog) {
+    _backlog = std::move(backlog);
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("storage:compaction:scheduler"),
+      {
+        sm::make_gauge(
+          "running_jobs",
+          [this] { return _running; },
+          sm::description("Number of partitions being compacted")),
+        sm::make_gauge(
+          "waiting_jobs",
+          [this] { return _jobs.waiters(); },
+          sm::description("Number of partitions waiting for a compaction slot")),
+        sm::make_derive(
+          "finished_jobs",
+          [this] { return _finished_jobs; },
+          sm::description("Number of finished partition compactions")),
+        sm::make_derive(
+          "failed_jobs",
+          [this] { return _failed_jobs; },
+          sm::description("Number of failed partition compactions")),
+        sm::make_total_bytes(
+          "processed_bytes",
+          [this] { return _processed_bytes; },
+          sm::description("Bytes read by compaction, the throughput is its "
+                          "rate")),
+        sm::make_derive(
+          "throttled_ms",
+          [this] { return _throttled.count(); },
+          sm::description("Total time compaction was delayed by the byte rate "
+                          "budget")),
+        sm::make_gauge(
+          "bytes_per_sec_budget",
+          [this] { return bytes_per_sec().value_or(0); },
+          sm::description("Current compaction byte rate budget, 0 if "
+                          "unlimited")),
+        sm::make_gauge(
+          "backlog_bytes",
+          [this] { return _backlog ? _backlog() : 0; },
+          sm::description("Bytes of data waiting to be compacted")),
+      });
+}
+
+std::ostream& operator<<(std::ostream& o, const compaction_scheduler& s) {
+    fmt::print(
+      o,
+      "{{max_concurrent_jobs:{}, running:{}, waiting:{}, "
+      "max_bytes_per_sec:{}, rate_scale:{}, processed_bytes:{}}}",
+      s._max_concurrent_jobs,
+      s._running,
+      s._jobs.waiters(),
+      s._max_bytes_per_sec ? std::to_string(*s._max_bytes_per_sec)
+                           : std::string("unlimited"),
+      s._rate_scale,
+      s._processed_bytes);
+    return o;
+}
+
+} // namespace storage
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "seastarx.h"
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/util/noncopyable_function.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+
+namespace storage {
+
+/**
+ * Per-shard scheduler of compaction jobs. A job is all the compaction work
+ * done on a single partition in one housekeeping round.
+ *
+ * - at most `max_concurrent_jobs` jobs run at the same time
+ * - jobs report the bytes they are about to process through `throttle()`,
+ *   which delays them to stay under `max_bytes_per_sec`. The rate is scaled
+ *   by the output of the compaction backlog controller, so the budget is only
+ *   fully used when the backlog is large.
+ */
+class compaction_scheduler {
+public:
+    using clock_type = ss::lowres_clock;
+
+    compaction_scheduler(
+      size_t max_concurrent_jobs, std::optional<size_t> max_bytes_per_sec);
+
+    /// \brief waits for a free job slot. the slot is held by the units
+    ss::future<ss::semaphore_units<>> acquire_job_slot();
+
+    /// \brief runs \p job, which must be holding a job slot, and tracks it in
+    /// the metrics
+    ss::future<> run_job(ss::noncopyable_function<ss::future<>()> job);
+
+    /// \brief accounts for \p bytes of compaction i/o, sleeping when the
+    /// byte rate budget is exhausted
+    ss::future<> throttle(size_t bytes, ss::abort_source&);
+
+    /// \brief fraction of `max_bytes_per_sec` available, in (0, 1]
+    void set_rate_scale(double);
+
+    /// \brief current byte rate budget, nullopt if unlimited
+    std::optional<double> bytes_per_sec() const;
+
+    void setup_metrics(ss::noncopyable_function<int64_t()> backlog);
+    /// \brief fails every waiter for a job slot
+    void stop();
+
+    size_t running_jobs() const { return _running; }
+    size_t waiting_jobs() const { return _jobs.waiters(); }
+    uint64_t processed_bytes() const { return _processed_bytes; }
+
+private:
+    void refill(double rate);
+
+    size_t _max_concurrent_jobs;
+    ss::semaphore _jobs;
+    std::optional<size_t> _max_bytes_per_sec;
+    double _rate_scale{1.0};
+    // token bucket with one second worth of burst. tokens go negative when a
+    // job takes more than is available, later callers pay off the debt
+    double _tokens{0};
+    clock_type::time_point _last_refill{clock_type::now()};
+
+    size_t _running{0};
+    uint64_t _finished_jobs{0};
+    uint64_t _failed_jobs{0};
+    uint64_t _processed_bytes{0};
+    std::chrono::milliseconds _throttled{0};
+    ss::noncopyable_function<int64_t()> _backlog;
+    ss::metrics::metric_groups _metrics;
+
+    friend std::ostream& operator<<(std::ostream&, const compaction_scheduler&);
+};
+
+} // namespace storage
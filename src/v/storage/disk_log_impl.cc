@@ -14,6 +14,7 @@
 #include "model/namespace.h"
 #include "model/timeout_clock.h"
 #include "reflection/adl.h"
+#include "storage/compaction_scheduler.h"
 #include "storage/disk_log_appender.h"
 #include "storage/fwd.h"
 #include "storage/kvstore.h"
@@ -263,24 +264,30 @@ ss::future<> disk_log_impl::garbage_collect_oldest_segments(
 }
 
 ss::future<> disk_log_impl::do_compact(compaction_config cfg) {
-    // find first not compacted segment
-    auto segit = std::find_if(
-      _segs.begin(), _segs.end(), [](ss::lw_shared_ptr<segment>& s) {
-          return !s->has_appender() && s->is_compacted_segment()
-                 && !s->finished_self_compaction();
-      });
+    // copy of the segments that still need self compaction. the segment set
+    // may change at every scheduling point below, e.g. with a truncation
+    std::vector<ss::lw_shared_ptr<segment>> segments;
+    for (auto& seg : _segs) {
+        if (
+          !seg->has_appender() && seg->is_compacted_segment()
+          && !seg->finished_self_compaction()) {
+            segments.push_back(seg);
+        }
+    }
     // loop until we compact segment or reached end of segments set
-    for (; segit != _segs.end(); ++segit) {
-        auto seg = *segit;
+    for (auto& seg : segments) {
         if (
-          seg->has_appender() || seg->finished_self_compaction()
-          || !seg->is_compacted_segment()) {
+          seg->is_closed() || seg->has_appender()
+          || seg->finished_self_compaction()) {
             continue;
         }
 
         co_await _stm_manager->ensure_snapshot_exists(
           seg->offsets().committed_offset);
 
+        if (cfg.scheduler) {
+            co_await cfg.scheduler->throttle(seg->size_bytes(), *cfg.asrc);
+        }
         auto result = co_await storage::internal::self_compact_segment(
           seg, cfg, _probe, *_readers_cache);
         vlog(
@@ -295,43 +302,96 @@ ss::future<> disk_log_impl::do_compact(compaction_config cfg) {
         }
     }
 
-    if (auto range = find_compaction_range(); range) {
-        auto r = co_await compact_adjacent_segments(std::move(*range), cfg);
+    auto range = find_compaction_range();
+    while (range) {
+        // iterators are invalidated across scheduling points so windows are
+        // looked up again by offset
+        const auto start = (*range->first)->offsets().base_offset;
+        const auto next = (*std::prev(range->second))->offsets().base_offset;
+        const auto size = range_size_bytes(*range);
+        if (co_await should_compact_adjacent_segments(*range, cfg)) {
+            if (cfg.scheduler) {
+                co_await cfg.scheduler->throttle(size, *cfg.asrc);
+            }
+            range = find_compaction_range(start);
+            if (!range) {
+                break;
+            }
+            auto r = co_await compact_adjacent_segments(std::move(*range), cfg);
+            vlog(
+              stlog.debug,
+              "adjejcent segments of {}, compaction result: {}",
+              config().ntp(),
+              r);
+            _compaction_ratio.update(r.compaction_ratio());
+            co_return;
+        }
+        range = find_compaction_range(next);
+    }
+}
+
+ss::future<bool> disk_log_impl::should_compact_adjacent_segments(
+  std::pair<segment_set::iterator, segment_set::iterator> range,
+  storage::compaction_config cfg) {
+    // merging small segments is worth it even if no record is removed
+    if (range_size_bytes(range) < _manager.config().compacted_segment_size) {
+        co_return true;
+    }
+    std::vector<ss::lw_shared_ptr<segment>> segments(range.first, range.second);
+    const auto superseded = co_await internal::may_have_superseded_keys(
+      segments, cfg);
+    if (!superseded) {
         vlog(
           stlog.debug,
-          "adjejcent segments of {}, compaction result: {}",
-          config().ntp(),
-          r);
-        _compaction_ratio.update(r.compaction_ratio());
+          "skipping adjacent compaction of {} segments starting at {}, no "
+          "common keys",
+          segments.size(),
+          segments.front()->reader().filename());
     }
+    co_return superseded;
+}
+
+size_t disk_log_impl::range_size_bytes(
+  std::pair<segment_set::iterator, segment_set::iterator> range) {
+    return std::accumulate(
+      range.first,
+      range.second,
+      size_t(0),
+      [](size_t acc, ss::lw_shared_ptr<segment>& seg) {
+          return acc + seg->size_bytes();
+      });
 }
 
 std::optional<std::pair<segment_set::iterator, segment_set::iterator>>
-disk_log_impl::find_compaction_range() {
+disk_log_impl::find_compaction_range(model::offset start) {
     /*
      * adjacent segment compaction.
      *
-     * the strategy is to choose a pair of adjacent segments and first combine
-     * them into a single segment that replaces the pair, and then perform
-     * self-compaction on the replacement segment.
+     * the strategy is to choose a run of adjacent segments and first combine
+     * them into a single segment that replaces the run, and then perform
+     * self-compaction on the replacement segment. the whole run is
+     * deduplicated by a single key map, so merging N segments at once costs
+     * one pass instead of the N - 1 passes of pairwise merges.
      */
     if (_segs.size() < 2) {
         return std::nullopt;
     }
 
-    // sliding window over segments. currently restricted to two segments
-    auto range = std::make_pair(_segs.begin(), std::next(_segs.begin(), 2));
+    // sliding window over segments. starts with two segments and is extended
+    // below up to `compaction_max_segments_per_job`
+    auto first = std::find_if(
+      _segs.begin(), _segs.end(), [start](ss::lw_shared_ptr<segment>& seg) {
+          return seg->offsets().base_offset >= start;
+      });
+    if (std::distance(first, _segs.end()) < 2) {
+        return std::nullopt;
+    }
+    auto range = std::make_pair(first, std::next(first, 2));
 
     while (true) {
         // the simple compaction process in use right now builds a concatenation
         // of segments so we avoid processing a group that is too large.
-        const auto total_size = std::accumulate(
-          range.first,
-          range.second,
-          size_t(0),
-          [](size_t acc, ss::lw_shared_ptr<segment>& seg) {
-              return acc + seg->size_bytes();
-          });
+        const auto total_size = range_size_bytes(range);
 
         // batches in a segment have a term that is implicitly defined by the
         // name of the file they are contained in. since we need to retain the
@@ -363,6 +423,26 @@ disk_log_impl::find_compaction_range() {
         ++range.second;
     }
 
+    // greedily grow the window with the following segments as long as they
+    // pass the same tests
+    const auto max_segments = std::max<size_t>(
+      2, _manager.config().compaction_max_segments_per_job);
+    auto total_size = range_size_bytes(range);
+    while (range.second != _segs.end()
+           && static_cast<size_t>(std::distance(range.first, range.second))
+                < max_segments) {
+        const auto& candidate = *range.second;
+        if (
+          candidate->has_appender()
+          || candidate->offsets().term != (*range.first)->offsets().term
+          || total_size + candidate->size_bytes()
+               >= _manager.config().max_compacted_segment_size) {
+            break;
+        }
+        total_size += candidate->size_bytes();
+        ++range.second;
+    }
+
     // the chosen segments all need to be stable
     const auto unstable = std::any_of(
       range.first, range.second, [](ss::lw_shared_ptr<segment>& seg) {
@@ -428,6 +508,12 @@ ss::future<compaction_result> disk_log_impl::compact_adjacent_segments(
         co_await ss::remove_file(compact_index.string());
     }
 
+    auto key_filter = internal::compacted_key_filter_path(
+      target->reader().filename().c_str());
+    if (co_await ss::file_exists(key_filter.string())) {
+        co_await ss::remove_file(key_filter.string());
+    }
+
     // lock the range. only metadata (e.g. open/rename/delete) i/o occurs with
     // these locks held so it is a relatively short duration. all of the data
     // copying and compaction i/o occurred above with no locks held. 5 retries
@@ -780,6 +866,11 @@ disk_log_impl::make_reader(log_reader_config config) {
         return ss::make_ready_future<model::record_batch_reader>(
           std::move(empty));
     }
+    if (config.read_buffer_size) {
+        // read ahead readers hold large buffers, they are not cached so that
+        // other readers of the log do not inherit them
+        return make_unchecked_reader(config);
+    }
     return make_cached_reader(config);
 }
 
@@ -997,6 +1088,18 @@ ss::future<> disk_log_impl::do_truncate(truncate_config cfg) {
             return do_truncate(cfg);
         });
     }
+    if (cfg.base_offset > _segs.back()->offsets().dirty_offset) {
+        return ss::make_ready_future<>();
+    }
+    // the index of a sealed segment may have been paged out
+    return _segs.back()->index().hydrate().then(
+      [this, cfg] { return do_truncate_last_segment(cfg); });
+}
+
+ss::future<> disk_log_impl::do_truncate_last_segment(truncate_config cfg) {
+    if (_segs.empty()) {
+        return ss::make_ready_future<>();
+    }
     auto& last = *_segs.back();
     if (cfg.base_offset > last.offsets().dirty_offset) {
         return ss::make_ready_future<>();
@@ -117,7 +117,12 @@ private:
       std::pair<segment_set::iterator, segment_set::iterator>,
       storage::compaction_config cfg);
     std::optional<std::pair<segment_set::iterator, segment_set::iterator>>
-    find_compaction_range();
+      find_compaction_range(model::offset start = model::offset::min());
+    ss::future<bool> should_compact_adjacent_segments(
+      std::pair<segment_set::iterator, segment_set::iterator>,
+      storage::compaction_config cfg);
+    static size_t
+      range_size_bytes(std::pair<segment_set::iterator, segment_set::iterator>);
     ss::future<> gc(compaction_config);
 
     ss::future<> remove_empty_segments();
@@ -132,6 +137,7 @@ private:
       ss::io_priority_class prio);
 
     ss::future<> do_truncate(truncate_config);
+    ss::future<> do_truncate_last_segment(truncate_config);
     ss::future<> remove_full_segments(model::offset o);
 
     ss::future<> do_truncate_prefix(truncate_prefix_config);
@@ -0,0 +1,123 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/fence_index.h"
+
+#include <algorithm>
+#include <iterator>
+
+#if !defined __aarch64__
+#include <immintrin.h>
+#endif
+
+namespace storage::internal {
+
+size_t count_lower_scalar(const uint32_t* data, size_t n, uint32_t needle) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += data[i] < needle;
+    }
+    return count;
+}
+
+#if !defined __aarch64__
+/*
+ * x86 only has signed 32 bit compares. flipping the sign bit of both operands
+ * maps the unsigned order onto the signed one.
+ */
+[[gnu::target("avx2")]] static size_t
+count_lower_avx2(const uint32_t* data, size_t n, uint32_t needle) {
+    const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+    const __m256i x = _mm256_xor_si256(_mm256_set1_epi32(needle), sign);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_xor_si256(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)),
+          sign);
+        const __m256i lt = _mm256_cmpgt_epi32(x, v);
+        count += __builtin_popcount(
+          _mm256_movemask_ps(_mm256_castsi256_ps(lt)));
+    }
+    return count + count_lower_scalar(data + i, n - i, needle);
+}
+
+[[gnu::target("sse4.2")]] static size_t
+count_lower_sse42(const uint32_t* data, size_t n, uint32_t needle) {
+    const __m128i sign = _mm_set1_epi32(INT32_MIN);
+    const __m128i x = _mm_xor_si128(_mm_set1_epi32(needle), sign);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i v = _mm_xor_si128(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), sign);
+        const __m128i lt = _mm_cmpgt_epi32(x, v);
+        count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(lt)));
+    }
+    return count + count_lower_scalar(data + i, n - i, needle);
+}
+#endif
+
+using count_lower_fn = size_t (*)(const uint32_t*, size_t, uint32_t);
+
+static count_lower_fn select_count_lower() {
+#if !defined __aarch64__
+    // may run before the cpu detection constructor, see syschecks.h
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return count_lower_avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return count_lower_sse42;
+    }
+#endif
+    return count_lower_scalar;
+}
+
+static const count_lower_fn count_lower_impl = select_count_lower();
+
+size_t count_lower(const uint32_t* data, size_t n, uint32_t needle) {
+    return count_lower_impl(data, n, needle);
+}
+
+void fence_index::track_push_back(const std::vector<uint32_t>& column) {
+    if ((column.size() - 1) % block_size == 0) {
+        _fences.push_back(column.back());
+    }
+}
+
+void fence_index::truncate(size_t column_size) {
+    _fences.resize((column_size + block_size - 1) / block_size);
+}
+
+void fence_index::rebuild(const std::vector<uint32_t>& column) {
+    _fences.clear();
+    _fences.reserve((column.size() + block_size - 1) / block_size);
+    for (size_t i = 0; i < column.size(); i += block_size) {
+        _fences.push_back(column[i]);
+    }
+}
+
+size_t fence_index::lower_bound(
+  const std::vector<uint32_t>& column, uint32_t needle) const {
+    /*
+     * the first fence that is not lower than the needle bounds the result
+     * from above. the result is then either the start of that block or
+     * somewhere in the previous one, whose fence is lower than the needle.
+     */
+    auto it = std::lower_bound(_fences.begin(), _fences.end(), needle);
+    if (it == _fences.begin()) {
+        return 0;
+    }
+    const size_t start = (std::distance(_fences.begin(), it) - 1) * block_size;
+    const size_t len = std::min(block_size, column.size() - start);
+    return start + count_lower(column.data() + start, len, needle);
+}
+
+} // namespace storage::internal
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace storage::internal {
+
+/**
+ * Two level lookup structure over a sorted column of the segment index.
+ *
+ * The column is split in blocks of 16 uint32_t. The fence array holds the first
+ * value of every block, so a lookup is a binary search over a 16x smaller array
+ * followed by a vectorized scan of one block of the column. Blocks are not
+ * aligned, the column is a plain vector shared with the index serialization.
+ *
+ *    fences:  [ f0               f1               f2          ]
+ *    column:  [ f0 .. (16) .. ] [ f1 .. (16) .. ] [ f2 .. (<=16) ]
+ *
+ * The fence index does not own the column, callers must keep it in sync with
+ * every change to the column.
+ */
+class fence_index {
+public:
+    static constexpr size_t block_size = 16;
+
+    /// \brief must be called after every push_back to the column
+    void track_push_back(const std::vector<uint32_t>& column);
+    /// \brief must be called after the column shrinks to \p column_size
+    void truncate(size_t column_size);
+    void rebuild(const std::vector<uint32_t>& column);
+    void clear() { _fences = {}; }
+
+    /// \brief same result as std::lower_bound over the whole column
+    size_t
+    lower_bound(const std::vector<uint32_t>& column, uint32_t needle) const;
+
+    size_t memory_usage() const {
+        return _fences.capacity() * sizeof(uint32_t);
+    }
+
+    friend bool operator==(const fence_index&, const fence_index&) = default;
+
+private:
+    std::vector<uint32_t> _fences;
+};
+
+/// \brief number of values in [data, data + n) that are lower than \p needle.
+/// dispatches at runtime to an AVX2 or SSE4.2 kernel when the cpu supports it
+size_t count_lower(const uint32_t* data, size_t n, uint32_t needle);
+size_t count_lower_scalar(const uint32_t* data, size_t n, uint32_t needle);
+
+} // namespace storage::internal
@@ -0,0 +1,98 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/flush_coordinator.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "storage/logger.h"
+#include "vlog.h"
+
+#include <seastar/core/metrics.hh>
+
+namespace storage::internal {
+
+flush_coordinator::flush_coordinator() noexcept
+  : _timer([this] { dispatch(); }) {}
+
+void flush_coordinator::start(std::chrono::microseconds window) {
+    _window = window;
+    setup_metrics();
+}
+
+ss::future<> flush_coordinator::flush(const void* owner, ss::file f) {
+    ++_requests;
+    auto m = _latency.auto_measure();
+    auto [it, _] = _pending.try_emplace(owner, std::move(f));
+    auto fut = it->second.done.get_shared_future();
+    if (_window == std::chrono::microseconds(0)) {
+        dispatch();
+    } else if (!_timer.armed()) {
+        _timer.arm(_window);
+    }
+    return fut.finally([m = std::move(m)] {});
+}
+
+void flush_coordinator::dispatch() {
+    _timer.cancel();
+    if (_pending.empty()) {
+        return;
+    }
+    ++_batches;
+    _syncs += _pending.size();
+    auto batch = ss::make_lw_shared<batch_t>(std::exchange(_pending, {}));
+    vlog(stlog.trace, "dispatching {} coalesced flushes", batch->size());
+    // requests made from now on wait for the next window, the bytes they
+    // cover may have been written after these syncs started
+    for (auto& entry : *batch) {
+        auto& sync = entry.second;
+        (void)sync.file.flush().then_wrapped(
+          [batch, &sync](ss::future<> f) mutable {
+              if (f.failed()) {
+                  sync.done.set_exception(f.get_exception());
+              } else {
+                  sync.done.set_value();
+              }
+          });
+    }
+}
+
+void flush_coordinator::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("storage:flush_coordinator"),
+      {
+        sm::make_derive(
+          "requests",
+          [this] { return _requests; },
+          sm::description("Number of segment flush requests")),
+        sm::make_derive(
+          "syncs",
+          [this] { return _syncs; },
+          sm::description("Number of fdatasync calls issued for the requests")),
+        sm::make_derive(
+          "batches",
+          [this] { return _batches; },
+          sm::description("Number of batches of syncs dispatched")),
+        sm::make_gauge(
+          "pending",
+          [this] { return _pending.size(); },
+          sm::description("Number of files waiting for the next batch")),
+        sm::make_histogram(
+          "flush_latency",
+          sm::description("Flush request latency in microseconds, including "
+                          "the coalescing window"),
+          [this] { return _latency.seastar_histogram_logform(); }),
+      });
+}
+
+} // namespace storage::internal
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "seastarx.h"
+#include "utils/hdr_hist.h"
+
+#include <seastar/core/file.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/shared_future.hh>
+#include <seastar/core/timer.hh>
+
+#include <absl/container/node_hash_map.h>
+
+#include <chrono>
+
+namespace storage::internal {
+
+/**
+ * Shard wide group commit of segment flushes.
+ *
+ * With many partitions per shard every segment appender flush used to issue
+ * its own fdatasync as soon as its writes completed. The coordinator instead
+ * collects the flush requests made within a small window and dispatches them
+ * together:
+ *
+ * - requests for the same file within a window share a single fdatasync
+ * - the syncs of a window are submitted at once so that the file system can
+ *   fold them into the same journal commit
+ *
+ * A request is resolved once the sync of a window that started after the
+ * request was made completes, so all the bytes written before the request are
+ * durable. With a zero window requests are dispatched right away.
+ */
+class flush_coordinator {
+public:
+    using clock_type = ss::steady_clock_type;
+
+    flush_coordinator() noexcept;
+    flush_coordinator(flush_coordinator&&) = delete;
+    flush_coordinator& operator=(flush_coordinator&&) = delete;
+    flush_coordinator(const flush_coordinator&) = delete;
+    flush_coordinator& operator=(const flush_coordinator&) = delete;
+    ~flush_coordinator() noexcept = default;
+
+    /// \brief sets the coalescing window and registers the metrics
+    void start(std::chrono::microseconds window);
+
+    /// \brief makes the data written to \p f before the call durable. \p owner
+    /// identifies the file: requests with the same owner share a sync.
+    ss::future<> flush(const void* owner, ss::file f);
+
+    std::chrono::microseconds window() const { return _window; }
+    uint64_t requests() const { return _requests; }
+    uint64_t syncs() const { return _syncs; }
+
+private:
+    struct pending_sync {
+        explicit pending_sync(ss::file f)
+          : file(std::move(f)) {}
+        ss::file file;
+        ss::shared_promise<> done;
+    };
+    // node map, shared promises stay in place while the syncs are in flight
+    using batch_t = absl::node_hash_map<const void*, pending_sync>;
+
+    void dispatch();
+    void setup_metrics();
+
+    std::chrono::microseconds _window{0};
+    batch_t _pending;
+    ss::timer<clock_type> _timer;
+
+    uint64_t _requests{0};
+    uint64_t _syncs{0};
+    uint64_t _batches{0};
+    hdr_hist _latency;
+    ss::metrics::metric_groups _metrics;
+};
+
+inline flush_coordinator& flusher() {
+    static thread_local flush_coordinator coordinator;
+    return coordinator;
+}
+
+} // namespace storage::internal
@@ -21,5 +21,6 @@ class segment;
 class snapshot_manager;
 class readers_cache;
 class compaction_controller;
+class compaction_scheduler;
 
 } // namespace storage
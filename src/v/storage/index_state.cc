@@ -20,6 +20,7 @@
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
+#include <array>
 #include <optional>
 
 namespace storage {
@@ -97,6 +98,72 @@ std::ostream& operator<<(std::ostream& o, const index_state& s) {
              << ")}";
 }
 
+/// \brief checksum of the fixed size header. the header checksum covers the
+/// global checksum, so a valid header also pins the contents of the entries
+static uint64_t checksum_header(const index_state& r, uint32_t vsize) {
+    auto xx = incremental_xxhash64{};
+    xx.update_all(
+      r.size,
+      r.checksum,
+      r.bitflags,
+      r.base_offset(),
+      r.max_offset(),
+      r.base_timestamp(),
+      r.max_timestamp(),
+      vsize);
+    return xx.digest();
+}
+
+/// \brief size of the encoded index, not including the version and size
+static uint32_t encoded_size(uint32_t vsize) {
+    return index_state::ondisk_header_size - sizeof(int8_t) - sizeof(uint32_t)
+           + (vsize * (sizeof(uint32_t) * 2 + sizeof(uint64_t)));
+}
+
+/// \brief decodes the header fields that follow the size. returns the number
+/// of entries in the index
+static std::optional<uint32_t>
+hydrate_header(iobuf_parser& parser, index_state& retval, int8_t version) {
+    retval.checksum = reflection::adl<uint64_t>{}.from(parser);
+    retval.bitflags = reflection::adl<uint32_t>{}.from(parser);
+    retval.base_offset = model::offset(
+      reflection::adl<model::offset::type>{}.from(parser));
+    retval.max_offset = model::offset(
+      reflection::adl<model::offset::type>{}.from(parser));
+    retval.base_timestamp = model::timestamp(
+      reflection::adl<model::timestamp::type>{}.from(parser));
+    retval.max_timestamp = model::timestamp(
+      reflection::adl<model::timestamp::type>{}.from(parser));
+
+    const uint32_t vsize = ss::le_to_cpu(
+      reflection::adl<uint32_t>{}.from(parser));
+    if (version < index_state::ondisk_version) {
+        return vsize;
+    }
+
+    const auto header_checksum = reflection::adl<uint64_t>{}.from(parser);
+    parser.skip(index_state::ondisk_header_size - parser.bytes_consumed());
+    const auto computed_checksum = checksum_header(retval, vsize);
+    if (unlikely(header_checksum != computed_checksum)) {
+        vlog(
+          stlog.debug,
+          "Invalid checksum for index header. Got:{}, expected:{}",
+          computed_checksum,
+          header_checksum);
+        return std::nullopt;
+    }
+    if (unlikely(retval.size != encoded_size(vsize))) {
+        vlog(
+          stlog.debug,
+          "Index header size does not match number of entries. Got:{}, "
+          "entries:{}",
+          retval.size,
+          vsize);
+        return std::nullopt;
+    }
+    return vsize;
+}
+
 std::optional<index_state> index_state::hydrate_from_buffer(iobuf b) {
     iobuf_parser parser(std::move(b));
     index_state retval;
@@ -106,8 +173,20 @@ std::optional<index_state> index_state::hydrate_from_buffer(iobuf b) {
     case index_state::ondisk_version:
         break;
 
+    case 3:
+        /*
+         * v3: same columns as v4 but with a variable length header that has
+         * no checksum of its own. it can only be decoded in full, the segment
+         * index rewrites it with the current version the next time it is
+         * persisted.
+         */
+        break;
+
     default:
         /*
+         * v4: fixed size (64 bytes) header with its own checksum, which allows
+         * decoding the header without reading the entries.
+         *
          * v3: changed the on-disk format to use 64-bit values for physical
          * offsets to avoid overflow for segments larger than 4gb. backwards
          * compat would require converting the overflowed values. instead, we
@@ -141,19 +220,11 @@ std::optional<index_state> index_state::hydrate_from_buffer(iobuf b) {
         return std::nullopt;
     }
 
-    retval.checksum = reflection::adl<uint64_t>{}.from(parser);
-    retval.bitflags = reflection::adl<uint32_t>{}.from(parser);
-    retval.base_offset = model::offset(
-      reflection::adl<model::offset::type>{}.from(parser));
-    retval.max_offset = model::offset(
-      reflection::adl<model::offset::type>{}.from(parser));
-    retval.base_timestamp = model::timestamp(
-      reflection::adl<model::timestamp::type>{}.from(parser));
-    retval.max_timestamp = model::timestamp(
-      reflection::adl<model::timestamp::type>{}.from(parser));
-
-    const uint32_t vsize = ss::le_to_cpu(
-      reflection::adl<uint32_t>{}.from(parser));
+    auto header = hydrate_header(parser, retval, version);
+    if (!header) {
+        return std::nullopt;
+    }
+    const uint32_t vsize = *header;
     retval.relative_offset_index.reserve(vsize);
     retval.relative_time_index.reserve(vsize);
     retval.position_index.reserve(vsize);
@@ -178,6 +249,38 @@ std::optional<index_state> index_state::hydrate_from_buffer(iobuf b) {
           retval.checksum);
         return std::nullopt;
     }
+    retval.offset_fences.rebuild(retval.relative_offset_index);
+    return retval;
+}
+
+std::optional<index_state>
+index_state::hydrate_header_from_buffer(iobuf b, size_t file_size) {
+    if (b.size_bytes() < ondisk_header_size) {
+        return std::nullopt;
+    }
+    iobuf_parser parser(std::move(b));
+    index_state retval;
+
+    auto version = reflection::adl<int8_t>{}.from(parser);
+    if (version != index_state::ondisk_version) {
+        // older versions have no standalone header, they must be decoded in
+        // full with hydrate_from_buffer
+        return std::nullopt;
+    }
+    retval.size = reflection::adl<uint32_t>{}.from(parser);
+    const size_t expected_file_size = retval.size + sizeof(int8_t)
+                                      + sizeof(uint32_t);
+    if (unlikely(file_size != expected_file_size)) {
+        vlog(
+          stlog.debug,
+          "Index file size does not match header size. Got:{}, expected:{}",
+          file_size,
+          expected_file_size);
+        return std::nullopt;
+    }
+    if (!hydrate_header(parser, retval, version)) {
+        return std::nullopt;
+    }
     return retval;
 }
 
@@ -188,16 +291,8 @@ iobuf index_state::checksum_and_serialize() {
         && relative_offset_index.size() == position_index.size(),
       "ALL indexes must match in size. {}",
       *this);
-    const uint32_t final_size
-      = sizeof(storage::index_state::checksum)
-        + sizeof(storage::index_state::bitflags)
-        + sizeof(storage::index_state::base_offset)
-        + sizeof(storage::index_state::max_offset)
-        + sizeof(storage::index_state::base_timestamp)
-        + sizeof(storage::index_state::max_timestamp)
-        + sizeof(uint32_t) // index size
-        + (relative_offset_index.size() * (sizeof(uint32_t) * 2 + sizeof(uint64_t)));
-    size = final_size;
+    const uint32_t vsize = relative_offset_index.size();
+    size = encoded_size(vsize);
     checksum = storage::index_state::checksum_state(*this);
     reflection::serialize(
       out,
@@ -209,8 +304,11 @@ iobuf index_state::checksum_and_serialize() {
       max_offset(),
       base_timestamp(),
       max_timestamp(),
-      uint32_t(relative_offset_index.size()));
-    const uint32_t vsize = relative_offset_index.size();
+      vsize,
+      checksum_header(*this, vsize));
+    // pad the header so that all the columns are aligned
+    const std::array<char, ondisk_header_size> padding{};
+    out.append(padding.data(), ondisk_header_size - out.size_bytes());
     for (auto i = 0U; i < vsize; ++i) {
         reflection::adl<uint32_t>{}.to(out, relative_offset_index[i]);
     }
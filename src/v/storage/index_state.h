@@ -14,6 +14,7 @@
 #include "bytes/iobuf.h"
 #include "model/fundamental.h"
 #include "model/timestamp.h"
+#include "storage/fence_index.h"
 
 #include <cstdint>
 #include <optional>
@@ -29,12 +30,20 @@ namespace storage {
    8 bytes - base_time
    8 bytes - max_time
    4 bytes - index.size()
+   8 bytes - header_checksum - xxhash64 of all fields above (v4+)
+   3 bytes - padding, the header is exactly 64 bytes (v4+)
    [] relative_offset_index
    [] relative_time_index
    [] position_index
+
+   Since v4 the header has a fixed size and is checksummed on its own. This
+   allows recovering the offset and time bounds of a segment by reading only
+   the first page of the index, and keeps every column naturally aligned in
+   the file so that the entries can be paged in later on demand.
  */
 struct index_state {
-    static constexpr int8_t ondisk_version = 3;
+    static constexpr int8_t ondisk_version = 4;
+    static constexpr size_t ondisk_header_size = 64;
 
     index_state() = default;
     index_state(index_state&&) noexcept = default;
@@ -62,6 +71,9 @@ struct index_state {
     std::vector<uint32_t> relative_offset_index;
     std::vector<uint32_t> relative_time_index;
     std::vector<uint64_t> position_index;
+    /// sparse top level index over relative_offset_index. not persisted,
+    /// rebuilt when the entries are hydrated
+    internal::fence_index offset_fences;
 
     bool empty() const { return relative_offset_index.empty(); }
 
@@ -70,11 +82,17 @@ struct index_state {
         relative_offset_index.push_back(relative_offset);
         relative_time_index.push_back(relative_time);
         position_index.push_back(pos);
+        offset_fences.track_push_back(relative_offset_index);
     }
     void pop_back() {
         relative_offset_index.pop_back();
         relative_time_index.pop_back();
         position_index.pop_back();
+        offset_fences.truncate(relative_offset_index.size());
+    }
+    /// \brief position of the first relative offset not lower than \p o
+    size_t offset_lower_bound(uint32_t o) const {
+        return offset_fences.lower_bound(relative_offset_index, o);
     }
     std::tuple<uint32_t, uint32_t, uint64_t> get_entry(size_t i) {
         return {
@@ -93,7 +111,28 @@ struct index_state {
 
     friend bool operator==(const index_state&, const index_state&) = default;
 
+    /// \brief memory used by the index entries
+    size_t entries_memory_usage() const {
+        return relative_offset_index.capacity() * sizeof(uint32_t)
+               + relative_time_index.capacity() * sizeof(uint32_t)
+               + position_index.capacity() * sizeof(uint64_t)
+               + offset_fences.memory_usage();
+    }
+    /// \brief releases the memory held by the index entries, leaving the
+    /// header fields (offset and time bounds) untouched
+    void release_entries() {
+        relative_offset_index = {};
+        relative_time_index = {};
+        position_index = {};
+        offset_fences.clear();
+    }
+
     static std::optional<index_state> hydrate_from_buffer(iobuf);
+    /// \brief decodes and validates only the fixed size header of a v4+
+    /// index. \p file_size is the size of the whole index file and is used to
+    /// validate the number of entries. The returned state has no entries.
+    static std::optional<index_state>
+    hydrate_header_from_buffer(iobuf, size_t file_size);
     static uint64_t checksum_state(const index_state&);
     friend std::ostream& operator<<(std::ostream&, const index_state&);
 };
@@ -0,0 +1,124 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/key_bloom_filter.h"
+
+#include "bytes/iobuf_parser.h"
+#include "hashing/crc32c.h"
+#include "hashing/xx.h"
+#include "reflection/adl.h"
+#include "storage/logger.h"
+#include "vlog.h"
+
+#include <fmt/ostream.h>
+
+#include <algorithm>
+
+namespace storage::internal {
+
+key_bloom_filter::key_bloom_filter(size_t expected_keys)
+  : _words(std::max<size_t>(1, (expected_keys * bits_per_key + 63) / 64), 0) {}
+
+uint64_t key_bloom_filter::hash(bytes_view key) {
+    return xxhash_64(key.data(), key.size());
+}
+
+void key_bloom_filter::add_hash(uint64_t h) {
+    const uint64_t nbits = size_bits();
+    const uint64_t h1 = h & 0xffffffff;
+    const uint64_t h2 = (h >> 32) | 1;
+    for (uint64_t i = 0; i < _hashes; ++i) {
+        const uint64_t bit = (h1 + i * h2) % nbits;
+        _words[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+bool key_bloom_filter::may_contain_hash(uint64_t h) const {
+    const uint64_t nbits = size_bits();
+    const uint64_t h1 = h & 0xffffffff;
+    const uint64_t h2 = (h >> 32) | 1;
+    for (uint64_t i = 0; i < _hashes; ++i) {
+        const uint64_t bit = (h1 + i * h2) % nbits;
+        if ((_words[bit / 64] & (uint64_t(1) << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t key_bloom_filter::checksum() const {
+    crc::crc32c crc;
+    crc.extend(_hashes);
+    crc.extend(uint32_t(_words.size()));
+    for (auto w : _words) {
+        crc.extend(w);
+    }
+    return crc.value();
+}
+
+iobuf key_bloom_filter::serialize() const {
+    iobuf out;
+    reflection::serialize(
+      out, ondisk_version, _hashes, uint32_t(_words.size()), checksum());
+    for (auto w : _words) {
+        reflection::adl<uint64_t>{}.to(out, w);
+    }
+    return out;
+}
+
+std::optional<key_bloom_filter> key_bloom_filter::deserialize(iobuf b) {
+    constexpr size_t header_size = sizeof(int8_t) + sizeof(uint8_t)
+                                   + sizeof(uint32_t) + sizeof(uint32_t);
+    if (b.size_bytes() < header_size) {
+        return std::nullopt;
+    }
+    iobuf_parser parser(std::move(b));
+    auto version = reflection::adl<int8_t>{}.from(parser);
+    if (version != ondisk_version) {
+        vlog(stlog.debug, "Unknown key bloom filter version: {}", version);
+        return std::nullopt;
+    }
+    auto hashes = reflection::adl<uint8_t>{}.from(parser);
+    auto nwords = reflection::adl<uint32_t>{}.from(parser);
+    auto expected_checksum = reflection::adl<uint32_t>{}.from(parser);
+    if (
+      hashes == 0 || nwords == 0
+      || parser.bytes_left() != nwords * sizeof(uint64_t)) {
+        vlog(
+          stlog.debug,
+          "Invalid key bloom filter, hashes:{}, words:{}, bytes left:{}",
+          hashes,
+          nwords,
+          parser.bytes_left());
+        return std::nullopt;
+    }
+    std::vector<uint64_t> words;
+    words.reserve(nwords);
+    for (auto i = 0U; i < nwords; ++i) {
+        words.push_back(reflection::adl<uint64_t>{}.from(parser));
+    }
+    key_bloom_filter retval(hashes, std::move(words));
+    if (retval.checksum() != expected_checksum) {
+        vlog(
+          stlog.debug,
+          "Key bloom filter checksum mismatch. Got:{}, expected:{}",
+          retval.checksum(),
+          expected_checksum);
+        return std::nullopt;
+    }
+    return retval;
+}
+
+std::ostream& operator<<(std::ostream& o, const key_bloom_filter& f) {
+    fmt::print(
+      o, "{{hashes:{}, bits:{}}}", uint32_t(f._hashes), f.size_bits());
+    return o;
+}
+
+} // namespace storage::internal
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include "bytes/bytes.h"
+#include "bytes/iobuf.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <vector>
+
+namespace storage::internal {
+
+/**
+ * Bloom filter over the keys of a compacted segment.
+ *
+ * It is built while self-compaction writes the deduplicated compaction index
+ * and persisted next to it. Adjacent segment compaction uses it to skip the
+ * pairs of segments that share no keys: deduplicating them would rewrite the
+ * data without removing a single record.
+ *
+ * Keys are hashed once with xxhash64 and the probe positions are derived with
+ * double hashing. With 10 bits per key and 7 probes the false positive rate is
+ * about 1%. There are no false negatives.
+ */
+class key_bloom_filter {
+public:
+    static constexpr int8_t ondisk_version = 0;
+    static constexpr size_t bits_per_key = 10;
+    static constexpr uint8_t default_hashes = 7;
+
+    /// \brief sized for \p expected_keys at `bits_per_key`
+    explicit key_bloom_filter(size_t expected_keys);
+
+    void add(bytes_view key) { add_hash(hash(key)); }
+    bool may_contain(bytes_view key) const {
+        return may_contain_hash(hash(key));
+    }
+
+    void add_hash(uint64_t h);
+    bool may_contain_hash(uint64_t h) const;
+
+    static uint64_t hash(bytes_view key);
+
+    size_t size_bits() const { return _words.size() * 64; }
+    size_t memory_usage() const { return _words.capacity() * sizeof(uint64_t); }
+
+    iobuf serialize() const;
+    /// \brief returns nullopt if the buffer is corrupted or of an unknown
+    /// version
+    static std::optional<key_bloom_filter> deserialize(iobuf);
+
+    friend bool operator==(const key_bloom_filter&, const key_bloom_filter&)
+      = default;
+    friend std::ostream& operator<<(std::ostream&, const key_bloom_filter&);
+
+private:
+    key_bloom_filter(uint8_t hashes, std::vector<uint64_t> words)
+      : _hashes(hashes)
+      , _words(std::move(words)) {}
+
+    uint32_t checksum() const;
+
+    uint8_t _hashes{default_hashes};
+    std::vector<uint64_t> _words;
+};
+
+} // namespace storage::internal
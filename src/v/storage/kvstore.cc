@@ -19,6 +19,7 @@
 #include "storage/record_batch_builder.h"
 #include "storage/segment_set.h"
 #include "storage/types.h"
+#include "utils/directory_walker.h"
 #include "vlog.h"
 
 #include <seastar/core/metrics.hh>
@@ -26,6 +27,9 @@
 #include <seastar/util/defer.hh>
 #include <seastar/util/log.hh>
 
+#include <map>
+#include <regex>
+
 static ss::logger lg("kvstore");
 
 namespace storage {
@@ -50,6 +54,19 @@ ss::future<> kvstore::start() {
               "segments_rolled",
               [this] { return _probe.segments_rolled; },
               ss::metrics::description("Number of segments rolled")),
+            ss::metrics::make_total_operations(
+              "full_snapshots",
+              [this] { return _probe.full_snapshots; },
+              ss::metrics::description("Number of full snapshots written")),
+            ss::metrics::make_total_operations(
+              "delta_snapshots",
+              [this] { return _probe.delta_snapshots; },
+              ss::metrics::description("Number of delta snapshots written")),
+            ss::metrics::make_total_operations(
+              "delta_snapshot_entries",
+              [this] { return _probe.delta_snapshot_entries; },
+              ss::metrics::description(
+                "Number of entries written to delta snapshots")),
             ss::metrics::make_total_operations(
               "entries_fetched",
               [this] { return _probe.entries_fetched; },
@@ -131,7 +148,7 @@ ss::future<> kvstore::stop() {
 /*
  * Return a key prefixed by a key-space
  */
-static inline bytes make_spaced_key(kvstore::key_space ks, bytes_view key) {
+bytes kvstore::make_spaced_key(key_space ks, bytes_view key) {
     auto ks_native
       = static_cast<std::underlying_type<kvstore::key_space>::type>(ks);
     auto ks_le = ss::cpu_to_le(ks_native);
@@ -181,6 +198,7 @@ ss::future<> kvstore::put(key_space ks, bytes key, std::optional<iobuf> value) {
 }
 
 void kvstore::apply_op(bytes key, std::optional<iobuf> value) {
+    _dirty.insert(key);
     auto it = _db.find(key);
     bool found = it != _db.end();
     if (value) {
@@ -314,11 +332,23 @@ ss::future<> kvstore::save_snapshot() {
       "Unexpected next offset {}",
       _next_offset);
 
-    // no operations have been applied to the db
-    if (_next_offset == model::offset(0)) {
+    // no operations have been applied to the db since the last snapshot
+    if (_next_offset == _snapshot_offset) {
         return ss::now();
     }
 
+    // deltas must chain from a full snapshot, and are only worth it while
+    // replaying them is cheaper than loading a full snapshot
+    if (
+      _snapshot_offset == model::offset(0) || _dirty.empty()
+      || _deltas.size() >= max_delta_snapshots
+      || _delta_entries + _dirty.size() > _db.size()) {
+        return save_full_snapshot();
+    }
+    return save_delta_snapshot();
+}
+
+ss::future<> kvstore::save_full_snapshot() {
     vlog(
       lg.debug,
       "Creating snapshot at offset {}",
@@ -341,31 +371,115 @@ ss::future<> kvstore::save_snapshot() {
     auto size = ss::cpu_to_le(int32_t(data.size_bytes() - sizeof(int32_t)));
     ph.write((const char*)&size, sizeof(size));
 
-    return _snap.start_snapshot().then(
-      [this, data = std::move(data)](snapshot_writer writer) mutable {
+    // the last log offset represented in the snapshot
+    iobuf meta;
+    reflection::serialize(meta, _next_offset - model::offset(1));
+
+    // snapshot state is only reset once the snapshot is stored, a failed
+    // write leaves the previous snapshot and the deltas in place
+    return write_snapshot(_snap, std::move(meta), std::move(data))
+      .then([this, snapshot_offset = _next_offset] {
+          _dirty.clear();
+          auto deltas = std::exchange(_deltas, {});
+          _delta_entries = 0;
+          _snapshot_offset = snapshot_offset;
+          _probe.full_snapshot();
+          // the full snapshot covers all the deltas
           return ss::do_with(
-            std::move(writer),
-            [this, data = std::move(data)](snapshot_writer& wr) mutable {
-                // the last log offset represented in the snapshot
-                auto last_offset = _next_offset - model::offset(1);
+            std::move(deltas), [](std::vector<delta_snapshot>& deltas) {
+                return ss::do_for_each(deltas, [](delta_snapshot& d) {
+                    vlog(lg.debug, "Removing delta snapshot {}", d.path);
+                    return ss::remove_file(d.path.string());
+                });
+            });
+      });
+}
+
+ss::future<> kvstore::save_delta_snapshot() {
+    const auto last_offset = _next_offset - model::offset(1);
+    vlog(
+      lg.debug,
+      "Creating delta snapshot of {} keys for offsets [{}, {}]",
+      _dirty.size(),
+      _snapshot_offset,
+      last_offset);
+
+    // deltas are encoded like the log: a missing value is a deletion
+    storage::record_batch_builder builder(
+      model::record_batch_type::kvstore, model::offset(0));
+    for (const auto& key : _dirty) {
+        std::optional<iobuf> value;
+        if (auto it = _db.find(key); it != _db.end()) {
+            value = it->second.share(0, it->second.size_bytes());
+        }
+        builder.add_raw_kv(
+          bytes_to_iobuf(key), reflection::to_iobuf(std::move(value)));
+    }
+    auto batch = std::move(builder).build();
 
-                iobuf meta;
-                reflection::serialize(meta, last_offset);
+    iobuf data;
+    auto ph = data.reserve(sizeof(int32_t));
+    reflection::serialize(data, std::move(batch));
+    auto size = ss::cpu_to_le(int32_t(data.size_bytes() - sizeof(int32_t)));
+    ph.write((const char*)&size, sizeof(size));
 
+    // the range of log offsets represented in the delta
+    iobuf meta;
+    reflection::serialize(meta, _snapshot_offset, last_offset);
+
+    const auto entries = _dirty.size();
+    auto path = delta_snapshot_path(last_offset);
+    auto mgr = std::make_unique<snapshot_manager>(
+      path.parent_path(),
+      path.filename().string(),
+      ss::default_priority_class());
+    auto& mgr_ref = *mgr;
+    return write_snapshot(mgr_ref, std::move(meta), std::move(data))
+      .then([this,
+             entries,
+             path,
+             snapshot_offset = _next_offset,
+             mgr = std::move(mgr)] {
+          _dirty.clear();
+          _snapshot_offset = snapshot_offset;
+          _probe.delta_snapshot(entries);
+          _deltas.push_back(delta_snapshot{path, entries});
+          _delta_entries += entries;
+      });
+}
+
+ss::future<>
+kvstore::write_snapshot(snapshot_manager& mgr, iobuf meta, iobuf data) {
+    return mgr.start_snapshot().then(
+      [&mgr, meta = std::move(meta), data = std::move(data)](
+        snapshot_writer writer) mutable {
+          return ss::do_with(
+            std::move(writer),
+            [&mgr, meta = std::move(meta), data = std::move(data)](
+              snapshot_writer& wr) mutable {
                 return wr.write_metadata(std::move(meta))
                   .then([&wr, data = std::move(data)]() mutable {
                       auto& os = wr.output(); // kept alive by do_with above
                       return write_iobuf_to_output_stream(std::move(data), os);
                   })
                   .then([&wr] { return wr.close(); })
-                  .then([this, &wr]() {
+                  .then([&mgr, &wr]() {
                       vlog(lg.debug, "Finishing snapshot creation");
-                      return _snap.finish_snapshot(wr);
+                      return mgr.finish_snapshot(wr);
                   });
             });
       });
 }
 
+std::filesystem::path
+kvstore::delta_snapshot_path(model::offset last_offset) const {
+    return std::filesystem::path(_ntpc.work_directory())
+           / fmt::format(
+             "{}.delta.{}",
+             snapshot_manager::default_snapshot_filename,
+             last_offset());
+}
+
 ss::future<> kvstore::recover() {
     return ss::async([this] {
         /*
@@ -373,6 +487,7 @@ ss::future<> kvstore::recover() {
          * is found, or the offset immediately following the snapshot offset.
          */
         load_snapshot_in_thread();
+        load_delta_snapshots_in_thread();
 
         auto dir = std::filesystem::path(_ntpc.work_directory());
         auto segments = recover_segments(
@@ -410,7 +525,115 @@ void kvstore::load_snapshot_in_thread() {
       last_offset);
 
     // read and restore db from snapshot
-    auto buf = read_iobuf_exactly(reader->input(), sizeof(int32_t)).get0();
+    auto batch = read_snapshot_batch_in_thread(*reader);
+
+    batch.for_each_record([this](model::record r) {
+        auto key = iobuf_to_bytes(r.release_key());
+        _probe.add_cached_bytes(key.size() + r.value().size_bytes());
+        auto res = _db.emplace(std::move(key), r.release_value());
+        vassert(
+          res.second, "Snapshot contained duplicate key {}", res.first->first);
+        vlog(
+          lg.trace,
+          "Load snapshot: restoring key={} value={}",
+          res.first->first,
+          res.first->second);
+    });
+
+    _next_offset = last_offset + model::offset(1);
+    _snapshot_offset = _next_offset;
+}
+
+void kvstore::load_delta_snapshots_in_thread() {
+    _gate.check(); // early out on shutdown
+
+    // delta snapshots by the last offset they represent
+    std::regex re(fmt::format(
+      R"(^{}\.delta\.(\d+)$)", snapshot_manager::default_snapshot_filename));
+    std::regex partial_re(fmt::format(
+      R"(^{}\.delta\.\d+\.partial\..*$)",
+      snapshot_manager::default_snapshot_filename));
+    std::map<model::offset, std::filesystem::path> deltas;
+    const auto dir = std::filesystem::path(_ntpc.work_directory());
+    if (!ss::file_exists(dir.string()).get0()) {
+        return;
+    }
+    directory_walker::walk(
+      dir.string(),
+      [&](ss::directory_entry ent) {
+          if (!ent.type || *ent.type != ss::directory_entry_type::regular) {
+              return ss::now();
+          }
+          std::cmatch match;
+          if (std::regex_match(ent.name.c_str(), match, re)) {
+              deltas.emplace(
+                model::offset(std::stoll(match[1].str())),
+                dir / ent.name.c_str());
+          } else if (std::regex_match(ent.name.c_str(), partial_re)) {
+              return ss::remove_file((dir / ent.name.c_str()).string());
+          }
+          return ss::now();
+      })
+      .get();
+
+    for (auto& [last_offset, path] : deltas) {
+        // covered by the full snapshot, left behind by a crash after it was
+        // written
+        if (last_offset < _next_offset) {
+            vlog(lg.debug, "Removing stale delta snapshot {}", path);
+            ss::remove_file(path.string()).get();
+            continue;
+        }
+
+        snapshot_manager mgr(
+          path.parent_path(),
+          path.filename().string(),
+          ss::default_priority_class());
+        auto reader = mgr.open_snapshot().get0();
+        vassert(reader, "Delta snapshot {} not found", path);
+        auto close_reader = ss::defer(
+          [&reader] { return reader->close().get(); });
+
+        auto meta = reader->read_metadata().get0();
+        iobuf_parser parser(std::move(meta));
+        auto start = model::offset(
+          reflection::adl<model::offset::type>{}.from(parser));
+        auto last = model::offset(
+          reflection::adl<model::offset::type>{}.from(parser));
+        if (start != _next_offset) {
+            throw std::runtime_error(fmt::format(
+              "Delta snapshot {} starts at offset {} expected {}",
+              path,
+              start,
+              _next_offset));
+        }
+        vlog(
+          lg.debug,
+          "Load snapshot: applying delta snapshot for offsets [{}, {}]",
+          start,
+          last);
+
+        auto batch = read_snapshot_batch_in_thread(*reader);
+        const auto entries = static_cast<size_t>(batch.record_count());
+        batch.for_each_record([this](model::record r) {
+            auto key = iobuf_to_bytes(r.release_key());
+            auto value = reflection::from_iobuf<std::optional<iobuf>>(
+              r.release_value());
+            apply_op(std::move(key), std::move(value));
+        });
+
+        _deltas.push_back(delta_snapshot{path, entries});
+        _delta_entries += entries;
+        _next_offset = last + model::offset(1);
+        _snapshot_offset = _next_offset;
+    }
+    // the deltas are already durable
+    _dirty.clear();
+}
+
+model::record_batch
+kvstore::read_snapshot_batch_in_thread(snapshot_reader& reader) {
+    auto buf = read_iobuf_exactly(reader.input(), sizeof(int32_t)).get0();
     if (buf.size_bytes() != sizeof(int32_t)) {
         throw std::runtime_error(fmt::format(
           "Failed to read snapshot size. Wanted {} bytes != {}",
@@ -419,7 +642,7 @@ void kvstore::load_snapshot_in_thread() {
     }
     auto size = reflection::from_iobuf<int32_t>(std::move(buf));
 
-    buf = read_iobuf_exactly(reader->input(), size).get0();
+    buf = read_iobuf_exactly(reader.input(), size).get0();
     if ((int32_t)buf.size_bytes() != size) {
         throw std::runtime_error(fmt::format(
           "Failed to read snapshot data. Wanted {} bytes != {}",
@@ -442,21 +665,7 @@ void kvstore::load_snapshot_in_thread() {
           header_crc,
           batch.header().header_crc));
     }
-
-    batch.for_each_record([this](model::record r) {
-        auto key = iobuf_to_bytes(r.release_key());
-        _probe.add_cached_bytes(key.size() + r.value().size_bytes());
-        auto res = _db.emplace(std::move(key), r.release_value());
-        vassert(
-          res.second, "Snapshot contained duplicate key {}", res.first->first);
-        vlog(
-          lg.trace,
-          "Load snapshot: restoring key={} value={}",
-          res.first->first,
-          res.first->second);
-    });
-
-    _next_offset = last_offset + model::offset(1);
+    return batch;
 }
 
 void kvstore::replay_segments_in_thread(segment_set segs) {
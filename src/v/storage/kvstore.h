@@ -25,7 +25,8 @@
 #include <seastar/core/semaphore.hh>
 #include <seastar/core/timer.hh>
 
-#include <absl/container/flat_hash_map.h>
+#include <absl/container/btree_map.h>
+#include <absl/container/flat_hash_set.h>
 
 namespace storage {
 
@@ -60,6 +61,17 @@ namespace storage {
  * in which access to the underlying file storing the metadata was already
  * controlled.
  *
+ * Snapshots
+ * =========
+ *
+ * When a segment is rolled its operations are folded into a snapshot so that
+ * the segment can be removed. Rewriting the whole database on every roll is
+ * expensive with many keys, so most rolls only write a delta snapshot with the
+ * keys changed since the previous snapshot. A full snapshot is written once the
+ * deltas grow larger than the database or there are too many of them, at which
+ * point the deltas are removed. Recovery loads the full snapshot, applies the
+ * chain of deltas on top of it, and then replays the segments.
+ *
  * Limitations
  * ===========
  *
@@ -107,12 +119,66 @@ public:
     ss::future<> put(key_space ks, bytes key, iobuf value);
     ss::future<> remove(key_space ks, bytes key);
 
+    /**
+     * Calls \p f(key, value) for every key in \p ks that starts with \p
+     * prefix, in key order. Keys are passed without the key space. \p f must
+     * not yield.
+     */
+    template<typename Func>
+    void for_each(key_space ks, bytes_view prefix, Func&& f) const {
+        vassert(_started, "kvstore has not been started");
+        const auto spaced_prefix = make_spaced_key(ks, prefix);
+        const bytes_view p(spaced_prefix);
+        for (auto it = _db.lower_bound(p); it != _db.end(); ++it) {
+            const bytes_view key(it->first);
+            if (key.substr(0, p.size()) != p) {
+                break;
+            }
+            f(key.substr(key_space_size), it->second);
+        }
+    }
+
+    /**
+     * Calls \p f(key, value) for every key in \p ks in the range [\p start,
+     * \p end), in key order. Keys are passed without the key space. The
+     * range is empty when \p start is not below \p end. \p f must not yield.
+     */
+    template<typename Func>
+    void for_each_in_range(
+      key_space ks, bytes_view start, bytes_view end, Func&& f) const {
+        vassert(_started, "kvstore has not been started");
+        if (start >= end) {
+            return;
+        }
+        const auto spaced_end = make_spaced_key(ks, end);
+        const auto last = _db.lower_bound(bytes_view(spaced_end));
+        for (auto it = _db.lower_bound(bytes_view(make_spaced_key(ks, start)));
+             it != last;
+             ++it) {
+            f(bytes_view(it->first).substr(key_space_size), it->second);
+        }
+    }
+
     bool empty() const {
         vassert(_started, "kvstore has not been started");
         return _db.empty();
     }
 
 private:
+    static constexpr size_t key_space_size = sizeof(
+      std::underlying_type_t<key_space>);
+    // a full snapshot is written after this many delta snapshots
+    static constexpr size_t max_delta_snapshots = 8;
+
+    static bytes make_spaced_key(key_space ks, bytes_view key);
+
+    // keys of the database are ordered so that all the keys of a key space,
+    // and all the keys with a common prefix, are adjacent
+    struct key_less {
+        using is_transparent = void;
+        bool operator()(bytes_view a, bytes_view b) const { return a < b; }
+    };
+
     kvstore_config _conf;
     ntp_config _ntpc;
     ss::gate _gate;
@@ -144,13 +210,30 @@ private:
     ss::semaphore _sem{0};
     ss::lw_shared_ptr<segment> _segment;
     model::offset _next_offset;
-    absl::flat_hash_map<bytes, iobuf, bytes_type_hash, bytes_type_eq> _db;
+    absl::btree_map<bytes, iobuf, key_less> _db;
+
+    /*
+     * snapshot state. `_dirty` holds the keys changed since the last snapshot,
+     * full or delta, which covers all the offsets below `_snapshot_offset`.
+     */
+    struct delta_snapshot {
+        std::filesystem::path path;
+        size_t entries;
+    };
+    absl::flat_hash_set<bytes, bytes_type_hash, bytes_type_eq> _dirty;
+    std::vector<delta_snapshot> _deltas;
+    size_t _delta_entries{0};
+    model::offset _snapshot_offset{0};
 
     ss::future<> put(key_space ks, bytes key, std::optional<iobuf> value);
     void apply_op(bytes key, std::optional<iobuf> value);
     ss::future<> flush_and_apply_ops();
     ss::future<> roll();
     ss::future<> save_snapshot();
+    ss::future<> save_full_snapshot();
+    ss::future<> save_delta_snapshot();
+    ss::future<> write_snapshot(snapshot_manager&, iobuf meta, iobuf data);
+    std::filesystem::path delta_snapshot_path(model::offset last_offset) const;
 
     /*
      * Recovery
@@ -160,6 +243,8 @@ private:
      */
     ss::future<> recover();
     void load_snapshot_in_thread();
+    void load_delta_snapshots_in_thread();
+    model::record_batch read_snapshot_batch_in_thread(snapshot_reader&);
     void replay_segments_in_thread(segment_set);
 
     /**
@@ -194,6 +279,11 @@ private:
 
     struct probe {
         void roll_segment() { ++segments_rolled; }
+        void full_snapshot() { ++full_snapshots; }
+        void delta_snapshot(size_t entries) {
+            ++delta_snapshots;
+            delta_snapshot_entries += entries;
+        }
         void entry_fetched() { ++entries_fetched; }
         void entry_written() { ++entries_written; }
         void entry_removed() { ++entries_removed; }
@@ -201,6 +291,9 @@ private:
         void dec_cached_bytes(size_t count) { cached_bytes -= count; }
 
         uint64_t segments_rolled{0};
+        uint64_t full_snapshots{0};
+        uint64_t delta_snapshots{0};
+        uint64_t delta_snapshot_entries{0};
         uint64_t entries_fetched{0};
         uint64_t entries_written{0};
         uint64_t entries_removed{0};
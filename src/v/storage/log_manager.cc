@@ -55,7 +55,13 @@ log_manager::log_manager(log_config config, kvstore& kvstore) noexcept
   : _config(std::move(config))
   , _kvstore(kvstore)
   , _jitter(_config.compaction_interval)
-  , _batch_cache(config.reclaim_opts) {
+  , _index_cache(_config.index_cache_max_memory)
+  , _batch_cache(config.reclaim_opts)
+  , _compaction_scheduler(
+      _config.compaction_max_concurrent_jobs,
+      _config.compaction_max_bytes_per_sec) {
+    _compaction_scheduler.setup_metrics(
+      [this] { return compaction_backlog(); });
     _compaction_timer.set_callback([this] { trigger_housekeeping(); });
     _compaction_timer.rearm(_jitter());
 }
@@ -78,6 +84,7 @@ void log_manager::trigger_housekeeping() {
 ss::future<> log_manager::stop() {
     _compaction_timer.cancel();
     _abort_source.request_abort();
+    _compaction_scheduler.stop();
     return _open_gate.close()
       .then([this] {
           return ss::parallel_for_each(_logs, [](logs_type::value_type& entry) {
@@ -114,34 +121,68 @@ ss::future<> log_manager::housekeeping() {
      * hotpath / (request-response)
      */
     using bflags = log_housekeeping_meta::bitflags;
+    // compactions run in the background, at most
+    // `compaction_max_concurrent_jobs` at a time. the round ends once all of
+    // them finished
+    auto jobs = ss::make_lw_shared<ss::gate>();
     return ss::do_until(
              [this] {
                  auto it = find_next_non_compacted_log(_logs);
                  return it == _logs.end();
              },
-             [this, collection_threshold] {
-                 return ss::with_scheduling_group(
-                   _config.compaction_sg, [this, collection_threshold] {
+             [this, collection_threshold, jobs] {
+                 return _compaction_scheduler.acquire_job_slot().then(
+                   [this, collection_threshold, jobs](
+                     ss::semaphore_units<> units) {
                        auto it = find_next_non_compacted_log(_logs);
                        if (it == _logs.end()) {
-                           // must check again because between the stop
-                           // condition and this continuation we might have
-                           // removed the log
-                           return ss::now();
+                           // must check again because while waiting for a
+                           // slot we might have removed the log
+                           return;
                        }
                        it->second.flags |= bflags::compacted;
                        it->second.last_compaction = ss::lowres_clock::now();
-                       return it->second.handle.compact(compaction_config(
+                       compaction_config cfg(
                          collection_threshold,
                          _config.retention_bytes,
                          _config.compaction_priority,
-                         _abort_source));
+                         _abort_source);
+                       cfg.scheduler = &_compaction_scheduler;
+                       // the handle keeps the log alive if it is removed
+                       // while being compacted
+                       (void)ss::with_gate(
+                         *jobs,
+                         [this,
+                          handle = it->second.handle,
+                          cfg,
+                          units = std::move(units)]() mutable {
+                             return ss::with_scheduling_group(
+                                      _config.compaction_sg,
+                                      [this, handle, cfg]() mutable {
+                                          return _compaction_scheduler.run_job(
+                                            [handle, cfg]() mutable {
+                                                return handle.compact(cfg);
+                                            });
+                                      })
+                               .handle_exception(
+                                 [ntp = handle.config().ntp()](
+                                   std::exception_ptr e) {
+                                     vlog(
+                                       stlog.info,
+                                       "Error compacting {}: {}",
+                                       ntp,
+                                       e);
+                                 })
+                               .finally([units = std::move(units)] {});
+                         });
                    });
              })
-      .finally([this] {
-          for (auto& h : _logs) {
-              h.second.flags &= ~bflags::compacted;
-          }
+      .finally([this, jobs] {
+          return jobs->close().finally([this, jobs] {
+              for (auto& h : _logs) {
+                  h.second.flags &= ~bflags::compacted;
+              }
+          });
       });
 }
 ss::future<ss::lw_shared_ptr<segment>> log_manager::make_log_segment(
@@ -161,7 +202,11 @@ ss::future<ss::lw_shared_ptr<segment>> log_manager::make_log_segment(
             version,
             buf_size,
             _config.sanitize_fileops,
-            create_cache(ntp.cache_enabled()));
+            create_cache(ntp.cache_enabled()))
+            .then([this](ss::lw_shared_ptr<segment> seg) {
+                seg->index().set_cache(&_index_cache);
+                return seg;
+            });
       });
 }
 
@@ -222,6 +267,9 @@ ss::future<log> log_manager::do_manage(ntp_config cfg) {
                  [this, cache_enabled] { return create_cache(cache_enabled); },
                  _abort_source)
           .then([this, cfg = std::move(cfg)](segment_set segments) mutable {
+              for (auto& s : segments) {
+                  s->index().set_cache(&_index_cache);
+              }
               auto l = storage::make_disk_backed_log(
                 std::move(cfg), *this, std::move(segments), _kvstore);
               auto [_, success] = _logs.emplace(l.config().ntp(), l);
@@ -343,11 +391,19 @@ std::ostream& operator<<(std::ostream& o, const log_config& c) {
     return o << ", compaction_interval_ms:" << c.compaction_interval.count()
              << ", delete_reteion_ms:" << c.delete_retention.count()
              << ", with_cache:" << c.cache
-             << ", relcaim_opts:" << c.reclaim_opts << "}";
+             << ", relcaim_opts:" << c.reclaim_opts
+             << ", index_cache_max_memory:" << c.index_cache_max_memory
+             << ", compaction_max_concurrent_jobs:"
+             << c.compaction_max_concurrent_jobs
+             << ", compaction_max_bytes_per_sec:"
+             << c.compaction_max_bytes_per_sec.value_or(0)
+             << ", compaction_max_segments_per_job:"
+             << c.compaction_max_segments_per_job << "}";
 }
 std::ostream& operator<<(std::ostream& o, const log_manager& m) {
     return o << "{config:" << m._config << ", logs.size:" << m._logs.size()
              << ", cache:" << m._batch_cache
+             << ", index_cache:" << m._index_cache
              << ", compaction_timer.armed:" << m._compaction_timer.armed()
              << "}";
 }
@@ -15,6 +15,7 @@
 #include "random/simple_time_jitter.h"
 #include "seastarx.h"
 #include "storage/batch_cache.h"
+#include "storage/compaction_scheduler.h"
 #include "storage/log.h"
 #include "storage/log_housekeeping_meta.h"
 #include "storage/ntp_config.h"
@@ -132,6 +133,14 @@ struct log_config {
     std::chrono::milliseconds readers_cache_eviction_timeout
       = std::chrono::seconds(30);
     ss::scheduling_group compaction_sg;
+    // memory budget for the entries of sealed segment indices
+    size_t index_cache_max_memory = 64_MiB;
+    // number of partitions compacted at the same time by each shard
+    size_t compaction_max_concurrent_jobs = 2;
+    // per shard compaction i/o budget, unlimited if not set
+    std::optional<size_t> compaction_max_bytes_per_sec = std::nullopt;
+    // max number of adjacent segments merged by a single compaction step
+    size_t compaction_max_segments_per_job = 8;
     friend std::ostream& operator<<(std::ostream& o, const log_config&);
 }; // namespace storage
 
@@ -218,6 +227,10 @@ public:
 
     int64_t compaction_backlog() const;
 
+    compaction_scheduler& get_compaction_scheduler() {
+        return _compaction_scheduler;
+    }
+
 private:
     using logs_type = absl::flat_hash_map<model::ntp, log_housekeeping_meta>;
 
@@ -240,8 +253,11 @@ private:
     kvstore& _kvstore;
     simple_time_jitter<ss::lowres_clock> _jitter;
     ss::timer<ss::lowres_clock> _compaction_timer;
+    // must outlive the segments of all the managed logs
+    segment_index_cache _index_cache;
     logs_type _logs;
     batch_cache _batch_cache;
+    compaction_scheduler _compaction_scheduler;
     ss::gate _open_gate;
     ss::abort_source _abort_source;
 
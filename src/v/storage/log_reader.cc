@@ -133,7 +133,16 @@ log_segment_batch_reader::log_segment_batch_reader(
 std::unique_ptr<continuous_batch_parser> log_segment_batch_reader::initialize(
   model::timeout_clock::time_point timeout,
   std::optional<model::offset> next_cached_batch) {
-    auto input = _seg.offset_data_stream(_config.start_offset, _config.prio);
+    ss::input_stream<char> input;
+    if (_config.read_buffer_size) {
+        input = _seg.offset_data_stream(
+          _config.start_offset,
+          _config.prio,
+          *_config.read_buffer_size,
+          read_ahead_buffers);
+    } else {
+        input = _seg.offset_data_stream(_config.start_offset, _config.prio);
+    }
     return std::make_unique<continuous_batch_parser>(
       std::make_unique<skipping_consumer>(*this, timeout, next_cached_batch),
       std::move(input));
@@ -198,8 +207,23 @@ log_segment_batch_reader::read_some(model::timeout_clock::time_point timeout) {
     }
 
     if (!_iterator) {
-        _iterator = initialize(timeout, cache_read.next_cached_batch);
+        /*
+         * the index entries of a sealed segment may have been released to
+         * stay within the index memory budget. page them back in before
+         * looking up the file position to start reading from.
+         */
+        return _seg.index().hydrate().then(
+          [this, timeout, next_cached = cache_read.next_cached_batch] {
+              if (!_iterator) {
+                  _iterator = initialize(timeout, next_cached);
+              }
+              return read_from_iterator();
+          });
     }
+    return read_from_iterator();
+}
+
+ss::future<result<records_t>> log_segment_batch_reader::read_from_iterator() {
     auto ptr = _iterator.get();
     return ptr->consume().then(
       [this](result<size_t> bytes_consumed) -> result<records_t> {
@@ -89,6 +89,9 @@ private:
 class log_segment_batch_reader {
 public:
     static constexpr size_t max_buffer_size = 32 * 1024; // 32KB
+    /// number of buffers read ahead when log_reader_config::read_buffer_size
+    /// is set
+    static constexpr unsigned read_ahead_buffers = 4;
 
     log_segment_batch_reader(
       segment&, log_reader_config& config, probe& p) noexcept;
@@ -111,6 +114,8 @@ private:
       std::optional<model::offset> next_cached_batch);
 
     void add_one(model::record_batch&&);
+    ss::future<result<ss::circular_buffer<model::record_batch>>>
+    read_from_iterator();
 
 private:
     struct tmp_state {
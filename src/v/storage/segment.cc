@@ -94,12 +94,14 @@ ss::future<> segment::remove_persistent_state() {
     vassert(is_closed(), "Cannot clear state from unclosed segment");
 
     std::vector<std::filesystem::path> rm;
-    rm.reserve(3);
+    rm.reserve(4);
     rm.emplace_back(reader().filename().c_str());
     rm.emplace_back(index().filename().c_str());
     if (is_compacted_segment()) {
         rm.push_back(
           internal::compacted_index_path(reader().filename().c_str()));
+        rm.push_back(
+          internal::compacted_key_filter_path(reader().filename().c_str()));
     }
     vlog(stlog.info, "removing: {}", rm);
     return ss::do_with(
@@ -155,6 +157,7 @@ ss::future<> segment::do_release_appender(
         std::optional<compacted_index_writer>& compacted_index) {
           return appender->close()
             .then([this] { return _idx.flush(); })
+            .then([this] { _idx.seal(); })
             .then([&compacted_index] {
                 if (compacted_index) {
                     return compacted_index->close();
@@ -256,9 +259,27 @@ ss::future<> segment::do_flush() {
 
 ss::future<> remove_compacted_index(const ss::sstring& reader_path) {
     auto path = internal::compacted_index_path(reader_path.c_str());
+    auto filter_path = internal::compacted_key_filter_path(reader_path.c_str());
     return ss::remove_file(path.c_str())
       .handle_exception([path](const std::exception_ptr& e) {
           vlog(stlog.warn, "error removing compacted index {} - {}", path, e);
+      })
+      .then([filter_path] {
+          // the key filter only exists once the segment was self compacted
+          return ss::remove_file(filter_path.c_str())
+            .handle_exception_type(
+              [](const std::filesystem::filesystem_error& e) {
+                  if (e.code() != std::errc::no_such_file_or_directory) {
+                      throw e;
+                  }
+              })
+            .handle_exception([filter_path](const std::exception_ptr& e) {
+                vlog(
+                  stlog.warn,
+                  "error removing key filter {} - {}",
+                  filter_path,
+                  e);
+            });
       });
 }
 
@@ -447,12 +468,25 @@ ss::future<append_result> segment::append(model::record_batch&& b) {
 ss::input_stream<char>
 segment::offset_data_stream(model::offset o, ss::io_priority_class iopc) {
     check_segment_not_closed("offset_data_stream()");
+    return _reader.data_stream(offset_file_position(o), iopc);
+}
+
+ss::input_stream<char> segment::offset_data_stream(
+  model::offset o,
+  ss::io_priority_class iopc,
+  size_t buffer_size,
+  unsigned read_ahead) {
+    check_segment_not_closed("offset_data_stream()");
+    return _reader.data_stream(
+      offset_file_position(o), iopc, buffer_size, read_ahead);
+}
+
+size_t segment::offset_file_position(model::offset o) {
     auto nearest = _idx.find_nearest(o);
-    size_t position = 0;
     if (nearest) {
-        position = nearest->filepos;
+        return nearest->filepos;
     }
-    return _reader.data_stream(position, iopc);
+    return 0;
 }
 
 void segment::advance_stable_offset(size_t offset) {
@@ -95,6 +95,12 @@ public:
     /// main read interface
     ss::input_stream<char>
       offset_data_stream(model::offset, ss::io_priority_class);
+    /// input stream reading ahead `read_ahead` buffers of `buffer_size` bytes
+    ss::input_stream<char> offset_data_stream(
+      model::offset,
+      ss::io_priority_class,
+      size_t buffer_size,
+      unsigned read_ahead);
 
     const offset_tracker& offsets() const { return _tracker; }
     bool empty() const;
@@ -151,6 +157,7 @@ private:
     void set_close();
     void cache_truncate(model::offset offset);
     void check_segment_not_closed(const char* msg);
+    size_t offset_file_position(model::offset);
     ss::future<> do_truncate(model::offset prev_last_offset, size_t physical);
     ss::future<> do_close();
     ss::future<> do_flush();
@@ -12,7 +12,9 @@
 #include "config/configuration.h"
 #include "likely.h"
 #include "storage/chunk_cache.h"
+#include "storage/flush_coordinator.h"
 #include "storage/logger.h"
+#include "storage/write_behind_controller.h"
 #include "vassert.h"
 #include "vlog.h"
 
@@ -23,6 +25,7 @@
 
 #include <fmt/format.h>
 
+#include <optional>
 #include <ostream>
 
 namespace storage {
@@ -43,6 +46,8 @@ namespace storage {
  * latency of each flush, but we'd dispatch less physical flush operations.
  */
 
+using write_clock = internal::write_behind_controller::clock_type;
+
 [[gnu::cold]] static ss::future<>
 size_missmatch_error(const char* ctx, size_t expected, size_t got) {
     return ss::make_exception_future<>(fmt::format(
@@ -53,8 +58,12 @@ segment_appender::segment_appender(ss::file f, options opts)
   : _out(std::move(f))
   , _opts(opts)
   , _concurrent_flushes(ss::semaphore::max_counter())
+  , _adaptive(internal::write_behind().enabled())
   , _prev_head_write(ss::make_lw_shared<ss::semaphore>(1))
   , _inactive_timer([this] { handle_inactive_timer(); }) {
+    if (_adaptive) {
+        update_write_behind_limit();
+    }
     const auto alignment = _out.disk_write_dma_alignment();
     vassert(
       internal::chunk_cache::alignment % alignment == 0,
@@ -92,6 +101,9 @@ segment_appender::segment_appender(segment_appender&& o) noexcept
   , _fallocation_offset(o._fallocation_offset)
   , _bytes_flush_pending(o._bytes_flush_pending)
   , _concurrent_flushes(std::move(o._concurrent_flushes))
+  , _adaptive(o._adaptive)
+  , _write_behind(std::move(o._write_behind))
+  , _write_behind_limit(o._write_behind_limit)
   , _head(std::move(o._head))
   , _prev_head_write(std::move(o._prev_head_write))
   , _flush_ops(std::move(o._flush_ops))
@@ -166,6 +178,16 @@ ss::future<> segment_appender::do_append(const char* buf, const size_t n) {
         return ss::make_ready_future<>();
     }
 
+    if (_adaptive && _write_behind.current() == 0) {
+        internal::write_behind().record_wait();
+        return ss::get_units(_write_behind, 1)
+          .then([this, next_buf = buf + written, next_sz = n - written](
+                  ss::semaphore_units<>) {
+              // do not hold the units!
+              return do_append(next_buf, next_sz);
+          });
+    }
+
     return ss::get_units(_concurrent_flushes, 1)
       .then([this, next_buf = buf + written, next_sz = n - written](
               ss::semaphore_units<>) {
@@ -321,7 +343,9 @@ ss::future<> segment_appender::do_next_adaptive_fallocation() {
                  // step - compute step rounded to 4096; this is needed because
                  // during a truncation the follow up fallocation might not be
                  // page aligned
-                 auto step = _opts.falloc_step;
+                 auto step = _adaptive
+                               ? internal::write_behind().fallocation_step()
+                               : _opts.falloc_step;
                  if (_fallocation_offset % 4096 != 0) {
                      // add left over bytes to a full page
                      step += 4096 - (_fallocation_offset % 4096);
@@ -399,16 +423,29 @@ ss::future<> segment_appender::process_flush_ops(size_t committed) {
 
     _flush_ops.erase(flushable, _flush_ops.end());
 
-    return _out.flush().then([this, committed, ops = std::move(ops)]() mutable {
-        _flushed_offset = committed;
-        /*
-         * TODO: as an optimization, add a little house keeping to determine if
-         * eligible flush operations showed up while flush() was completing.
-         */
-        for (auto& op : ops) {
-            op.p.set_value();
-        }
-    });
+    return internal::flusher()
+      .flush(this, _out)
+      .then([this, committed, ops = std::move(ops)]() mutable {
+          _flushed_offset = committed;
+          /*
+           * TODO: as an optimization, add a little house keeping to determine
+           * if eligible flush operations showed up while flush() was
+           * completing.
+           */
+          for (auto& op : ops) {
+              op.p.set_value();
+          }
+      });
+}
+
+void segment_appender::update_write_behind_limit() {
+    const auto limit = internal::write_behind().max_inflight_chunks();
+    if (limit > _write_behind_limit) {
+        _write_behind.signal(limit - _write_behind_limit);
+    } else {
+        _write_behind.consume(_write_behind_limit - limit);
+    }
+    _write_behind_limit = limit;
 }
 
 void segment_appender::dispatch_background_head_write() {
@@ -453,6 +490,12 @@ void segment_appender::dispatch_background_head_write() {
     auto prev = _prev_head_write;
     auto units = ss::get_units(*prev, 1);
 
+    std::optional<ss::semaphore_units<>> write_behind;
+    if (_adaptive) {
+        update_write_behind_limit();
+        write_behind = ss::consume_units(_write_behind, 1);
+    }
+
     (void)ss::with_semaphore(
       _concurrent_flushes,
       1,
@@ -464,13 +507,19 @@ void segment_appender::dispatch_background_head_write() {
        src,
        prev,
        units = std::move(units),
-       full]() mutable {
+       full,
+       write_behind = std::move(write_behind)]() mutable {
           return units
             .then([this, h, w, start_offset, expected, src, full](
                     ss::semaphore_units<> u) mutable {
+                const auto start = write_clock::now();
                 return _out
                   .dma_write(start_offset, src, expected, _opts.priority)
-                  .then([this, h, w, expected, full](size_t got) {
+                  .then([this, h, w, expected, full, start](size_t got) {
+                      if (_adaptive) {
+                          internal::write_behind().record_write(
+                            this, got, write_clock::now() - start);
+                      }
                       /*
                        * the continuation that captured full=true is the end of
                        * the dependency chain for this chunk. it can be returned
@@ -488,7 +537,7 @@ void segment_appender::dispatch_background_head_write() {
                   })
                   .finally([u = std::move(u)] {});
             })
-            .finally([prev] {});
+            .finally([prev, write_behind = std::move(write_behind)] {});
       })
       .handle_exception([this](std::exception_ptr e) {
           vassert(false, "Could not dma_write: {} - {}", e, *this);
@@ -534,9 +583,10 @@ ss::future<> segment_appender::flush() {
       _stable_offset,
       *this);
 
-    return _out.flush().handle_exception([this](std::exception_ptr e) {
-        vassert(false, "Could not flush: {} - {}", e, *this);
-    });
+    return internal::flusher().flush(this, _out).handle_exception(
+      [this](std::exception_ptr e) {
+          vassert(false, "Could not flush: {} - {}", e, *this);
+      });
 }
 
 ss::future<> segment_appender::hard_flush() {
@@ -86,6 +86,7 @@ private:
     ss::future<> hydrate_last_half_page();
     ss::future<> do_truncation(size_t);
     ss::future<> do_append(const char* buf, const size_t n);
+    void update_write_behind_limit();
 
     /*
      * committed offset isn't updated until the background write is dispatched.
@@ -108,6 +109,11 @@ private:
     size_t _fallocation_offset{0};
     size_t _bytes_flush_pending{0};
     ss::semaphore _concurrent_flushes;
+    // adaptive write-behind: background writes hold a unit until they
+    // complete, appends wait for a unit before taking a new chunk
+    bool _adaptive;
+    ss::semaphore _write_behind{0};
+    size_t _write_behind_limit{0};
     ss::lw_shared_ptr<chunk> _head;
     ss::lw_shared_ptr<ss::semaphore> _prev_head_write;
 
@@ -12,6 +12,7 @@
 #include "model/timestamp.h"
 #include "storage/logger.h"
 #include "vassert.h"
+#include "vlog.h"
 
 #include <seastar/core/fstream.hh>
 #include <seastar/core/iostream.hh>
@@ -42,21 +43,40 @@ segment_index::segment_index(
     _state.base_offset = base;
 }
 
+segment_index::~segment_index() noexcept {
+    if (_cache) {
+        _cache->remove(*this);
+    }
+}
+
 void segment_index::reset() {
     auto base = _state.base_offset;
     _state = {};
     _state.base_offset = base;
     _acc = 0;
+    _hydrated = true;
 }
 
 void segment_index::swap_index_state(index_state&& o) {
     _needs_persistence = true;
     _acc = 0;
+    _hydrated = true;
     std::swap(_state, o);
+    if (_cache && _sealed) {
+        _cache->touch(*this);
+    }
+}
+
+void segment_index::seal() {
+    _sealed = true;
+    if (_cache && _hydrated) {
+        _cache->touch(*this);
+    }
 }
 
 void segment_index::maybe_track(
   const model::record_batch_header& hdr, size_t filepos) {
+    vassert(!_sealed, "Cannot track batches on a sealed index: {}", *this);
     _acc += hdr.size_bytes;
     if (_state.maybe_index(
           _acc,
@@ -98,16 +118,9 @@ segment_index::find_nearest(model::offset o) {
         return std::nullopt;
     }
     const uint32_t needle = o() - _state.base_offset();
-    auto it = std::lower_bound(
-      std::begin(_state.relative_offset_index),
-      std::end(_state.relative_offset_index),
-      needle,
-      std::less<uint32_t>{});
-    if (it == _state.relative_offset_index.end()) {
-        it = std::prev(it);
-    }
+    const size_t last = _state.relative_offset_index.size() - 1;
     // make it signed so it can be negative
-    int i = std::distance(_state.relative_offset_index.begin(), it);
+    int i = std::min(_state.offset_lower_bound(needle), last);
     do {
         if (_state.relative_offset_index[i] <= needle) {
             return translate_index_entry(_state, _state.get_entry(i));
@@ -121,17 +134,17 @@ ss::future<> segment_index::truncate(model::offset o) {
     if (o < _state.base_offset) {
         return ss::now();
     }
+    if (!_hydrated) {
+        // retry in case the entries were evicted again before the
+        // continuation had a chance to run
+        return hydrate().then([this, o] { return truncate(o); });
+    }
     const uint32_t i = o() - _state.base_offset();
-    auto it = std::lower_bound(
-      std::begin(_state.relative_offset_index),
-      std::end(_state.relative_offset_index),
-      i,
-      std::less<uint32_t>{});
+    const size_t pos = _state.offset_lower_bound(i);
 
-    if (it != _state.relative_offset_index.end()) {
+    if (pos < _state.relative_offset_index.size()) {
         _needs_persistence = true;
-        int remove_back_elems = std::distance(
-          it, _state.relative_offset_index.end());
+        int remove_back_elems = _state.relative_offset_index.size() - pos;
         while (remove_back_elems-- > 0) {
             _state.pop_back();
         }
@@ -148,25 +161,124 @@ ss::future<> segment_index::truncate(model::offset o) {
 }
 
 ss::future<bool> segment_index::materialize_index() {
+    return _out.size().then([this](uint64_t size) mutable {
+        if (size == 0) {
+            return ss::make_ready_future<bool>(false);
+        }
+        const auto header_size = std::min<uint64_t>(
+          size, index_state::ondisk_header_size);
+        return _out.dma_read_bulk<char>(0, header_size)
+          .then([this, size](ss::temporary_buffer<char> buf) {
+              iobuf b;
+              b.append(std::move(buf));
+              auto hydrated = index_state::hydrate_header_from_buffer(
+                std::move(b), size);
+              if (hydrated) {
+                  // entries are paged in on first use
+                  _state = std::move(hydrated.value());
+                  _hydrated = false;
+                  _sealed = true;
+                  return ss::make_ready_future<bool>(true);
+              }
+              // older versions have no standalone header and are decoded
+              // in full, then rewritten in the current format
+              return _out.dma_read_bulk<char>(0, size).then(
+                [this](ss::temporary_buffer<char> buf) {
+                    if (buf.empty()) {
+                        return ss::make_ready_future<bool>(false);
+                    }
+                    iobuf b;
+                    b.append(std::move(buf));
+                    auto hydrated = index_state::hydrate_from_buffer(
+                      std::move(b));
+                    if (!hydrated) {
+                        return ss::make_ready_future<bool>(false);
+                    }
+                    _state = std::move(hydrated.value());
+                    _hydrated = true;
+                    _sealed = true;
+                    _needs_persistence = true;
+                    return flush().then([] { return true; });
+                });
+          });
+    });
+}
+
+ss::future<> segment_index::hydrate() {
+    if (_hydrated) {
+        if (_cache && _sealed) {
+            _cache->touch(*this);
+        }
+        return ss::now();
+    }
+    if (!_hydration) {
+        auto f = do_hydrate();
+        if (f.available()) {
+            // nothing left to share, and a reset attached to a ready future
+            // would run before the assignment below and leave it pinned
+            return f;
+        }
+        _hydration = ss::shared_future<>(
+          std::move(f).finally([this] { _hydration = std::nullopt; }));
+    }
+    return _hydration->get_future();
+}
+
+ss::future<> segment_index::do_hydrate() {
     return _out.size()
-      .then([this](uint64_t size) mutable {
+      .then([this](uint64_t size) {
           return _out.dma_read_bulk<char>(0, size);
       })
       .then([this](ss::temporary_buffer<char> buf) {
-          if (buf.empty()) {
-              return false;
+          if (_hydrated) {
+              // the state was replaced while we were reading
+              return;
           }
           iobuf b;
           b.append(std::move(buf));
           auto hydrated = index_state::hydrate_from_buffer(std::move(b));
-          if (!hydrated) {
-              return false;
+          if (
+            !hydrated || hydrated->base_offset != _state.base_offset
+            || hydrated->max_offset != _state.max_offset) {
+              /*
+               * the header was valid when materialized. keep it, but with no
+               * entries, so that lookups fall back to scanning the segment
+               * from the start, which is slower but correct.
+               */
+              vlog(
+                stlog.warn,
+                "Could not hydrate index entries, lookups will scan the "
+                "segment: {}",
+                *this);
+              _state.release_entries();
+          } else {
+              _state = std::move(hydrated.value());
+          }
+          _hydrated = true;
+          if (_cache) {
+              _cache->touch(*this);
+          }
+      })
+      .handle_exception([this](std::exception_ptr e) {
+          vlog(stlog.warn, "Error hydrating index {}: {}", _name, e);
+          if (!_hydrated) {
+              _state.release_entries();
+              _hydrated = true;
           }
-          _state = std::move(hydrated.value());
-          return true;
       });
 }
 
+bool segment_index::is_evictable() const {
+    return _sealed && _hydrated && !_needs_persistence && !_hydration;
+}
+
+size_t segment_index::evict() {
+    const auto freed = memory_usage();
+    _state.release_entries();
+    _hydrated = false;
+    return freed;
+}
+
 ss::future<> segment_index::drop_all_data() {
     reset();
     return _out.truncate(0);
@@ -202,7 +314,9 @@ ss::future<> segment_index::close() {
 std::ostream& operator<<(std::ostream& o, const segment_index& i) {
     return o << "{file:" << i.filename() << ", offsets:" << i.base_offset()
              << ", index:" << i._state << ", step:" << i._step
-             << ", needs_persistence:" << i._needs_persistence << "}";
+             << ", needs_persistence:" << i._needs_persistence
+             << ", hydrated:" << i._hydrated << ", sealed:" << i._sealed
+             << "}";
 }
 std::ostream& operator<<(std::ostream& o, const segment_index_ptr& i) {
     if (i) {
@@ -217,6 +331,48 @@ operator<<(std::ostream& o, const std::optional<segment_index::entry>& e) {
     }
     return o << "{empty segment_index::entry}";
 }
+
+void segment_index_cache::touch(segment_index& idx) {
+    if (idx._hook.is_linked()) {
+        idx._hook.unlink();
+        _memory -= idx._accounted_memory;
+    }
+    idx._accounted_memory = idx.memory_usage();
+    _memory += idx._accounted_memory;
+    _lru.push_back(idx);
+    evict();
+}
+
+void segment_index_cache::remove(segment_index& idx) {
+    if (idx._hook.is_linked()) {
+        idx._hook.unlink();
+        _memory -= idx._accounted_memory;
+    }
+    idx._accounted_memory = 0;
+}
+
+void segment_index_cache::evict() {
+    auto it = _lru.begin();
+    // the most recently used index is never evicted, it is about to be used
+    while (_memory > _max_memory && it != _lru.end()
+           && std::next(it) != _lru.end()) {
+        auto& idx = *it;
+        if (!idx.is_evictable()) {
+            ++it;
+            continue;
+        }
+        it = _lru.erase(it);
+        _memory -= idx._accounted_memory;
+        idx._accounted_memory = 0;
+        idx.evict();
+    }
+}
+
+std::ostream& operator<<(std::ostream& o, const segment_index_cache& c) {
+    return o << "{memory:" << c._memory << ", max_memory:" << c._max_memory
+             << "}";
+}
+
 std::ostream& operator<<(std::ostream& o, const segment_index::entry& e) {
     return o << "{offset:" << e.offset << ", time:" << e.timestamp
              << ", filepos:" << e.filepos << "}";
@@ -14,8 +14,10 @@
 #include "model/record.h"
 #include "model/timestamp.h"
 #include "storage/index_state.h"
+#include "utils/intrusive_list_helpers.h"
 
 #include <seastar/core/file.hh>
+#include <seastar/core/shared_future.hh>
 #include <seastar/core/unaligned.hh>
 
 #include <memory>
@@ -24,6 +26,8 @@
 
 namespace storage {
 
+class segment_index_cache;
+
 /**
  * file file format is: [ header ] [ payload ]
  * header  == segment_index::header
@@ -34,6 +38,13 @@ namespace storage {
  *
  * The name of this index _must_ be then:
  *     default/test/0/1-1-v1.base_index
+ *
+ * Indices recovered from disk are materialized lazily: only the header is
+ * read at startup, which is enough to recover the offset and time bounds of
+ * the segment. The entries are paged in by `hydrate()` on first use and may
+ * be released again by the per-shard `segment_index_cache` once the segment
+ * is sealed. Lookups on an index that is not hydrated find nothing, which is
+ * always safe since readers then start from the beginning of the segment.
  */
 class segment_index {
 public:
@@ -50,7 +61,7 @@ public:
 
     segment_index(
       ss::sstring filename, ss::file, model::offset base, size_t step);
-    ~segment_index() noexcept = default;
+    ~segment_index() noexcept;
     segment_index(segment_index&&) noexcept = default;
     segment_index& operator=(segment_index&&) noexcept = default;
     segment_index(const segment_index&) = delete;
@@ -66,7 +77,22 @@ public:
     model::timestamp base_timestamp() const { return _state.base_timestamp; }
     const ss::sstring& filename() const { return _name; }
 
+    /// \brief recovers the header of the index from disk. the entries are
+    /// only read when the index is hydrated
     ss::future<bool> materialize_index();
+    /// \brief ensures that the entries of the index are in memory. Must be
+    /// called before any lookup on an index that may have been evicted
+    ss::future<> hydrate();
+    bool is_hydrated() const { return _hydrated; }
+
+    /// \brief attach the index to the shard-wide cache of hydrated indices
+    void set_cache(segment_index_cache* c) { _cache = c; }
+    /// \brief marks the index as read-only. Only sealed indices may have
+    /// their entries released by the cache
+    void seal();
+    /// \brief memory used by the entries of the index
+    size_t memory_usage() const { return _state.entries_memory_usage(); }
+
     ss::future<> close();
     ss::future<> flush();
     ss::future<> truncate(model::offset);
@@ -84,16 +110,63 @@ public:
     index_state release_index_state() && { return std::move(_state); }
 
 private:
+    ss::future<> do_hydrate();
+    bool is_evictable() const;
+    /// \brief drops the entries of the index, returns the freed memory
+    size_t evict();
+
     ss::sstring _name;
     ss::file _out;
     size_t _step;
     size_t _acc{0};
     bool _needs_persistence{false};
+    bool _hydrated{true};
+    bool _sealed{false};
     index_state _state;
+    std::optional<ss::shared_future<>> _hydration;
 
+    segment_index_cache* _cache{nullptr};
+    size_t _accounted_memory{0};
+    intrusive_list_hook _hook;
+
+    friend class segment_index_cache;
     friend std::ostream& operator<<(std::ostream&, const segment_index&);
 };
 
+/**
+ * Per-shard LRU of hydrated segment indices. The entries of sealed indices
+ * are only kept in memory while they fit in the configured budget, the
+ * least recently used ones are released first and paged back in from disk
+ * by `segment_index::hydrate()` when needed again.
+ */
+class segment_index_cache {
+public:
+    explicit segment_index_cache(size_t max_memory) noexcept
+      : _max_memory(max_memory) {}
+    segment_index_cache(segment_index_cache&&) = delete;
+    segment_index_cache& operator=(segment_index_cache&&) = delete;
+    segment_index_cache(const segment_index_cache&) = delete;
+    segment_index_cache& operator=(const segment_index_cache&) = delete;
+    ~segment_index_cache() noexcept = default;
+
+    /// \brief marks the index as most recently used and evicts others if
+    /// the budget is exceeded
+    void touch(segment_index&);
+    void remove(segment_index&);
+
+    size_t memory_usage() const { return _memory; }
+    size_t max_memory() const { return _max_memory; }
+
+private:
+    void evict();
+
+    size_t _max_memory;
+    size_t _memory{0};
+    intrusive_list<segment_index, &segment_index::_hook> _lru;
+
+    friend std::ostream& operator<<(std::ostream&, const segment_index_cache&);
+};
+
 using segment_index_ptr = std::unique_ptr<segment_index>;
 std::ostream& operator<<(std::ostream&, const segment_index_ptr&);
 std::ostream&
@@ -31,15 +31,23 @@ segment_reader::segment_reader(
 
 ss::input_stream<char>
 segment_reader::data_stream(size_t pos, const ss::io_priority_class& pc) {
+    return data_stream(pos, pc, _buffer_size, 10);
+}
+
+ss::input_stream<char> segment_reader::data_stream(
+  size_t pos,
+  const ss::io_priority_class& pc,
+  size_t buffer_size,
+  unsigned read_ahead) {
     vassert(
       pos <= _file_size,
       "cannot read negative bytes. Asked to read at position: '{}' - {}",
       pos,
       *this);
     ss::file_input_stream_options options;
-    options.buffer_size = _buffer_size;
+    options.buffer_size = buffer_size;
     options.io_priority_class = pc;
-    options.read_ahead = 10;
+    options.read_ahead = read_ahead;
     return make_file_input_stream(
       _data_file, pos, _file_size - pos, std::move(options));
 }
@@ -64,6 +64,13 @@ public:
     /// starting at position @pos
     ss::input_stream<char>
     data_stream(size_t pos, const ss::io_priority_class&);
+    /// same as above, with `read_ahead` buffers of `buffer_size` bytes read
+    /// ahead of the consumer
+    ss::input_stream<char> data_stream(
+      size_t pos,
+      const ss::io_priority_class&,
+      size_t buffer_size,
+      unsigned read_ahead);
 
 private:
     ss::sstring _filename;
@@ -22,6 +22,7 @@
 #include "storage/compaction_reducers.h"
 #include "storage/fwd.h"
 #include "storage/index_state.h"
+#include "storage/key_bloom_filter.h"
 #include "storage/lock_manager.h"
 #include "storage/log_reader.h"
 #include "storage/logger.h"
@@ -173,15 +174,16 @@ natural_index_of_entries_to_keep(compacted_index_reader reader) {
 ss::future<> copy_filtered_entries(
   compacted_index_reader reader,
   Roaring to_copy_index,
-  compacted_index_writer writer) {
+  compacted_index_writer writer,
+  key_bloom_filter* filter) {
     return ss::do_with(
       std::move(writer),
-      [bm = std::move(to_copy_index),
-       reader](compacted_index_writer& writer) mutable {
+      [bm = std::move(to_copy_index), reader, filter](
+        compacted_index_writer& writer) mutable {
           reader.reset();
           return reader
             .consume(
-              index_filtered_copy_reducer(std::move(bm), writer),
+              index_filtered_copy_reducer(std::move(bm), writer, filter),
               model::no_timeout)
             // must be last
             .finally([&writer] {
@@ -198,32 +200,132 @@ static ss::future<> do_write_clean_compacted_index(
                                                           cfg](Roaring bitmap) {
         const auto tmpname = std::filesystem::path(
           fmt::format("{}.staging", reader.filename()));
+        // the filter holds exactly the keys of the clean index
+        auto filter = ss::make_lw_shared<key_bloom_filter>(
+          bitmap.cardinality());
         return make_handle(
                  tmpname,
                  ss::open_flags::rw | ss::open_flags::truncate
                    | ss::open_flags::create,
                  writer_opts(),
                  cfg.sanitize)
-          .then(
-            [tmpname, cfg, reader, bm = std::move(bitmap)](ss::file f) mutable {
-                auto writer = make_file_backed_compacted_index(
-                  tmpname.string(),
-                  std::move(f),
-                  cfg.iopc,
-                  // TODO: pass this memory from the cfg
-                  segment_appender::write_behind_memory / 2);
-                return copy_filtered_entries(
-                  reader, std::move(bm), std::move(writer));
-            })
+          .then([tmpname, cfg, reader, filter, bm = std::move(bitmap)](
+                  ss::file f) mutable {
+              auto writer = make_file_backed_compacted_index(
+                tmpname.string(),
+                std::move(f),
+                cfg.iopc,
+                // TODO: pass this memory from the cfg
+                segment_appender::write_behind_memory / 2);
+              return copy_filtered_entries(
+                reader, std::move(bm), std::move(writer), filter.get());
+          })
           .then([old_name = tmpname.string(), new_name = reader.filename()] {
               // from glibc: If oldname is not a directory, then any
               // existing file named newname is removed during the
               // renaming operation
               return ss::rename_file(old_name, new_name);
+          })
+          .then([filter, cfg, reader] {
+              return write_key_filter(
+                compacted_key_filter_path(reader.filename().c_str()),
+                *filter,
+                cfg);
           });
     });
 }
 
+ss::future<> write_key_filter(
+  std::filesystem::path path,
+  const key_bloom_filter& filter,
+  compaction_config cfg) {
+    const auto tmpname = std::filesystem::path(
+      fmt::format("{}.staging", path.string()));
+    auto f = co_await make_handle(
+      tmpname,
+      ss::open_flags::rw | ss::open_flags::truncate | ss::open_flags::create,
+      writer_opts(),
+      cfg.sanitize);
+    auto out = co_await ss::make_file_output_stream(std::move(f));
+    std::exception_ptr ex;
+    try {
+        co_await write_iobuf_to_output_stream(filter.serialize(), out);
+        co_await out.flush();
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await out.close();
+    if (ex) {
+        std::rethrow_exception(ex);
+    }
+    co_await ss::rename_file(tmpname.string(), path.string());
+}
+
+ss::future<std::optional<key_bloom_filter>>
+read_key_filter(std::filesystem::path path, compaction_config cfg) {
+    if (!co_await ss::file_exists(path.string())) {
+        co_return std::nullopt;
+    }
+    auto f = co_await make_reader_handle(path, cfg.sanitize);
+    std::optional<key_bloom_filter> retval;
+    try {
+        const auto size = co_await f.size();
+        auto buf = co_await f.dma_read_bulk<char>(0, size, cfg.iopc);
+        iobuf b;
+        b.append(std::move(buf));
+        retval = key_bloom_filter::deserialize(std::move(b));
+    } catch (...) {
+        vlog(
+          stlog.info,
+          "error reading key filter {}: {}",
+          path,
+          std::current_exception());
+    }
+    co_await f.close();
+    co_return retval;
+}
+
+ss::future<bool> may_have_superseded_keys(
+  std::vector<ss::lw_shared_ptr<segment>> segments, compaction_config cfg) {
+    // filters of all the segments older than the one being probed
+    std::vector<key_bloom_filter> filters;
+    filters.reserve(segments.size());
+    for (size_t i = 0; i + 1 < segments.size(); ++i) {
+        auto filter = co_await read_key_filter(
+          compacted_key_filter_path(segments[i]->reader().filename().c_str()),
+          cfg);
+        if (!filter) {
+            co_return true;
+        }
+        filters.push_back(std::move(*filter));
+
+        const auto& newer = segments[i + 1];
+        auto path = compacted_index_path(newer->reader().filename().c_str());
+        if (!co_await ss::file_exists(path.string())) {
+            co_return true;
+        }
+        auto f = co_await make_reader_handle(path, cfg.sanitize);
+        auto reader = make_file_backed_compacted_reader(
+          path.string(), std::move(f), cfg.iopc, 64_KiB);
+        bool found = true;
+        try {
+            found = co_await reader.consume(
+              key_filter_probe_reducer(filters), model::no_timeout);
+        } catch (...) {
+            vlog(
+              stlog.info,
+              "error probing key filters with {}: {}",
+              path,
+              std::current_exception());
+        }
+        co_await reader.close();
+        if (found) {
+            co_return true;
+        }
+    }
+    co_return false;
+}
+
 ss::future<> write_clean_compacted_index(
   compacted_index_reader reader, compaction_config cfg) {
     // integrity verified in `do_detect_compaction_index_state`
@@ -631,11 +733,13 @@ ss::future<std::vector<compacted_index_reader>> make_indices_readers(
 }
 
 ss::future<> rewrite_concatenated_indicies(
-  compacted_index_writer writer, std::vector<compacted_index_reader>& readers) {
+  compacted_index_writer writer,
+  std::vector<compacted_index_reader>& readers,
+  key_bloom_filter* filter) {
     return ss::do_with(
-      std::move(writer), [&readers](compacted_index_writer& writer) {
+      std::move(writer), [&readers, filter](compacted_index_writer& writer) {
           return ss::do_with(
-            index_copy_reducer{writer},
+            index_copy_reducer{writer, filter},
             [&readers, &writer](index_copy_reducer& reducer) {
                 return ss::do_for_each(
                          readers.begin(),
@@ -653,6 +757,25 @@ ss::future<> rewrite_concatenated_indicies(
       });
 }
 
+/// \brief the merged segment gets its key filter while its index is written.
+/// self compaction later replaces it with one over the deduplicated keys
+static ss::future<> write_concatenated_index_and_key_filter(
+  std::filesystem::path target_path,
+  std::vector<compacted_index_reader>& readers,
+  compaction_config cfg) {
+    // footers were loaded by the integrity check
+    size_t keys = 0;
+    for (auto& reader : readers) {
+        keys += (co_await reader.load_footer()).keys;
+    }
+    key_bloom_filter filter(keys);
+    auto writer = co_await make_compacted_index_writer(
+      target_path, cfg.sanitize, cfg.iopc);
+    co_await rewrite_concatenated_indicies(std::move(writer), readers, &filter);
+    co_await write_key_filter(
+      compacted_key_filter_path(target_path), filter, cfg);
+}
+
 ss::future<> do_write_concatenated_compacted_index(
   std::filesystem::path target_path,
   std::vector<ss::lw_shared_ptr<segment>>& segments,
@@ -686,12 +809,8 @@ ss::future<> do_write_concatenated_compacted_index(
                           return ss::now();
                       }
 
-                      return make_compacted_index_writer(
-                               target_path, cfg.sanitize, cfg.iopc)
-                        .then([&readers](compacted_index_writer writer) {
-                            return rewrite_concatenated_indicies(
-                              std::move(writer), readers);
-                        });
+                      return write_concatenated_index_and_key_filter(
+                        target_path, readers, cfg);
                   })
                   .finally([&readers] {
                       return ss::parallel_for_each(
@@ -735,16 +854,24 @@ ss::future<std::vector<ss::rwlock::holder>> transfer_segment(
     co_await do_swap_data_file_handles(from_path, to, cfg, probe);
 
     // offset index
+    co_await from->index().hydrate();
     to->index().swap_index_state(
       std::move(from->index()).release_index_state());
     to->force_set_commit_offset_from_index();
     co_await to->index().flush();
 
     // compaction index
-    from_path = compacted_index_path(from_path);
-    auto to_path = compacted_index_path(
-      std::filesystem::path(to->reader().filename()));
-    co_await ss::rename_file(from_path.string(), to_path.string());
+    auto to_path = std::filesystem::path(to->reader().filename());
+    co_await ss::rename_file(
+      compacted_index_path(from_path).string(),
+      compacted_index_path(to_path).string());
+
+    // key filter. a missing one only disables the skip heuristic
+    auto from_filter = compacted_key_filter_path(from_path);
+    if (co_await ss::file_exists(from_filter.string())) {
+        co_await ss::rename_file(
+          from_filter.string(), compacted_key_filter_path(to_path).string());
+    }
 
     // clean up replacement segment
     co_await from->remove_persistent_state();
@@ -784,6 +911,11 @@ std::filesystem::path compacted_index_path(std::filesystem::path segment_path) {
     return segment_path.replace_extension(".compaction_index");
 }
 
+std::filesystem::path
+compacted_key_filter_path(std::filesystem::path segment_path) {
+    return segment_path.replace_extension(".compaction_key_filter");
+}
+
 size_t jitter_segment_size(size_t sz, jitter_percents jitter_percents) {
     vassert(
       jitter_percents >= 0 || jitter_percents <= 100,
@@ -15,6 +15,7 @@
 #include "storage/compacted_index_reader.h"
 #include "storage/compacted_index_writer.h"
 #include "storage/compacted_offset_list.h"
+#include "storage/key_bloom_filter.h"
 #include "storage/probe.h"
 #include "storage/readers_cache.h"
 #include "storage/segment.h"
@@ -115,16 +116,34 @@ size_t number_of_chunks_from_config(const storage::ntp_config&);
 /// the fully dedupped entries, clean of truncations, etc
 ss::future<Roaring> natural_index_of_entries_to_keep(compacted_index_reader);
 
+/// \brief when \p filter is not null, every copied key is added to it
 ss::future<> copy_filtered_entries(
   storage::compacted_index_reader input,
   Roaring to_copy_index_filter,
-  storage::compacted_index_writer output);
+  storage::compacted_index_writer output,
+  key_bloom_filter* filter = nullptr);
 
 /// \brief writes a new `*.compacted_index` file and *closes* the
-/// input compacted_index_reader file
+/// input compacted_index_reader file. also writes the key filter of the new
+/// index next to it
 ss::future<> write_clean_compacted_index(
   storage::compacted_index_reader, storage::compaction_config);
 
+ss::future<> write_key_filter(
+  std::filesystem::path, const key_bloom_filter&, storage::compaction_config);
+
+/// \brief returns nullopt if the filter is missing or corrupted
+ss::future<std::optional<key_bloom_filter>>
+  read_key_filter(std::filesystem::path, storage::compaction_config);
+
+/// \brief false only if no key in the compaction index of a segment may be
+/// present in the key filter of any segment before it in \p segments, i.e.
+/// compacting them together would not remove any record. true whenever one of
+/// the files is unavailable
+ss::future<bool> may_have_superseded_keys(
+  std::vector<ss::lw_shared_ptr<storage::segment>> segments,
+  storage::compaction_config);
+
 ss::future<compacted_offset_list>
   generate_compacted_list(model::offset, storage::compacted_index_reader);
 
@@ -152,6 +171,8 @@ ss::future<> do_swap_data_file_handles(
   probe&);
 
 std::filesystem::path compacted_index_path(std::filesystem::path segment_path);
+std::filesystem::path
+compacted_key_filter_path(std::filesystem::path segment_path);
 
 using jitter_percents = named_type<int, struct jitter_percents_tag>;
 static constexpr jitter_percents default_segment_size_jitter(5);
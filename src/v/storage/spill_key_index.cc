@@ -10,6 +10,7 @@
 #include "storage/spill_key_index.h"
 
 #include "bytes/bytes.h"
+#include "likely.h"
 #include "random/generators.h"
 #include "reflection/adl.h"
 #include "storage/compacted_index_writer.h"
@@ -36,6 +37,8 @@ spill_key_index::spill_key_index(
   size_t max_memory)
   : compacted_index_writer::impl(std::move(name))
   , _appender(std::move(index_file), segment_appender::options(p, 1))
+  , _midx(max_memory)
+  , _keys(max_memory / 16)
   , _max_mem(max_memory) {}
 
 spill_key_index::~spill_key_index() {
@@ -47,71 +50,65 @@ spill_key_index::~spill_key_index() {
 
 ss::future<>
 spill_key_index::index(bytes_view v, model::offset base_offset, int32_t delta) {
-    if (auto it = _midx.find(v); it != _midx.end()) {
-        auto& pair = it->second;
-        if (base_offset > pair.base_offset) {
-            pair.base_offset = base_offset;
-            pair.delta = delta;
+    const auto fp = key_fingerprint::of(v);
+    const bool found = _midx.update(fp, [base_offset, delta](entry& e) {
+        if (base_offset() > e.base_offset) {
+            e.base_offset = base_offset();
+            e.delta = delta;
         }
+    });
+    if (found) {
         return ss::now();
     }
     // not found
-    return add_key(bytes(v), value_type{base_offset, delta});
+    return add_key(fp, v, value_type{base_offset, delta});
 }
 
-ss::future<> spill_key_index::add_key(bytes b, value_type v) {
-    auto f = ss::now();
-    auto const key_size = b.size();
-    auto const expected_size = idx_mem_usage() + _keys_mem_usage + key_size;
-
-    if (expected_size >= _max_mem) {
-        f = ss::do_until(
-          [this, key_size] {
-              // stop condition
-              return _midx.empty()
-                     || idx_mem_usage() + _keys_mem_usage + key_size < _max_mem;
-          },
-          [this] {
-              /**
-               * Evict first entry, we use hash function that guarante good
-               * randomness so evicting first entry is actually evicting a
-               * pseudo random elemnent
-               */
-              auto node = _midx.extract(_midx.begin());
-
-              return ss::do_with(
-                node.key(),
-                node.mapped(),
-                [this](const bytes& k, value_type o) {
-                    _keys_mem_usage -= k.size();
-                    return spill(compacted_index::entry_type::key, k, o);
-                });
-          });
+ss::future<> spill_key_index::add_key(
+  const key_fingerprint& fp, bytes_view b, value_type v) {
+    auto insert = [this, fp, v](bytes_view b) {
+        auto key = _keys.append(b);
+        _midx.insert(
+          fp,
+          entry{
+            .base_offset = v.base_offset(),
+            .delta = v.delta,
+            .key_size = static_cast<uint32_t>(key.size()),
+            .key = key.data()});
+    };
+    const bool needs_spill = !_midx.empty()
+                             && (!_midx.has_room()
+                                 || mem_usage_after_insert(b.size())
+                                      >= _max_mem);
+    if (likely(!needs_spill)) {
+        insert(b);
+        return ss::now();
     }
-
-    return f.then([this, b = std::move(b), v]() mutable {
-        // convert iobuf to key
-        _keys_mem_usage += b.size();
-        _midx.insert({std::move(b), v});
-    });
+    // keys cannot be freed one by one from the arena so all of them are
+    // spilled at once. the key must outlive the spill
+    return drain_all_keys().then(
+      [insert, k = bytes(b)]() mutable { insert(k); });
 }
 
 ss::future<>
 spill_key_index::index(bytes&& b, model::offset base_offset, int32_t delta) {
-    if (auto it = _midx.find(b); it != _midx.end()) {
-        auto& pair = it->second;
+    const auto fp = key_fingerprint::of(b);
+    const bool found = _midx.update(fp, [base_offset, delta](entry& e) {
         // must use both base+delta, since we only want to keep the latest
         // which might be inserted into the batch multiple times by client
         const auto record = base_offset + model::offset(delta);
-        const auto current = pair.base_offset + model::offset(pair.delta);
+        const auto current = model::offset(e.base_offset)
+                             + model::offset(e.delta);
         if (record > current) {
-            pair.base_offset = base_offset;
-            pair.delta = delta;
+            e.base_offset = base_offset();
+            e.delta = delta;
         }
+    });
+    if (found) {
         return ss::now();
     }
     // not found
-    return add_key(std::move(b), value_type{base_offset, delta});
+    return add_key(fp, b, value_type{base_offset, delta});
 }
 ss::future<> spill_key_index::index(
   const iobuf& key, model::offset base_offset, int32_t delta) {
@@ -176,17 +173,21 @@ ss::future<> spill_key_index::append(compacted_index::entry e) {
 
 ss::future<> spill_key_index::drain_all_keys() {
     return ss::do_until(
-      [this] {
-          // stop condition
-          return _midx.empty();
-      },
-      [this] {
-          auto node = _midx.extract(_midx.begin());
-          _keys_mem_usage -= node.key().size();
-          return ss::do_with(
-            node.key(), node.mapped(), [this](const bytes& k, value_type o) {
-                return spill(compacted_index::entry_type::key, k, o);
-            });
+             [this] {
+                 // stop condition
+                 return _midx.empty();
+             },
+             [this] {
+                 auto e = _midx.evict_one().second;
+                 return spill(
+                   compacted_index::entry_type::key,
+                   e.key_view(),
+                   e.to_value());
+             })
+      .then([this] {
+          // every view into the arena is gone
+          _midx.clear();
+          _keys.clear();
       });
 }
 
@@ -213,9 +214,9 @@ ss::future<> spill_key_index::truncate(model::offset o) {
 ss::future<> spill_key_index::close() {
     return drain_all_keys().then([this] {
         vassert(
-          _keys_mem_usage == 0,
+          _keys.memory_usage() == 0,
           "Failed to drain all keys, {} bytes left",
-          _keys_mem_usage);
+          _keys.memory_usage());
         _footer.crc = _crc.value();
         return ss::do_with(
                  reflection::to_iobuf(_footer),
@@ -239,7 +240,7 @@ std::ostream& operator<<(std::ostream& o, const spill_key_index& k) {
       "in_memory_entries:{}, file_appender:{}}}",
       k.filename(),
       k._max_mem,
-      k._keys_mem_usage,
+      k._keys.memory_usage(),
       k._footer.keys,
       k._midx.size(),
       k._appender);
@@ -16,14 +16,13 @@
 #include "model/fundamental.h"
 #include "storage/compacted_index.h"
 #include "storage/compacted_index_writer.h"
+#include "storage/compaction_key_map.h"
 #include "storage/segment_appender.h"
 #include "utils/vint.h"
 
 #include <seastar/core/file.hh>
 #include <seastar/core/future.hh>
 
-#include <absl/container/node_hash_map.h>
-#include <absl/hash/hash.h>
 namespace storage::internal {
 using namespace storage; // NOLINT
 class spill_key_index final : public compacted_index_writer::impl {
@@ -35,11 +34,19 @@ public:
     static constexpr auto value_sz = sizeof(value_type);
     static constexpr size_t max_key_size = compacted_index::max_entry_size
                                            - (2 * vint::max_length);
-    using underlying_t = absl::node_hash_map<
-      bytes,
-      value_type,
-      bytes_hasher<uint64_t, xxhash_64>,
-      bytes_type_eq>;
+    /// in memory entry, the key bytes live in the key arena
+    struct entry {
+        int64_t base_offset;
+        int32_t delta;
+        uint32_t key_size;
+        const uint8_t* key;
+
+        value_type to_value() const {
+            return value_type{model::offset(base_offset), delta};
+        }
+        bytes_view key_view() const { return bytes_view(key, key_size); }
+    };
+    using underlying_t = key_fingerprint_map<entry>;
 
     spill_key_index(
       ss::sstring filename,
@@ -64,25 +71,20 @@ public:
     void set_flag(compacted_index::footer_flags) final;
 
 private:
-    /**
-     * returns memory usage of the map structures itself. In order to get total
-     * memory usage of spill key index we have to do:
-     *
-     *    idx_mem_usage() + _keys_mem_usage
-     */
-    size_t idx_mem_usage() {
-        using debug = absl::container_internal::hashtable_debug_internal::
-          HashtableDebugAccess<underlying_t>;
-        return debug::AllocatedByteSize(_midx);
+    /// memory usage of the map and the key arena after adding a key of
+    /// \p key_size bytes
+    size_t mem_usage_after_insert(size_t key_size) const {
+        return _midx.memory_usage_after_insert()
+               + _keys.memory_usage_after_append(key_size);
     }
     ss::future<> drain_all_keys();
-    ss::future<> add_key(bytes b, value_type);
+    ss::future<> add_key(const key_fingerprint&, bytes_view, value_type);
     ss::future<> spill(compacted_index::entry_type, bytes_view, value_type);
 
     segment_appender _appender;
     underlying_t _midx;
+    key_arena _keys;
     size_t _max_mem;
-    size_t _keys_mem_usage{0};
     compacted_index::footer _footer;
     crc::crc32c _crc;
 
@@ -37,3 +37,62 @@ PERF_TEST_F(reducer_bench, compaction_key_reducer_test) {
         perf_tests::stop_measuring_time();
     });
 }
+
+// 150k distinct 20 byte keys, twice each. with the default 5MiB budget the
+// whole key set fits in the map and the second pass dedups every key.
+struct unique_keys_bench {
+    static constexpr size_t keys = 150'000;
+
+    unique_keys_bench() {
+        data.reserve(keys);
+        for (size_t i = 0; i < keys; ++i) {
+            data.push_back(random_generators::get_bytes(20));
+        }
+    }
+
+    std::vector<bytes> data;
+};
+
+PERF_TEST_F(unique_keys_bench, compaction_key_reducer_budget) {
+    storage::internal::compaction_key_reducer reducer;
+    perf_tests::start_measuring_time();
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < data.size(); ++i) {
+            // the reducer always returns a ready future
+            (void)reducer(storage::compacted_index::entry(
+              storage::compacted_index::entry_type::key,
+              data[i],
+              model::offset(i),
+              0));
+        }
+    }
+    auto bitmap = reducer.end_of_stream();
+    perf_tests::stop_measuring_time();
+    // number of records kept, equals keys when nothing was evicted
+    perf_tests::do_not_optimize(bitmap.cardinality());
+    return data.size() * 2;
+}
+
+// the map compaction used before, for comparison. it has no budget and grows
+// to hold every key.
+PERF_TEST_F(unique_keys_bench, node_hash_map_baseline) {
+    absl::node_hash_map<
+      bytes,
+      storage::internal::compaction_key_reducer::value_type,
+      bytes_hasher<uint64_t, xxhash_64>,
+      bytes_type_eq>
+      map;
+    perf_tests::start_measuring_time();
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < data.size(); ++i) {
+            auto [it, _] = map.try_emplace(
+              data[i],
+              storage::internal::compaction_key_reducer::value_type{
+                int64_t(i), uint32_t(i)});
+            it->second.offset = int64_t(i);
+        }
+    }
+    perf_tests::stop_measuring_time();
+    perf_tests::do_not_optimize(map.size());
+    return data.size() * 2;
+}
@@ -225,29 +225,25 @@ FIXTURE_TEST(key_reducer_max_mem, compacted_topic_fixture) {
 
     rdr.verify_integrity().get();
     rdr.reset();
+    using key_map = storage::internal::compaction_key_reducer::underlying_t;
+    // room for a single key
     auto small_mem_bitmap = rdr
                               .consume(
                                 storage::internal::compaction_key_reducer(
-                                  1_KiB + 16),
+                                  key_map::slot_size),
                                 model::no_timeout)
                               .get0();
 
     /*
       There are 2 keys exactly.
-      Each key is exactly 1KB
-      We need 2KB + 2* (capacity * sizeof(std::pair) + 1)
-      memory map
+      Keys are stored as fingerprints, the map needs one free slot on top of
+      the 2 used ones at its max load factor.
      */
     rdr.reset();
-    auto entry_size
-      = sizeof(
-          std::
-            pair<bytes, storage::internal::compaction_key_reducer::value_type>)
-        + 1;
     auto exact_mem_bitmap = rdr
                               .consume(
                                 storage::internal::compaction_key_reducer(
-                                  2_KiB + 2 * entry_size * 2),
+                                  4 * key_map::slot_size),
                                 model::no_timeout)
                               .get0();
 
@@ -262,6 +258,98 @@ FIXTURE_TEST(key_reducer_max_mem, compacted_topic_fixture) {
     BOOST_REQUIRE(exact_mem_bitmap.contains(98));
     BOOST_REQUIRE(exact_mem_bitmap.contains(99));
 }
+FIXTURE_TEST(key_reducer_default_budget, compacted_topic_fixture) {
+    // the default budget holds this many keys without evicting
+    constexpr size_t keys = 140'000;
+    storage::internal::compaction_key_reducer reducer;
+    std::vector<bytes> data;
+    data.reserve(keys);
+    for (size_t i = 0; i < keys; ++i) {
+        data.push_back(random_generators::get_bytes(20));
+    }
+    size_t natural_index = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (auto& k : data) {
+            reducer(storage::compacted_index::entry(
+                      storage::compacted_index::entry_type::key,
+                      k,
+                      model::offset(natural_index++),
+                      0))
+              .get();
+        }
+    }
+    auto bitmap = reducer.end_of_stream();
+    BOOST_REQUIRE_EQUAL(bitmap.cardinality(), keys);
+    // only the second pass survives
+    BOOST_REQUIRE_EQUAL(bitmap.minimum(), keys);
+    BOOST_REQUIRE_EQUAL(bitmap.maximum(), 2 * keys - 1);
+}
+
+FIXTURE_TEST(key_fingerprint_full_width, compacted_topic_fixture) {
+    using storage::internal::key_fingerprint;
+    // the high word is a full 64 bit hash, not a truncated one
+    bool upper_bits = false;
+    for (int i = 0; i < 64 && !upper_bits; ++i) {
+        auto fp = key_fingerprint::of(random_generators::get_bytes(20));
+        upper_bits = (fp.hi >> 32U) != 0;
+    }
+    BOOST_REQUIRE(upper_bits);
+
+    // fingerprints that only differ in the top bit are different keys
+    storage::internal::key_fingerprint_map<int64_t> map(1_KiB);
+    const key_fingerprint a{.lo = 42, .hi = 1};
+    const key_fingerprint b{.lo = 42, .hi = 1 | (uint64_t(1) << 63U)};
+    map.insert(a, 1);
+    BOOST_REQUIRE(!map.update(b, [](int64_t&) {}));
+    map.insert(b, 2);
+    BOOST_REQUIRE_EQUAL(map.size(), 2);
+    int64_t va = 0;
+    int64_t vb = 0;
+    BOOST_REQUIRE(map.update(a, [&va](int64_t& v) { va = v; }));
+    BOOST_REQUIRE(map.update(b, [&vb](int64_t& v) { vb = v; }));
+    BOOST_REQUIRE_EQUAL(va, 1);
+    BOOST_REQUIRE_EQUAL(vb, 2);
+}
+
+FIXTURE_TEST(spill_key_index_keys_in_arena, compacted_topic_fixture) {
+    tmpbuf_file::store_t index_data;
+    auto idx = storage::make_file_backed_compacted_index(
+      "dummy name",
+      ss::file(ss::make_shared(tmpbuf_file(index_data))),
+      ss::default_priority_class(),
+      256_KiB);
+    std::vector<bytes> data;
+    for (auto i = 0; i < 1000; ++i) {
+        data.push_back(random_generators::get_bytes(20));
+    }
+    // every key is indexed 3 times, the latest offset must win
+    for (auto pass = 0; pass < 3; ++pass) {
+        for (size_t i = 0; i < data.size(); ++i) {
+            idx.index(
+                 bytes_view(data[i]), model::offset(pass * data.size() + i), 0)
+              .get();
+        }
+    }
+    idx.close().get();
+
+    auto rdr = storage::make_file_backed_compacted_reader(
+      "dummy name",
+      ss::file(ss::make_shared(tmpbuf_file(index_data))),
+      ss::default_priority_class(),
+      32_KiB);
+    rdr.verify_integrity().get();
+    auto vec = compaction_index_reader_to_memory(rdr).get0();
+    // 1000 keys fit in the budget, nothing was spilled before close
+    BOOST_REQUIRE_EQUAL(vec.size(), data.size());
+    for (auto& e : vec) {
+        auto it = std::find(data.begin(), data.end(), e.key);
+        BOOST_REQUIRE(it != data.end());
+        BOOST_REQUIRE_EQUAL(
+          e.offset,
+          model::offset(2 * data.size() + std::distance(data.begin(), it)));
+    }
+}
+
 FIXTURE_TEST(index_filtered_copy_tests, compacted_topic_fixture) {
     tmpbuf_file::store_t index_data;
 
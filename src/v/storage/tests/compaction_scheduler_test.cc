@@ -0,0 +1,72 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/compaction_scheduler.h"
+#include "units.h"
+
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+using namespace std::chrono_literals; // NOLINT
+
+SEASTAR_THREAD_TEST_CASE(compaction_scheduler_limits_concurrent_jobs) {
+    storage::compaction_scheduler s(2, std::nullopt);
+    auto u1 = s.acquire_job_slot().get0();
+    auto u2 = s.acquire_job_slot().get0();
+    auto f = s.acquire_job_slot();
+    BOOST_REQUIRE(!f.available());
+    BOOST_REQUIRE_EQUAL(s.waiting_jobs(), 1);
+    u1.return_all();
+    auto u3 = f.get0();
+    BOOST_REQUIRE_EQUAL(s.waiting_jobs(), 0);
+
+    // a stopped scheduler fails the waiters
+    auto stopped = s.acquire_job_slot();
+    s.stop();
+    BOOST_REQUIRE_THROW(stopped.get(), ss::broken_semaphore);
+}
+
+SEASTAR_THREAD_TEST_CASE(compaction_scheduler_unlimited_rate) {
+    storage::compaction_scheduler s(1, std::nullopt);
+    ss::abort_source as;
+    auto f = s.throttle(1_GiB, as);
+    BOOST_REQUIRE(f.available());
+    f.get();
+    BOOST_REQUIRE_EQUAL(s.processed_bytes(), 1_GiB);
+}
+
+SEASTAR_THREAD_TEST_CASE(compaction_scheduler_throttles_to_rate) {
+    storage::compaction_scheduler s(1, 1000);
+    ss::abort_source as;
+    // one second worth of burst is available right away
+    auto f = s.throttle(1000, as);
+    BOOST_REQUIRE(f.available());
+    f.get();
+
+    // the next 500 bytes wait for the bucket to refill
+    const auto start = storage::compaction_scheduler::clock_type::now();
+    s.throttle(500, as).get();
+    BOOST_REQUIRE_GE(
+      storage::compaction_scheduler::clock_type::now() - start, 300ms);
+
+    // the rate follows the controller output
+    s.set_rate_scale(0.5);
+    BOOST_REQUIRE_EQUAL(*s.bytes_per_sec(), 500);
+}
+
+SEASTAR_THREAD_TEST_CASE(compaction_scheduler_throttle_abort) {
+    storage::compaction_scheduler s(1, 1);
+    ss::abort_source as;
+    s.throttle(1, as).get();
+    auto f = s.throttle(1_MiB, as);
+    as.request_abort();
+    BOOST_REQUIRE_THROW(f.get(), ss::sleep_aborted);
+}
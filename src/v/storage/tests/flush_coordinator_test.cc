@@ -0,0 +1,56 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "random/generators.h"
+#include "storage/flush_coordinator.h"
+
+#include <seastar/core/file.hh>
+#include <seastar/core/future-util.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+using namespace std::chrono_literals; // NOLINT
+
+static ss::file open_test_file() {
+    auto name = ss::sstring(fmt::format(
+      "flush_coordinator_test.{}.log", random_generators::get_int(100000)));
+    return ss::open_file_dma(
+             name, ss::open_flags::create | ss::open_flags::rw)
+      .get0();
+}
+
+SEASTAR_THREAD_TEST_CASE(flush_coordinator_coalesces_same_file) {
+    storage::internal::flush_coordinator c;
+    c.start(10ms);
+    auto f = open_test_file();
+    int owner = 0;
+    std::vector<ss::future<>> flushes;
+    for (int i = 0; i < 10; ++i) {
+        flushes.push_back(c.flush(&owner, f));
+    }
+    ss::when_all_succeed(flushes.begin(), flushes.end()).get();
+    BOOST_REQUIRE_EQUAL(c.requests(), 10);
+    BOOST_REQUIRE_EQUAL(c.syncs(), 1);
+    f.close().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(flush_coordinator_zero_window_dispatches_each) {
+    storage::internal::flush_coordinator c;
+    c.start(0us);
+    auto f = open_test_file();
+    int a = 0;
+    int b = 0;
+    auto fa = c.flush(&a, f);
+    auto fb = c.flush(&b, f);
+    auto fa2 = c.flush(&a, f);
+    ss::when_all_succeed(std::move(fa), std::move(fb), std::move(fa2)).get();
+    BOOST_REQUIRE_EQUAL(c.requests(), 3);
+    BOOST_REQUIRE_EQUAL(c.syncs(), 3);
+    f.close().get();
+}
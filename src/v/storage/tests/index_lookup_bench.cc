@@ -0,0 +1,79 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "random/generators.h"
+#include "storage/index_state.h"
+
+#include <seastar/core/reactor.hh>
+#include <seastar/testing/perf_tests.hh>
+
+#include <algorithm>
+#include <vector>
+
+/*
+ * compares the plain lower_bound over the offset column of the segment index
+ * with the two level fence index lookup. each measured run performs
+ * `lookups` random lookups.
+ */
+template<size_t Entries>
+struct index_lookup_bench {
+    static constexpr size_t lookups = 1024;
+
+    index_lookup_bench() {
+        uint32_t offset = 0;
+        for (size_t i = 0; i < Entries; ++i) {
+            offset += random_generators::get_int<uint32_t>(1, 64);
+            state.add_entry(offset, offset, i * 4096);
+        }
+        needles.reserve(lookups);
+        for (size_t i = 0; i < lookups; ++i) {
+            needles.push_back(random_generators::get_int<uint32_t>(0, offset));
+        }
+    }
+
+    size_t lower_bound() {
+        size_t ret = 0;
+        perf_tests::start_measuring_time();
+        for (auto needle : needles) {
+            auto it = std::lower_bound(
+              state.relative_offset_index.begin(),
+              state.relative_offset_index.end(),
+              needle);
+            ret += std::distance(state.relative_offset_index.begin(), it);
+        }
+        perf_tests::do_not_optimize(ret);
+        perf_tests::stop_measuring_time();
+        return lookups;
+    }
+
+    size_t fence_index() {
+        size_t ret = 0;
+        perf_tests::start_measuring_time();
+        for (auto needle : needles) {
+            ret += state.offset_lower_bound(needle);
+        }
+        perf_tests::do_not_optimize(ret);
+        perf_tests::stop_measuring_time();
+        return lookups;
+    }
+
+    storage::index_state state;
+    std::vector<uint32_t> needles;
+};
+
+using index_1k = index_lookup_bench<1'000>;
+using index_32k = index_lookup_bench<32'000>;
+using index_1m = index_lookup_bench<1'000'000>;
+
+PERF_TEST_F(index_1k, lower_bound) { return lower_bound(); }
+PERF_TEST_F(index_1k, fence_index) { return fence_index(); }
+PERF_TEST_F(index_32k, lower_bound) { return lower_bound(); }
+PERF_TEST_F(index_32k, fence_index) { return fence_index(); }
+PERF_TEST_F(index_1m, lower_bound) { return lower_bound(); }
+PERF_TEST_F(index_1m, fence_index) { return fence_index(); }
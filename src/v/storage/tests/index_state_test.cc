@@ -1,9 +1,13 @@
 #define BOOST_TEST_MODULE storage
 #include "bytes/bytes.h"
+#include "reflection/adl.h"
+#include "storage/fence_index.h"
 #include "storage/index_state.h"
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+
 static storage::index_state make_random_index_state() {
     storage::index_state st;
     st.size = 33;
@@ -97,3 +101,135 @@ BOOST_AUTO_TEST_CASE(encode_decode_future_version) {
     auto dst = storage::index_state::hydrate_from_buffer(src_buf.copy());
     BOOST_REQUIRE(!dst);
 }
+
+static iobuf serialize_v3(const storage::index_state& st) {
+    // v3 had no header checksum nor padding
+    iobuf out;
+    const uint32_t vsize = st.relative_offset_index.size();
+    reflection::serialize(
+      out,
+      int8_t(3),
+      uint32_t(48 + vsize * 16),
+      storage::index_state::checksum_state(st),
+      st.bitflags,
+      st.base_offset(),
+      st.max_offset(),
+      st.base_timestamp(),
+      st.max_timestamp(),
+      vsize);
+    for (auto i = 0U; i < vsize; ++i) {
+        reflection::adl<uint32_t>{}.to(out, st.relative_offset_index[i]);
+    }
+    for (auto i = 0U; i < vsize; ++i) {
+        reflection::adl<uint32_t>{}.to(out, st.relative_time_index[i]);
+    }
+    for (auto i = 0U; i < vsize; ++i) {
+        reflection::adl<uint64_t>{}.to(out, st.position_index[i]);
+    }
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(encode_decode_v3) {
+    auto src = make_random_index_state();
+    auto src_buf = serialize_v3(src);
+
+    // version 3 is decoded in full but has no standalone header
+    auto dst = storage::index_state::hydrate_from_buffer(src_buf.copy());
+    BOOST_REQUIRE(dst);
+    BOOST_REQUIRE_EQUAL(dst->max_offset, src.max_offset);
+    BOOST_REQUIRE(dst->relative_offset_index == src.relative_offset_index);
+    BOOST_REQUIRE(dst->position_index == src.position_index);
+
+    auto hdr = storage::index_state::hydrate_header_from_buffer(
+      src_buf.copy(), src_buf.size_bytes());
+    BOOST_REQUIRE(!hdr);
+}
+
+BOOST_AUTO_TEST_CASE(encode_decode_header_only) {
+    auto src = make_random_index_state();
+    src.add_entry(5, 6, 7);
+    auto src_buf = src.checksum_and_serialize();
+    const auto file_size = src_buf.size_bytes();
+    BOOST_REQUIRE_EQUAL(
+      file_size, storage::index_state::ondisk_header_size + 2 * 16);
+
+    // only the first page of the file is needed
+    auto header = src_buf.share(0, storage::index_state::ondisk_header_size);
+    auto dst = storage::index_state::hydrate_header_from_buffer(
+      std::move(header), file_size);
+    BOOST_REQUIRE(dst);
+    BOOST_REQUIRE(dst->empty());
+    BOOST_REQUIRE_EQUAL(dst->base_offset, src.base_offset);
+    BOOST_REQUIRE_EQUAL(dst->max_offset, src.max_offset);
+    BOOST_REQUIRE_EQUAL(dst->base_timestamp, src.base_timestamp);
+    BOOST_REQUIRE_EQUAL(dst->max_timestamp, src.max_timestamp);
+    BOOST_REQUIRE_EQUAL(dst->checksum, src.checksum);
+
+    // the file size must match the number of entries
+    BOOST_REQUIRE(!storage::index_state::hydrate_header_from_buffer(
+      src_buf.copy(), file_size - 16));
+}
+
+BOOST_AUTO_TEST_CASE(encode_decode_header_corrupted) {
+    auto src = make_random_index_state();
+    auto src_buf = src.checksum_and_serialize();
+    const auto file_size = src_buf.size_bytes();
+
+    // flip a bit in the max offset
+    auto tmp = iobuf_to_bytes(src_buf);
+    tmp[30] ^= 1;
+    auto corrupted = bytes_to_iobuf(tmp);
+
+    BOOST_REQUIRE(!storage::index_state::hydrate_header_from_buffer(
+      corrupted.copy(), file_size));
+    BOOST_REQUIRE(!storage::index_state::hydrate_from_buffer(corrupted.copy()));
+}
+
+BOOST_AUTO_TEST_CASE(fence_index_lookup) {
+    storage::index_state st;
+    uint32_t offset = 0;
+    for (auto i = 0U; i < 1000; ++i) {
+        offset += 1 + (i * 7919) % 13;
+        st.add_entry(offset, i, i);
+    }
+    auto check_all = [&st](uint32_t max) {
+        for (uint32_t needle = 0; needle <= max + 1; ++needle) {
+            auto it = std::lower_bound(
+              st.relative_offset_index.begin(),
+              st.relative_offset_index.end(),
+              needle);
+            BOOST_REQUIRE_EQUAL(
+              st.offset_lower_bound(needle),
+              size_t(std::distance(st.relative_offset_index.begin(), it)));
+        }
+    };
+    check_all(offset);
+
+    // shrinking the column keeps the fences in sync
+    while (st.relative_offset_index.size() > 500) {
+        st.pop_back();
+    }
+    check_all(offset);
+
+    // and so does hydrating from disk
+    auto dst = storage::index_state::hydrate_from_buffer(
+      st.checksum_and_serialize());
+    BOOST_REQUIRE(dst);
+    BOOST_REQUIRE(st == *dst);
+}
+
+BOOST_AUTO_TEST_CASE(fence_index_count_lower) {
+    std::vector<uint32_t> values;
+    for (auto i = 0U; i < 37; ++i) {
+        // exercise the unsigned compares in the vectorized kernels
+        values.push_back(i < 20 ? i * 3 : 0x80000000U + i);
+    }
+    for (uint32_t needle :
+         {0U, 1U, 30U, 57U, 58U, 0x7fffffffU, 0x80000000U, 0x80000015U}) {
+        for (auto n = 0U; n <= values.size(); ++n) {
+            BOOST_REQUIRE_EQUAL(
+              storage::internal::count_lower(values.data(), n, needle),
+              storage::internal::count_lower_scalar(values.data(), n, needle));
+        }
+    }
+}
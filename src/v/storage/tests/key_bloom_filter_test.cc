@@ -0,0 +1,86 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "bytes/bytes.h"
+#include "random/generators.h"
+#include "storage/key_bloom_filter.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+static std::vector<bytes> make_keys(size_t n) {
+    std::vector<bytes> keys;
+    keys.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back(random_generators::get_bytes(20));
+    }
+    return keys;
+}
+
+BOOST_AUTO_TEST_CASE(key_bloom_filter_no_false_negatives) {
+    auto keys = make_keys(10000);
+    storage::internal::key_bloom_filter filter(keys.size());
+    for (auto& k : keys) {
+        filter.add(k);
+    }
+    for (auto& k : keys) {
+        BOOST_REQUIRE(filter.may_contain(k));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(key_bloom_filter_false_positive_rate) {
+    auto keys = make_keys(10000);
+    storage::internal::key_bloom_filter filter(keys.size());
+    for (auto& k : keys) {
+        filter.add(k);
+    }
+    size_t false_positives = 0;
+    for (auto& k : make_keys(10000)) {
+        false_positives += filter.may_contain(k);
+    }
+    // ~1% expected at 10 bits per key
+    BOOST_REQUIRE_LT(false_positives, 300);
+}
+
+BOOST_AUTO_TEST_CASE(key_bloom_filter_empty) {
+    storage::internal::key_bloom_filter filter(0);
+    BOOST_REQUIRE_EQUAL(filter.size_bits(), 64);
+    BOOST_REQUIRE(!filter.may_contain(random_generators::get_bytes(20)));
+}
+
+BOOST_AUTO_TEST_CASE(key_bloom_filter_encode_decode) {
+    auto keys = make_keys(1000);
+    storage::internal::key_bloom_filter filter(keys.size());
+    for (auto& k : keys) {
+        filter.add(k);
+    }
+    auto decoded = storage::internal::key_bloom_filter::deserialize(
+      filter.serialize());
+    BOOST_REQUIRE(decoded);
+    BOOST_REQUIRE(*decoded == filter);
+    for (auto& k : keys) {
+        BOOST_REQUIRE(decoded->may_contain(k));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(key_bloom_filter_corrupted) {
+    storage::internal::key_bloom_filter filter(100);
+    filter.add(random_generators::get_bytes(20));
+    auto buf = iobuf_to_bytes(filter.serialize());
+    // flip a bit in the last word
+    buf[buf.size() - 1] ^= 1;
+    BOOST_REQUIRE(!storage::internal::key_bloom_filter::deserialize(
+      bytes_to_iobuf(buf)));
+
+    // truncated
+    auto truncated = iobuf_to_bytes(filter.serialize());
+    BOOST_REQUIRE(!storage::internal::key_bloom_filter::deserialize(
+      bytes_to_iobuf(truncated.substr(0, truncated.size() - 8))));
+}
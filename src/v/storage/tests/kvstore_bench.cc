@@ -0,0 +1,91 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "config/configuration.h"
+#include "random/generators.h"
+#include "storage/kvstore.h"
+#include "units.h"
+
+#include <seastar/core/future-util.hh>
+#include <seastar/testing/perf_tests.hh>
+
+#include <chrono>
+
+// a kvstore with 100K keys, about the state of 30K raft groups on a shard.
+// segments are small so the measured puts include rolls and snapshots.
+struct kvstore_bench {
+    static constexpr size_t keys = 100'000;
+
+    kvstore_bench() {
+        config::shard_local_cfg().get("disable_metrics").set_value(true);
+        kvs = std::make_unique<storage::kvstore>(storage::kvstore_config(
+          1_MiB,
+          std::chrono::milliseconds(1),
+          ssx::sformat(
+            "kvstore_bench_{}", random_generators::get_int(100'000)),
+          storage::debug_sanitize_files::no));
+        kvs->start().get();
+
+        data.reserve(keys);
+        for (size_t i = 0; i < keys; ++i) {
+            data.push_back(random_generators::get_bytes(16));
+        }
+        for (size_t i = 0; i < keys; i += 1000) {
+            std::vector<ss::future<>> puts;
+            for (size_t j = i; j < std::min(keys, i + 1000); ++j) {
+                puts.push_back(kvs->put(ks, data[j], value()));
+            }
+            ss::when_all_succeed(puts.begin(), puts.end()).get();
+        }
+    }
+
+    ~kvstore_bench() { kvs->stop().get(); }
+
+    static iobuf value() {
+        return bytes_to_iobuf(random_generators::get_bytes(32));
+    }
+
+    const bytes& random_key() const {
+        return data[random_generators::get_int(data.size() - 1)];
+    }
+
+    static constexpr auto ks = storage::kvstore::key_space::testing;
+    std::unique_ptr<storage::kvstore> kvs;
+    std::vector<bytes> data;
+};
+
+PERF_TEST_F(kvstore_bench, put_one) {
+    auto v = value();
+    perf_tests::start_measuring_time();
+    kvs->put(ks, random_key(), std::move(v)).get();
+    perf_tests::stop_measuring_time();
+}
+
+PERF_TEST_F(kvstore_bench, put_batch_1000) {
+    std::vector<ss::future<>> puts;
+    puts.reserve(1000);
+    perf_tests::start_measuring_time();
+    for (size_t i = 0; i < 1000; ++i) {
+        puts.push_back(kvs->put(ks, random_key(), value()));
+    }
+    ss::when_all_succeed(puts.begin(), puts.end()).get();
+    perf_tests::stop_measuring_time();
+    return 1000;
+}
+
+PERF_TEST_F(kvstore_bench, prefix_scan) {
+    size_t n = 0;
+    perf_tests::start_measuring_time();
+    kvs->for_each(ks, bytes_view(random_key()).substr(0, 1), [&n](auto, auto&) {
+        ++n;
+    });
+    perf_tests::stop_measuring_time();
+    perf_tests::do_not_optimize(n);
+    return n;
+}
@@ -14,6 +14,8 @@
 
 #include <seastar/testing/thread_test_case.hh>
 
+#include <filesystem>
+
 template<typename T>
 static void set_configuration(ss::sstring p_name, T v) {
     ss::smp::invoke_on_all([p_name, v = std::move(v)] {
@@ -205,3 +207,151 @@ SEASTAR_THREAD_TEST_CASE(kvstore) {
     }
     kvs->stop().get();
 }
+
+SEASTAR_THREAD_TEST_CASE(kvstore_prefix_and_range_iteration) {
+    set_configuration("disable_metrics", true);
+
+    auto dir = ssx::sformat(
+      "kvstore_test_{}", random_generators::get_int(4000));
+
+    auto conf = get_conf(dir);
+
+    auto kvs = std::make_unique<storage::kvstore>(conf);
+    kvs->start().get();
+
+    auto make_key = [](std::string_view k) {
+        return bytes(reinterpret_cast<const uint8_t*>(k.data()), k.size());
+    };
+    for (auto k : {"a/1", "a/2", "a/3", "b/1", "b/2", "c"}) {
+        kvs->put(
+             storage::kvstore::key_space::testing,
+             make_key(k),
+             bytes_to_iobuf(make_key(k)))
+          .get();
+    }
+    // same keys in another key space must not be visited
+    kvs->put(storage::kvstore::key_space::consensus, make_key("a/4"), iobuf())
+      .get();
+
+    std::vector<bytes> keys;
+    auto collect = [&keys](bytes_view key, const iobuf& value) {
+        auto k = bytes(key.data(), key.size());
+        BOOST_REQUIRE(iobuf_to_bytes(value.copy()) == k);
+        keys.push_back(std::move(k));
+    };
+
+    kvs->for_each(
+      storage::kvstore::key_space::testing, make_key("a/"), collect);
+    BOOST_REQUIRE(
+      keys
+      == std::vector<bytes>(
+        {make_key("a/1"), make_key("a/2"), make_key("a/3")}));
+
+    keys.clear();
+    kvs->for_each(storage::kvstore::key_space::testing, bytes_view(), collect);
+    BOOST_REQUIRE_EQUAL(keys.size(), 6);
+    BOOST_REQUIRE(std::is_sorted(keys.begin(), keys.end()));
+
+    keys.clear();
+    kvs->for_each_in_range(
+      storage::kvstore::key_space::testing,
+      make_key("a/2"),
+      make_key("b/2"),
+      collect);
+    BOOST_REQUIRE(
+      keys
+      == std::vector<bytes>(
+        {make_key("a/2"), make_key("a/3"), make_key("b/1")}));
+
+    // reversed range is empty
+    keys.clear();
+    kvs->for_each_in_range(
+      storage::kvstore::key_space::testing,
+      make_key("b/2"),
+      make_key("a/2"),
+      collect);
+    BOOST_REQUIRE(keys.empty());
+
+    keys.clear();
+    kvs->for_each(storage::kvstore::key_space::testing, make_key("d"), collect);
+    BOOST_REQUIRE(keys.empty());
+
+    kvs->stop().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(kvstore_delta_snapshots) {
+    set_configuration("disable_metrics", true);
+
+    auto dir = ssx::sformat(
+      "kvstore_test_{}", random_generators::get_int(4000));
+
+    auto conf = get_conf(dir);
+
+    std::unordered_map<bytes, iobuf> truth;
+    std::vector<bytes> keys;
+
+    auto has_deltas = [&dir] {
+        for (auto& e : std::filesystem::recursive_directory_iterator(
+               std::filesystem::path(dir))) {
+            if (e.path().filename().string().starts_with("snapshot.delta.")) {
+                return true;
+            }
+        }
+        return false;
+    };
+    bool saw_deltas = false;
+
+    auto kvs = std::make_unique<storage::kvstore>(conf);
+    kvs->start().get();
+
+    // a large database, then a few rounds of small changes. each round rolls
+    // at least one segment so most snapshots are deltas
+    for (int i = 0; i < 1000; i++) {
+        auto key = random_generators::get_bytes(8);
+        auto value = bytes_to_iobuf(random_generators::get_bytes(10));
+        truth[key] = value.copy();
+        keys.push_back(key);
+        kvs->put(storage::kvstore::key_space::testing, key, std::move(value))
+          .get();
+    }
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 100; i++) {
+            const auto& key = keys[random_generators::get_int(
+              keys.size() - 1)];
+            if (random_generators::get_int(10) == 0) {
+                truth.erase(key);
+                kvs->remove(storage::kvstore::key_space::testing, key).get();
+            } else {
+                auto value = bytes_to_iobuf(random_generators::get_bytes(10));
+                truth[key] = value.copy();
+                kvs->put(
+                     storage::kvstore::key_space::testing,
+                     key,
+                     std::move(value))
+                  .get();
+            }
+        }
+        saw_deltas |= has_deltas();
+    }
+    kvs->stop().get();
+
+    BOOST_REQUIRE(saw_deltas);
+
+    // the full snapshot plus the deltas plus the log rebuild the database
+    for (int restart = 0; restart < 2; restart++) {
+        kvs = std::make_unique<storage::kvstore>(conf);
+        kvs->start().get();
+        size_t count = 0;
+        kvs->for_each(
+          storage::kvstore::key_space::testing,
+          bytes_view(),
+          [&count](bytes_view, const iobuf&) { ++count; });
+        BOOST_REQUIRE_EQUAL(count, truth.size());
+        for (auto& e : truth) {
+            BOOST_REQUIRE(
+              kvs->get(storage::kvstore::key_space::testing, e.first).value()
+              == e.second);
+        }
+        kvs->stop().get();
+    }
+}
@@ -126,3 +126,62 @@ FIXTURE_TEST(bucket_truncate, context) {
         BOOST_REQUIRE_EQUAL(p->filepos, 458048);
     }
 }
+
+FIXTURE_TEST(index_lazy_hydration, context) {
+    for (uint32_t i = 0; i < 1024; ++i) {
+        model::offset o = _base_offset + model::offset(i);
+        _idx->maybe_track(
+          modify_get(o, storage::segment_index::default_data_buffer_step), i);
+    }
+    _idx->flush().get0();
+
+    // a budget of zero keeps only the most recently used index in memory
+    storage::segment_index_cache cache(0);
+    auto make_lazy_index = [this, &cache](ss::sstring name) {
+        auto idx = std::make_unique<storage::segment_index>(
+          std::move(name),
+          ss::file(ss::make_shared(tmpbuf_file(_data))),
+          _base_offset,
+          storage::segment_index::default_data_buffer_step);
+        idx->set_cache(&cache);
+        BOOST_REQUIRE(idx->materialize_index().get0());
+        return idx;
+    };
+
+    auto lazy = make_lazy_index("lazy");
+    info("lazy index: {}", lazy);
+    BOOST_REQUIRE(!lazy->is_hydrated());
+    BOOST_REQUIRE_EQUAL(lazy->base_offset(), _base_offset);
+    BOOST_REQUIRE_EQUAL(lazy->max_offset(), model::offset(1023));
+    BOOST_REQUIRE_EQUAL(cache.memory_usage(), 0);
+    // nothing is found before the entries are paged in
+    BOOST_REQUIRE(!lazy->find_nearest(model::offset(512)));
+
+    lazy->hydrate().get();
+    BOOST_REQUIRE(lazy->is_hydrated());
+    BOOST_REQUIRE_EQUAL(cache.memory_usage(), lazy->memory_usage());
+    {
+        auto p = lazy->find_nearest(model::offset(512));
+        BOOST_REQUIRE(bool(p));
+        BOOST_REQUIRE_EQUAL(p->offset, model::offset(512));
+        BOOST_REQUIRE_EQUAL(p->filepos, 512);
+    }
+
+    // hydrating another index evicts the least recently used one
+    auto other = make_lazy_index("other");
+    other->hydrate().get();
+    BOOST_REQUIRE(other->is_hydrated());
+    BOOST_REQUIRE(!lazy->is_hydrated());
+    BOOST_REQUIRE_EQUAL(lazy->memory_usage(), 0);
+    BOOST_REQUIRE_EQUAL(cache.memory_usage(), other->memory_usage());
+
+    // and it can be paged back in
+    lazy->hydrate().get();
+    BOOST_REQUIRE(lazy->is_hydrated());
+    BOOST_REQUIRE(!other->is_hydrated());
+    BOOST_REQUIRE_EQUAL(
+      lazy->find_nearest(model::offset(1000))->offset, model::offset(1000));
+
+    lazy->close().get();
+    other->close().get();
+}
@@ -236,6 +236,35 @@ FIXTURE_TEST(test_reading_range_from_a_log, storage_test_fixture) {
     BOOST_REQUIRE_EQUAL(range.back().header().crc, batches[7].header().crc);
 };
 
+FIXTURE_TEST(test_reading_with_read_ahead, storage_test_fixture) {
+    storage::log_manager mgr = make_log_manager();
+    info("Configuration: {}", mgr.config());
+    auto ntp = model::ntp("default", "test", 0);
+    auto log
+      = mgr.manage(storage::ntp_config(ntp, mgr.config().base_dir)).get0();
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    append_random_batches(log, 10);
+    log.flush().get0();
+    auto batches = read_and_validate_all_batches(log);
+
+    // sequential read bypassing the batch cache
+    storage::log_reader_config cfg(
+      batches[2].base_offset(),
+      batches.back().last_offset(),
+      ss::default_priority_class());
+    cfg.skip_batch_cache = true;
+    cfg.read_buffer_size = 16 * 1024;
+    auto reader = log.make_reader(cfg).get0();
+    auto range = std::move(reader)
+                   .consume(batch_validating_consumer(), model::no_timeout)
+                   .get0();
+    BOOST_REQUIRE_EQUAL(range.size(), batches.size() - 2);
+    for (size_t i = 0; i < range.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(
+          range[i].header().crc, batches[i + 2].header().crc);
+    }
+};
+
 FIXTURE_TEST(test_rolling_term, storage_test_fixture) {
     storage::log_manager mgr = make_log_manager();
     info("Configuration: {}", mgr.config());
@@ -1089,6 +1118,8 @@ FIXTURE_TEST(check_segment_size_jitter, storage_test_fixture) {
 
 FIXTURE_TEST(adjacent_segment_compaction, storage_test_fixture) {
     auto cfg = default_log_config(test_dir);
+    // the steps below merge one pair of segments at a time
+    cfg.compaction_max_segments_per_job = 2;
     cfg.stype = storage::log_config::storage_type::disk;
     cfg.cache = storage::with_cache::yes;
     storage::ntp_config::default_overrides overrides;
@@ -1133,6 +1164,13 @@ FIXTURE_TEST(adjacent_segment_compaction, storage_test_fixture) {
     log.compact(c_cfg).get0();
     BOOST_REQUIRE_EQUAL(disk_log->segment_count(), 3);
 
+    // the merged segment carries the key filter of its keys
+    auto merged_filter = storage::internal::compacted_key_filter_path(
+      disk_log->segments().front()->reader().filename().c_str());
+    BOOST_REQUIRE(storage::internal::read_key_filter(merged_filter, c_cfg)
+                    .get0()
+                    .has_value());
+
     log.compact(c_cfg).get0();
     BOOST_REQUIRE_EQUAL(disk_log->segment_count(), 2);
 
@@ -1143,6 +1181,8 @@ FIXTURE_TEST(adjacent_segment_compaction, storage_test_fixture) {
 
 FIXTURE_TEST(adjacent_segment_compaction_terms, storage_test_fixture) {
     auto cfg = default_log_config(test_dir);
+    // the steps below merge one pair of segments at a time
+    cfg.compaction_max_segments_per_job = 2;
     cfg.stype = storage::log_config::storage_type::disk;
     cfg.cache = storage::with_cache::yes;
     storage::ntp_config::default_overrides overrides;
@@ -1205,6 +1245,8 @@ FIXTURE_TEST(adjacent_segment_compaction_terms, storage_test_fixture) {
 
 FIXTURE_TEST(max_adjacent_segment_compaction, storage_test_fixture) {
     auto cfg = default_log_config(test_dir);
+    // the steps below merge one pair of segments at a time
+    cfg.compaction_max_segments_per_job = 2;
     cfg.max_compacted_segment_size = 6_MiB;
     cfg.stype = storage::log_config::storage_type::disk;
     cfg.cache = storage::with_cache::yes;
@@ -1279,6 +1321,60 @@ FIXTURE_TEST(max_adjacent_segment_compaction, storage_test_fixture) {
     BOOST_REQUIRE_EQUAL(disk_log->segment_count(), 3);
 }
 
+FIXTURE_TEST(multi_segment_adjacent_compaction, storage_test_fixture) {
+    auto cfg = default_log_config(test_dir);
+    cfg.stype = storage::log_config::storage_type::disk;
+    cfg.cache = storage::with_cache::yes;
+    cfg.compaction_max_segments_per_job = 4;
+    storage::ntp_config::default_overrides overrides;
+    overrides.cleanup_policy_bitflags
+      = model::cleanup_policy_bitflags::compaction;
+
+    ss::abort_source as;
+    storage::log_manager mgr = make_log_manager(cfg);
+
+    info("config: {}", mgr.config());
+    auto deferred = ss::defer([&mgr]() mutable { mgr.stop().get0(); });
+    auto ntp = model::ntp("default", "test", 0);
+    auto log = mgr
+                 .manage(storage::ntp_config(
+                   ntp,
+                   mgr.config().base_dir,
+                   std::make_unique<storage::ntp_config::default_overrides>(
+                     overrides)))
+                 .get0();
+
+    // build some segments
+    auto disk_log = get_disk_log(log);
+    append_single_record_batch(log, 20, model::term_id(1));
+    disk_log->force_roll(ss::default_priority_class()).get();
+    append_single_record_batch(log, 30, model::term_id(1));
+    disk_log->force_roll(ss::default_priority_class()).get();
+    append_single_record_batch(log, 40, model::term_id(1));
+    disk_log->force_roll(ss::default_priority_class()).get();
+    append_single_record_batch(log, 50, model::term_id(1));
+    log.flush().get0();
+
+    BOOST_REQUIRE_EQUAL(disk_log->segment_count(), 4);
+
+    storage::compaction_config c_cfg(
+      model::timestamp::min(), std::nullopt, ss::default_priority_class(), as);
+
+    // self compaction steps
+    log.compact(c_cfg).get0();
+    log.compact(c_cfg).get0();
+    log.compact(c_cfg).get0();
+    BOOST_REQUIRE_EQUAL(disk_log->segment_count(), 4);
+
+    // the three closed segments are merged in a single step
+    log.compact(c_cfg).get0();
+    BOOST_REQUIRE_EQUAL(disk_log->segment_count(), 2);
+
+    // no change since we can't combine with appender segment
+    log.compact(c_cfg).get0();
+    BOOST_REQUIRE_EQUAL(disk_log->segment_count(), 2);
+}
+
 FIXTURE_TEST(many_segment_locking, storage_test_fixture) {
     auto cfg = default_log_config(test_dir);
     cfg.stype = storage::log_config::storage_type::disk;
@@ -0,0 +1,88 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/segment_appender.h"
+#include "storage/write_behind_controller.h"
+#include "units.h"
+
+#include <seastar/testing/thread_test_case.hh>
+
+using namespace std::chrono_literals; // NOLINT
+using controller = storage::internal::write_behind_controller;
+
+struct period_driver {
+    controller& c;
+    controller::clock_type::time_point now{controller::clock_type::now()};
+
+    // one sample period of writes of \p bytes each from \p appenders
+    void run(
+      size_t appenders,
+      size_t bytes,
+      controller::clock_type::duration latency,
+      bool waited) {
+        if (waited) {
+            c.record_wait();
+        }
+        now += controller::sample_period;
+        for (size_t i = 0; i < appenders; ++i) {
+            // the owner is only used as an identity
+            c.record_write(
+              reinterpret_cast<const void*>(i + 1), bytes, latency, now);
+        }
+    }
+};
+
+SEASTAR_THREAD_TEST_CASE(write_behind_grows_while_device_keeps_up) {
+    controller c;
+    period_driver d{c};
+    const auto initial = c.max_inflight_chunks();
+    BOOST_REQUIRE_EQUAL(initial, storage::segment_appender::chunks_no_buffer);
+
+    // without waiting appends there is no reason to grow
+    d.run(1, 16_KiB, 100us, false);
+    BOOST_REQUIRE_EQUAL(c.max_inflight_chunks(), initial);
+
+    for (int i = 0; i < 5; ++i) {
+        d.run(1, 16_KiB, 100us, true);
+    }
+    BOOST_REQUIRE_EQUAL(c.max_inflight_chunks(), initial + 5);
+}
+
+SEASTAR_THREAD_TEST_CASE(write_behind_shrinks_when_device_is_congested) {
+    controller c;
+    period_driver d{c};
+    const auto initial = c.max_inflight_chunks();
+    d.run(1, 16_KiB, 100us, true);
+    for (int i = 0; i < 5 && c.max_inflight_chunks() > initial; ++i) {
+        d.run(1, 16_KiB, 10ms, true);
+    }
+    BOOST_REQUIRE_LT(c.max_inflight_chunks(), initial);
+}
+
+SEASTAR_THREAD_TEST_CASE(write_behind_fallocation_step_follows_throughput) {
+    controller c;
+    period_driver d{c};
+    BOOST_REQUIRE_EQUAL(
+      c.fallocation_step(), storage::segment_appender::fallocation_step);
+
+    d.run(1, 64_MiB, 100us, false);
+    BOOST_REQUIRE_EQUAL(c.fallocation_step(), 64_MiB);
+
+    // the same throughput split across more appenders
+    controller split;
+    period_driver ds{split};
+    ds.run(2, 32_MiB, 100us, false);
+    BOOST_REQUIRE_EQUAL(split.fallocation_step(), 32_MiB);
+
+    controller idle;
+    period_driver di{idle};
+    di.run(1, 16_KiB, 100us, false);
+    BOOST_REQUIRE_EQUAL(
+      idle.fallocation_step(), controller::min_fallocation_step);
+}
@@ -32,6 +32,12 @@ std::ostream& operator<<(std::ostream& o, const log_reader_config& cfg) {
     } else {
         o << "nullopt";
     }
+    o << ", skip_batch_cache:" << cfg.skip_batch_cache << ", read_buffer_size:";
+    if (cfg.read_buffer_size) {
+        o << *cfg.read_buffer_size;
+    } else {
+        o << "nullopt";
+    }
     return o << "}";
 }
 
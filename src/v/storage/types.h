@@ -230,6 +230,12 @@ struct log_reader_config {
     // historical read-once workloads like compaction).
     bool skip_batch_cache{false};
 
+    // size of the buffers read ahead of the reader when segment files are
+    // read, segment reader defaults are used when not set. use this option
+    // for long sequential reads (e.g. follower recovery). readers with this
+    // option set are not kept in the readers cache
+    std::optional<size_t> read_buffer_size;
+
     log_reader_config(
       model::offset start_offset,
       model::offset max_offset,
@@ -292,6 +298,8 @@ struct compaction_config {
     debug_sanitize_files sanitize;
     // abort source for compaction task
     ss::abort_source* asrc;
+    // i/o budget shared by the compactions of a shard, unthrottled if null
+    compaction_scheduler* scheduler{nullptr};
 
     friend std::ostream& operator<<(std::ostream&, const compaction_config&);
 };
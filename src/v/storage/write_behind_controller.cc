@@ -0,0 +1,167 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "storage/write_behind_controller.h"
+
+#include "config/configuration.h"
+#include "prometheus/prometheus_sanitize.h"
+#include "resource_mgmt/memory_groups.h"
+#include "storage/logger.h"
+#include "storage/segment_appender.h"
+#include "vlog.h"
+
+#include <seastar/core/align.hh>
+#include <seastar/core/metrics.hh>
+
+#include <algorithm>
+
+namespace storage::internal {
+
+// weight of the latest sample period in the smoothed observations
+static constexpr double smoothing = 0.3;
+// the lowest observed latency slowly decays towards the current latency so
+// that the baseline follows changes of the device
+static constexpr double min_latency_decay = 1.05;
+// latency relative to the baseline below which the device is considered idle
+static constexpr double uncongested_latency = 2.0;
+// latency relative to the baseline above which the device is congested
+static constexpr double congested_latency = 4.0;
+
+write_behind_controller::write_behind_controller() noexcept
+  : _max_inflight_chunks(segment_appender::chunks_no_buffer)
+  , _fallocation_step(segment_appender::fallocation_step)
+  , _period_start(clock_type::now()) {}
+
+void write_behind_controller::start(bool enabled) {
+    _enabled = enabled;
+    if (_enabled) {
+        setup_metrics();
+    }
+}
+
+void write_behind_controller::record_write(
+  const void* appender,
+  size_t bytes,
+  clock_type::duration latency,
+  clock_type::time_point now) {
+    ++_period_writes;
+    _period_bytes += bytes;
+    _period_latency_us += std::chrono::duration<double, std::micro>(latency)
+                            .count();
+    _period_appenders.insert(appender);
+    if (now - _period_start >= sample_period) {
+        update(now);
+    }
+}
+
+void write_behind_controller::update(clock_type::time_point now) {
+    const std::chrono::duration<double> elapsed = now - _period_start;
+    const auto latency_us = _period_latency_us
+                            / static_cast<double>(_period_writes);
+    const auto bytes_per_sec = static_cast<double>(_period_bytes)
+                               / elapsed.count();
+    const auto waits = _waits - _period_start_waits;
+    _active_appenders = _period_appenders.size();
+
+    if (_min_latency_us == 0) {
+        _latency_us = latency_us;
+        _min_latency_us = latency_us;
+        _bytes_per_sec = bytes_per_sec;
+    } else {
+        _latency_us = smoothing * latency_us + (1 - smoothing) * _latency_us;
+        _min_latency_us = std::min(
+          _min_latency_us * min_latency_decay, latency_us);
+        _bytes_per_sec = smoothing * bytes_per_sec
+                         + (1 - smoothing) * _bytes_per_sec;
+    }
+
+    // additive increase while the device keeps up, multiplicative decrease
+    // once requests queue up in it
+    if (_latency_us > congested_latency * _min_latency_us) {
+        _max_inflight_chunks /= 2;
+    } else if (
+      waits > 0 && _latency_us < uncongested_latency * _min_latency_us) {
+        ++_max_inflight_chunks;
+    }
+    const size_t memory_bound = memory_groups::chunk_cache_max_memory()
+                                / segment_appender::chunk_size
+                                / std::max<size_t>(1, _active_appenders);
+    _max_inflight_chunks = std::clamp<size_t>(
+      _max_inflight_chunks, 1, std::max<size_t>(1, memory_bound));
+
+    const auto per_appender = _bytes_per_sec
+                              / static_cast<double>(
+                                std::max<size_t>(1, _active_appenders));
+    const auto step = std::chrono::duration<double>(sample_period).count()
+                      * per_appender;
+    _fallocation_step = ss::align_up<size_t>(
+      std::clamp<size_t>(
+        static_cast<size_t>(step), min_fallocation_step, max_fallocation_step),
+      1_MiB);
+
+    vlog(
+      stlog.trace,
+      "write-behind: latency {}us (min {}us), {} bytes/sec, {} appenders, {} "
+      "waits: {} chunks in flight, fallocation step {}",
+      _latency_us,
+      _min_latency_us,
+      _bytes_per_sec,
+      _active_appenders,
+      waits,
+      _max_inflight_chunks,
+      _fallocation_step);
+
+    _period_start = now;
+    _period_writes = 0;
+    _period_bytes = 0;
+    _period_latency_us = 0;
+    _period_start_waits = _waits;
+    _period_appenders.clear();
+}
+
+void write_behind_controller::setup_metrics() {
+    if (config::shard_local_cfg().disable_metrics()) {
+        return;
+    }
+    namespace sm = ss::metrics;
+    _metrics.add_group(
+      prometheus_sanitize::metrics_name("storage:write_behind"),
+      {
+        sm::make_gauge(
+          "max_inflight_chunks",
+          [this] { return _max_inflight_chunks; },
+          sm::description("Chunks a segment appender may have in flight")),
+        sm::make_gauge(
+          "fallocation_step_bytes",
+          [this] { return _fallocation_step; },
+          sm::description("Bytes reserved by each segment fallocation")),
+        sm::make_gauge(
+          "write_latency_us",
+          [this] { return _latency_us; },
+          sm::description("Smoothed latency of background segment writes")),
+        sm::make_gauge(
+          "min_write_latency_us",
+          [this] { return _min_latency_us; },
+          sm::description("Baseline latency of background segment writes")),
+        sm::make_gauge(
+          "write_bytes_per_sec",
+          [this] { return _bytes_per_sec; },
+          sm::description("Smoothed throughput of background segment writes")),
+        sm::make_gauge(
+          "active_appenders",
+          [this] { return _active_appenders; },
+          sm::description("Segment appenders that wrote in the last period")),
+        sm::make_derive(
+          "waits",
+          [this] { return _waits; },
+          sm::description("Appends that waited for write-behind to drain")),
+      });
+}
+
+} // namespace storage::internal
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+#include "seastarx.h"
+#include "units.h"
+
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/core/timer.hh>
+
+#include <absl/container/flat_hash_set.h>
+
+#include <chrono>
+
+namespace storage::internal {
+
+/**
+ * Tunes the write-behind of the segment appenders of a shard from the latency
+ * and throughput of their background writes. All the segments of a shard live
+ * on the same device, so the observations of every appender are pooled.
+ *
+ * Once per sample period:
+ *
+ * - the number of chunks an appender may have in flight grows by one while
+ *   appenders are waiting for write-behind and the mean write latency stays
+ *   close to the lowest latency observed, and it is halved when the latency
+ *   shows that the device queue is building up. The limit is bounded so that
+ *   the active appenders together stay within the chunk cache memory.
+ * - the fallocation step is sized to about a sample period worth of writes of
+ *   a single appender, so slow devices fallocate less often under load and
+ *   idle partitions reserve less space.
+ */
+class write_behind_controller {
+public:
+    using clock_type = ss::steady_clock_type;
+
+    static constexpr std::chrono::seconds sample_period{1};
+    static constexpr size_t min_fallocation_step = 4_MiB;
+    static constexpr size_t max_fallocation_step = 128_MiB;
+
+    write_behind_controller() noexcept;
+    write_behind_controller(write_behind_controller&&) = delete;
+    write_behind_controller& operator=(write_behind_controller&&) = delete;
+    write_behind_controller(const write_behind_controller&) = delete;
+    write_behind_controller& operator=(const write_behind_controller&) = delete;
+    ~write_behind_controller() noexcept = default;
+
+    /// \brief enables the adaptive mode and registers the metrics
+    void start(bool enabled);
+
+    bool enabled() const { return _enabled; }
+    /// \brief number of chunks an appender may have in flight
+    size_t max_inflight_chunks() const { return _max_inflight_chunks; }
+    size_t fallocation_step() const { return _fallocation_step; }
+
+    /// \brief records a background write of \p bytes by \p appender
+    void record_write(
+      const void* appender,
+      size_t bytes,
+      clock_type::duration latency,
+      clock_type::time_point now = clock_type::now());
+    /// \brief records an append that waited for write-behind to drain
+    void record_wait() { ++_waits; }
+
+private:
+    void update(clock_type::time_point now);
+    void setup_metrics();
+
+    bool _enabled{false};
+    size_t _max_inflight_chunks;
+    size_t _fallocation_step;
+
+    // smoothed observations, valid once a period has been sampled
+    double _latency_us{0};
+    double _min_latency_us{0};
+    double _bytes_per_sec{0};
+
+    // current sample period
+    clock_type::time_point _period_start;
+    uint64_t _period_writes{0};
+    uint64_t _period_bytes{0};
+    double _period_latency_us{0};
+    uint64_t _period_start_waits{0};
+    absl::flat_hash_set<const void*> _period_appenders;
+    size_t _active_appenders{0};
+
+    uint64_t _waits{0};
+    ss::metrics::metric_groups _metrics;
+};
+
+inline write_behind_controller& write_behind() {
+    static thread_local write_behind_controller controller;
+    return controller;
+}
+
+} // namespace storage::internal
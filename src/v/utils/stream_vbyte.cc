@@ -0,0 +1,164 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "utils/stream_vbyte.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if !defined __aarch64__
+#include <immintrin.h>
+#endif
+
+namespace stream_vbyte {
+
+static_assert(
+  std::endian::native == std::endian::little,
+  "data bytes are copied straight from the in memory representation");
+
+// lengths above 8 come only from malformed input, they are clamped so that
+// the decoder never reads past the data bytes and the padding
+static constexpr uint8_t nibble_length(uint8_t nibble) {
+    return nibble > 8 ? 8 : nibble;
+}
+
+static constexpr std::array<uint8_t, 256> make_length_table() {
+    std::array<uint8_t, 256> table{};
+    for (size_t c = 0; c < table.size(); ++c) {
+        table[c] = nibble_length(c & 0x0f) + nibble_length(c >> 4);
+    }
+    return table;
+}
+
+static constexpr std::array<uint64_t, 9> make_mask_table() {
+    std::array<uint64_t, 9> table{};
+    for (size_t len = 1; len < table.size(); ++len) {
+        table[len] = ~uint64_t(0) >> (64 - 8 * len);
+    }
+    return table;
+}
+
+/// data length of both values of a control byte
+static constexpr auto length_table = make_length_table();
+/// value mask for every length
+static constexpr auto mask_table = make_mask_table();
+
+static inline uint8_t value_length(uint64_t v) {
+    return (71 - std::countl_zero(v)) / 8;
+}
+
+static inline const uint8_t*
+decode_one(const uint8_t* data, uint8_t nibble, uint64_t* out) {
+    const uint8_t len = nibble_length(nibble);
+    uint64_t v;
+    std::memcpy(&v, data, sizeof(v));
+    *out = v & mask_table[len];
+    return data + len;
+}
+
+size_t encode(const uint64_t* in, size_t n, uint8_t* out) noexcept {
+    uint8_t* control = out;
+    uint8_t* data = out + control_size(n);
+    std::memset(control, 0, control_size(n));
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t len = value_length(in[i]);
+        control[i / 2] |= len << (4 * (i & 1));
+        // always stores all 8 bytes, the next value overwrites the unused ones
+        std::memcpy(data, &in[i], sizeof(uint64_t));
+        data += len;
+    }
+    return data - out;
+}
+
+size_t data_size(const uint8_t* control, size_t n) noexcept {
+    size_t size = 0;
+    for (size_t i = 0; i < n / 2; ++i) {
+        size += length_table[control[i]];
+    }
+    if (n & 1) {
+        size += nibble_length(control[n / 2] & 0x0f);
+    }
+    return size;
+}
+
+size_t decode_scalar(const uint8_t* in, size_t n, uint64_t* out) noexcept {
+    const uint8_t* control = in;
+    const uint8_t* data = in + control_size(n);
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t nibble = (control[i / 2] >> (4 * (i & 1))) & 0x0f;
+        data = decode_one(data, nibble, out + i);
+    }
+    return data - in;
+}
+
+#if !defined __aarch64__
+/*
+ * shuffle mask of every control byte, moves the data bytes of the first value
+ * to the low 8 bytes of the register and of the second value to the high 8
+ * bytes. 0x80 zeroes the destination byte.
+ */
+static constexpr std::array<std::array<uint8_t, 16>, 256>
+make_shuffle_table() {
+    std::array<std::array<uint8_t, 16>, 256> table{};
+    for (size_t c = 0; c < table.size(); ++c) {
+        const uint8_t first = nibble_length(c & 0x0f);
+        const uint8_t second = nibble_length(c >> 4);
+        for (uint8_t b = 0; b < 8; ++b) {
+            table[c][b] = b < first ? b : 0x80;
+            table[c][8 + b] = b < second ? first + b : 0x80;
+        }
+    }
+    return table;
+}
+
+alignas(16) static constexpr auto shuffle_table = make_shuffle_table();
+
+[[gnu::target("ssse3")]] static size_t
+decode_ssse3(const uint8_t* in, size_t n, uint64_t* out) {
+    const uint8_t* control = in;
+    const uint8_t* data = in + control_size(n);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const uint8_t c = control[i / 2];
+        const __m128i v = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(data));
+        const __m128i shuffle = _mm_load_si128(
+          reinterpret_cast<const __m128i*>(shuffle_table[c].data()));
+        _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out + i), _mm_shuffle_epi8(v, shuffle));
+        data += length_table[c];
+    }
+    if (i < n) {
+        data = decode_one(data, control[i / 2] & 0x0f, out + i);
+    }
+    return data - in;
+}
+#endif
+
+using decode_fn = size_t (*)(const uint8_t*, size_t, uint64_t*);
+
+static decode_fn select_decode() {
+#if !defined __aarch64__
+    // may run before the cpu detection constructor, see syschecks.h
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3")) {
+        return decode_ssse3;
+    }
+#endif
+    return decode_scalar;
+}
+
+static const decode_fn decode_impl = select_decode();
+
+size_t decode(const uint8_t* in, size_t n, uint64_t* out) noexcept {
+    return decode_impl(in, n, out);
+}
+
+} // namespace stream_vbyte
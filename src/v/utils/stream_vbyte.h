@@ -0,0 +1,56 @@
+/*
+ * Copyright 2021 Vectorized, Inc.
+ *
+ * Use of this software is governed by the Business Source License
+ * included in the file licenses/BSL.md
+ *
+ * As of the Change Date specified in that file, in accordance with
+ * the Business Source License, use of this software will be governed
+ * by the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Stream VByte encoding of 64 bit unsigned integers.
+ * https://arxiv.org/abs/1709.08990
+ *
+ * Unlike varint, the lengths of the values are kept apart from the value
+ * bytes. Every value has a 4 bit control nibble holding its length in bytes
+ * (0 - 8, zero is encoded with no data bytes at all), two nibbles per control
+ * byte. All control bytes precede the data bytes:
+ *
+ *    [ control: (n + 1) / 2 bytes ][ data: sum of lengths bytes ]
+ *
+ * Decoding a control byte doesn't depend on the data of previous values, so
+ * a single shuffle turns the data of two values into two 64 bit integers.
+ * Signed values must be zigzag encoded first (see vint::encode_zigzag).
+ */
+namespace stream_vbyte {
+
+inline constexpr size_t control_size(size_t n) { return (n + 1) / 2; }
+
+inline constexpr size_t max_encoded_size(size_t n) {
+    return control_size(n) + n * sizeof(uint64_t);
+}
+
+/// decoder input must be readable this many bytes past the encoded data
+inline constexpr size_t decode_padding = 16;
+
+/// \brief encodes \p n values into \p out, which must have room for
+/// max_encoded_size(n) bytes. returns number of bytes written
+size_t encode(const uint64_t* in, size_t n, uint8_t* out) noexcept;
+
+/// \brief size of the data bytes described by the control bytes of \p n
+/// values
+size_t data_size(const uint8_t* control, size_t n) noexcept;
+
+/// \brief decodes \p n values. returns number of bytes consumed. dispatches at
+/// runtime to an SSSE3 kernel when the cpu supports it
+size_t decode(const uint8_t* in, size_t n, uint64_t* out) noexcept;
+size_t decode_scalar(const uint8_t* in, size_t n, uint64_t* out) noexcept;
+
+} // namespace stream_vbyte
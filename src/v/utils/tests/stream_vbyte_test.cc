@@ -0,0 +1,80 @@
+// Copyright 2021 Vectorized, Inc.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.md
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0
+
+#include "utils/stream_vbyte.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> encode(const std::vector<uint64_t>& values) {
+    std::vector<uint8_t> buf(
+      stream_vbyte::max_encoded_size(values.size())
+      + stream_vbyte::decode_padding);
+    auto sz = stream_vbyte::encode(values.data(), values.size(), buf.data());
+    BOOST_REQUIRE_EQUAL(
+      sz,
+      stream_vbyte::control_size(values.size())
+        + stream_vbyte::data_size(buf.data(), values.size()));
+    buf.resize(sz + stream_vbyte::decode_padding);
+    return buf;
+}
+
+void check_roundtrip(const std::vector<uint64_t>& values) {
+    auto buf = encode(values);
+    const size_t encoded = buf.size() - stream_vbyte::decode_padding;
+
+    std::vector<uint64_t> simd(values.size());
+    std::vector<uint64_t> scalar(values.size());
+    BOOST_REQUIRE_EQUAL(
+      stream_vbyte::decode(buf.data(), values.size(), simd.data()), encoded);
+    BOOST_REQUIRE_EQUAL(
+      stream_vbyte::decode_scalar(buf.data(), values.size(), scalar.data()),
+      encoded);
+    BOOST_REQUIRE(simd == values);
+    BOOST_REQUIRE(scalar == values);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(stream_vbyte_empty) { check_roundtrip({}); }
+
+BOOST_AUTO_TEST_CASE(stream_vbyte_zeros_have_no_data_bytes) {
+    std::vector<uint64_t> zeros(31, 0);
+    auto buf = encode(zeros);
+    BOOST_REQUIRE_EQUAL(
+      buf.size() - stream_vbyte::decode_padding,
+      stream_vbyte::control_size(zeros.size()));
+    check_roundtrip(zeros);
+}
+
+BOOST_AUTO_TEST_CASE(stream_vbyte_every_length) {
+    std::vector<uint64_t> values;
+    for (int bits = 0; bits <= 64; ++bits) {
+        values.push_back(bits == 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1);
+        values.push_back(bits == 64 ? 0 : uint64_t(1) << bits);
+    }
+    check_roundtrip(values);
+}
+
+BOOST_AUTO_TEST_CASE(stream_vbyte_random_sizes) {
+    std::mt19937_64 rng(0);
+    for (size_t n = 1; n < 300; ++n) {
+        std::vector<uint64_t> values(n);
+        for (auto& v : values) {
+            const auto bits = rng() % 65;
+            v = bits == 64 ? rng() : rng() & ((uint64_t(1) << bits) - 1);
+        }
+        check_roundtrip(values);
+    }
+}